@@ -0,0 +1,37 @@
+#ifndef _OSMAND_CORE_CONCURRENT_PARALLEL_FOR_H_
+#define _OSMAND_CORE_CONCURRENT_PARALLEL_FOR_H_
+
+#include <OsmAndCore/stdlib_common.h>
+#include <functional>
+
+#include <OsmAndCore/QtExtensions.h>
+#include <QThreadPool>
+
+#include <OsmAndCore.h>
+
+namespace OsmAnd
+{
+    namespace Concurrent
+    {
+        struct OSMAND_CORE_API ParallelFor Q_DECL_FINAL
+        {
+            typedef std::function<void (const int index)> Body;
+
+            // Invokes body for each index in [0, count) and returns once all of them were processed.
+            // Calling thread takes part in processing, so progress is guaranteed even if thread pool
+            // is saturated (e.g. when called from one of its own threads). Zero maxConcurrency means
+            // as many as thread pool allows.
+            static void run(
+                QThreadPool* const threadPool,
+                const int count,
+                const Body body,
+                const int maxConcurrency = 0);
+
+        private:
+            ParallelFor();
+            ~ParallelFor();
+        };
+    }
+}
+
+#endif // !defined(_OSMAND_CORE_CONCURRENT_PARALLEL_FOR_H_)
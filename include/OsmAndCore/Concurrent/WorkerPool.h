@@ -24,6 +24,10 @@ namespace OsmAnd
             Q_DISABLE_COPY_AND_MOVE(WorkerPool);
 
         public:
+            // Runnables with higher priority are always executed first, order only decides between
+            // runnables of equal priority. New runnables are put to the front of queue, and FIFO takes
+            // runnables from its front (so most recently enqueued is executed first), while LIFO takes
+            // them from its back (so the oldest is executed first).
             enum class Order
             {
                 FIFO,
@@ -32,6 +36,7 @@ namespace OsmAnd
             };
 
             typedef std::function<bool (QRunnable* const l, QRunnable* const r)> SortPredicate;
+            typedef std::function<int64_t (QRunnable* const runnable)> PriorityFunction;
 
         private:
             PrivateImplementation<WorkerPool_P> _p;
@@ -56,6 +61,15 @@ namespace OsmAnd
 
             void sortQueue(const SortPredicate predicate);
 
+            // Enqueue runnables with explicit priorities. Unlike sorting predicates, priorities cost
+            // O(log n) per enqueued runnable and do not require queue to be sorted
+            void enqueueWithPriority(QRunnable* const runnable, const int64_t priority);
+            void enqueueWithPriorities(const QVector<QRunnable*>& runnables, const PriorityFunction priorityFunction);
+
+            // Re-evaluates priorities of all queued runnables in O(n)
+            void updatePriorities(const PriorityFunction priorityFunction);
+            unsigned int queueSize() const;
+
             void reset();
         };
     }
@@ -37,7 +37,7 @@ namespace OsmAnd
         PrivateImplementation<ObfReader_P> _p;
     protected:
     public:
-        ObfReader(const std::shared_ptr<const ObfFile>& obfFile);
+        ObfReader(const std::shared_ptr<const ObfFile>& obfFile, const bool useMemoryMapping = false);
         ObfReader(const std::shared_ptr<QIODevice>& input);
         virtual ~ObfReader();
 
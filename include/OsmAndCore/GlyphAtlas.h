@@ -0,0 +1,128 @@
+#ifndef _OSMAND_CORE_GLYPH_ATLAS_H_
+#define _OSMAND_CORE_GLYPH_ATLAS_H_
+
+#include <OsmAndCore/stdlib_common.h>
+
+#include <OsmAndCore/QtExtensions.h>
+#include <QVector>
+
+#include <OsmAndCore.h>
+#include <OsmAndCore/CommonTypes.h>
+#include <OsmAndCore/PointsAndAreas.h>
+#include <OsmAndCore/PrivateImplementation.h>
+
+class SkBitmap;
+class SkPaint;
+
+namespace OsmAnd
+{
+    class GlyphAtlas_P;
+    class OSMAND_CORE_API GlyphAtlas
+    {
+        Q_DISABLE_COPY_AND_MOVE(GlyphAtlas);
+    public:
+        enum class Mode
+        {
+            // Pages contain glyph coverage, rasterized for each font size and halo radius
+            Coverage,
+
+            // Pages contain signed distance fields of glyphs, rasterized once per font at base size.
+            // Values above 128 are inside of glyph, and each 127/spread step is a texel of distance.
+            SignedDistanceField,
+        };
+
+        enum {
+            DefaultPageSize = 1024,
+            DefaultMaxPagesCount = 4,
+            DefaultSignedDistanceFieldSpread = 4,
+        };
+
+        struct Glyph Q_DECL_FINAL
+        {
+            Glyph()
+                : pageIndex(0)
+                , rasterizedSize(0.0f)
+            {
+            }
+
+            // Area of glyph in page, is empty for glyphs without any visible pixels (e.g. spaces)
+            unsigned int pageIndex;
+            AreaI area;
+
+            // Offset of area top-left corner from pen position on baseline, at rasterized size
+            PointF offset;
+            float rasterizedSize;
+        };
+
+        struct GlyphQuad Q_DECL_FINAL
+        {
+            GlyphQuad()
+                : pageIndex(0)
+                , isHalo(false)
+            {
+            }
+
+            unsigned int pageIndex;
+
+            // Position of quad in text space, in pixels, and normalized texture coordinates in page
+            AreaF area;
+            AreaF textureArea;
+
+            bool isHalo;
+        };
+
+    private:
+        PrivateImplementation<GlyphAtlas_P> _p;
+    protected:
+    public:
+        GlyphAtlas(
+            const Mode mode = Mode::Coverage,
+            const unsigned int pageSize = DefaultPageSize,
+            const float signedDistanceFieldBaseSize = 32.0f,
+            const unsigned int signedDistanceFieldSpread = DefaultSignedDistanceFieldSpread,
+            const unsigned int maxPagesCount = DefaultMaxPagesCount);
+        virtual ~GlyphAtlas();
+
+        const Mode mode;
+        const unsigned int pageSize;
+        const float signedDistanceFieldBaseSize;
+        const unsigned int signedDistanceFieldSpread;
+        // Atlas never holds more pages than this: once all of them are full, glyphs that are not in atlas yet
+        // can't be obtained (and text has to be rasterized into bitmap instead), until atlas is cleared
+        const unsigned int maxPagesCount;
+
+        // Returns glyph of typeface, size and fake-bold setting of paint, rasterizing it into atlas if needed
+        bool obtainGlyph(
+            const SkPaint& paint,
+            const uint16_t glyphId,
+            const unsigned int haloRadius,
+            Glyph& outGlyph);
+
+        // Reserves area of given size in one of pages
+        bool allocateArea(
+            const PointI& size,
+            unsigned int& outPageIndex,
+            AreaI& outArea);
+
+        unsigned int getPagesCount() const;
+        bool copyPage(
+            const unsigned int pageIndex,
+            SkBitmap& outBitmap,
+            unsigned int* const outRevision = nullptr) const;
+        unsigned int getPageRevision(const unsigned int pageIndex) const;
+
+        // Removes all pages and glyphs. Generation is incremented, so that quads and page copies made before
+        // can be recognized as invalid.
+        void clear();
+        unsigned int getGeneration() const;
+
+        static void computeSignedDistanceField(
+            const uint8_t* const coverage,
+            const unsigned int width,
+            const unsigned int height,
+            const unsigned int spread,
+            uint8_t* const outDistances);
+    };
+}
+
+#endif // !defined(_OSMAND_CORE_GLYPH_ATLAS_H_)
@@ -26,6 +26,8 @@ namespace OsmAnd
         /* Time elapsed for symbols stage */                                                                    \
         FIELD_ACTION(float, elapsedTimeForSymbolsStage, "s");                                                   \
         FIELD_ACTION(float, elapsedTimeForPreparingSymbols, "s");                                               \
+        FIELD_ACTION(unsigned int, reusedSymbolsPlacements, "");                                                \
+        FIELD_ACTION(unsigned int, incrementalSymbolsPlacements, "");                                           \
         FIELD_ACTION(float, elapsedTimeForPublishingPreparedSymbols, "s");                                      \
         FIELD_ACTION(float, elapsedTimeForObtainingRenderableSymbols, "s");                                     \
         FIELD_ACTION(float, elapsedTimeForObtainingRenderableSymbolsWithLock, "s");                             \
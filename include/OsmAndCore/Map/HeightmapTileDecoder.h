@@ -0,0 +1,33 @@
+#ifndef _OSMAND_CORE_HEIGHTMAP_TILE_DECODER_H_
+#define _OSMAND_CORE_HEIGHTMAP_TILE_DECODER_H_
+
+#include <OsmAndCore/stdlib_common.h>
+
+#include <OsmAndCore/QtExtensions.h>
+#include <OsmAndCore/ignore_warnings_on_external_includes.h>
+#include <QByteArray>
+#include <OsmAndCore/restore_internal_warnings.h>
+
+#include <OsmAndCore.h>
+
+namespace OsmAnd
+{
+    // Decodes single-band Int16 heightmap tiles into caller-provided buffer of tileSize*tileSize floats.
+    // Uncompressed, Deflate and LZW GeoTIFFs, as well as raw little-endian Int16 rasters, are decoded
+    // directly. Anything else is passed to GDAL.
+    struct OSMAND_CORE_API HeightmapTileDecoder Q_DECL_FINAL
+    {
+        static bool decode(const QByteArray& data, const uint32_t tileSize, float* const outHeights);
+
+        // Return false for anything they can not handle, without logging an error
+        static bool decodeGeoTiff(const QByteArray& data, const uint32_t tileSize, float* const outHeights);
+        static bool decodeRaw(const QByteArray& data, const uint32_t tileSize, float* const outHeights);
+
+        static bool decodeUsingGDAL(const QByteArray& data, const uint32_t tileSize, float* const outHeights);
+    private:
+        HeightmapTileDecoder();
+        ~HeightmapTileDecoder();
+    };
+}
+
+#endif // !defined(_OSMAND_CORE_HEIGHTMAP_TILE_DECODER_H_)
@@ -0,0 +1,139 @@
+#ifndef _OSMAND_CORE_HILLSHADE_TILE_PROVIDER_H_
+#define _OSMAND_CORE_HILLSHADE_TILE_PROVIDER_H_
+
+#include <OsmAndCore/stdlib_common.h>
+
+#include <OsmAndCore/QtExtensions.h>
+#include <QVector>
+
+#include <OsmAndCore.h>
+#include <OsmAndCore/CommonTypes.h>
+#include <OsmAndCore/PrivateImplementation.h>
+#include <OsmAndCore/Map/IRasterMapLayerProvider.h>
+#include <OsmAndCore/Map/IMapElevationDataProvider.h>
+
+namespace OsmAnd
+{
+    // Shades relief on CPU from elevation tiles (e.g. ones served by HeightmapTileProvider), so that
+    // no precomputed hillshade database is needed. Edges of each tile are stitched with neighbour tiles.
+    class HillshadeTileProvider_P;
+    class OSMAND_CORE_API HillshadeTileProvider : public IRasterMapLayerProvider
+    {
+        Q_DISABLE_COPY_AND_MOVE(HillshadeTileProvider);
+    public:
+        enum class Mode
+        {
+            // Lit by sun, from black (facing away from sun) to white (facing sun)
+            Hillshade,
+            // From black (flat) to white (vertical)
+            Slope,
+            // Downslope direction clockwise from north, from black (0 degrees) to white (360 degrees)
+            Aspect,
+        };
+
+        struct TilesCacheStatistics Q_DECL_FINAL
+        {
+            TilesCacheStatistics()
+                : hits(0)
+                , misses(0)
+                , entriesCount(0)
+                , sizeInBytes(0)
+                , sizeLimitInBytes(0)
+            {
+            }
+
+            unsigned int hits;
+            unsigned int misses;
+            unsigned int entriesCount;
+            unsigned int sizeInBytes;
+            unsigned int sizeLimitInBytes;
+        };
+
+        enum {
+            DefaultTilesCacheSizeLimitInBytes = 16 * 1024 * 1024,
+            ElevationTilesCacheSize = 64,
+        };
+
+    private:
+        PrivateImplementation<HillshadeTileProvider_P> _p;
+    protected:
+    public:
+        HillshadeTileProvider(
+            const std::shared_ptr<IMapElevationDataProvider>& elevationDataProvider,
+            const Mode mode = Mode::Hillshade,
+            const float sunAzimuth = 315.0f,
+            const float sunAltitude = 45.0f,
+            const float zFactor = 1.0f,
+            const uint32_t tileSize = 256,
+            const float densityFactor = 1.0f);
+        virtual ~HillshadeTileProvider();
+
+        const std::shared_ptr<IMapElevationDataProvider> elevationDataProvider;
+        const Mode mode;
+        // Degrees clockwise from north
+        const float sunAzimuth;
+        // Degrees above horizon
+        const float sunAltitude;
+        // Vertical exaggeration
+        const float zFactor;
+        const uint32_t tileSize;
+        const float densityFactor;
+
+        virtual MapStubStyle getDesiredStubsStyle() const;
+
+        virtual float getTileDensityFactor() const;
+        virtual uint32_t getTileSize() const;
+
+        virtual bool supportsNaturalObtainData() const Q_DECL_OVERRIDE;
+        virtual bool obtainData(
+            const IMapDataProvider::Request& request,
+            std::shared_ptr<IMapDataProvider::Data>& outData,
+            std::shared_ptr<Metric>* const pOutMetric = nullptr) Q_DECL_OVERRIDE;
+
+        virtual bool supportsNaturalObtainDataAsync() const Q_DECL_OVERRIDE;
+        virtual void obtainDataAsync(
+            const IMapDataProvider::Request& request,
+            const IMapDataProvider::ObtainDataAsyncCallback callback,
+            const bool collectMetric = false) Q_DECL_OVERRIDE;
+
+        virtual ZoomLevel getMinZoom() const;
+        virtual ZoomLevel getMaxZoom() const;
+
+        // Computed tiles are kept in memory, so that tile requested again is not computed again.
+        // Size limit is in bytes of pixel data, 0 disables the cache.
+        TilesCacheStatistics getTilesCacheStatistics() const;
+        void setTilesCacheSizeLimit(const unsigned int sizeLimitInBytes);
+        void clearTilesCache();
+
+        // Obtains heights of elevation tile in meters, padded with one sample of neighbour tiles around
+        // each edge, as they are passed to computeShading. Size is 0 if there's no elevation data for tile.
+        bool obtainPaddedElevationHeights(
+            const TileId tileId,
+            const ZoomLevel zoom,
+            QVector<float>& outHeights,
+            uint32_t& outSize,
+            const std::shared_ptr<const IQueryController>& queryController = nullptr);
+
+        // Applies 3x3 Horn kernel to (size+2)x(size+2) heights in meters, which include one sample of
+        // neighbour data around each edge. Cell size is distance between samples in meters. Writes
+        // size*size values from 0 to 255.
+        static void computeShading(
+            const float* const paddedHeights,
+            const unsigned int size,
+            const float cellSize,
+            const Mode mode,
+            const float sunAzimuth,
+            const float sunAltitude,
+            const float zFactor,
+            uint8_t* const outValues);
+
+        // Bilinearly resamples (size+2)x(size+2) padded heights to (resampledSize+2)x(resampledSize+2)
+        static void resampleHeights(
+            const float* const paddedHeights,
+            const uint32_t size,
+            const uint32_t resampledSize,
+            float* const outPaddedHeights);
+    };
+}
+
+#endif // !defined(_OSMAND_CORE_HILLSHADE_TILE_PROVIDER_H_)
@@ -5,6 +5,7 @@
 
 #include <OsmAndCore/QtExtensions.h>
 #include <QList>
+#include <QVector>
 
 #include <OsmAndCore.h>
 #include <OsmAndCore/CommonSWIG.h>
@@ -49,6 +50,33 @@ namespace OsmAnd
             std::shared_ptr<const MapSymbolsGroup::AdditionalSymbolInstanceParameters> instanceParameters;
         };
 
+        struct PredictedCameraPosition Q_DECL_FINAL
+        {
+            PredictedCameraPosition()
+                : zoomLevel(InvalidZoomLevel)
+            {
+            }
+
+            PredictedCameraPosition(const PointI& target31_, const ZoomLevel zoomLevel_)
+                : target31(target31_)
+                , zoomLevel(zoomLevel_)
+            {
+            }
+
+            PointI target31;
+            ZoomLevel zoomLevel;
+
+            inline bool operator==(const PredictedCameraPosition& r) const
+            {
+                return target31 == r.target31 && zoomLevel == r.zoomLevel;
+            }
+
+            inline bool operator!=(const PredictedCameraPosition& r) const
+            {
+                return !(*this == r);
+            }
+        };
+
     private:
     protected:
         IMapRenderer();
@@ -126,6 +154,12 @@ namespace OsmAnd
 
         virtual bool setStubsStyle(const MapStubStyle style, bool forcedUpdate = false) = 0;
 
+        // Positions that camera is expected to pass soon, ordered from nearest to farthest. Resources around them
+        // are requested ahead of time with low priority. Each call replaces previous prediction, and resources
+        // that were requested only for positions that are no longer predicted are released.
+        virtual QVector<PredictedCameraPosition> getPredictedCameraPositions() const = 0;
+        virtual void setPredictedCameraPositions(const QVector<PredictedCameraPosition>& positions) = 0;
+
         virtual std::shared_ptr<MapRendererDebugSettings> getDebugSettings() const = 0;
         virtual void setDebugSettings(const std::shared_ptr<const MapRendererDebugSettings>& debugSettings) = 0;
 
@@ -27,6 +27,7 @@ namespace OsmAnd
     class ObfMapSectionInfo;
 
     class MapPresentationEnvironment_P;
+    class MapPrimitiviser_P;
     class OSMAND_CORE_API MapPresentationEnvironment
     {
         Q_DISABLE_COPY_AND_MOVE(MapPresentationEnvironment);
@@ -90,6 +91,12 @@ namespace OsmAnd
         QHash< OsmAnd::IMapStyle::ValueDefinitionId, MapStyleConstantValue > getSettings() const;
         void setSettings(const QHash< OsmAnd::IMapStyle::ValueDefinitionId, MapStyleConstantValue >& newSettings);
         void setSettings(const QHash< QString, QString >& newSettings);
+        // Incremented each time settings are changed, so that results that depend on settings can be cached
+        unsigned int getSettingsRevision() const;
+
+        // Memoization of map style evaluation results shared by all primitivisations using this environment
+        bool isStyleEvaluationsCacheEnabled() const;
+        void setStyleEvaluationsCacheEnabled(const bool enabled);
 
         void applyTo(MapStyleEvaluator& evaluator) const;
 
@@ -116,6 +123,8 @@ namespace OsmAnd
             DefaultShadowLevelMin = 0,
             DefaultShadowLevelMax = 256,
         };
+
+    friend class OsmAnd::MapPrimitiviser_P;
     };
 }
 
@@ -7,6 +7,7 @@
 
 #include <OsmAndCore/QtExtensions.h>
 #include <QList>
+#include <QThreadPool>
 
 #include <OsmAndCore.h>
 #include <OsmAndCore/CommonTypes.h>
@@ -22,6 +23,7 @@ namespace OsmAnd
 {
     class MapObject;
     class MapPresentationEnvironment;
+    template<typename OBJECT, unsigned int BLOCK_CAPACITY> class SharedObjectsArena;
 
     class MapPrimitiviser_P;
     class OSMAND_CORE_API MapPrimitiviser
@@ -118,6 +120,7 @@ namespace OsmAnd
 
         friend class OsmAnd::MapPrimitiviser;
         friend class OsmAnd::MapPrimitiviser_P;
+        template<typename OBJECT, unsigned int BLOCK_CAPACITY> friend class OsmAnd::SharedObjectsArena;
         };
 
         class Symbol;
@@ -298,6 +301,13 @@ namespace OsmAnd
 
         const std::shared_ptr<const MapPresentationEnvironment> environment;
 
+        // Opt-in parallel mode: large lists of map objects are split into chunks that are primitivised by tasks
+        // on given thread pool (calling thread participates too), each with own style evaluators. Results are
+        // merged in the order of source objects. Passing nullptr disables parallel mode.
+        QThreadPool* getParallelPrimitivisationThreadPool() const;
+        int getMaxParallelPrimitivisationTasks() const;
+        void setParallelPrimitivisation(QThreadPool* const threadPool, const int maxParallelTasks = 0);
+
         std::shared_ptr<PrimitivisedObjects> primitiviseAllMapObjects(
             const ZoomLevel zoom,
             const QList< std::shared_ptr<const MapObject> >& objects,
@@ -87,6 +87,9 @@ namespace OsmAnd
         /* Time spent on Point processing */                                                        \
         FIELD_ACTION(float, elapsedTimeForPointProcessing, "s");                                    \
                                                                                                     \
+        /* Number of style evaluations served from style evaluations cache */                       \
+        FIELD_ACTION(unsigned int, styleEvaluationsCacheHits, "");                                  \
+                                                                                                    \
         /* Time spent on sorting and filtering primitives */                                        \
         FIELD_ACTION(float, elapsedTimeForSortingAndFilteringPrimitives, "s");                      \
                                                                                                     \
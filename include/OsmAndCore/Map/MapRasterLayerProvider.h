@@ -39,9 +39,34 @@ namespace OsmAnd
                 const RetainableCacheMetadata* const pRetainableCacheMetadata = nullptr);
             virtual ~Data();
 
+            // Is not available for tiles restored from compressed tiles cache
             std::shared_ptr<const MapPrimitivesProvider::Data> binaryMapData;
         };
 
+        struct CompressedTilesCacheStatistics Q_DECL_FINAL
+        {
+            CompressedTilesCacheStatistics()
+                : hits(0)
+                , misses(0)
+                , entriesCount(0)
+                , sizeInBytes(0)
+                , sizeLimitInBytes(0)
+            {
+            }
+
+            unsigned int hits;
+            unsigned int misses;
+            unsigned int entriesCount;
+            unsigned int sizeInBytes;
+            unsigned int sizeLimitInBytes;
+        };
+
+        enum {
+            DefaultCompressedTilesCacheSizeLimitInBytes = 16 * 1024 * 1024,
+            DefaultCompressedTilesCompressionLevel = 1,
+            DefaultDiskCacheSizeLimitInBytes = 256 * 1024 * 1024,
+        };
+
     private:
         PrivateImplementation<MapRasterLayerProvider_P> _p;
     protected:
@@ -79,6 +104,28 @@ namespace OsmAnd
 
         virtual ZoomLevel getMinZoom() const;
         virtual ZoomLevel getMaxZoom() const;
+
+        // Rasterized tiles are also kept compressed in memory, so that tile requested again after it was
+        // released by its consumer is decompressed instead of being primitivised and rasterized again.
+        // Size limit is in bytes of compressed data, 0 disables the cache.
+        CompressedTilesCacheStatistics getCompressedTilesCacheStatistics() const;
+        void setCompressedTilesCacheSizeLimit(const unsigned int sizeLimitInBytes);
+        // zlib compression level, from 1 (fastest) to 9 (smallest)
+        void setCompressedTilesCompressionLevel(const int compressionLevel);
+        void clearCompressedTilesCache();
+
+        // Rasterized tiles may also be stored on disk, so that they survive restarts. Tiles are stored in a
+        // subdirectory named after fingerprint of map style, its settings and provider parameters, and name
+        // of each tile file includes version of OBF files, so that installing or updating any OBF invalidates
+        // stored tiles. Version tag is part of fingerprint too, and should be changed if map style files were
+        // updated. Empty path disables the cache. Disk cache is used only with OBF map objects provider.
+        QString getDiskCachePath() const;
+        void setDiskCachePath(const QString& diskCachePath, const QString& versionTag = QString());
+        // Size limit applies to all tiles under disk cache path, including ones stored with other fingerprints.
+        // Once it's exceeded, least recently used tiles are removed, along with directories left empty.
+        // 0 means no limit.
+        uint64_t getDiskCacheSizeLimit() const;
+        void setDiskCacheSizeLimit(const uint64_t sizeLimitInBytes);
     };
 }
 
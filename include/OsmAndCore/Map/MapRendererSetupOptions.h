@@ -76,6 +76,19 @@ namespace OsmAnd
         }
 #endif // !defined(SWIG)
 
+        // Limit number of tiles per resource type that are requested ahead of camera, at predicted positions
+        // or along its current motion. 0 disables prefetching
+        unsigned int maxPrefetchedTilesCount;
+#if !defined(SWIG)
+        inline MapRendererSetupOptions& setMaxPrefetchedTilesCount(
+            const unsigned int newMaxPrefetchedTilesCount)
+        {
+            maxPrefetchedTilesCount = newMaxPrefetchedTilesCount;
+
+            return *this;
+        }
+#endif // !defined(SWIG)
+
         // Display density factor
         float displayDensityFactor;
 #if !defined(SWIG)
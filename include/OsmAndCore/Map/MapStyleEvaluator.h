@@ -43,6 +43,10 @@ namespace OsmAnd
         bool evaluate(
             const std::shared_ptr<const IMapStyle::IAttribute>& attribute,
             MapStyleEvaluationResult* const outResultStorage = nullptr) const;
+
+        // Whether last evaluation inspected map object itself (e.g. its additional tags), so its result
+        // is specific to that map object and can not be reused for other objects with same input values
+        bool wasMapObjectInspected() const;
     };
 }
 
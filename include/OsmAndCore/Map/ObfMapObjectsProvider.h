@@ -7,6 +7,7 @@
 #include <QString>
 #include <QList>
 #include <QSet>
+#include <QThreadPool>
 
 #include <OsmAndCore.h>
 #include <OsmAndCore/PrivateImplementation.h>
@@ -37,11 +38,14 @@ namespace OsmAnd
     public:
         ObfMapObjectsProvider(
             const std::shared_ptr<const IObfsCollection>& obfsCollection,
-            const Mode mode = Mode::BinaryMapObjectsAndRoads);
+            const Mode mode = Mode::BinaryMapObjectsAndRoads,
+            QThreadPool* const parallelReadingThreadPool = nullptr);
         virtual ~ObfMapObjectsProvider();
 
         const std::shared_ptr<const IObfsCollection> obfsCollection;
         const Mode mode;
+        // If set, OBF files of a tile are read in parallel (see ObfDataInterface::setParallelReading)
+        QThreadPool* const parallelReadingThreadPool;
 
         virtual ZoomLevel getMinZoom() const;
         virtual ZoomLevel getMaxZoom() const;
@@ -21,6 +21,7 @@
 namespace OsmAnd
 {
     class ResolvedMapStyle_P;
+    class MapStyleEvaluator_P;
     class OSMAND_CORE_API ResolvedMapStyle : public IMapStyle
     {
         Q_DISABLE_COPY_AND_MOVE(ResolvedMapStyle);
@@ -216,6 +217,8 @@ namespace OsmAnd
 
         static std::shared_ptr<const ResolvedMapStyle> resolveMapStylesChain(
             const QList< std::shared_ptr<const UnresolvedMapStyle> >& unresolvedMapStylesChain);
+
+    friend class OsmAnd::MapStyleEvaluator_P;
     };
 }
 
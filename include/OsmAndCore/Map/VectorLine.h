@@ -88,6 +88,14 @@ namespace OsmAnd
 
         QVector<PointI> getPoints() const;
         void setPoints(const QVector<PointI>& points);
+        // Appends points to the end of line, reusing simplification of all points but the last ones
+        void appendPoints(const QVector<PointI>& points);
+
+        // Simplification is precomputed when points are set or appended. Returns runs of indices of points
+        // that are kept at given tolerance (in 31 units), with segments that intersect given area.
+        QVector< QVector<int> > getSimplifiedRuns(const double tolerance, const AreaI64& area31) const;
+        // Total number of points simplification was computed for, including ones recomputed after appending
+        unsigned int getSimplifiedPointsCount() const;
 
         bool hasUnappliedChanges() const;
 
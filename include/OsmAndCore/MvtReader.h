@@ -3,11 +3,14 @@
 
 #include <OsmAndCore/stdlib_common.h>
 #include <OsmAndCore/QtExtensions.h>
+#include <QByteArray>
 #include <QHash>
 #include <QList>
+#include <QSet>
 #include <QVector>
 #include <QVariant>
 
+#include <OsmAndCore/Callable.h>
 #include <OsmAndCore/PrivateImplementation.h>
 
 static const int UNKNOWN_ID = 0;     // Unsupported id
@@ -125,8 +128,35 @@ namespace OsmAnd
             friend class OsmAnd::MvtReader_P;
         };
         
+        struct OSMAND_CORE_API Filter Q_DECL_FINAL
+        {
+            Filter();
+            ~Filter();
+
+            // Empty set accepts all layers
+            QSet<QString> layerNames;
+            // Empty set accepts all types. LINE_STRING also accepts lines read as MULTI_LINE_STRING.
+            // Polygons are not supported, so they are always skipped.
+            QSet<GeomType> geometryTypes;
+        };
+
+        // Return false to stop reading. Tile holds keys referenced by user data of geometry, while
+        // geometry itself is not added to it.
+        OSMAND_CALLABLE(GeometryVisitor,
+            bool,
+            const std::shared_ptr<const Tile>& tile,
+            const QString& layerName,
+            const std::shared_ptr<const Geometry>& geometry);
+
         static uint8_t getUserDataId(const std::string& key);
-        std::shared_ptr<const Tile> parseTile(const QString &pathToFile) const;
+
+        // Tile is decoded layer by layer, so that only one layer is held in memory at once. Layers and
+        // features rejected by filter are skipped without being decoded. Malformed or truncated tile is
+        // parsed as empty one, while reading it returns false after layers preceding the error were visited.
+        std::shared_ptr<const Tile> parseTile(const QString &pathToFile, const Filter& filter = Filter()) const;
+        std::shared_ptr<const Tile> parseTileData(const QByteArray& data, const Filter& filter = Filter()) const;
+        bool readTile(const QString& pathToFile, const GeometryVisitor visitor, const Filter& filter = Filter()) const;
+        bool readTileData(const QByteArray& data, const GeometryVisitor visitor, const Filter& filter = Filter()) const;
     };
 }
 
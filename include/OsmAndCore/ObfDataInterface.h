@@ -7,6 +7,8 @@
 
 #include <OsmAndCore/QtExtensions.h>
 #include <QList>
+#include <QSet>
+#include <QThreadPool>
 
 #include <OsmAndCore.h>
 #include <OsmAndCore/CommonTypes.h>
@@ -30,6 +32,40 @@ namespace OsmAnd
     {
         Q_DISABLE_COPY_AND_MOVE(ObfDataInterface);
     private:
+        QThreadPool* _parallelReadingThreadPool;
+        int _maxParallelReaders;
+
+        bool loadBinaryMapObjectsInParallel(
+            QList< std::shared_ptr<const OsmAnd::BinaryMapObject> >* resultOut,
+            MapSurfaceType* outSurfaceType,
+            const ZoomLevel zoom,
+            const AreaI* const bbox31,
+            const ObfMapSectionReader::FilterByIdFunction filterById,
+            ObfMapSectionReader::DataBlocksCache* cache,
+            QList< std::shared_ptr<const ObfMapSectionReader::DataBlock> >* outReferencedCacheEntries,
+            const std::shared_ptr<const IQueryController>& queryController,
+            ObfMapSectionReader_Metrics::Metric_loadMapObjects* const metric);
+        bool loadRoadsInParallel(
+            const QList< std::shared_ptr<const ObfReader> >& readers,
+            const QSet<QString>& skippedSectionsNames,
+            const RoutingDataLevel dataLevel,
+            const AreaI* const bbox31,
+            QList< std::shared_ptr<const OsmAnd::Road> >* resultOut,
+            const FilterRoadsByIdFunction filterById,
+            ObfRoutingSectionReader::DataBlocksCache* cache,
+            QList< std::shared_ptr<const ObfRoutingSectionReader::DataBlock> >* outReferencedCacheEntries,
+            const std::shared_ptr<const IQueryController>& queryController,
+            ObfRoutingSectionReader_Metrics::Metric_loadRoads* const metric);
+        bool loadAmenitiesFromReader(
+            const std::shared_ptr<const ObfReader>& obfReader,
+            QList< std::shared_ptr<const OsmAnd::Amenity> >* outAmenities,
+            const AreaI* const bbox31,
+            const TileAcceptorFunction tileFilter,
+            const ZoomLevel zoomFilter,
+            const QHash<QString, QStringList>* const categoriesFilter,
+            const ObfPoiSectionReader::VisitorFunction visitor,
+            const std::shared_ptr<const IQueryController>& queryController);
+        bool shouldReadInParallel() const;
     protected:
     public:
         ObfDataInterface(const QList< std::shared_ptr<const ObfReader> >& obfReaders);
@@ -37,6 +73,15 @@ namespace OsmAnd
 
         const QList< std::shared_ptr<const ObfReader> > obfReaders;
 
+        // Opt-in parallel mode for loadBinaryMapObjects(), loadRoads(), loadMapObjects() and loadAmenities(): each
+        // OBF file is read by its own task on given thread pool (calling thread participates too), results are merged
+        // in the order of obfReaders. In this mode filterById functions are applied during merge on calling thread,
+        // so same object present in several files is accepted from the same file as in sequential reading, while POI
+        // visitor is invoked from worker threads one at a time. Passing nullptr disables parallel mode.
+        QThreadPool* getParallelReadingThreadPool() const;
+        int getMaxParallelReaders() const;
+        void setParallelReading(QThreadPool* const threadPool, const int maxParallelReaders = 0);
+
         bool loadObfFiles(
             QList< std::shared_ptr<const ObfFile> >* outFiles = nullptr,
             const std::shared_ptr<const IQueryController>& queryController = nullptr);
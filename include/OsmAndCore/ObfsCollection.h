@@ -40,6 +40,14 @@ namespace OsmAnd
         SourceOriginId addFile(const QString& filePath);
         bool remove(const SourceOriginId entryId);
 
+        // Readers created by this collection map each OBF file into memory once and share that mapping
+        bool isMemoryMappingEnabled() const;
+        void setMemoryMappingEnabled(const bool enabled);
+
+        // Opened readers are reused per OBF file and worker thread, up to given number of pooled readers (0 disables pooling)
+        unsigned int getReadersPoolCapacity() const;
+        void setReadersPoolCapacity(const unsigned int capacity);
+
         virtual QList< std::shared_ptr<const ObfFile> > getObfFiles() const;
         virtual std::shared_ptr<OsmAnd::ObfDataInterface> obtainDataInterface(
             const std::shared_ptr<const ObfFile> obfFile) const;
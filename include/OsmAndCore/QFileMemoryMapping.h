@@ -0,0 +1,46 @@
+#ifndef _OSMAND_CORE_Q_FILE_MEMORY_MAPPING_H_
+#define _OSMAND_CORE_Q_FILE_MEMORY_MAPPING_H_
+
+#include <memory>
+
+#include <OsmAndCore/QtExtensions.h>
+#include <QString>
+#include <QFile>
+
+#include <OsmAndCore.h>
+
+namespace OsmAnd
+{
+    /**
+    Read-only memory mapping of an entire file. Mapping is established once on creation and
+    released on destruction, so it can be shared between any number of readers.
+    */
+    class OSMAND_CORE_API QFileMemoryMapping
+    {
+        Q_DISABLE_COPY_AND_MOVE(QFileMemoryMapping);
+    private:
+        //! File that owns the mapping
+        const std::shared_ptr<QFile> _file;
+
+        //! Pointer to mapped memory
+        uint8_t* _mappedMemory;
+    protected:
+        QFileMemoryMapping(const std::shared_ptr<QFile>& file, uint8_t* const mappedMemory);
+    public:
+        virtual ~QFileMemoryMapping();
+
+        //! Name of the mapped file
+        const QString fileName;
+
+        //! Size of the mapped file (and of mapped memory)
+        const qint64 size;
+
+        //! Pointer to the first byte of mapped memory
+        const uint8_t* const data;
+
+        //! Map entire file into memory, returns nullptr on failure
+        static std::shared_ptr<const QFileMemoryMapping> map(const QString& fileName);
+    };
+}
+
+#endif // !defined(_OSMAND_CORE_Q_FILE_MEMORY_MAPPING_H_)
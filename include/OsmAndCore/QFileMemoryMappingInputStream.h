@@ -0,0 +1,44 @@
+#ifndef _OSMAND_CORE_Q_FILE_MEMORY_MAPPING_INPUT_STREAM_H_
+#define _OSMAND_CORE_Q_FILE_MEMORY_MAPPING_INPUT_STREAM_H_
+
+#include <memory>
+
+#include <OsmAndCore/QtExtensions.h>
+
+#include "ignore_warnings_on_external_includes.h"
+#include <google/protobuf/io/zero_copy_stream.h>
+#include "restore_internal_warnings.h"
+
+#include <OsmAndCore.h>
+#include <OsmAndCore/QFileMemoryMapping.h>
+
+namespace OsmAnd
+{
+    namespace gpb = google::protobuf;
+
+    /**
+    Implementation of zero-copy input stream for Google Protobuf over whole-file memory mapping.
+    Unlike QFileDeviceInputStream, no system calls are performed while reading.
+    */
+    class OSMAND_CORE_API QFileMemoryMappingInputStream : public gpb::io::ZeroCopyInputStream
+    {
+    private:
+        GOOGLE_DISALLOW_EVIL_CONSTRUCTORS(QFileMemoryMappingInputStream);
+
+        //! Current position
+        qint64 _currentPosition;
+    protected:
+    public:
+        QFileMemoryMappingInputStream(const std::shared_ptr<const QFileMemoryMapping>& mapping);
+        virtual ~QFileMemoryMappingInputStream();
+
+        const std::shared_ptr<const QFileMemoryMapping> mapping;
+
+        virtual bool Next(const void** data, int* size);
+        virtual void BackUp(int count);
+        virtual bool Skip(int count);
+        virtual gpb::int64 ByteCount() const;
+    };
+}
+
+#endif // !defined(_OSMAND_CORE_Q_FILE_MEMORY_MAPPING_INPUT_STREAM_H_)
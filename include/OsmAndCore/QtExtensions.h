@@ -20,7 +20,7 @@
 #if !defined(SWIG)
 template<typename T>
 inline auto qHash(
-    const T& value) Q_DECL_NOTHROW -> typename std::enable_if< std::is_same<decltype(value.qHash()), uint(uint)>::value, uint>::type;
+    const T& value) Q_DECL_NOTHROW -> typename std::enable_if< std::is_same<decltype(value.qHash()), uint>::value, uint>::type;
 
 template<typename T>
 inline auto qHash(
@@ -46,7 +46,7 @@ inline uint qHash(const OsmAnd::SmartPOD<T, DEFAULT_VALUE>& value) Q_DECL_NOTHRO
 #if !defined(SWIG)
 template<typename T>
 inline auto qHash(
-    const T& value) Q_DECL_NOTHROW -> typename std::enable_if< std::is_same<decltype(value.qHash()), uint()>::value, uint>::type
+    const T& value) Q_DECL_NOTHROW -> typename std::enable_if< std::is_same<decltype(value.qHash()), uint>::value, uint>::type
 {
     return value.qHash();
 }
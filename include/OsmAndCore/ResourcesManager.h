@@ -297,6 +297,12 @@ namespace OsmAnd
         bool updateFromRepository(const QString& id, const QString& filePath);
         
         const std::shared_ptr<const OnlineTileSources> downloadOnlineTileSources() const;
+
+        // OBF access:
+        bool isObfMemoryMappingEnabled() const;
+        void setObfMemoryMappingEnabled(const bool enabled);
+        unsigned int getObfReadersPoolCapacity() const;
+        void setObfReadersPoolCapacity(const unsigned int capacity);
         
         // Tests
         bool addLocalResource(const QString& filePath);
@@ -5,6 +5,8 @@
 
 #include <OsmAndCore/QtExtensions.h>
 #include <QList>
+#include <QVector>
+#include <QThreadPool>
 
 #include <OsmAndCore.h>
 #include <OsmAndCore/CommonTypes.h>
@@ -67,6 +69,19 @@ namespace OsmAnd
             const ObfRoutingSectionReader::VisitorFunction filter = nullptr,
             QList<std::shared_ptr<const ObfRoutingSectionReader::DataBlock>>* const outReferencedCacheEntries = nullptr) const;
 
+        // Matches all positions (e.g. entire GPX track) at once: roads are loaded once per group of nearby
+        // positions and indexed per segment, then positions are processed in parallel on given thread pool (if any).
+        // For each position, up to maxRoadsPerPosition nearest roads within radius are returned ordered by distance,
+        // zero means all roads within radius.
+        QVector< QVector< std::pair<std::shared_ptr<const Road>, std::shared_ptr<const RoadInfo>> > > findNearestRoadsBatch(
+            const QVector<PointI>& positions31,
+            const double radiusInMeters,
+            const int maxRoadsPerPosition = 1,
+            const RoutingDataLevel dataLevel = RoutingDataLevel::Detailed,
+            const ObfRoutingSectionReader::VisitorFunction filter = nullptr,
+            QThreadPool* const threadPool = nullptr,
+            QList<std::shared_ptr<const ObfRoutingSectionReader::DataBlock>>* const outReferencedCacheEntries = nullptr) const;
+
         static std::shared_ptr<const Road> findNearestRoad(
             const QList<std::shared_ptr<const Road>>& collection,
             const PointI position31,
@@ -85,6 +100,13 @@ namespace OsmAnd
             const PointI position31,
             const double radiusInMeters,
             const ObfRoutingSectionReader::VisitorFunction filter = nullptr);
+        static QVector< QVector< std::pair<std::shared_ptr<const Road>, std::shared_ptr<const RoadInfo>> > > findNearestRoadsBatch(
+            const QList< std::shared_ptr<const Road> >& collection,
+            const QVector<PointI>& positions31,
+            const double radiusInMeters,
+            const int maxRoadsPerPosition = 1,
+            const ObfRoutingSectionReader::VisitorFunction filter = nullptr,
+            QThreadPool* const threadPool = nullptr);
     };
 }
 
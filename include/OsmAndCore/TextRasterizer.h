@@ -6,12 +6,14 @@
 
 #include <OsmAndCore/QtExtensions.h>
 #include <QList>
+#include <QVector>
 
 #include <OsmAndCore.h>
 #include <OsmAndCore/CommonTypes.h>
 #include <OsmAndCore/CommonSWIG.h>
 #include <OsmAndCore/PrivateImplementation.h>
 #include <OsmAndCore/IFontFinder.h>
+#include <OsmAndCore/GlyphAtlas.h>
 #include <OsmAndCore/Map/MapCommonTypes.h>
 #include <OsmAndCore/Map/MapPrimitiviser.h>
 
@@ -146,6 +148,28 @@ namespace OsmAnd
 #endif // !defined(SWIG)
         };
 
+        struct CacheStatistics Q_DECL_FINAL
+        {
+            CacheStatistics()
+                : hits(0)
+                , misses(0)
+                , entriesCount(0)
+                , sizeInBytes(0)
+                , sizeLimitInBytes(0)
+            {
+            }
+
+            unsigned int hits;
+            unsigned int misses;
+            unsigned int entriesCount;
+            unsigned int sizeInBytes;
+            unsigned int sizeLimitInBytes;
+        };
+
+        enum {
+            DefaultCacheSizeLimitInBytes = 8 * 1024 * 1024,
+        };
+
     private:
         PrivateImplementation<TextRasterizer_P> _p;
     protected:
@@ -175,6 +199,32 @@ namespace OsmAnd
             float* const outLineSpacing = nullptr,
             float* const outFontAscent = nullptr) const;
 
+        // Same as rasterize(), but resulting bitmap is shared with all callers that rasterize same text
+        // using equal style. Background bitmaps of styles are compared by identity.
+        std::shared_ptr<const SkBitmap> rasterizeCached(
+            const QString& text,
+            const Style& style = Style(),
+            QVector<SkScalar>* const outGlyphWidths = nullptr,
+            float* const outExtraTopSpace = nullptr,
+            float* const outExtraBottomSpace = nullptr,
+            float* const outLineSpacing = nullptr,
+            float* const outFontAscent = nullptr) const;
+
+        // Lays text out as quads of glyphs stored in atlas, instead of rasterizing it into a bitmap. Quads
+        // are placed exactly as rasterize() would draw glyphs, and output size is the size of that bitmap.
+        // Halo quads (that precede text quads) are produced only by atlas in coverage mode, since
+        // distance field of text glyph is enough to draw its halo.
+        bool layoutGlyphs(
+            const QString& text,
+            const Style& style,
+            GlyphAtlas& atlas,
+            QVector<GlyphAtlas::GlyphQuad>& outQuads,
+            PointI* const outSize = nullptr) const;
+
+        CacheStatistics getCacheStatistics() const;
+        void setCacheSizeLimit(const unsigned int sizeLimitInBytes);
+        void clearCache();
+
         static std::shared_ptr<const TextRasterizer> getDefault();
         static std::shared_ptr<const TextRasterizer> getOnlySystemFonts();
     };
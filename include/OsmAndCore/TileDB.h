@@ -8,11 +8,21 @@
 #include <QDir>
 #include <QFile>
 #include <QString>
+#include <QHash>
+#include <QPair>
+#include <QList>
+#include <QVector>
+#include <QSet>
+#include <QAtomicInt>
 #include <QMutex>
+#include <QReadWriteLock>
+#include <QThreadStorage>
 #include <QSqlDatabase>
+#include <QSqlQuery>
 
 #include <OsmAndCore.h>
 #include <OsmAndCore/CommonTypes.h>
+#include <OsmAndCore/PointsAndAreas.h>
 
 namespace OsmAnd {
 
@@ -20,18 +30,88 @@ namespace OsmAnd {
     class OSMAND_CORE_API TileDB
     {
     public:
+        enum {
+            // Capacity of pool of each thread that reads tiles
+            DefaultConnectionsPoolCapacity = 16,
+        };
+
     private:
+        // Entries of each zoom are ordered by left edge, and each one also knows maximal right edge
+        // among itself and all entries before it. So lookup stops as soon as no earlier entry can
+        // contain requested tile.
+        struct IndexEntry
+        {
+            AreaI area;
+            int fileId;
+            int32_t maxRightSoFar;
+        };
+
+        // Opened read-only database along with prepared tile query. Connection is used and closed only by
+        // thread that created it, since QSqlDatabase is not thread-safe.
+        struct Connection
+        {
+            Connection(const QString& connectionName, const QString& filename);
+            ~Connection();
+
+            const QString connectionName;
+            QSqlDatabase db;
+            QSqlQuery tileQuery;
+            bool isValid;
+        };
+        struct ConnectionsPoolEntry
+        {
+            std::shared_ptr<Connection> connection;
+            uint64_t lastUse;
+        };
+
+        // Each thread pools its own connections, so that they are evicted and closed by that thread only.
+        // Pools are kept in storage of thread rather than of TileDB: pools left by destroyed TileDB are marked
+        // as orphaned, and each thread releases its own on exit or on next use of any TileDB.
+        struct ConnectionsPool
+        {
+            ConnectionsPool(const std::shared_ptr<QAtomicInt>& orphaned, const int generation);
+
+            // Shared by all pools of same TileDB, set once that TileDB is destroyed
+            const std::shared_ptr<QAtomicInt> orphaned;
+            QHash<int, ConnectionsPoolEntry> connections;
+            uint64_t useCounter;
+            int generation;
+        };
+        typedef QList< std::shared_ptr<ConnectionsPool> > ConnectionsPools;
+
+        mutable QReadWriteLock _intervalIndexLock;
+        bool _isIntervalIndexLoaded;
+        QHash<int, QString> _files;
+        QHash<ZoomLevel, QVector<IndexEntry> > _intervalIndex;
+        bool loadIntervalIndex();
+        bool lookupFiles(const TileId tileId, const ZoomLevel zoom, QList< QPair<int, QString> >& outFiles) const;
+
+        static QThreadStorage<ConnectionsPools>& threadConnectionsPools();
+        const std::shared_ptr<QAtomicInt> _connectionsPoolsOrphaned;
+        // Pools of other threads are released lazily, each by its own thread
+        QAtomicInt _connectionsGeneration;
+        std::shared_ptr<ConnectionsPool> obtainConnectionsPool(const bool create);
+        std::shared_ptr<Connection> obtainConnection(const int fileId, const QString& filename);
+        void evictConnections(ConnectionsPool& pool) const;
+        void releaseAllConnections();
+
+        static QString makeConnectionName(const QString& prefix, const QString& filename);
     protected:
         mutable QMutex _indexMutex;
+        const QString _indexConnectionName;
         QSqlDatabase _indexDb;
 
         bool openIndex();
     public:
-        TileDB(const QDir& dataPath, const QString& indexFilename = QString::null);
+        TileDB(
+            const QDir& dataPath,
+            const QString& indexFilename = QString::null,
+            const unsigned int connectionsPoolCapacity = DefaultConnectionsPoolCapacity);
         virtual ~TileDB();
 
         const QDir dataPath;
         const QString indexFilename;
+        const unsigned int connectionsPoolCapacity;
 
         bool rebuildIndex();
         bool obtainTileData(const TileId tileId, const ZoomLevel zoom, QByteArray& data);
@@ -4,6 +4,7 @@
 #include "QtCommon.h"
 
 #include "RoadLocator.h"
+#include "RoadLocator_P.h"
 #include "Road.h"
 #include "IObfsCollection.h"
 #include "ObfDataInterface.h"
@@ -69,7 +70,41 @@ QVector<std::pair<std::shared_ptr<const OsmAnd::Road>, std::shared_ptr<const Osm
         const OsmAnd::ObfRoutingSectionReader::VisitorFunction filter,
         QList<std::shared_ptr<const OsmAnd::ObfRoutingSectionReader::DataBlock>> * const outReferencedCacheEntries) const
 {
+    QList< std::shared_ptr<const Road> > roadsInBBox;
 
+    const auto bbox31 = (AreaI)Utilities::boundingBox31FromAreaInMeters(radiusInMeters, position31);
+    const auto obfDataInterface = owner->obfsCollection->obtainDataInterface(
+        &bbox31,
+        MinZoomLevel,
+        MaxZoomLevel,
+        ObfDataTypesMask().set(ObfDataType::Routing));
+    QList< std::shared_ptr<const ObfRoutingSectionReader::DataBlock> > referencedCacheEntries;
+    obfDataInterface->loadRoads(
+        dataLevel,
+        &bbox31,
+        &roadsInBBox,
+        nullptr,
+        nullptr,
+        &_cache,
+        &referencedCacheEntries,
+        nullptr,
+        nullptr);
+
+    if (outReferencedCacheEntries)
+        outReferencedCacheEntries->append(referencedCacheEntries);
+
+    {
+        QMutexLocker scopedLocker(&_referencedDataBlocksMapMutex);
+
+        for (auto& referencedBlock : referencedCacheEntries)
+            _referencedDataBlocksMap[referencedBlock.get()].push_back(qMove(referencedBlock));
+    }
+
+    return RoadLocator_P::sortedRoadsByDistance(
+        roadsInBBox,
+        position31,
+        radiusInMeters,
+        filter);
 }
 
 QList< std::shared_ptr<const OsmAnd::Road> > OsmAnd::CachingRoadLocator_P::findRoadsInArea(
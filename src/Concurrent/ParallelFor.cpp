@@ -0,0 +1,87 @@
+#include "ParallelFor.h"
+
+#include "QtExtensions.h"
+#include <QAtomicInt>
+#include <QMutex>
+#include <QWaitCondition>
+
+#include "QRunnableFunctor.h"
+
+void OsmAnd::Concurrent::ParallelFor::run(
+    QThreadPool* const threadPool,
+    const int count,
+    const Body body,
+    const int maxConcurrency /*= 0*/)
+{
+    if (count <= 0)
+        return;
+
+    // Without thread pool or with single item, there's nothing to parallelize
+    auto helpersCount = threadPool ? qMin(count, threadPool->maxThreadCount()) - 1 : 0;
+    if (maxConcurrency > 0)
+        helpersCount = qMin(helpersCount, maxConcurrency - 1);
+    if (helpersCount <= 0)
+    {
+        for (auto index = 0; index < count; index++)
+            body(index);
+        return;
+    }
+
+    // State is shared with helpers, since helper may start after all work is already done
+    struct State
+    {
+        State(const Body body_, const int count_)
+            : body(body_)
+            , count(count_)
+            , nextIndex(0)
+            , processedCount(0)
+        {
+        }
+
+        const Body body;
+        const int count;
+        QAtomicInt nextIndex;
+        QAtomicInt processedCount;
+        QMutex processedMutex;
+        QWaitCondition allProcessed;
+    };
+    const std::shared_ptr<State> state(new State(body, count));
+
+    const auto processAll =
+        [state]
+        ()
+        {
+            for (;;)
+            {
+                const auto index = state->nextIndex.fetchAndAddOrdered(1);
+                if (index >= state->count)
+                    break;
+
+                state->body(index);
+
+                if (state->processedCount.fetchAndAddOrdered(1) + 1 == state->count)
+                {
+                    QMutexLocker scopedLocker(&state->processedMutex);
+                    state->allProcessed.wakeAll();
+                }
+            }
+        };
+
+    for (auto helperIndex = 0; helperIndex < helpersCount; helperIndex++)
+    {
+        const auto helper = new QRunnableFunctor(
+            [processAll]
+            (const QRunnableFunctor* const runnable)
+            {
+                processAll();
+            });
+        helper->setAutoDelete(true);
+        threadPool->start(helper);
+    }
+
+    processAll();
+
+    QMutexLocker scopedLocker(&state->processedMutex);
+    while (state->processedCount.loadAcquire() < count)
+        state->allProcessed.wait(&state->processedMutex);
+}
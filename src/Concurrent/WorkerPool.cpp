@@ -68,6 +68,28 @@ void OsmAnd::Concurrent::WorkerPool::sortQueue(const SortPredicate predicate)
     _p->sortQueue(predicate);
 }
 
+void OsmAnd::Concurrent::WorkerPool::enqueueWithPriority(QRunnable* const runnable, const int64_t priority)
+{
+    _p->enqueueWithPriority(runnable, priority);
+}
+
+void OsmAnd::Concurrent::WorkerPool::enqueueWithPriorities(
+    const QVector<QRunnable*>& runnables,
+    const PriorityFunction priorityFunction)
+{
+    _p->enqueueWithPriorities(runnables, priorityFunction);
+}
+
+void OsmAnd::Concurrent::WorkerPool::updatePriorities(const PriorityFunction priorityFunction)
+{
+    _p->updatePriorities(priorityFunction);
+}
+
+unsigned int OsmAnd::Concurrent::WorkerPool::queueSize() const
+{
+    return _p->queueSize();
+}
+
 void OsmAnd::Concurrent::WorkerPool::reset()
 {
     _p->reset();
@@ -6,13 +6,31 @@
 
 #include "Logging.h"
 
+namespace
+{
+    inline uint64_t mixSequence(uint64_t value)
+    {
+        value ^= value >> 30;
+        value *= 0xbf58476d1ce4e5b9ull;
+        value ^= value >> 27;
+        value *= 0x94d049bb133111ebull;
+        value ^= value >> 31;
+        return value;
+    }
+}
+
 OsmAnd::Concurrent::WorkerPool_P::WorkerPool_P(WorkerPool* const owner_, const Order order_, const int maxThreadCount_)
     : _order(static_cast<int>(order_))
     , _maxThreadCount(maxThreadCount_)
+    , _queueSequence(0)
+    , _queueOrder(order_)
+    , _randomSeed((static_cast<uint64_t>(qrand()) << 32) | static_cast<uint64_t>(qrand()))
+    , _activeThreadCount(0)
     , _isBeingReset(false)
     , owner(owner_)
 {
     _queue.reserve(1024);
+    _queueIndices.reserve(1024);
 }
 
 OsmAnd::Concurrent::WorkerPool_P::~WorkerPool_P()
@@ -27,6 +45,13 @@ OsmAnd::Concurrent::WorkerPool_P::Order OsmAnd::Concurrent::WorkerPool_P::order(
 void OsmAnd::Concurrent::WorkerPool_P::setOrder(const Order order)
 {
     _order.storeRelease(static_cast<int>(order));
+
+    QMutexLocker scopedLocker(&_queueMutex);
+
+    if (_queueOrder == order)
+        return;
+    _queueOrder = order;
+    heapifyQueue();
 }
 
 int OsmAnd::Concurrent::WorkerPool_P::maxThreadCount() const
@@ -37,59 +62,74 @@ int OsmAnd::Concurrent::WorkerPool_P::maxThreadCount() const
 void OsmAnd::Concurrent::WorkerPool_P::setMaxThreadCount(int maxThreadCount)
 {
     const auto oldMaxThreadCount = _maxThreadCount.fetchAndStoreOrdered(maxThreadCount);
-    if (maxThreadCount > 0 && oldMaxThreadCount <= maxThreadCount)
+    if (maxThreadCount > 0 && oldMaxThreadCount > 0 && oldMaxThreadCount >= maxThreadCount)
         return;
 
+    // Limit was raised, so more threads may serve the queue now
     QMutexLocker scopedLocker(&_mutex);
-    tryLaunchNextRunnables();
+    wakeUpThreadsNoLock(queueSize());
 }
 
 unsigned int OsmAnd::Concurrent::WorkerPool_P::activeThreadCount() const
 {
-    QMutexLocker scopedLocker(&_mutex);
-
-    return activeThreadCountNoLock();
+    return _activeThreadCount.loadAcquire();
 }
 
 bool OsmAnd::Concurrent::WorkerPool_P::waitForDone(const int msecs) const
 {
     QMutexLocker scopedLocker(&_mutex);
-    
+
     return waitForDoneNoLock(msecs);
 }
 
 void OsmAnd::Concurrent::WorkerPool_P::enqueue(QRunnable* const runnable, const SortPredicate predicate)
 {
-    QMutexLocker scopedLocker(&_mutex);
-    
-    _queue.push_front(runnable);
-    if (predicate)
-        sortQueueNoLock(predicate);
+    {
+        QMutexLocker scopedLocker(&_queueMutex);
+
+        pushToQueue(runnable, 0);
+        if (predicate)
+            sortQueueNoLock(predicate);
+    }
 
-    tryLaunchNextRunnable();
+    wakeUpThreads(1);
 }
 
 void OsmAnd::Concurrent::WorkerPool_P::enqueue(const QVector<QRunnable*>& runnables, const SortPredicate predicate)
 {
-    QMutexLocker scopedLocker(&_mutex);
+    {
+        QMutexLocker scopedLocker(&_queueMutex);
 
-    for (const auto& runnable : constOf(runnables))
-        _queue.push_front(runnable);
-    if (predicate)
-        sortQueueNoLock(predicate);
+        for (const auto& runnable : constOf(runnables))
+            pushToQueue(runnable, 0);
+        if (predicate)
+            sortQueueNoLock(predicate);
+    }
 
-    tryLaunchNextRunnable();
+    wakeUpThreads(runnables.size());
 }
 
 bool OsmAnd::Concurrent::WorkerPool_P::dequeue(QRunnable* const runnable, const SortPredicate predicate)
 {
-    QMutexLocker scopedLocker(&_mutex);
-    
-    const auto result = _queue.removeOne(runnable);
-    if (result && predicate)
-        sortQueueNoLock(predicate);
+    // Removal from heap keeps the rest of queue ordered, so there's nothing to sort
+    Q_UNUSED(predicate);
 
-    return result;
+    bool isQueueEmpty;
+    {
+        QMutexLocker scopedLocker(&_queueMutex);
+
+        if (!removeFromQueue(runnable))
+            return false;
+        isQueueEmpty = _queue.isEmpty();
+    }
+
+    if (isQueueEmpty)
+    {
+        QMutexLocker scopedLocker(&_mutex);
+        _threadFreed.wakeAll();
+    }
+
+    return true;
 }
 
 void OsmAnd::Concurrent::WorkerPool_P::dequeueAll()
@@ -97,15 +137,57 @@ void OsmAnd::Concurrent::WorkerPool_P::dequeueAll()
     QMutexLocker scopedLocker(&_mutex);
 
     dequeueAllNoLock();
+    _threadFreed.wakeAll();
 }
 
 void OsmAnd::Concurrent::WorkerPool_P::sortQueue(const SortPredicate predicate)
 {
-    QMutexLocker scopedLocker(&_mutex);
+    QMutexLocker scopedLocker(&_queueMutex);
 
     sortQueueNoLock(predicate);
 }
 
+void OsmAnd::Concurrent::WorkerPool_P::enqueueWithPriority(QRunnable* const runnable, const int64_t priority)
+{
+    {
+        QMutexLocker scopedLocker(&_queueMutex);
+
+        pushToQueue(runnable, priority);
+    }
+
+    wakeUpThreads(1);
+}
+
+void OsmAnd::Concurrent::WorkerPool_P::enqueueWithPriorities(
+    const QVector<QRunnable*>& runnables,
+    const PriorityFunction priorityFunction)
+{
+    {
+        QMutexLocker scopedLocker(&_queueMutex);
+
+        for (const auto& runnable : constOf(runnables))
+            pushToQueue(runnable, priorityFunction(runnable));
+    }
+
+    wakeUpThreads(runnables.size());
+}
+
+void OsmAnd::Concurrent::WorkerPool_P::updatePriorities(const PriorityFunction priorityFunction)
+{
+    QMutexLocker scopedLocker(&_queueMutex);
+
+    for (auto& entry : _queue)
+        entry.priority = priorityFunction(entry.runnable);
+    heapifyQueue();
+}
+
+unsigned int OsmAnd::Concurrent::WorkerPool_P::queueSize() const
+{
+    QMutexLocker scopedLocker(&_queueMutex);
+
+    return _queue.size();
+}
+
 void OsmAnd::Concurrent::WorkerPool_P::reset()
 {
     QMutexLocker scopedLocker(&_mutex);
@@ -113,112 +195,262 @@ void OsmAnd::Concurrent::WorkerPool_P::reset()
     dequeueAllNoLock();
     REPEAT_UNTIL(waitForDoneNoLock(-1));
     _isBeingReset = true;
-    while (!_allThreads.isEmpty())
-    {
-        const auto thread = _freeThreads.head();
-        scopedLocker.unlock();
+    const auto threads = _allThreads;
+    while (!_freeThreads.isEmpty())
+        _freeThreads.dequeue()->wakeup.wakeOne();
+    scopedLocker.unlock();
 
-        thread->wakeup.wakeOne();
+    // Threads that are not sleeping will notice reset before going to sleep
+    for (const auto& thread : constOf(threads))
+    {
         thread->wait();
         delete thread;
-
-        scopedLocker.relock();
     }
+
+    scopedLocker.relock();
     _isBeingReset = false;
 }
 
-unsigned int OsmAnd::Concurrent::WorkerPool_P::activeThreadCountNoLock() const
+bool OsmAnd::Concurrent::WorkerPool_P::isQueuedBefore(const QueueEntry& l, const QueueEntry& r) const
 {
-    return _allThreads.count() - _freeThreads.count() - _inactiveThreads.count();
+    if (l.priority != r.priority)
+        return l.priority > r.priority;
+
+    switch (_queueOrder)
+    {
+        // Sequence is position from the back of queue, since new runnables are put to its front
+        case Order::FIFO:
+            return l.sequence > r.sequence;
+        case Order::LIFO:
+            return l.sequence < r.sequence;
+        case Order::Random:
+            return mixSequence(l.sequence ^ _randomSeed) < mixSequence(r.sequence ^ _randomSeed);
+        default:
+            return false;
+    }
 }
 
-void OsmAnd::Concurrent::WorkerPool_P::createNewThread()
+void OsmAnd::Concurrent::WorkerPool_P::placeInQueue(const int index, const QueueEntry& entry)
 {
-    const auto thread = new WorkerThread(this);
+    _queue[index] = entry;
+    _queueIndices[entry.runnable] = index;
+}
 
-    thread->setObjectName(QLatin1String("Worker (pooled)"));
-    _allThreads.insert(thread);
-    _freeThreads.enqueue(thread);
+void OsmAnd::Concurrent::WorkerPool_P::siftUpInQueue(int index)
+{
+    const auto entry = _queue[index];
+    while (index > 0)
+    {
+        const auto parentIndex = (index - 1) / QueueHeapArity;
+        if (!isQueuedBefore(entry, _queue[parentIndex]))
+            break;
 
-    thread->start();
+        placeInQueue(index, _queue[parentIndex]);
+        index = parentIndex;
+    }
+    placeInQueue(index, entry);
 }
 
-bool OsmAnd::Concurrent::WorkerPool_P::tryLaunchNextRunnable()
+void OsmAnd::Concurrent::WorkerPool_P::siftDownInQueue(int index)
 {
-    // In case there are no threads, create new one
-    if (_allThreads.isEmpty())
+    const auto entry = _queue[index];
+    const auto queueSize = _queue.size();
+    for (;;)
     {
-        createNewThread();
-        return true;
-    }
+        const auto firstChildIndex = index * QueueHeapArity + 1;
+        if (firstChildIndex >= queueSize)
+            break;
 
-    // Check if max threads limit is not reached
-    if (tooManyThreadsActive())
-        return false;
+        auto bestChildIndex = firstChildIndex;
+        const auto childrenEndIndex = qMin(firstChildIndex + QueueHeapArity, queueSize);
+        for (auto childIndex = firstChildIndex + 1; childIndex < childrenEndIndex; childIndex++)
+        {
+            if (isQueuedBefore(_queue[childIndex], _queue[bestChildIndex]))
+                bestChildIndex = childIndex;
+        }
+        if (!isQueuedBefore(_queue[bestChildIndex], entry))
+            break;
 
-    // If free thread is available, use it
-    if (!_freeThreads.isEmpty())
-    {
-        _freeThreads.head()->wakeup.wakeOne();
-        return true;
+        placeInQueue(index, _queue[bestChildIndex]);
+        index = bestChildIndex;
     }
+    placeInQueue(index, entry);
+}
+
+void OsmAnd::Concurrent::WorkerPool_P::heapifyQueue()
+{
+    if (_queue.size() <= 1)
+        return;
+
+    for (auto index = (_queue.size() - 2) / QueueHeapArity; index >= 0; index--)
+        siftDownInQueue(index);
+}
 
-    // If inactive thread is available, use it
-    if (!_inactiveThreads.isEmpty())
+void OsmAnd::Concurrent::WorkerPool_P::pushToQueue(QRunnable* const runnable, const int64_t priority)
+{
+    // Runnable that is already queued only gets new priority
+    const auto citIndex = _queueIndices.constFind(runnable);
+    if (citIndex != _queueIndices.cend())
     {
-        _inactiveThreads.head()->wakeup.wakeOne();
-        return true;
+        const auto index = *citIndex;
+        _queue[index].priority = priority;
+        siftUpInQueue(index);
+        siftDownInQueue(_queueIndices[runnable]);
+        return;
     }
 
-    // Otherwise, just start new thread
-    createNewThread();
-    return true;
+    QueueEntry entry;
+    entry.runnable = runnable;
+    entry.priority = priority;
+    entry.sequence = _queueSequence++;
+    _queue.push_back(entry);
+    _queueIndices.insert(runnable, _queue.size() - 1);
+    siftUpInQueue(_queue.size() - 1);
 }
 
-void OsmAnd::Concurrent::WorkerPool_P::tryLaunchNextRunnables()
+bool OsmAnd::Concurrent::WorkerPool_P::removeFromQueue(QRunnable* const runnable)
 {
-    while (!_queue.isEmpty() && tryLaunchNextRunnable());
+    const auto itIndex = _queueIndices.find(runnable);
+    if (itIndex == _queueIndices.end())
+        return false;
+    const auto index = *itIndex;
+    _queueIndices.erase(itIndex);
+
+    const auto lastEntry = _queue.last();
+    _queue.removeLast();
+    if (index == _queue.size())
+        return true;
+
+    placeInQueue(index, lastEntry);
+    if (index > 0 && isQueuedBefore(lastEntry, _queue[(index - 1) / QueueHeapArity]))
+        siftUpInQueue(index);
+    else
+        siftDownInQueue(index);
+
+    return true;
 }
 
 QRunnable* OsmAnd::Concurrent::WorkerPool_P::takeNextRunnable()
 {
+    QMutexLocker scopedLocker(&_queueMutex);
+
     if (_queue.isEmpty())
         return nullptr;
 
-    switch (order())
+    const auto runnable = _queue.first().runnable;
+    removeFromQueue(runnable);
+    return runnable;
+}
+
+bool OsmAnd::Concurrent::WorkerPool_P::hasQueuedRunnables() const
+{
+    QMutexLocker scopedLocker(&_queueMutex);
+
+    return !_queue.isEmpty();
+}
+
+void OsmAnd::Concurrent::WorkerPool_P::sortQueueNoLock(const SortPredicate predicate)
+{
+    // Sorted order is converted to sequences, so that start of sorted queue becomes its front:
+    // FIFO executes runnables from the start of sorted queue, while LIFO executes them from the end.
+    // Priorities are kept, since they take precedence over order anyway.
+    QVector<QRunnable*> runnables;
+    runnables.reserve(_queue.size());
+    for (const auto& entry : constOf(_queue))
+        runnables.push_back(entry.runnable);
+    std::sort(runnables, predicate);
+
+    const auto runnablesCount = runnables.size();
+    for (auto index = 0; index < runnablesCount; index++)
+        _queue[_queueIndices[runnables[index]]].sequence = _queueSequence + (runnablesCount - 1 - index);
+    _queueSequence += runnablesCount;
+    heapifyQueue();
+}
+
+bool OsmAnd::Concurrent::WorkerPool_P::tryAcquireActiveThreadSlot()
+{
+    for (;;)
     {
-        case Order::FIFO:
-            return _queue.takeFirst();
-        case Order::LIFO:
-            return _queue.takeLast();
-        case Order::Random:
-            return _queue.takeAt(qrand() % _queue.size());
-        default:
-            return nullptr;
+        const auto activeThreadCount = _activeThreadCount.loadAcquire();
+        const auto maxThreadCount = this->maxThreadCount();
+        if (maxThreadCount > 0 && activeThreadCount >= maxThreadCount)
+            return false;
+
+        if (_activeThreadCount.testAndSetOrdered(activeThreadCount, activeThreadCount + 1))
+            return true;
+    }
+}
+
+int OsmAnd::Concurrent::WorkerPool_P::releaseActiveThreadSlot()
+{
+    return _activeThreadCount.fetchAndAddOrdered(-1) - 1;
+}
+
+void OsmAnd::Concurrent::WorkerPool_P::createNewThread()
+{
+    const auto thread = new WorkerThread(this);
+
+    thread->setObjectName(QLatin1String("Worker (pooled)"));
+    _allThreads.insert(thread);
+
+    thread->start();
+}
+
+void OsmAnd::Concurrent::WorkerPool_P::wakeUpThreadsNoLock(int count)
+{
+    // Threads that are executing runnables will take next ones by themselves, so only sleeping
+    // threads need to be woken up (or new threads started) to serve the rest. Pool without limit
+    // still doesn't start more threads at once than there are cores.
+    const auto maxThreadCount = this->maxThreadCount();
+    count = qMin(count, maxThreadCount > 0 ? maxThreadCount : QThread::idealThreadCount());
+    while (count-- > 0)
+    {
+        if (tooManyThreadsActive())
+            break;
+
+        if (!_freeThreads.isEmpty())
+        {
+            _freeThreads.dequeue()->wakeup.wakeOne();
+            continue;
+        }
+
+        if (maxThreadCount > 0 && _allThreads.size() >= maxThreadCount)
+            break;
+        createNewThread();
     }
 }
 
+void OsmAnd::Concurrent::WorkerPool_P::wakeUpThreads(const int count)
+{
+    QMutexLocker scopedLocker(&_mutex);
+
+    wakeUpThreadsNoLock(count);
+}
+
 bool OsmAnd::Concurrent::WorkerPool_P::tooManyThreadsActive() const
 {
     const auto maxThreadCount = this->maxThreadCount();
-    return maxThreadCount > 0 && activeThreadCountNoLock() >= maxThreadCount;
+    return maxThreadCount > 0 && _activeThreadCount.loadAcquire() >= maxThreadCount;
 }
 
 void OsmAnd::Concurrent::WorkerPool_P::dequeueAllNoLock()
 {
-    for (auto runnable : _queue)
+    QMutexLocker scopedLocker(&_queueMutex);
+
+    for (const auto& entry : constOf(_queue))
     {
-        if (runnable->autoDelete())
-            delete runnable;
+        if (entry.runnable->autoDelete())
+            delete entry.runnable;
     }
     _queue.clear();
+    _queueIndices.clear();
 }
 
 bool OsmAnd::Concurrent::WorkerPool_P::waitForDoneNoLock(const int msecs) const
 {
     if (msecs < 0)
     {
-        while (activeThreadCountNoLock() != 0 || !_queue.isEmpty())
+        while (_activeThreadCount.loadAcquire() != 0 || hasQueuedRunnables())
             REPEAT_UNTIL(_threadFreed.wait(&_mutex));
     }
     else
@@ -226,16 +458,14 @@ bool OsmAnd::Concurrent::WorkerPool_P::waitForDoneNoLock(const int msecs) const
         QElapsedTimer waitTimer;
         waitTimer.start();
         int timeLeft;
-        while ((activeThreadCountNoLock() != 0 || !_queue.isEmpty()) && ((timeLeft = msecs - waitTimer.elapsed()) > 0))
+        while ((_activeThreadCount.loadAcquire() != 0 || hasQueuedRunnables()) &&
+            ((timeLeft = msecs - waitTimer.elapsed()) > 0))
+        {
             _threadFreed.wait(&_mutex, timeLeft);
+        }
     }
 
-    return activeThreadCountNoLock() == 0 && _queue.isEmpty();
-}
-
-void OsmAnd::Concurrent::WorkerPool_P::sortQueueNoLock(const SortPredicate predicate)
-{
-    std::sort(_queue, predicate);
+    return _activeThreadCount.loadAcquire() == 0 && !hasQueuedRunnables();
 }
 
 OsmAnd::Concurrent::WorkerPool_P::WorkerThread::WorkerThread(WorkerPool_P* const pool_)
@@ -251,8 +481,17 @@ void OsmAnd::Concurrent::WorkerPool_P::WorkerThread::run()
 {
     for (;;)
     {
-        // Get the runnable
+        // Get the runnable, if limit of active threads allows that
         QRunnable* runnable = nullptr;
+        if (pool->tryAcquireActiveThreadSlot())
+        {
+            runnable = pool->takeNextRunnable();
+            if (!runnable)
+                pool->releaseActiveThreadSlot();
+        }
+
+        // Sleep if there's nothing to do
+        if (!runnable)
         {
             QMutexLocker scopedLocker(&pool->_mutex);
 
@@ -264,31 +503,19 @@ void OsmAnd::Concurrent::WorkerPool_P::WorkerThread::run()
                 return;
             }
 
-            // Check if not out of limit or sleep
-            if (pool->tooManyThreadsActive())
-            {
-                pool->_freeThreads.removeOne(this);
-                pool->_inactiveThreads.enqueue(this);
-
-                REPEAT_UNTIL(wakeup.wait(&pool->_mutex));
-
-                pool->_inactiveThreads.removeOne(this);
-                pool->_freeThreads.enqueue(this);
+            // Runnable may have been enqueued right after queue was checked
+            if (pool->hasQueuedRunnables() && !pool->tooManyThreadsActive())
                 continue;
-            }
 
-            // Take runnable or sleep
-            runnable = pool->takeNextRunnable();
-            if (!runnable)
-            {
-                REPEAT_UNTIL(wakeup.wait(&pool->_mutex));
-                continue;
-            }
+            pool->_freeThreads.enqueue(this);
+            pool->_threadFreed.wakeAll();
+
+            REPEAT_UNTIL(wakeup.wait(&pool->_mutex));
 
-            // Since runnable was obtained, this thread is no longer free
             pool->_freeThreads.removeOne(this);
+            continue;
         }
-        
+
         // Execute the runnable
 #ifndef QT_NO_EXCEPTIONS
         try
@@ -308,12 +535,12 @@ void OsmAnd::Concurrent::WorkerPool_P::WorkerThread::run()
         }
 #endif
 
-        // After runnable execution is complete, free this thread
+        // After runnable execution is complete, notify if pool became idle
+        if (pool->releaseActiveThreadSlot() == 0)
         {
             QMutexLocker scopedLocker(&pool->_mutex);
 
-            pool->_freeThreads.enqueue(this);
-            pool->_threadFreed.wakeOne();
+            pool->_threadFreed.wakeAll();
         }
     }
 }
@@ -6,6 +6,7 @@
 #include "QtExtensions.h"
 #include "ignore_warnings_on_external_includes.h"
 #include <QList>
+#include <QHash>
 #include <QAtomicInt>
 #include <QWaitCondition>
 #include <QMutex>
@@ -30,6 +31,7 @@ namespace OsmAnd
         public:
             typedef WorkerPool::Order Order;
             typedef WorkerPool::SortPredicate SortPredicate;
+            typedef WorkerPool::PriorityFunction PriorityFunction;
 
         private:
             class WorkerThread Q_DECL_FINAL : public QThread
@@ -54,23 +56,53 @@ namespace OsmAnd
             QAtomicInt _order;
             QAtomicInt _maxThreadCount;
 
+            // Queue is a d-ary max-heap of runnables, ordered by priority and then by enqueue sequence
+            // according to order. Sequence grows towards the front of queue, where runnables are enqueued. Index of each runnable in heap is tracked to dequeue it in O(log n).
+            // Queue has own lock, separate from threads bookkeeping, so that workers that take next
+            // runnable do not contend with the rest of the pool.
+            enum {
+                QueueHeapArity = 4,
+            };
+            struct QueueEntry
+            {
+                QRunnable* runnable;
+                int64_t priority;
+                uint64_t sequence;
+            };
+            mutable QMutex _queueMutex;
+            QVector<QueueEntry> _queue;
+            QHash<QRunnable*, int> _queueIndices;
+            uint64_t _queueSequence;
+            Order _queueOrder;
+            const uint64_t _randomSeed;
+            bool isQueuedBefore(const QueueEntry& l, const QueueEntry& r) const;
+            void placeInQueue(const int index, const QueueEntry& entry);
+            void siftUpInQueue(int index);
+            void siftDownInQueue(int index);
+            void heapifyQueue();
+            void pushToQueue(QRunnable* const runnable, const int64_t priority);
+            bool removeFromQueue(QRunnable* const runnable);
+            QRunnable* takeNextRunnable();
+            bool hasQueuedRunnables() const;
+            void sortQueueNoLock(const SortPredicate predicate);
+
+            // Threads bookkeeping. Threads that execute runnables are counted without lock, while the
+            // lock is needed only to put thread to sleep and to wake it up.
             mutable QMutex _mutex;
-            QVector<QRunnable*> _queue;
             QSet<WorkerThread*> _allThreads;
             QQueue<WorkerThread*> _freeThreads;
-            QQueue<WorkerThread*> _inactiveThreads;
+            QAtomicInt _activeThreadCount;
             volatile bool _isBeingReset;
             mutable QWaitCondition _threadFreed;
 
-            unsigned int activeThreadCountNoLock() const;
+            bool tryAcquireActiveThreadSlot();
+            int releaseActiveThreadSlot();
             void createNewThread();
-            bool tryLaunchNextRunnable();
-            void tryLaunchNextRunnables();
-            QRunnable* takeNextRunnable();
+            void wakeUpThreadsNoLock(int count);
+            void wakeUpThreads(const int count);
             bool tooManyThreadsActive() const;
             void dequeueAllNoLock();
             bool waitForDoneNoLock(const int msecs) const;
-            void sortQueueNoLock(const SortPredicate predicate);
         protected:
             WorkerPool_P(WorkerPool* const owner, const Order order, const int maxThreadCount);
         public:
@@ -94,6 +126,11 @@ namespace OsmAnd
 
             void sortQueue(const SortPredicate predicate);
 
+            void enqueueWithPriority(QRunnable* const runnable, const int64_t priority);
+            void enqueueWithPriorities(const QVector<QRunnable*>& runnables, const PriorityFunction priorityFunction);
+            void updatePriorities(const PriorityFunction priorityFunction);
+            unsigned int queueSize() const;
+
             void reset();
 
         friend class OsmAnd::Concurrent::WorkerPool;
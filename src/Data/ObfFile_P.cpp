@@ -1,16 +1,35 @@
 #include "ObfFile_P.h"
+#include "ObfFile.h"
+
+#include "QFileMemoryMapping.h"
 
 OsmAnd::ObfFile_P::ObfFile_P(ObfFile* owner_, const std::shared_ptr<const ObfInfo>& obfInfo_)
     : owner(owner_)
     , _obfInfo(obfInfo_)
+    , _memoryMappingFailed(false)
 {
 }
 
 OsmAnd::ObfFile_P::ObfFile_P(ObfFile* owner_)
     : owner(owner_)
+    , _memoryMappingFailed(false)
 {
 }
 
 OsmAnd::ObfFile_P::~ObfFile_P()
 {
 }
+
+std::shared_ptr<const OsmAnd::QFileMemoryMapping> OsmAnd::ObfFile_P::obtainMemoryMapping() const
+{
+    QMutexLocker scopedLocker(&_memoryMappingMutex);
+
+    // Mapping is established once and kept for the lifetime of the file, don't retry if it failed
+    if (!_memoryMapping && !_memoryMappingFailed)
+    {
+        _memoryMapping = QFileMemoryMapping::map(owner->filePath);
+        _memoryMappingFailed = !_memoryMapping;
+    }
+
+    return _memoryMapping;
+}
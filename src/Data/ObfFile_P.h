@@ -14,6 +14,7 @@ namespace OsmAnd
 {
     class ObfReader_P;
     class ObfInfo;
+    class QFileMemoryMapping;
 
     class ObfFile;
     class ObfFile_P Q_DECL_FINAL
@@ -28,6 +29,11 @@ namespace OsmAnd
 
         mutable QMutex _obfInfoMutex;
         mutable std::shared_ptr<const ObfInfo> _obfInfo;
+
+        mutable QMutex _memoryMappingMutex;
+        mutable std::shared_ptr<const QFileMemoryMapping> _memoryMapping;
+        mutable bool _memoryMappingFailed;
+        std::shared_ptr<const QFileMemoryMapping> obtainMemoryMapping() const;
     public:
         virtual ~ObfFile_P();
 
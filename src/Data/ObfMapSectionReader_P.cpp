@@ -493,6 +493,11 @@ void OsmAnd::ObfMapSectionReader_P::readMapObjectsBlock(
 
     QList< std::shared_ptr<BinaryMapObject> > intermediateResult;
     QStringList mapObjectsCaptionsTable;
+    // Vertices of all objects of this block are decoded into this buffer, and accepted objects get exact-size
+    // copies. Objects do not share one per-block store (with offset views into it): MapObject::points31 is
+    // a QVector that is read directly all over rasterizer, primitiviser and coastline code, and QVector
+    // can't view memory it does not own.
+    QVector< PointI > pointsBuffer;
     gpb::uint64 baseId = 0;
     for (;;)
     {
@@ -560,7 +565,7 @@ void OsmAnd::ObfMapSectionReader_P::readMapObjectsBlock(
                 std::shared_ptr<OsmAnd::BinaryMapObject> mapObject;
                 auto oldLimit = cis->PushLimit(length);
                 
-                readMapObject(reader, section, baseId, tree, mapObject, bbox31, metric);
+                readMapObject(reader, section, baseId, tree, mapObject, bbox31, pointsBuffer, metric);
 
                 ObfReaderUtilities::ensureAllDataWasRead(cis);
                 cis->PopLimit(oldLimit);
@@ -642,6 +647,7 @@ void OsmAnd::ObfMapSectionReader_P::readMapObject(
     const std::shared_ptr<const ObfMapSectionLevelTreeNode>& treeNode,
     std::shared_ptr<OsmAnd::BinaryMapObject>& mapObject,
     const AreaI* bbox31,
+    QVector< PointI >& pointsBuffer,
     ObfMapSectionReader_Metrics::Metric_loadMapObjects* const metric)
 {
     const auto cis = reader.getCodedInputStream().get();
@@ -691,10 +697,13 @@ void OsmAnd::ObfMapSectionReader_P::readMapObject(
                 // so try to guess size of array, and preallocate it.
                 // (BytesUntilLimit/2) is ~= number of vertices, and is always larger than needed.
                 // So it's impossible that a buffer overflow will ever happen. But assert on that.
+                // Vertices are decoded into buffer shared by all objects of the block, and only accepted
+                // objects get own storage of exact size.
                 const auto probableVerticesCount = (cis->BytesUntilLimit() / 2);
-                QVector< PointI > points31(probableVerticesCount);
+                if (pointsBuffer.size() < probableVerticesCount)
+                    pointsBuffer.resize(probableVerticesCount);
 
-                auto pPoint = points31.data();
+                auto pPoint = pointsBuffer.data();
                 auto verticesCount = 0;
                 bool shouldNotSkip = (bbox31 == nullptr);
                 while (cis->BytesUntilLimit() > 0)
@@ -706,7 +715,7 @@ void OsmAnd::ObfMapSectionReader_P::readMapObject(
                     p += d;
 
                     // Save point into storage
-                    assert(points31.size() > verticesCount);
+                    assert(pointsBuffer.size() > verticesCount);
                     *(pPoint++) = p;
                     verticesCount++;
 
@@ -727,13 +736,9 @@ void OsmAnd::ObfMapSectionReader_P::readMapObject(
 
                 cis->PopLimit(oldLimit);
 
-                // Since reserved space may be larger than actual amount of data,
-                // shrink the vertices array
-                points31.resize(verticesCount);
-
                 // If map object has no vertices, retain it in a special way to report later, when
                 // it's identifier will be known
-                if (points31.isEmpty())
+                if (verticesCount == 0)
                 {
                     // Fake that this object is inside bbox
                     shouldNotSkip = true;
@@ -744,7 +749,7 @@ void OsmAnd::ObfMapSectionReader_P::readMapObject(
                 // may intersect the bbox
                 if (!shouldNotSkip && bbox31)
                 {
-                    assert(lastUnprocessedVertexForBBox == points31.size());
+                    assert(lastUnprocessedVertexForBBox == verticesCount);
 
                     shouldNotSkip =
                         objectBBox.contains(*bbox31) ||
@@ -757,7 +762,7 @@ void OsmAnd::ObfMapSectionReader_P::readMapObject(
                     if (metric)
                     {
                         metric->elapsedTimeForSkippedMapObjectsPoints += mapObjectPointsStopwatch.elapsed();
-                        metric->skippedMapObjectsPoints += points31.size();
+                        metric->skippedMapObjectsPoints += verticesCount;
                     }
 
                     cis->Skip(cis->BytesUntilLimit());
@@ -768,12 +773,12 @@ void OsmAnd::ObfMapSectionReader_P::readMapObject(
                 if (metric)
                 {
                     metric->elapsedTimeForNotSkippedMapObjectsPoints += mapObjectPointsStopwatch.elapsed();
-                    metric->notSkippedMapObjectsPoints += points31.size();
+                    metric->notSkippedMapObjectsPoints += verticesCount;
                 }
 
                 // In case bbox is not fully calculated, complete this task
-                auto pPointForBBox = points31.data() + lastUnprocessedVertexForBBox;
-                while (lastUnprocessedVertexForBBox < points31.size())
+                auto pPointForBBox = pointsBuffer.constData() + lastUnprocessedVertexForBBox;
+                while (lastUnprocessedVertexForBBox < verticesCount)
                 {
                     const Stopwatch mapObjectBboxStopwatch(metric != nullptr);
 
@@ -790,6 +795,8 @@ void OsmAnd::ObfMapSectionReader_P::readMapObject(
                 if (!mapObject)
                     mapObject.reset(new OsmAnd::BinaryMapObject(section, treeNode->level));
                 mapObject->isArea = (tgn == OBF::MapData::kAreaCoordinatesFieldNumber);
+                QVector< PointI > points31(verticesCount);
+                std::copy(pointsBuffer.constData(), pointsBuffer.constData() + verticesCount, points31.data());
                 mapObject->points31 = qMove(points31);
                 mapObject->bbox31 = objectBBox;
                 assert(treeNode->area31.top() - mapObject->bbox31.top() <= 32);
@@ -816,10 +823,10 @@ void OsmAnd::ObfMapSectionReader_P::readMapObject(
 
                 // Preallocate memory
                 const auto probableVerticesCount = (cis->BytesUntilLimit() / 2);
-                mapObject->innerPolygonsPoints31.push_back(qMove(QVector< PointI >(probableVerticesCount)));
-                auto& polygon = mapObject->innerPolygonsPoints31.last();
+                if (pointsBuffer.size() < probableVerticesCount)
+                    pointsBuffer.resize(probableVerticesCount);
 
-                auto pPoint = polygon.data();
+                auto pPoint = pointsBuffer.data();
                 auto verticesCount = 0;
                 while (cis->BytesUntilLimit() > 0)
                 {
@@ -830,13 +837,15 @@ void OsmAnd::ObfMapSectionReader_P::readMapObject(
                     p += d;
 
                     // Save point into storage
-                    assert(polygon.size() > verticesCount);
+                    assert(pointsBuffer.size() > verticesCount);
                     *(pPoint++) = p;
                     verticesCount++;
                 }
 
-                // Shrink memory
-                polygon.resize(verticesCount);
+                // Store exactly as much as was read
+                QVector< PointI > polygon(verticesCount);
+                std::copy(pointsBuffer.constData(), pointsBuffer.constData() + verticesCount, polygon.data());
+                mapObject->innerPolygonsPoints31.push_back(qMove(polygon));
 
                 cis->PopLimit(oldLimit);
 
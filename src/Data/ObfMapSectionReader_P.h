@@ -9,6 +9,7 @@
 #include <QHash>
 #include <QMap>
 #include <QSet>
+#include <QVector>
 #include "restore_internal_warnings.h"
 
 #include "OsmAndCore.h"
@@ -115,6 +116,7 @@ namespace OsmAnd
             const std::shared_ptr<const ObfMapSectionLevelTreeNode>& treeNode,
             std::shared_ptr<OsmAnd::BinaryMapObject>& mapObjectOut,
             const AreaI* bbox31,
+            QVector< PointI >& pointsBuffer,
             ObfMapSectionReader_Metrics::Metric_loadMapObjects* const metric);
 
         enum : uint32_t {
@@ -5,15 +5,15 @@
 
 #include "ObfFile.h"
 
-OsmAnd::ObfReader::ObfReader(const std::shared_ptr<const ObfFile>& obfFile_)
-    : _p(new ObfReader_P(this, std::shared_ptr<QIODevice>(new QFile(obfFile_->filePath))))
+OsmAnd::ObfReader::ObfReader(const std::shared_ptr<const ObfFile>& obfFile_, const bool useMemoryMapping /*= false*/)
+    : _p(new ObfReader_P(this, std::shared_ptr<QIODevice>(new QFile(obfFile_->filePath)), useMemoryMapping))
     , obfFile(obfFile_)
 {
     open();
 }
 
 OsmAnd::ObfReader::ObfReader(const std::shared_ptr<QIODevice>& input)
-    : _p(new ObfReader_P(this, input))
+    : _p(new ObfReader_P(this, input, false))
 {
     open();
 }
@@ -11,6 +11,7 @@
 
 #include "QIODeviceInputStream.h"
 #include "QFileDeviceInputStream.h"
+#include "QFileMemoryMappingInputStream.h"
 #include "ObfFile.h"
 #include "ObfFile_P.h"
 #include "ObfInfo.h"
@@ -34,8 +35,10 @@
 
 OsmAnd::ObfReader_P::ObfReader_P(
     ObfReader* const owner_,
-    const std::shared_ptr<QIODevice>& input_)
+    const std::shared_ptr<QIODevice>& input_,
+    const bool useMemoryMapping_)
     : _input(input_)
+    , _useMemoryMapping(useMemoryMapping_)
 #if OSMAND_VERIFY_OBF_READER_THREAD
     , _threadId(QThread::currentThreadId())
 #endif // OSMAND_VERIFY_OBF_READER_THREAD
@@ -73,7 +76,12 @@ bool OsmAnd::ObfReader_P::open()
 
     // Create zero-copy input stream
     gpb::io::ZeroCopyInputStream* zcis = nullptr;
-    if (const auto inputFileDevice = std::dynamic_pointer_cast<QFileDevice>(_input))
+    std::shared_ptr<const QFileMemoryMapping> memoryMapping;
+    if (_useMemoryMapping && owner->obfFile)
+        memoryMapping = owner->obfFile->_p->obtainMemoryMapping();
+    if (memoryMapping)
+        zcis = new QFileMemoryMappingInputStream(memoryMapping);
+    else if (const auto inputFileDevice = std::dynamic_pointer_cast<QFileDevice>(_input))
         zcis = new QFileDeviceInputStream(inputFileDevice);
     else
         zcis = new QIODeviceInputStream(_input);
@@ -85,7 +93,16 @@ bool OsmAnd::ObfReader_P::open()
     _codedInputStream.reset(cis);
 
 #if OSMAND_TRACE_OBF_READERS
-    if (const auto inputFileDevice = std::dynamic_pointer_cast<QFileDevice>(_input))
+    if (memoryMapping)
+    {
+        LogPrintf(LogSeverityLevel::Debug,
+            "Opened ObfReader(%p) in %p for '%s' using memory mapping %p",
+            owner.get(),
+            QThread::currentThreadId(),
+            qPrintable(memoryMapping->fileName),
+            memoryMapping->data);
+    }
+    else if (const auto inputFileDevice = std::dynamic_pointer_cast<QFileDevice>(_input))
     {
         LogPrintf(LogSeverityLevel::Debug,
             "Opened ObfReader(%p) in %p for '%s', handle 0x%08x",
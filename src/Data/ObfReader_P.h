@@ -39,6 +39,7 @@ namespace OsmAnd
 
     private:
         const std::shared_ptr<QIODevice> _input;
+        const bool _useMemoryMapping;
         std::shared_ptr<gpb::io::ZeroCopyInputStream> _zeroCopyInputStream;
         std::shared_ptr<gpb::io::CodedInputStream> _codedInputStream;
 
@@ -49,7 +50,7 @@ namespace OsmAnd
         const Qt::HANDLE _threadId;
 #endif // OSMAND_VERIFY_OBF_READER_THREAD
     protected:
-        ObfReader_P(ObfReader* const owner, const std::shared_ptr<QIODevice>& input);
+        ObfReader_P(ObfReader* const owner, const std::shared_ptr<QIODevice>& input, const bool useMemoryMapping);
     public:
         virtual ~ObfReader_P();
 
@@ -0,0 +1,127 @@
+#include "ObfReadersPool.h"
+
+#include <QThread>
+
+#include "ObfFile.h"
+#include "ObfReader.h"
+
+OsmAnd::ObfReadersPool::ObfReadersPool(const unsigned int capacity_ /*= DefaultCapacity*/)
+    : _capacity(capacity_)
+    , _useCounter(0)
+{
+}
+
+OsmAnd::ObfReadersPool::~ObfReadersPool()
+{
+}
+
+unsigned int OsmAnd::ObfReadersPool::getCapacity() const
+{
+    QMutexLocker scopedLocker(&_mutex);
+
+    return _capacity;
+}
+
+void OsmAnd::ObfReadersPool::setCapacity(const unsigned int capacity)
+{
+    QMutexLocker scopedLocker(&_mutex);
+
+    _capacity = capacity;
+    evictNoLock();
+}
+
+std::shared_ptr<const OsmAnd::ObfReader> OsmAnd::ObfReadersPool::obtainReader(
+    const std::shared_ptr<const ObfFile>& obfFile,
+    const bool useMemoryMapping)
+{
+    QMutexLocker scopedLocker(&_mutex);
+
+    if (_capacity == 0)
+    {
+        scopedLocker.unlock();
+        return std::make_shared<ObfReader>(obfFile, useMemoryMapping);
+    }
+
+    const Key key(obfFile.get(), QThread::currentThreadId());
+    auto itEntry = _entries.find(key);
+    if (itEntry != _entries.end())
+    {
+        auto& entry = *itEntry;
+
+        // Reader that is still referenced elsewhere is in use by the same thread (e.g. nested data interface),
+        // so a separate short-lived reader is needed to keep stream state intact
+        if (entry.reader.use_count() > 1)
+        {
+            scopedLocker.unlock();
+            return std::make_shared<ObfReader>(obfFile, useMemoryMapping);
+        }
+
+        // Reader is reusable only if previous user left no limits pushed on the stream
+        if (entry.useMemoryMapping == useMemoryMapping &&
+            entry.reader->isOpened() &&
+            entry.reader->getCodedInputStream()->BytesUntilLimit() < 0)
+        {
+            entry.lastUse = ++_useCounter;
+            return entry.reader;
+        }
+
+        _entries.erase(itEntry);
+    }
+
+    const std::shared_ptr<const ObfReader> reader(new ObfReader(obfFile, useMemoryMapping));
+    if (!reader->isOpened())
+        return reader;
+
+    Entry newEntry;
+    newEntry.reader = reader;
+    newEntry.useMemoryMapping = useMemoryMapping;
+    newEntry.lastUse = ++_useCounter;
+    _entries.insert(key, newEntry);
+
+    evictNoLock();
+
+    return reader;
+}
+
+void OsmAnd::ObfReadersPool::evictNoLock()
+{
+    while (static_cast<unsigned int>(_entries.size()) > _capacity)
+    {
+        // Find least recently used reader that is idle
+        auto itVictim = _entries.end();
+        for (auto itEntry = _entries.begin(); itEntry != _entries.end(); ++itEntry)
+        {
+            if (itEntry->reader.use_count() > 1)
+                continue;
+            if (itVictim == _entries.end() || itEntry->lastUse < itVictim->lastUse)
+                itVictim = itEntry;
+        }
+
+        // All readers are in use, pool will shrink on subsequent calls
+        if (itVictim == _entries.end())
+            break;
+
+        _entries.erase(itVictim);
+    }
+}
+
+void OsmAnd::ObfReadersPool::releaseReaders(const QString& filePath)
+{
+    QMutexLocker scopedLocker(&_mutex);
+
+    auto itEntry = _entries.begin();
+    while (itEntry != _entries.end())
+    {
+        if (itEntry->reader->obfFile->filePath == filePath)
+            itEntry = _entries.erase(itEntry);
+        else
+            ++itEntry;
+    }
+}
+
+void OsmAnd::ObfReadersPool::releaseAllReaders()
+{
+    QMutexLocker scopedLocker(&_mutex);
+
+    _entries.clear();
+}
@@ -0,0 +1,62 @@
+#ifndef _OSMAND_CORE_OBF_READERS_POOL_H_
+#define _OSMAND_CORE_OBF_READERS_POOL_H_
+
+#include "stdlib_common.h"
+
+#include "QtExtensions.h"
+#include <QHash>
+#include <QPair>
+#include <QMutex>
+#include <QString>
+
+#include "OsmAndCore.h"
+
+namespace OsmAnd
+{
+    class ObfFile;
+    class ObfReader;
+
+    // Pool of opened ObfReaders, keyed by ObfFile and calling thread. ObfReader is not thread-safe,
+    // so each pooled reader is only ever handed out to the thread that created it, and only while
+    // no one else holds it. Least-recently used idle readers are closed once capacity is exceeded.
+    class ObfReadersPool Q_DECL_FINAL
+    {
+        Q_DISABLE_COPY_AND_MOVE(ObfReadersPool);
+    public:
+        enum {
+            DefaultCapacity = 128,
+        };
+
+    private:
+        typedef QPair<const ObfFile*, Qt::HANDLE> Key;
+        struct Entry
+        {
+            std::shared_ptr<const ObfReader> reader;
+            bool useMemoryMapping;
+            uint64_t lastUse;
+        };
+
+        mutable QMutex _mutex;
+        QHash<Key, Entry> _entries;
+        unsigned int _capacity;
+        uint64_t _useCounter;
+
+        void evictNoLock();
+    protected:
+    public:
+        ObfReadersPool(const unsigned int capacity = DefaultCapacity);
+        ~ObfReadersPool();
+
+        unsigned int getCapacity() const;
+        void setCapacity(const unsigned int capacity);
+
+        std::shared_ptr<const ObfReader> obtainReader(
+            const std::shared_ptr<const ObfFile>& obfFile,
+            const bool useMemoryMapping);
+
+        void releaseReaders(const QString& filePath);
+        void releaseAllReaders();
+    };
+}
+
+#endif // !defined(_OSMAND_CORE_OBF_READERS_POOL_H_)
@@ -0,0 +1,158 @@
+#include "ObfsSpatialIndex.h"
+
+#include "ObfInfo.h"
+#include "ObfMapSectionInfo.h"
+#include "ObfRoutingSectionInfo.h"
+#include "ObfPoiSectionInfo.h"
+#include "ObfAddressSectionInfo.h"
+#include "ObfTransportSectionInfo.h"
+
+OsmAnd::ObfsSpatialIndex::ObfsSpatialIndex()
+    : _areasTree(AreaI::largestPositive(), MaxDepth)
+{
+}
+
+OsmAnd::ObfsSpatialIndex::~ObfsSpatialIndex()
+{
+}
+
+void OsmAnd::ObfsSpatialIndex::insert(
+    const QString& key,
+    const std::shared_ptr<const ObfInfo>& obfInfo,
+    const bool unconditional /*= false*/)
+{
+    QList< std::shared_ptr<const IndexedArea> > areas;
+    if (!unconditional && obfInfo)
+    {
+        const auto collectArea =
+            [&areas, &key]
+            (const ObfDataType dataType, const ZoomLevel minZoom, const ZoomLevel maxZoom, const AreaI& area31)
+            {
+                const auto indexedArea = std::make_shared<IndexedArea>();
+                indexedArea->key = key;
+                indexedArea->dataType = dataType;
+                indexedArea->minZoom = minZoom;
+                indexedArea->maxZoom = maxZoom;
+                indexedArea->area31 = area31;
+                areas.push_back(indexedArea);
+            };
+
+        for (const auto& mapSection : constOf(obfInfo->mapSections))
+        {
+            for (const auto& level : constOf(mapSection->levels))
+                collectArea(ObfDataType::Map, level->minZoom, level->maxZoom, level->area31);
+        }
+        for (const auto& routingSection : constOf(obfInfo->routingSections))
+            collectArea(ObfDataType::Routing, MinZoomLevel, MaxZoomLevel, routingSection->area31);
+        for (const auto& poiSection : constOf(obfInfo->poiSections))
+            collectArea(ObfDataType::POI, MinZoomLevel, MaxZoomLevel, poiSection->area31);
+        for (const auto& addressSection : constOf(obfInfo->addressSections))
+            collectArea(ObfDataType::Address, MinZoomLevel, MaxZoomLevel, addressSection->area31);
+        for (const auto& transportSection : constOf(obfInfo->transportSections))
+            collectArea(ObfDataType::Transport, MinZoomLevel, MaxZoomLevel, transportSection->area31);
+    }
+
+    QWriteLocker scopedLocker(&_lock);
+
+    removeNoLock(key);
+    for (const auto& indexedArea : constOf(areas))
+    {
+        // Areas that fall outside of 31-bit tile space can not be placed into tree, so check them directly
+        if (!_areasTree.insert(indexedArea, indexedArea->area31, true))
+            _unindexedAreas.push_back(indexedArea);
+    }
+    _entries.insert(key, qMove(areas));
+    if (unconditional)
+        _unconditionalKeys.insert(key);
+}
+
+void OsmAnd::ObfsSpatialIndex::remove(const QString& key)
+{
+    QWriteLocker scopedLocker(&_lock);
+
+    removeNoLock(key);
+}
+
+void OsmAnd::ObfsSpatialIndex::removeNoLock(const QString& key)
+{
+    const auto itEntry = _entries.find(key);
+    if (itEntry == _entries.end())
+        return;
+
+    for (const auto& indexedArea : constOf(*itEntry))
+    {
+        if (!_areasTree.removeOne(indexedArea, indexedArea->area31))
+            _unindexedAreas.removeOne(indexedArea);
+    }
+    _entries.erase(itEntry);
+    _unconditionalKeys.remove(key);
+}
+
+void OsmAnd::ObfsSpatialIndex::clear()
+{
+    QWriteLocker scopedLocker(&_lock);
+
+    _areasTree = AreasTree(AreaI::largestPositive(), MaxDepth);
+    _entries.clear();
+    _unconditionalKeys.clear();
+    _unindexedAreas.clear();
+}
+
+bool OsmAnd::ObfsSpatialIndex::contains(const QString& key) const
+{
+    QReadLocker scopedLocker(&_lock);
+
+    return _entries.contains(key);
+}
+
+bool OsmAnd::ObfsSpatialIndex::accepts(
+    const IndexedArea& indexedArea,
+    const ZoomLevel minZoomLevel,
+    const ZoomLevel maxZoomLevel,
+    const ObfDataTypesMask desiredDataTypes)
+{
+    if (!desiredDataTypes.isSet(indexedArea.dataType))
+        return false;
+
+    return minZoomLevel <= indexedArea.maxZoom && indexedArea.minZoom <= maxZoomLevel;
+}
+
+QSet<QString> OsmAnd::ObfsSpatialIndex::query(
+    const AreaI* const pBbox31,
+    const ZoomLevel minZoomLevel,
+    const ZoomLevel maxZoomLevel,
+    const ObfDataTypesMask desiredDataTypes) const
+{
+    QReadLocker scopedLocker(&_lock);
+
+    auto result = _unconditionalKeys;
+
+    const AreasTree::Acceptor acceptor =
+        [&result, minZoomLevel, maxZoomLevel, desiredDataTypes]
+        (const std::shared_ptr<const IndexedArea>& indexedArea, const AreasTree::BBox& bbox) -> bool
+        {
+            // Once OBF is known to be needed, none of its other areas have to be checked
+            if (result.contains(indexedArea->key))
+                return false;
+            if (!accepts(*indexedArea, minZoomLevel, maxZoomLevel, desiredDataTypes))
+                return false;
+
+            result.insert(indexedArea->key);
+            return false;
+        };
+
+    QList< std::shared_ptr<const IndexedArea> > dummyResults;
+    if (pBbox31)
+        _areasTree.query(*pBbox31, dummyResults, false, acceptor);
+    else
+        _areasTree.get(dummyResults, acceptor);
+
+    for (const auto& indexedArea : constOf(_unindexedAreas))
+    {
+        if (pBbox31 && !pBbox31->intersects(indexedArea->area31))
+            continue;
+        acceptor(indexedArea, AreasTree::BBox(indexedArea->area31));
+    }
+
+    return result;
+}
@@ -0,0 +1,77 @@
+#ifndef _OSMAND_CORE_OBFS_SPATIAL_INDEX_H_
+#define _OSMAND_CORE_OBFS_SPATIAL_INDEX_H_
+
+#include "stdlib_common.h"
+
+#include "QtExtensions.h"
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QReadWriteLock>
+#include <QSet>
+#include <QString>
+
+#include "OsmAndCore.h"
+#include "CommonTypes.h"
+#include "QuadTree.h"
+#include "DataCommonTypes.h"
+
+namespace OsmAnd
+{
+    class ObfInfo;
+
+    // Spatial index over section areas of a set of OBF files, keyed by arbitrary string (e.g. resource id).
+    // Replaces per-request linear scan with ObfInfo::containsDataFor() by a quad-tree query, and is kept up-to-date
+    // incrementally as OBF files are added or removed. Query semantics match ObfInfo::containsDataFor().
+    class ObfsSpatialIndex Q_DECL_FINAL
+    {
+        Q_DISABLE_COPY_AND_MOVE(ObfsSpatialIndex);
+    public:
+        enum {
+            MaxDepth = 12,
+        };
+
+    private:
+        struct IndexedArea
+        {
+            QString key;
+            ObfDataType dataType;
+            ZoomLevel minZoom;
+            ZoomLevel maxZoom;
+            AreaI area31;
+        };
+        typedef QuadTree< std::shared_ptr<const IndexedArea>, AreaI::CoordType > AreasTree;
+
+
+        mutable QReadWriteLock _lock;
+        AreasTree _areasTree;
+        QHash< QString, QList< std::shared_ptr<const IndexedArea> > > _entries;
+        QSet<QString> _unconditionalKeys;
+        QList< std::shared_ptr<const IndexedArea> > _unindexedAreas;
+
+        void removeNoLock(const QString& key);
+        static bool accepts(
+            const IndexedArea& indexedArea,
+            const ZoomLevel minZoomLevel,
+            const ZoomLevel maxZoomLevel,
+            const ObfDataTypesMask desiredDataTypes);
+    protected:
+    public:
+        ObfsSpatialIndex();
+        ~ObfsSpatialIndex();
+
+        // Inserts or replaces entry. Unconditional entries (e.g. basemaps) are returned by any query
+        void insert(const QString& key, const std::shared_ptr<const ObfInfo>& obfInfo, const bool unconditional = false);
+        void remove(const QString& key);
+        void clear();
+
+        bool contains(const QString& key) const;
+        QSet<QString> query(
+            const AreaI* const pBbox31,
+            const ZoomLevel minZoomLevel,
+            const ZoomLevel maxZoomLevel,
+            const ObfDataTypesMask desiredDataTypes) const;
+    };
+}
+
+#endif // !defined(_OSMAND_CORE_OBFS_SPATIAL_INDEX_H_)
@@ -0,0 +1,112 @@
+#include "GlyphAtlas.h"
+#include "GlyphAtlas_P.h"
+
+OsmAnd::GlyphAtlas::GlyphAtlas(
+    const Mode mode_ /*= Mode::Coverage*/,
+    const unsigned int pageSize_ /*= DefaultPageSize*/,
+    const float signedDistanceFieldBaseSize_ /*= 32.0f*/,
+    const unsigned int signedDistanceFieldSpread_ /*= DefaultSignedDistanceFieldSpread*/,
+    const unsigned int maxPagesCount_ /*= DefaultMaxPagesCount*/)
+    : _p(new GlyphAtlas_P(this))
+    , mode(mode_)
+    , pageSize(pageSize_)
+    , signedDistanceFieldBaseSize(signedDistanceFieldBaseSize_)
+    , signedDistanceFieldSpread(qMax(1u, signedDistanceFieldSpread_))
+    , maxPagesCount(qMax(1u, maxPagesCount_))
+{
+}
+
+OsmAnd::GlyphAtlas::~GlyphAtlas()
+{
+}
+
+bool OsmAnd::GlyphAtlas::obtainGlyph(
+    const SkPaint& paint,
+    const uint16_t glyphId,
+    const unsigned int haloRadius,
+    Glyph& outGlyph)
+{
+    return _p->obtainGlyph(paint, glyphId, haloRadius, outGlyph);
+}
+
+bool OsmAnd::GlyphAtlas::allocateArea(
+    const PointI& size,
+    unsigned int& outPageIndex,
+    AreaI& outArea)
+{
+    return _p->allocateArea(size, outPageIndex, outArea);
+}
+
+unsigned int OsmAnd::GlyphAtlas::getPagesCount() const
+{
+    return _p->getPagesCount();
+}
+
+bool OsmAnd::GlyphAtlas::copyPage(
+    const unsigned int pageIndex,
+    SkBitmap& outBitmap,
+    unsigned int* const outRevision /*= nullptr*/) const
+{
+    return _p->copyPage(pageIndex, outBitmap, outRevision);
+}
+
+unsigned int OsmAnd::GlyphAtlas::getPageRevision(const unsigned int pageIndex) const
+{
+    return _p->getPageRevision(pageIndex);
+}
+
+void OsmAnd::GlyphAtlas::clear()
+{
+    _p->clear();
+}
+
+unsigned int OsmAnd::GlyphAtlas::getGeneration() const
+{
+    return _p->getGeneration();
+}
+
+void OsmAnd::GlyphAtlas::computeSignedDistanceField(
+    const uint8_t* const coverage,
+    const unsigned int width,
+    const unsigned int height,
+    const unsigned int spread,
+    uint8_t* const outDistances)
+{
+    // For each texel, find distance to closest texel on the other side of glyph edge within spread.
+    // Edge is assumed to lie halfway between texel centers, so adjacent texels are 0.5 away from it.
+    const auto maxDistance = static_cast<float>(spread);
+    const auto searchRadius = static_cast<int>(spread);
+    for (auto y = 0; y < static_cast<int>(height); y++)
+    {
+        for (auto x = 0; x < static_cast<int>(width); x++)
+        {
+            const auto isInside = (coverage[y * width + x] >= 128);
+
+            auto minSquaredDistance = std::numeric_limits<int>::max();
+            const auto top = qMax(0, y - searchRadius);
+            const auto bottom = qMin(static_cast<int>(height) - 1, y + searchRadius);
+            const auto left = qMax(0, x - searchRadius);
+            const auto right = qMin(static_cast<int>(width) - 1, x + searchRadius);
+            for (auto otherY = top; otherY <= bottom; otherY++)
+            {
+                for (auto otherX = left; otherX <= right; otherX++)
+                {
+                    if ((coverage[otherY * width + otherX] >= 128) == isInside)
+                        continue;
+
+                    const auto dx = otherX - x;
+                    const auto dy = otherY - y;
+                    minSquaredDistance = qMin(minSquaredDistance, dx * dx + dy * dy);
+                }
+            }
+
+            const auto distance = (minSquaredDistance == std::numeric_limits<int>::max())
+                ? maxDistance
+                : qMin(maxDistance, qSqrt(static_cast<float>(minSquaredDistance)) - 0.5f);
+            const auto value = isInside
+                ? 128.0f + distance * 127.0f / maxDistance
+                : 128.0f - distance * 128.0f / maxDistance;
+            outDistances[y * width + x] = static_cast<uint8_t>(qBound(0, qRound(value), 255));
+        }
+    }
+}
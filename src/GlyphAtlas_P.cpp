@@ -0,0 +1,346 @@
+#include "GlyphAtlas_P.h"
+#include "GlyphAtlas.h"
+
+#include "ignore_warnings_on_external_includes.h"
+#include <SkBitmapDevice.h>
+#include <SkCanvas.h>
+#include "restore_internal_warnings.h"
+
+#include "Logging.h"
+
+OsmAnd::GlyphAtlas_P::GlyphAtlas_P(GlyphAtlas* const owner_)
+    : _generation(0)
+    , owner(owner_)
+{
+}
+
+OsmAnd::GlyphAtlas_P::~GlyphAtlas_P()
+{
+    for (const auto& typeface : constOf(_referencedTypefaces))
+        typeface->unref();
+}
+
+void OsmAnd::GlyphAtlas_P::clear()
+{
+    QWriteLocker scopedLocker(&_lock);
+
+    _pages.clear();
+    _glyphs.clear();
+    for (const auto& typeface : constOf(_referencedTypefaces))
+        typeface->unref();
+    _referencedTypefaces.clear();
+    _generation++;
+}
+
+unsigned int OsmAnd::GlyphAtlas_P::getGeneration() const
+{
+    QReadLocker scopedLocker(&_lock);
+
+    return _generation;
+}
+
+bool OsmAnd::GlyphAtlas_P::obtainGlyph(
+    const SkPaint& paint,
+    const uint16_t glyphId,
+    const unsigned int haloRadius,
+    Glyph& outGlyph)
+{
+    // In signed distance field mode, glyph is stored once per typeface: both size and halo are
+    // applied later by sampling the distance field at proper scale and threshold
+    const auto isSignedDistanceField = (owner->mode == GlyphAtlas::Mode::SignedDistanceField);
+
+    GlyphKey key;
+    key.typeface = paint.getTypeface();
+    key.glyphId = glyphId;
+    key.size = isSignedDistanceField ? 0.0f : paint.getTextSize();
+    key.fakeBold = paint.isFakeBoldText();
+    key.haloRadius = isSignedDistanceField ? 0 : haloRadius;
+
+    {
+        QReadLocker scopedLocker(&_lock);
+
+        const auto citGlyph = _glyphs.constFind(key);
+        if (citGlyph != _glyphs.cend())
+        {
+            outGlyph = *citGlyph;
+            return true;
+        }
+    }
+
+    // Rasterize glyph outside of lock, since it's the most expensive part
+    const auto rasterizedSize = isSignedDistanceField ? owner->signedDistanceFieldBaseSize : paint.getTextSize();
+    SkBitmap coverage;
+    PointF offset;
+    if (!rasterizeGlyph(paint, glyphId, key.haloRadius, rasterizedSize, coverage, offset))
+        return false;
+
+    if (isSignedDistanceField && !coverage.isNull())
+    {
+        SkBitmap distances;
+        if (!distances.tryAllocPixels(SkImageInfo::MakeA8(coverage.width(), coverage.height())))
+        {
+            LogPrintf(LogSeverityLevel::Error,
+                "Failed to allocate bitmap of size %dx%d",
+                coverage.width(),
+                coverage.height());
+            return false;
+        }
+
+        GlyphAtlas::computeSignedDistanceField(
+            reinterpret_cast<const uint8_t*>(coverage.getPixels()),
+            coverage.width(),
+            coverage.height(),
+            owner->signedDistanceFieldSpread,
+            reinterpret_cast<uint8_t*>(distances.getPixels()));
+        coverage = distances;
+    }
+
+    QWriteLocker scopedLocker(&_lock);
+
+    // Glyph may have been inserted by other thread meanwhile
+    const auto citGlyph = _glyphs.constFind(key);
+    if (citGlyph != _glyphs.cend())
+    {
+        outGlyph = *citGlyph;
+        return true;
+    }
+
+    Glyph glyph;
+    glyph.offset = offset;
+    glyph.rasterizedSize = rasterizedSize;
+    if (!coverage.isNull())
+    {
+        if (!unsafeAllocateArea(PointI(coverage.width(), coverage.height()), glyph.pageIndex, glyph.area))
+            return false;
+
+        auto& page = _pages[glyph.pageIndex];
+        for (auto row = 0; row < coverage.height(); row++)
+        {
+            memcpy(
+                page.bitmap.getAddr8(glyph.area.left(), glyph.area.top() + row),
+                coverage.getAddr8(0, row),
+                coverage.width());
+        }
+        page.revision++;
+    }
+
+    if (key.typeface && !_referencedTypefaces.contains(key.typeface))
+    {
+        key.typeface->ref();
+        _referencedTypefaces.insert(key.typeface);
+    }
+    _glyphs.insert(key, glyph);
+
+    outGlyph = glyph;
+    return true;
+}
+
+bool OsmAnd::GlyphAtlas_P::rasterizeGlyph(
+    const SkPaint& paint_,
+    const uint16_t glyphId,
+    const unsigned int haloRadius,
+    const float rasterizedSize,
+    SkBitmap& outCoverage,
+    PointF& outOffset) const
+{
+    auto paint = paint_;
+    paint.setTextEncoding(SkPaint::kGlyphID_TextEncoding);
+    paint.setTextSize(rasterizedSize);
+    paint.setAntiAlias(true);
+    paint.setColor(SK_ColorWHITE);
+    paint.setShader(nullptr);
+    if (haloRadius > 0)
+    {
+        paint.setStyle(SkPaint::kStroke_Style);
+        paint.setStrokeWidth(haloRadius);
+    }
+    else
+        paint.setStyle(SkPaint::kFill_Style);
+
+    SkRect bounds;
+    paint.measureText(&glyphId, sizeof(uint16_t), &bounds);
+    if (bounds.isEmpty())
+    {
+        // Glyph has no visible pixels, so only its offset is meaningful
+        outCoverage.reset();
+        outOffset = PointF();
+        return true;
+    }
+
+    // Distance field needs space around glyph to fade out, while coverage needs just a single texel
+    // to avoid bleeding of neighbours when sampled with linear filtering
+    const auto padding = (owner->mode == GlyphAtlas::Mode::SignedDistanceField)
+        ? static_cast<int>(owner->signedDistanceFieldSpread)
+        : 1;
+    const auto left = qFloor(bounds.left()) - padding;
+    const auto top = qFloor(bounds.top()) - padding;
+    const auto width = qCeil(bounds.right()) + padding - left;
+    const auto height = qCeil(bounds.bottom()) + padding - top;
+
+    if (!outCoverage.tryAllocPixels(SkImageInfo::MakeA8(width, height)))
+    {
+        LogPrintf(LogSeverityLevel::Error,
+            "Failed to allocate bitmap of size %dx%d",
+            width,
+            height);
+        return false;
+    }
+    outCoverage.eraseColor(SK_ColorTRANSPARENT);
+
+    SkBitmapDevice target(outCoverage);
+    SkCanvas canvas(&target);
+    canvas.drawText(&glyphId, sizeof(uint16_t), -left, -top, paint);
+    canvas.flush();
+
+    outOffset = PointF(left, top);
+    return true;
+}
+
+bool OsmAnd::GlyphAtlas_P::allocateArea(
+    const PointI& size,
+    unsigned int& outPageIndex,
+    AreaI& outArea)
+{
+    QWriteLocker scopedLocker(&_lock);
+
+    return unsafeAllocateArea(size, outPageIndex, outArea);
+}
+
+bool OsmAnd::GlyphAtlas_P::unsafeAllocateArea(
+    const PointI& size,
+    unsigned int& outPageIndex,
+    AreaI& outArea)
+{
+    const auto pageSize = static_cast<int>(owner->pageSize);
+    if (size.x <= 0 || size.y <= 0 || size.x > pageSize || size.y > pageSize)
+        return false;
+
+    for (auto pageIndex = 0; pageIndex < _pages.size(); pageIndex++)
+    {
+        auto& page = _pages[pageIndex];
+
+        // Find shelf that wastes least height. Shelves that are much taller than requested area are
+        // used only when page has no space left for a new shelf
+        Shelf* pBestShelf = nullptr;
+        for (auto& shelf : page.shelves)
+        {
+            if (shelf.height < size.y || shelf.filledWidth + size.x > pageSize)
+                continue;
+            if (!pBestShelf || shelf.height < pBestShelf->height)
+                pBestShelf = &shelf;
+        }
+        const auto canOpenShelf = (page.filledHeight + size.y <= pageSize);
+        if (pBestShelf && canOpenShelf && pBestShelf->height > size.y + size.y / 2)
+            pBestShelf = nullptr;
+
+        if (!pBestShelf && canOpenShelf)
+        {
+            Shelf shelf;
+            shelf.top = page.filledHeight;
+            shelf.height = size.y;
+            shelf.filledWidth = 0;
+            page.shelves.push_back(shelf);
+            page.filledHeight += size.y;
+
+            pBestShelf = &page.shelves.last();
+        }
+
+        if (pBestShelf)
+        {
+            outPageIndex = pageIndex;
+            outArea = AreaI(
+                pBestShelf->top,
+                pBestShelf->filledWidth,
+                pBestShelf->top + size.y,
+                pBestShelf->filledWidth + size.x);
+            pBestShelf->filledWidth += size.x;
+
+            return true;
+        }
+    }
+
+    // No existing page has space, so open a new one if limit allows
+    if (_pages.size() >= static_cast<int>(owner->maxPagesCount))
+        return false;
+
+    Page page;
+    if (!page.bitmap.tryAllocPixels(SkImageInfo::MakeA8(pageSize, pageSize)))
+    {
+        LogPrintf(LogSeverityLevel::Error,
+            "Failed to allocate glyph atlas page of size %dx%d",
+            pageSize,
+            pageSize);
+        return false;
+    }
+    page.bitmap.eraseColor(SK_ColorTRANSPARENT);
+    page.filledHeight = size.y;
+    page.revision = 0;
+
+    Shelf shelf;
+    shelf.top = 0;
+    shelf.height = size.y;
+    shelf.filledWidth = size.x;
+    page.shelves.push_back(shelf);
+
+    outPageIndex = _pages.size();
+    outArea = AreaI(0, 0, size.y, size.x);
+    _pages.push_back(qMove(page));
+
+    return true;
+}
+
+unsigned int OsmAnd::GlyphAtlas_P::getPagesCount() const
+{
+    QReadLocker scopedLocker(&_lock);
+
+    return _pages.size();
+}
+
+bool OsmAnd::GlyphAtlas_P::copyPage(
+    const unsigned int pageIndex,
+    SkBitmap& outBitmap,
+    unsigned int* const outRevision) const
+{
+    QReadLocker scopedLocker(&_lock);
+
+    if (pageIndex >= _pages.size())
+        return false;
+
+    const auto& page = _pages[pageIndex];
+    if (!page.bitmap.deepCopyTo(&outBitmap))
+        return false;
+    if (outRevision)
+        *outRevision = page.revision;
+
+    return true;
+}
+
+unsigned int OsmAnd::GlyphAtlas_P::getPageRevision(const unsigned int pageIndex) const
+{
+    QReadLocker scopedLocker(&_lock);
+
+    if (pageIndex >= _pages.size())
+        return 0;
+
+    return _pages[pageIndex].revision;
+}
+
+bool OsmAnd::GlyphAtlas_P::GlyphKey::operator==(const GlyphKey& that) const
+{
+    return
+        typeface == that.typeface &&
+        glyphId == that.glyphId &&
+        size == that.size &&
+        fakeBold == that.fakeBold &&
+        haloRadius == that.haloRadius;
+}
+
+uint OsmAnd::GlyphAtlas_P::GlyphKey::qHash() const
+{
+    uint hash = ::qHash(typeface);
+    hash = hash * 31 + glyphId;
+    hash = hash * 31 + ::qHash(size);
+    hash = hash * 31 + (fakeBold ? 1 : 0);
+    hash = hash * 31 + haloRadius;
+    return hash;
+}
@@ -0,0 +1,108 @@
+#ifndef _OSMAND_CORE_GLYPH_ATLAS_P_H_
+#define _OSMAND_CORE_GLYPH_ATLAS_P_H_
+
+#include "stdlib_common.h"
+
+#include "QtExtensions.h"
+#include "ignore_warnings_on_external_includes.h"
+#include <QHash>
+#include <QVector>
+#include <QSet>
+#include <QReadWriteLock>
+#include "restore_internal_warnings.h"
+
+#include "ignore_warnings_on_external_includes.h"
+#include <SkBitmap.h>
+#include <SkPaint.h>
+#include <SkTypeface.h>
+#include "restore_internal_warnings.h"
+
+#include "OsmAndCore.h"
+#include "CommonTypes.h"
+#include "PrivateImplementation.h"
+#include "GlyphAtlas.h"
+
+namespace OsmAnd
+{
+    class GlyphAtlas;
+    class GlyphAtlas_P Q_DECL_FINAL
+    {
+    public:
+        typedef GlyphAtlas::Mode Mode;
+        typedef GlyphAtlas::Glyph Glyph;
+
+    private:
+        struct GlyphKey Q_DECL_FINAL
+        {
+            const SkTypeface* typeface;
+            uint16_t glyphId;
+            float size;
+            bool fakeBold;
+            unsigned int haloRadius;
+
+            bool operator==(const GlyphKey& that) const;
+            uint qHash() const;
+        };
+
+        // Page is packed with shelves: rows of areas of similar height, that are filled from left to right
+        struct Shelf Q_DECL_FINAL
+        {
+            int top;
+            int height;
+            int filledWidth;
+        };
+        struct Page Q_DECL_FINAL
+        {
+            SkBitmap bitmap;
+            QVector<Shelf> shelves;
+            int filledHeight;
+            unsigned int revision;
+        };
+
+        mutable QReadWriteLock _lock;
+        unsigned int _generation;
+        QVector<Page> _pages;
+        QHash<GlyphKey, Glyph> _glyphs;
+        // Typefaces referenced by glyph keys are kept alive by atlas
+        QSet<const SkTypeface*> _referencedTypefaces;
+
+        bool unsafeAllocateArea(const PointI& size, unsigned int& outPageIndex, AreaI& outArea);
+        bool rasterizeGlyph(
+            const SkPaint& paint,
+            const uint16_t glyphId,
+            const unsigned int haloRadius,
+            const float rasterizedSize,
+            SkBitmap& outCoverage,
+            PointF& outOffset) const;
+    protected:
+        GlyphAtlas_P(GlyphAtlas* const owner);
+    public:
+        ~GlyphAtlas_P();
+
+        ImplementationInterface<GlyphAtlas> owner;
+
+        bool obtainGlyph(
+            const SkPaint& paint,
+            const uint16_t glyphId,
+            const unsigned int haloRadius,
+            Glyph& outGlyph);
+        bool allocateArea(
+            const PointI& size,
+            unsigned int& outPageIndex,
+            AreaI& outArea);
+
+        unsigned int getPagesCount() const;
+        bool copyPage(
+            const unsigned int pageIndex,
+            SkBitmap& outBitmap,
+            unsigned int* const outRevision) const;
+        unsigned int getPageRevision(const unsigned int pageIndex) const;
+
+        void clear();
+        unsigned int getGeneration() const;
+
+    friend class OsmAnd::GlyphAtlas;
+    };
+}
+
+#endif // !defined(_OSMAND_CORE_GLYPH_ATLAS_P_H_)
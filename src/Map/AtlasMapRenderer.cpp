@@ -68,7 +68,11 @@ bool OsmAnd::AtlasMapRenderer::postPrepareFrame()
         return false;
 
     // Notify resources manager about new active zone
-    getResources().updateActiveZone(internalState->targetTileId, internalState->uniqueTiles, currentState.zoomLevel);
+    getResources().updateActiveZone(
+        currentState.target31,
+        internalState->targetTileId,
+        internalState->uniqueTiles,
+        currentState.zoomLevel);
 
     return true;
 }
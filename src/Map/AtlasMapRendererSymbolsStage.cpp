@@ -1,9 +1,12 @@
 #include "AtlasMapRendererSymbolsStage.h"
 
+#include <limits>
+
 #include "QtExtensions.h"
 #include "ignore_warnings_on_external_includes.h"
 #include <QLinkedList>
 #include <QSet>
+#include <QtMath>
 #include <QVector>
 #include "restore_internal_warnings.h"
 
@@ -34,9 +37,14 @@
 #include "MapSymbolIntersectionClassesRegistry.h"
 #include "Stopwatch.h"
 #include "GlmExtensions.h"
+#include "Utilities.h"
 
 OsmAnd::AtlasMapRendererSymbolsStage::AtlasMapRendererSymbolsStage(AtlasMapRenderer* const renderer_)
     : AtlasMapRendererStage(renderer_)
+    , _lastPlacementHasSymbolsWithoutGpuResources(false)
+    , _lastPlacementSymbolsRevision(0)
+    , _lastPlacementValid(false)
+    , _lastPlacementIncremental(false)
 {
 }
 
@@ -48,8 +56,42 @@ void OsmAnd::AtlasMapRendererSymbolsStage::prepare(AtlasMapRenderer_Metrics::Met
 {
     Stopwatch stopwatch(metric != nullptr);
 
+    // Symbols placed in previous frame are still valid if nothing that affects placement was changed since then.
+    // Debug stage is refilled every frame, so placement has to be repeated to provide debug primitives again
+    const auto symbolsRevision = renderer->getSymbolsRevision();
+    const auto camera = capturePlacementCamera();
+    const auto lastPlacementIsUpToDate =
+        _lastPlacementValid &&
+        _lastPlacementSymbolsRevision == symbolsRevision &&
+        !_lastPlacementHasSymbolsWithoutGpuResources &&
+        !debugSettings->debugStageEnabled;
+    if (lastPlacementIsUpToDate && !_lastPlacementIncremental && camera == _lastPlacementCamera)
+    {
+        if (metric)
+        {
+            metric->reusedSymbolsPlacements++;
+            metric->elapsedTimeForPreparingSymbols = stopwatch.elapsed();
+        }
+
+        return;
+    }
+
+    // Camera moves do not change symbols revision. In case camera moved a little since last full placement,
+    // symbols accepted by it are placed again at their new positions, and nothing else is tested. Symbols that
+    // may have become visible are picked up by full placement once camera moves farther or stops.
+    const auto incremental =
+        lastPlacementIsUpToDate &&
+        camera != _lastPlacementCamera &&
+        !renderer->isSymbolsUpdateSuspended() &&
+        computeCameraShiftInPixels(_lastFullPlacementCamera, camera) <= IncrementalPlacementMaxCameraShiftInPixels;
+    _lastPlacementValid = false;
+    _lastPlacementHasSymbolsWithoutGpuResources = false;
+
     ScreenQuadTree intersections;
-    if (!obtainRenderableSymbols(renderableSymbols, intersections, metric))
+    const auto ok = incremental
+        ? obtainRenderableSymbols(_lastAcceptedMapSymbolsByOrder, renderableSymbols, intersections, nullptr, metric)
+        : obtainRenderableSymbols(renderableSymbols, intersections, metric);
+    if (!ok)
     {
         // In case obtain failed due to lock, schedule another frame
         invalidateFrame();
@@ -59,6 +101,20 @@ void OsmAnd::AtlasMapRendererSymbolsStage::prepare(AtlasMapRenderer_Metrics::Met
 
         return;
     }
+    _lastPlacementValid = true;
+    _lastPlacementSymbolsRevision = symbolsRevision;
+    _lastPlacementIncremental = incremental;
+    _lastPlacementCamera = camera;
+    if (!incremental)
+        _lastFullPlacementCamera = camera;
+    if (incremental)
+    {
+        // Ensure that full placement follows once camera stops
+        invalidateFrame();
+
+        if (metric)
+            metric->incrementalSymbolsPlacements++;
+    }
 
     Stopwatch preparedSymbolsPublishingStopwatch(metric != nullptr);
     
@@ -86,6 +142,64 @@ void OsmAnd::AtlasMapRendererSymbolsStage::prepare(AtlasMapRenderer_Metrics::Met
         metric->elapsedTimeForPreparingSymbols = stopwatch.elapsed();
 }
 
+OsmAnd::AtlasMapRendererSymbolsStage::PlacementCamera OsmAnd::AtlasMapRendererSymbolsStage::capturePlacementCamera() const
+{
+    PlacementCamera camera;
+    camera.target31 = currentState.target31;
+    camera.zoomLevel = currentState.zoomLevel;
+    camera.scale = currentState.visualZoom * (1.0f + currentState.visualZoomShift);
+    camera.azimuth = currentState.azimuth;
+    camera.elevationAngle = currentState.elevationAngle;
+    return camera;
+}
+
+float OsmAnd::AtlasMapRendererSymbolsStage::computeCameraShiftInPixels(
+    const PlacementCamera& from,
+    const PlacementCamera& to) const
+{
+    // Other zoom level means other tiles, and thus other symbols
+    if (from.zoomLevel != to.zoomLevel)
+        return std::numeric_limits<float>::max();
+
+    // Shift of target, taking into account wrapping around 180th meridian
+    const auto& internalState = getInternalState();
+    const auto tileSizeOnScreenInPixels =
+        internalState.referenceTileSizeOnScreenInPixels * internalState.tileOnScreenScaleFactor;
+    const auto tileSize31 = static_cast<double>(1u << (MaxZoomLevel - to.zoomLevel));
+    auto dx = static_cast<int64_t>(to.target31.x) - static_cast<int64_t>(from.target31.x);
+    if (dx > INT32_MAX / 2)
+        dx -= static_cast<int64_t>(INT32_MAX) + 1;
+    else if (dx < -(INT32_MAX / 2))
+        dx += static_cast<int64_t>(INT32_MAX) + 1;
+    const auto dy = static_cast<int64_t>(to.target31.y) - static_cast<int64_t>(from.target31.y);
+    const auto targetShift = std::sqrt(static_cast<double>(dx * dx + dy * dy)) / tileSize31 * tileSizeOnScreenInPixels;
+
+    // Scale, rotation and tilt shift symbols in viewport corners the most
+    const auto viewportRadius =
+        0.5f * glm::length(glm::vec2(currentState.viewport.width(), currentState.viewport.height()));
+    const auto scaleShift = viewportRadius * qAbs(to.scale / from.scale - 1.0f);
+    const auto rotationShift = viewportRadius *
+        qDegreesToRadians(qAbs(static_cast<float>(Utilities::normalizedAngleDegrees(to.azimuth - from.azimuth))));
+    const auto tiltShift = viewportRadius * qDegreesToRadians(qAbs(to.elevationAngle - from.elevationAngle));
+
+    return static_cast<float>(targetShift) + scaleShift + rotationShift + tiltShift;
+}
+
+bool OsmAnd::AtlasMapRendererSymbolsStage::PlacementCamera::operator==(const PlacementCamera& that) const
+{
+    return
+        target31 == that.target31 &&
+        zoomLevel == that.zoomLevel &&
+        scale == that.scale &&
+        azimuth == that.azimuth &&
+        elevationAngle == that.elevationAngle;
+}
+
+bool OsmAnd::AtlasMapRendererSymbolsStage::PlacementCamera::operator!=(const PlacementCamera& that) const
+{
+    return !(*this == that);
+}
+
 void OsmAnd::AtlasMapRendererSymbolsStage::convertRenderableSymbolsToMapSymbolInformation(
     const QList< std::shared_ptr<const RenderableSymbol> >& input,
     QList<IMapRenderer::MapSymbolInformation>& output)
@@ -216,6 +330,10 @@ bool OsmAnd::AtlasMapRendererSymbolsStage::obtainRenderableSymbols(
 {
     Stopwatch stopwatch(metric != nullptr);
 
+    // Content identifiers only have to be consistent within single pass, so drop them once too many were collected
+    if (_contentIds.size() > MaxContentIdsCount)
+        _contentIds.clear();
+
     typedef QLinkedList< std::shared_ptr<const RenderableSymbol> > PlottedSymbols;
     PlottedSymbols plottedSymbols;
     
@@ -693,6 +811,8 @@ void OsmAnd::AtlasMapRendererSymbolsStage::obtainRenderablesFromSymbol(
 {
     Stopwatch stopwatch(metric != nullptr);
 
+    const auto firstRenderableIndex = outRenderableSymbols.size();
+
     if (const auto onPathMapSymbol = std::dynamic_pointer_cast<const OnPathRasterMapSymbol>(mapSymbol))
     {
         if (Q_UNLIKELY(debugSettings->excludeOnPathSymbolsFromProcessing))
@@ -744,6 +864,9 @@ void OsmAnd::AtlasMapRendererSymbolsStage::obtainRenderablesFromSymbol(
         assert(false);
     }
 
+    for (auto renderableIndex = firstRenderableIndex; renderableIndex < outRenderableSymbols.size(); renderableIndex++)
+        captureIntersectionClassesAndContentId(outRenderableSymbols[renderableIndex]);
+
     if (metric)
     {
         metric->elapsedTimeForObtainRenderableSymbolCalls += stopwatch.elapsed();
@@ -751,6 +874,31 @@ void OsmAnd::AtlasMapRendererSymbolsStage::obtainRenderablesFromSymbol(
     }
 }
 
+void OsmAnd::AtlasMapRendererSymbolsStage::captureIntersectionClassesAndContentId(
+    const std::shared_ptr<RenderableSymbol>& renderable) const
+{
+    const auto& mapSymbol = renderable->mapSymbol;
+
+    for (const auto& intersectionClass : constOf(mapSymbol->intersectsWithClasses))
+    {
+        if (intersectionClass >= 0 && intersectionClass < RenderableSymbol::IntersectionClassesMaskBits)
+            renderable->intersectionClassesMask |= (static_cast<RenderableSymbol::IntersectionClassesMask>(1) << intersectionClass);
+        else
+            renderable->hasUnmaskedIntersectionClasses = true;
+    }
+
+    if (const auto rasterMapSymbol = std::dynamic_pointer_cast<const RasterMapSymbol>(mapSymbol))
+    {
+        if (!rasterMapSymbol->content.isNull())
+        {
+            auto itContentId = _contentIds.find(rasterMapSymbol->content);
+            if (itContentId == _contentIds.end())
+                itContentId = _contentIds.insert(rasterMapSymbol->content, _contentIds.size());
+            renderable->contentId = *itContentId;
+        }
+    }
+}
+
 bool OsmAnd::AtlasMapRendererSymbolsStage::plotSymbol(
     const std::shared_ptr<RenderableSymbol>& renderable,
     ScreenQuadTree& intersections,
@@ -835,7 +983,10 @@ void OsmAnd::AtlasMapRendererSymbolsStage::obtainRenderablesFromBillboardSymbol(
     // Get GPU resource
     const auto gpuResource = captureGpuResource(referenceOrigins, mapSymbol);
     if (!gpuResource)
+    {
+        _lastPlacementHasSymbolsWithoutGpuResources = true;
         return;
+    }
 
     std::shared_ptr<RenderableBillboardSymbol> renderable(new RenderableBillboardSymbol());
     renderable->mapSymbolGroup = mapSymbolGroup;
@@ -994,7 +1145,10 @@ void OsmAnd::AtlasMapRendererSymbolsStage::obtainRenderablesFromOnSurfaceSymbol(
     // Get GPU resource
     const auto gpuResource = captureGpuResource(referenceOrigins, mapSymbol);
     if (!gpuResource)
+    {
+        _lastPlacementHasSymbolsWithoutGpuResources = true;
         return;
+    }
 
     if (const auto& gpuMeshResource = std::dynamic_pointer_cast<const GPUAPI::MeshInGPU>(gpuResource))
     {
@@ -1126,7 +1280,10 @@ void OsmAnd::AtlasMapRendererSymbolsStage::obtainRenderablesFromOnPathSymbol(
     // Get GPU resource for this map symbol, since it's useless to perform any calculations unless it's possible to draw it
     const auto gpuResource = std::dynamic_pointer_cast<const GPUAPI::TextureInGPU>(captureGpuResource(referenceOrigins, onPathMapSymbol));
     if (!gpuResource)
+    {
+        _lastPlacementHasSymbolsWithoutGpuResources = true;
         return;
+    }
 
     // Processing pin-point needs path in world and path on screen, as well as lengths of all segments. This may have already been computed
     auto itComputedPathData = computedPathsDataCache.find(onPathMapSymbol->shareablePath31);
@@ -1535,15 +1692,19 @@ bool OsmAnd::AtlasMapRendererSymbolsStage::applyIntersectionWithOtherSymbolsFilt
     const auto checkIntersectionsWithinGroup = renderable->mapSymbolGroup->intersectionProcessingMode.isSet(
         MapSymbolsGroup::IntersectionProcessingModeFlag::CheckIntersectionsWithinGroup);
     const auto& intersectionClassesRegistry = MapSymbolIntersectionClassesRegistry::globalInstance();
-    const auto& symbolIntersectsWithClasses = symbol->intersectsWithClasses;
+    const auto symbolIntersectsWithClasses = &symbol->intersectsWithClasses;
+    const auto symbolIntersectionClassesMask = renderable->intersectionClassesMask;
+    const auto symbolHasUnmaskedIntersectionClasses = renderable->hasUnmaskedIntersectionClasses;
     const auto anyIntersectionClass = intersectionClassesRegistry.anyClass;
-    const auto symbolIntersectsWithAnyClass = symbolIntersectsWithClasses.contains(intersectionClassesRegistry.anyClass);
+    assert(anyIntersectionClass < RenderableSymbol::IntersectionClassesMaskBits);
+    const auto anyIntersectionClassMask = static_cast<RenderableSymbol::IntersectionClassesMask>(1) << anyIntersectionClass;
+    const auto symbolIntersectsWithAnyClass = (symbolIntersectionClassesMask & anyIntersectionClassMask) != 0;
     const auto symbolGroupPtr = symbol->groupPtr;
     const auto symbolGroupInstancePtr = renderable->genericInstanceParameters
         ? renderable->genericInstanceParameters->groupInstancePtr
         : nullptr;
     const auto intersects = intersections.test(renderable->intersectionBBox, false,
-        [symbolGroupPtr, symbolIntersectsWithClasses, symbolIntersectsWithAnyClass, anyIntersectionClass, symbolGroupInstancePtr, checkIntersectionsWithinGroup]
+        [symbolGroupPtr, symbolIntersectsWithClasses, symbolIntersectionClassesMask, symbolHasUnmaskedIntersectionClasses, symbolIntersectsWithAnyClass, anyIntersectionClassMask, symbolGroupInstancePtr, checkIntersectionsWithinGroup]
         (const std::shared_ptr<const RenderableSymbol>& otherRenderable, const ScreenQuadTree::BBox& otherBBox) -> bool
         {
             const auto& otherSymbol = otherRenderable->mapSymbol;
@@ -1559,17 +1720,31 @@ bool OsmAnd::AtlasMapRendererSymbolsStage::applyIntersectionWithOtherSymbolsFilt
             }
 
             // Special case: tested symbol intersects any other symbol with at least 1 any class
-            if (symbolIntersectsWithAnyClass && !otherSymbol->intersectsWithClasses.isEmpty())
+            if (symbolIntersectsWithAnyClass &&
+                (otherRenderable->intersectionClassesMask != 0 || otherRenderable->hasUnmaskedIntersectionClasses))
+            {
                 return true;
+            }
 
             // Special case: other symbol intersects tested symbol with at least 1 any class (which is true already)
-            if (otherSymbol->intersectsWithClasses.contains(anyIntersectionClass))
+            if ((otherRenderable->intersectionClassesMask & anyIntersectionClassMask) != 0)
                 return true;
 
             // General case:
-            const auto commonIntersectionClasses = symbolIntersectsWithClasses & otherSymbol->intersectsWithClasses;
-            const auto hasCommonIntersectionClasses = !commonIntersectionClasses.isEmpty();
-            return hasCommonIntersectionClasses;
+            if ((symbolIntersectionClassesMask & otherRenderable->intersectionClassesMask) != 0)
+                return true;
+
+            // Rare case: classes that don't fit into mask can only be common if both symbols have such
+            if (symbolHasUnmaskedIntersectionClasses && otherRenderable->hasUnmaskedIntersectionClasses)
+            {
+                for (const auto& intersectionClass : constOf(*symbolIntersectsWithClasses))
+                {
+                    if (otherSymbol->intersectsWithClasses.contains(intersectionClass))
+                        return true;
+                }
+            }
+
+            return false;
         });
 
     if (metric)
@@ -1611,16 +1786,16 @@ bool OsmAnd::AtlasMapRendererSymbolsStage::applyMinDistanceToSameContentFromOthe
     const auto symbolGroupInstancePtr = renderable->genericInstanceParameters
         ? renderable->genericInstanceParameters->groupInstancePtr
         : nullptr;
-    const auto& symbolContent = symbol->content;
+    const auto symbolContentId = renderable->contentId;
     const auto hasSimilarContent = intersections.test(renderable->intersectionBBox.getEnlargedBy(symbol->minDistance), false,
-        [symbolContent, symbolGroupPtr, symbolGroupInstancePtr]
+        [symbolContentId, symbolGroupPtr, symbolGroupInstancePtr]
         (const std::shared_ptr<const RenderableSymbol>& otherRenderable, const ScreenQuadTree::BBox& otherBBox) -> bool
         {
-            const auto otherSymbol = std::dynamic_pointer_cast<const RasterMapSymbol>(otherRenderable->mapSymbol);
-            if (!otherSymbol)
+            // Only raster symbols have content identifier, so this also rejects all other symbols
+            if (otherRenderable->contentId != symbolContentId)
                 return false;
 
-            if (symbolGroupPtr == otherSymbol->groupPtr)
+            if (symbolGroupPtr == otherRenderable->mapSymbol->groupPtr)
             {
                 const auto otherSymbolGroupInstancePtr = otherRenderable->genericInstanceParameters
                     ? otherRenderable->genericInstanceParameters->groupInstancePtr
@@ -1629,8 +1804,7 @@ bool OsmAnd::AtlasMapRendererSymbolsStage::applyMinDistanceToSameContentFromOthe
                     return false;
             }
 
-            const auto shouldCheck = (otherSymbol->content == symbolContent);
-            return shouldCheck;
+            return true;
         });
 
     if (metric)
@@ -2485,6 +2659,14 @@ void OsmAnd::AtlasMapRendererSymbolsStage::addIntersectionDebugBox(
     }
 }
 
+OsmAnd::AtlasMapRendererSymbolsStage::RenderableSymbol::RenderableSymbol()
+    : distanceToCamera(0.0)
+    , intersectionClassesMask(0)
+    , hasUnmaskedIntersectionClasses(false)
+    , contentId(-1)
+{
+}
+
 OsmAnd::AtlasMapRendererSymbolsStage::RenderableSymbol::~RenderableSymbol()
 {
 }
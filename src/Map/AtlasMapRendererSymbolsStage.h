@@ -6,6 +6,7 @@
 #include "QtExtensions.h"
 #include "ignore_warnings_on_external_includes.h"
 #include <QReadWriteLock>
+#include <QHash>
 #include "restore_internal_warnings.h"
 
 #include "ignore_warnings_on_external_includes.h"
@@ -34,6 +35,13 @@ namespace OsmAnd
 
         struct RenderableSymbol
         {
+            // Intersection class with identifier N is represented by N-th bit, if it fits
+            typedef uint64_t IntersectionClassesMask;
+            enum {
+                IntersectionClassesMaskBits = sizeof(IntersectionClassesMask) * 8,
+            };
+
+            RenderableSymbol();
             virtual ~RenderableSymbol();
 
             std::shared_ptr<const MapSymbolsGroup> mapSymbolGroup;
@@ -44,6 +52,13 @@ namespace OsmAnd
             double distanceToCamera;
             ScreenQuadTree::BBox visibleBBox;
             ScreenQuadTree::BBox intersectionBBox;
+
+            // Intersection classes of map symbol. Classes that don't fit into mask are checked using map symbol
+            IntersectionClassesMask intersectionClassesMask;
+            bool hasUnmaskedIntersectionClasses;
+
+            // Identifier of raster map symbol content, that is same for same content, or -1
+            int contentId;
         };
 
         struct RenderableBillboardSymbol : RenderableSymbol
@@ -120,6 +135,38 @@ namespace OsmAnd
             AtlasMapRenderer_Metrics::Metric_renderFrame* const metric) const;
         mutable MapRenderer::PublishedMapSymbolsByOrder _lastAcceptedMapSymbolsByOrder;
 
+        // Placement of symbols is reused while renderer reports no changes of symbols or state. While only camera
+        // moves by small distance from camera of last full placement, only symbols accepted by that placement are
+        // placed again (incremental placement).
+        struct PlacementCamera
+        {
+            PointI target31;
+            ZoomLevel zoomLevel;
+            float scale;
+            float azimuth;
+            float elevationAngle;
+
+            bool operator==(const PlacementCamera& that) const;
+            bool operator!=(const PlacementCamera& that) const;
+        };
+        enum {
+            IncrementalPlacementMaxCameraShiftInPixels = 48,
+        };
+        mutable bool _lastPlacementHasSymbolsWithoutGpuResources;
+        unsigned int _lastPlacementSymbolsRevision;
+        bool _lastPlacementValid;
+        bool _lastPlacementIncremental;
+        PlacementCamera _lastPlacementCamera;
+        PlacementCamera _lastFullPlacementCamera;
+        PlacementCamera capturePlacementCamera() const;
+        float computeCameraShiftInPixels(const PlacementCamera& from, const PlacementCamera& to) const;
+
+        // Content identifiers of raster map symbols
+        enum {
+            MaxContentIdsCount = 16384,
+        };
+        mutable QHash<QString, int> _contentIds;
+
         mutable QReadWriteLock _lastPreparedIntersectionsLock;
         ScreenQuadTree _lastPreparedIntersections;
 
@@ -145,6 +192,9 @@ namespace OsmAnd
             QList< std::shared_ptr<RenderableSymbol> >& outRenderableSymbols,
             AtlasMapRenderer_Metrics::Metric_renderFrame* const metric) const;
 
+        void captureIntersectionClassesAndContentId(
+            const std::shared_ptr<RenderableSymbol>& renderable) const;
+
         bool plotSymbol(
             const std::shared_ptr<RenderableSymbol>& renderable,
             ScreenQuadTree& intersections,
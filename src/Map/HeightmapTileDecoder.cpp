@@ -0,0 +1,549 @@
+#include "HeightmapTileDecoder.h"
+
+#include "QtExtensions.h"
+#include <QVector>
+
+#include "ignore_warnings_on_external_includes.h"
+#define ZLIB_CONST
+#include <zlib.h>
+#include <gdal.h>
+#include <gdal_priv.h>
+#include <cpl_vsi.h>
+#include "restore_internal_warnings.h"
+
+#include "Logging.h"
+
+namespace
+{
+    enum : uint16_t
+    {
+        TiffTagImageWidth = 256,
+        TiffTagImageLength = 257,
+        TiffTagBitsPerSample = 258,
+        TiffTagCompression = 259,
+        TiffTagStripOffsets = 273,
+        TiffTagSamplesPerPixel = 277,
+        TiffTagRowsPerStrip = 278,
+        TiffTagStripByteCounts = 279,
+        TiffTagPlanarConfiguration = 284,
+        TiffTagPredictor = 317,
+        TiffTagColorMap = 320,
+        TiffTagTileWidth = 322,
+        TiffTagTileLength = 323,
+        TiffTagTileOffsets = 324,
+        TiffTagTileByteCounts = 325,
+        TiffTagSampleFormat = 339,
+    };
+
+    enum : uint32_t
+    {
+        TiffCompressionNone = 1,
+        TiffCompressionLzw = 5,
+        TiffCompressionAdobeDeflate = 8,
+        TiffCompressionDeflate = 32946,
+    };
+
+    enum : uint32_t
+    {
+        TiffPredictorNone = 1,
+        TiffPredictorHorizontal = 2,
+    };
+
+    enum : uint32_t
+    {
+        TiffSampleFormatSignedInteger = 2,
+    };
+
+    inline uint16_t readUInt16(const uint8_t* const p, const bool isBigEndian)
+    {
+        return isBigEndian
+            ? static_cast<uint16_t>((p[0] << 8) | p[1])
+            : static_cast<uint16_t>(p[0] | (p[1] << 8));
+    }
+
+    inline uint32_t readUInt32(const uint8_t* const p, const bool isBigEndian)
+    {
+        return isBigEndian
+            ? (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) | (static_cast<uint32_t>(p[2]) << 8) | p[3]
+            : (static_cast<uint32_t>(p[3]) << 24) | (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[1]) << 8) | p[0];
+    }
+
+    inline bool isTiff(const QByteArray& data)
+    {
+        return data.size() >= 4 && (
+            (data[0] == 'I' && data[1] == 'I' && data[2] == 42 && data[3] == 0) ||
+            (data[0] == 'M' && data[1] == 'M' && data[2] == 0 && data[3] == 42));
+    }
+
+    // Reads values of SHORT or LONG entry of image file directory. Values that fit into 4 bytes are
+    // stored in entry itself, others are referenced by offset.
+    bool readTiffEntryValues(
+        const uint8_t* const data,
+        const size_t dataSize,
+        const bool isBigEndian,
+        const uint8_t* const entry,
+        QVector<uint32_t>& outValues)
+    {
+        const auto type = readUInt16(entry + 2, isBigEndian);
+        const auto count = readUInt32(entry + 4, isBigEndian);
+
+        size_t valueSize;
+        if (type == 3)
+            valueSize = 2;
+        else if (type == 4)
+            valueSize = 4;
+        else
+            return false;
+        if (count == 0 || count > dataSize / valueSize)
+            return false;
+
+        auto pValues = entry + 8;
+        if (count * valueSize > 4)
+        {
+            const auto offset = readUInt32(entry + 8, isBigEndian);
+            if (offset > dataSize || count * valueSize > dataSize - offset)
+                return false;
+            pValues = data + offset;
+        }
+
+        outValues.resize(count);
+        for (auto valueIdx = 0u; valueIdx < count; valueIdx++)
+        {
+            outValues[valueIdx] = (valueSize == 2)
+                ? readUInt16(pValues + valueIdx * 2, isBigEndian)
+                : readUInt32(pValues + valueIdx * 4, isBigEndian);
+        }
+
+        return true;
+    }
+
+    bool decompressDeflate(
+        const uint8_t* const input,
+        const size_t inputSize,
+        uint8_t* const output,
+        const size_t outputSize)
+    {
+        z_stream stream;
+        memset(&stream, 0, sizeof(z_stream));
+        stream.next_in = input;
+        stream.avail_in = static_cast<uInt>(inputSize);
+        stream.next_out = output;
+        stream.avail_out = static_cast<uInt>(outputSize);
+        if (inflateInit(&stream) != Z_OK)
+            return false;
+
+        const auto result = inflate(&stream, Z_FINISH);
+        inflateEnd(&stream);
+
+        // Some writers store complete last strip, so data may be larger than needed
+        return stream.avail_out == 0 && (result == Z_STREAM_END || result == Z_OK || result == Z_BUF_ERROR);
+    }
+
+    // TIFF variant of LZW: codes are written starting from most significant bit, and code width is
+    // increased one code earlier than table actually requires
+    bool decompressLzw(
+        const uint8_t* const input,
+        const size_t inputSize,
+        uint8_t* const output,
+        const size_t outputSize)
+    {
+        enum {
+            ClearCode = 256,
+            EndOfInformationCode = 257,
+            FirstFreeCode = 258,
+            MinCodeWidth = 9,
+            MaxCodeWidth = 12,
+            MaxCodesCount = 1 << MaxCodeWidth,
+        };
+
+        // Old-style LZW uses reversed bit order, and starts with clear code written that way
+        if (inputSize >= 2 && input[0] == 0 && (input[1] & 0x01))
+            return false;
+
+        uint16_t prefixes[MaxCodesCount];
+        uint8_t suffixes[MaxCodesCount];
+        uint8_t firstBytes[MaxCodesCount];
+        uint16_t lengths[MaxCodesCount];
+        for (auto code = 0; code < 256; code++)
+        {
+            prefixes[code] = 0;
+            suffixes[code] = static_cast<uint8_t>(code);
+            firstBytes[code] = static_cast<uint8_t>(code);
+            lengths[code] = 1;
+        }
+
+        size_t inputOffset = 0;
+        size_t outputOffset = 0;
+        uint32_t bitBuffer = 0;
+        int bitsCount = 0;
+        int codeWidth = MinCodeWidth;
+        int nextCode = FirstFreeCode;
+        int oldCode = -1;
+        while (outputOffset < outputSize)
+        {
+            while (bitsCount < codeWidth)
+            {
+                if (inputOffset >= inputSize)
+                    return false;
+                bitBuffer = (bitBuffer << 8) | input[inputOffset++];
+                bitsCount += 8;
+            }
+            const auto code = static_cast<int>((bitBuffer >> (bitsCount - codeWidth)) & ((1u << codeWidth) - 1));
+            bitsCount -= codeWidth;
+
+            if (code == EndOfInformationCode)
+                break;
+            if (code == ClearCode)
+            {
+                codeWidth = MinCodeWidth;
+                nextCode = FirstFreeCode;
+                oldCode = -1;
+                continue;
+            }
+
+            if (oldCode < 0)
+            {
+                if (code > 255)
+                    return false;
+                output[outputOffset++] = static_cast<uint8_t>(code);
+                oldCode = code;
+                continue;
+            }
+
+            // Code that is not yet in table may only be the one that is going to be added now
+            if (code > nextCode || (code == nextCode && nextCode >= MaxCodesCount))
+                return false;
+            if (nextCode < MaxCodesCount)
+            {
+                prefixes[nextCode] = static_cast<uint16_t>(oldCode);
+                suffixes[nextCode] = (code == nextCode) ? firstBytes[oldCode] : firstBytes[code];
+                firstBytes[nextCode] = firstBytes[oldCode];
+                lengths[nextCode] = lengths[oldCode] + 1;
+                nextCode++;
+            }
+
+            const auto length = lengths[code];
+            if (length > outputSize - outputOffset)
+                return false;
+            auto stringCode = code;
+            for (auto byteIdx = length; byteIdx > 0; byteIdx--)
+            {
+                output[outputOffset + byteIdx - 1] = suffixes[stringCode];
+                stringCode = prefixes[stringCode];
+            }
+            outputOffset += length;
+            oldCode = code;
+
+            if (nextCode >= (1 << codeWidth) - 1 && codeWidth < MaxCodeWidth)
+                codeWidth++;
+        }
+
+        return outputOffset == outputSize;
+    }
+}
+
+OsmAnd::HeightmapTileDecoder::HeightmapTileDecoder()
+{
+}
+
+OsmAnd::HeightmapTileDecoder::~HeightmapTileDecoder()
+{
+}
+
+bool OsmAnd::HeightmapTileDecoder::decode(const QByteArray& data, const uint32_t tileSize, float* const outHeights)
+{
+    if (isTiff(data))
+    {
+        if (decodeGeoTiff(data, tileSize, outHeights))
+            return true;
+    }
+    else if (decodeRaw(data, tileSize, outHeights))
+        return true;
+
+    return decodeUsingGDAL(data, tileSize, outHeights);
+}
+
+bool OsmAnd::HeightmapTileDecoder::decodeGeoTiff(const QByteArray& data, const uint32_t tileSize, float* const outHeights)
+{
+    if (!isTiff(data) || data.size() < 8)
+        return false;
+
+    const auto pData = reinterpret_cast<const uint8_t*>(data.constData());
+    const auto dataSize = static_cast<size_t>(data.size());
+    const auto isBigEndian = (pData[0] == 'M');
+
+    // Only first image is used, same as GDAL does
+    const auto ifdOffset = readUInt32(pData + 4, isBigEndian);
+    if (ifdOffset > dataSize - 2)
+        return false;
+    const auto entriesCount = readUInt16(pData + ifdOffset, isBigEndian);
+    if (entriesCount * 12u > dataSize - ifdOffset - 2)
+        return false;
+
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t bitsPerSample = 1;
+    uint32_t compression = TiffCompressionNone;
+    uint32_t samplesPerPixel = 1;
+    uint32_t rowsPerStrip = std::numeric_limits<uint32_t>::max();
+    uint32_t predictor = TiffPredictorNone;
+    uint32_t sampleFormat = 1;
+    uint32_t tileWidth = 0;
+    uint32_t tileLength = 0;
+    QVector<uint32_t> blockOffsets;
+    QVector<uint32_t> blockByteCounts;
+    QVector<uint32_t> values;
+    for (auto entryIdx = 0u; entryIdx < entriesCount; entryIdx++)
+    {
+        const auto entry = pData + ifdOffset + 2 + entryIdx * 12;
+        const auto tag = readUInt16(entry, isBigEndian);
+        switch (tag)
+        {
+            case TiffTagImageWidth:
+            case TiffTagImageLength:
+            case TiffTagBitsPerSample:
+            case TiffTagCompression:
+            case TiffTagStripOffsets:
+            case TiffTagSamplesPerPixel:
+            case TiffTagRowsPerStrip:
+            case TiffTagStripByteCounts:
+            case TiffTagPlanarConfiguration:
+            case TiffTagPredictor:
+            case TiffTagTileWidth:
+            case TiffTagTileLength:
+            case TiffTagTileOffsets:
+            case TiffTagTileByteCounts:
+            case TiffTagSampleFormat:
+                break;
+
+            // Heights in palette make no sense
+            case TiffTagColorMap:
+                return false;
+
+            // GeoTIFF georeferencing and other tags are not needed to read heights
+            default:
+                continue;
+        }
+
+        if (!readTiffEntryValues(pData, dataSize, isBigEndian, entry, values))
+            return false;
+        switch (tag)
+        {
+            case TiffTagImageWidth:
+                width = values[0];
+                break;
+            case TiffTagImageLength:
+                height = values[0];
+                break;
+            case TiffTagBitsPerSample:
+                bitsPerSample = values[0];
+                break;
+            case TiffTagCompression:
+                compression = values[0];
+                break;
+            case TiffTagSamplesPerPixel:
+                samplesPerPixel = values[0];
+                break;
+            case TiffTagRowsPerStrip:
+                rowsPerStrip = values[0];
+                break;
+            case TiffTagPredictor:
+                predictor = values[0];
+                break;
+            case TiffTagTileWidth:
+                tileWidth = values[0];
+                break;
+            case TiffTagTileLength:
+                tileLength = values[0];
+                break;
+            case TiffTagSampleFormat:
+                sampleFormat = values[0];
+                break;
+            case TiffTagStripOffsets:
+            case TiffTagTileOffsets:
+                blockOffsets = values;
+                break;
+            case TiffTagStripByteCounts:
+            case TiffTagTileByteCounts:
+                blockByteCounts = values;
+                break;
+            default:
+                break;
+        }
+    }
+
+    if (width != tileSize ||
+        height != tileSize ||
+        samplesPerPixel != 1 ||
+        bitsPerSample != 16 ||
+        sampleFormat != TiffSampleFormatSignedInteger)
+    {
+        return false;
+    }
+    if (predictor != TiffPredictorNone && predictor != TiffPredictorHorizontal)
+        return false;
+    if (compression != TiffCompressionNone &&
+        compression != TiffCompressionLzw &&
+        compression != TiffCompressionAdobeDeflate &&
+        compression != TiffCompressionDeflate)
+    {
+        return false;
+    }
+
+    // Image is split either into strips of full width, or into tiles that may extend past image edges
+    const auto isTiled = (tileWidth > 0 || tileLength > 0);
+    const auto blockWidth = isTiled ? tileWidth : width;
+    const auto blockHeight = isTiled ? tileLength : qMin(rowsPerStrip, height);
+    if (blockWidth == 0 || blockHeight == 0 || blockWidth > 4 * width || blockHeight > 4 * height)
+        return false;
+    const auto blocksAcross = (width + blockWidth - 1) / blockWidth;
+    const auto blocksDown = (height + blockHeight - 1) / blockHeight;
+    const auto blocksCount = static_cast<int>(blocksAcross * blocksDown);
+    if (blockOffsets.size() != blocksCount || blockByteCounts.size() != blocksCount)
+        return false;
+
+    QByteArray blockBuffer;
+    for (auto blockIdx = 0; blockIdx < blocksCount; blockIdx++)
+    {
+        const auto blockOffset = blockOffsets[blockIdx];
+        const auto blockByteCount = blockByteCounts[blockIdx];
+        if (blockOffset > dataSize || blockByteCount > dataSize - blockOffset)
+            return false;
+
+        const auto blockLeft = (blockIdx % blocksAcross) * blockWidth;
+        const auto blockTop = (blockIdx / blocksAcross) * blockHeight;
+        const auto blockRows = isTiled ? blockHeight : qMin(blockHeight, height - blockTop);
+        const auto blockSize = static_cast<size_t>(blockWidth) * blockRows * 2;
+
+        const uint8_t* pBlock;
+        if (compression == TiffCompressionNone)
+        {
+            if (blockByteCount < blockSize)
+                return false;
+            pBlock = pData + blockOffset;
+        }
+        else
+        {
+            blockBuffer.resize(static_cast<int>(blockSize));
+            const auto pBlockBuffer = reinterpret_cast<uint8_t*>(blockBuffer.data());
+            const auto decompressed = (compression == TiffCompressionLzw)
+                ? decompressLzw(pData + blockOffset, blockByteCount, pBlockBuffer, blockSize)
+                : decompressDeflate(pData + blockOffset, blockByteCount, pBlockBuffer, blockSize);
+            if (!decompressed)
+                return false;
+            pBlock = pBlockBuffer;
+        }
+
+        const auto rows = qMin(blockRows, height - blockTop);
+        const auto columns = qMin(blockWidth, width - blockLeft);
+        for (auto row = 0u; row < rows; row++)
+        {
+            const auto pRow = pBlock + row * blockWidth * 2;
+            const auto pOutRow = outHeights + (blockTop + row) * width + blockLeft;
+
+            // Horizontal predictor stores each sample as difference with previous one in row
+            uint16_t accumulator = 0;
+            for (auto column = 0u; column < columns; column++)
+            {
+                auto sample = readUInt16(pRow + column * 2, isBigEndian);
+                if (predictor == TiffPredictorHorizontal)
+                {
+                    accumulator = static_cast<uint16_t>(accumulator + sample);
+                    sample = accumulator;
+                }
+                pOutRow[column] = static_cast<int16_t>(sample);
+            }
+        }
+    }
+
+    return true;
+}
+
+bool OsmAnd::HeightmapTileDecoder::decodeRaw(const QByteArray& data, const uint32_t tileSize, float* const outHeights)
+{
+    const auto samplesCount = tileSize * tileSize;
+    if (static_cast<size_t>(data.size()) != samplesCount * 2)
+        return false;
+
+    const auto pData = reinterpret_cast<const uint8_t*>(data.constData());
+    for (auto sampleIdx = 0u; sampleIdx < samplesCount; sampleIdx++)
+        outHeights[sampleIdx] = static_cast<int16_t>(readUInt16(pData + sampleIdx * 2, false));
+
+    return true;
+}
+
+bool OsmAnd::HeightmapTileDecoder::decodeUsingGDAL(const QByteArray& data, const uint32_t tileSize, float* const outHeights)
+{
+    bool success = false;
+    QString vmemFilename;
+    vmemFilename.sprintf("/vsimem/heightmapTile@%p", data.constData());
+    VSIFileFromMemBuffer(
+        qPrintable(vmemFilename),
+        reinterpret_cast<GByte*>(const_cast<char*>(data.constData())),
+        data.length(),
+        FALSE);
+    auto dataset = reinterpret_cast<GDALDataset*>(GDALOpen(qPrintable(vmemFilename), GA_ReadOnly));
+    if (dataset != nullptr)
+    {
+        if (dataset->GetRasterCount() != 1)
+        {
+            LogPrintf(LogSeverityLevel::Error,
+                "Height tile has %d bands instead of 1",
+                dataset->GetRasterCount());
+        }
+        else if (dataset->GetRasterXSize() != tileSize || dataset->GetRasterYSize() != tileSize)
+        {
+            LogPrintf(LogSeverityLevel::Error,
+                "Height tile has %dx%d size instead of %d",
+                dataset->GetRasterXSize(),
+                dataset->GetRasterYSize(),
+                tileSize);
+        }
+        else
+        {
+            auto band = dataset->GetRasterBand(1);
+            if (band->GetColorTable() != nullptr)
+            {
+                LogPrintf(LogSeverityLevel::Error,
+                    "Height tile has color table");
+            }
+            else if (band->GetRasterDataType() != GDT_Int16)
+            {
+                LogPrintf(LogSeverityLevel::Error,
+                    "Height tile has %s data type in band 1",
+                    GDALGetDataTypeName(band->GetRasterDataType()));
+            }
+            else
+            {
+                const auto res = dataset->RasterIO(
+                    GF_Read,
+                    0,
+                    0,
+                    tileSize,
+                    tileSize,
+                    outHeights,
+                    tileSize,
+                    tileSize,
+                    GDT_Float32,
+                    1,
+                    nullptr,
+                    0,
+                    0,
+                    0);
+                if (res != CE_None)
+                {
+                    LogPrintf(LogSeverityLevel::Error,
+                        "Failed to decode height tile: %s",
+                        CPLGetLastErrorMsg());
+                }
+                else
+                    success = true;
+            }
+        }
+
+        GDALClose(dataset);
+    }
+    VSIUnlink(qPrintable(vmemFilename));
+
+    return success;
+}
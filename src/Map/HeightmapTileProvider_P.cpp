@@ -3,12 +3,7 @@
 
 #include <cassert>
 
-#include "ignore_warnings_on_external_includes.h"
-#include <gdal.h>
-#include <gdal_priv.h>
-#include <cpl_vsi.h>
-#include "restore_internal_warnings.h"
-
+#include "HeightmapTileDecoder.h"
 #include "Logging.h"
 #include "MapDataProviderHelpers.h"
 
@@ -65,113 +60,25 @@ bool OsmAnd::HeightmapTileProvider_P::obtainData(
         return true;
     }
 
-    // We have the data, use GDAL to decode this GeoTIFF
+    // Common tile formats are decoded directly, since opening GDAL dataset costs much more than decoding
     const auto tileSize = getTileSize();
-    bool success = false;
-    QString vmemFilename;
-    vmemFilename.sprintf("/vsimem/heightmapTile@%p", data.data());
-    VSIFileFromMemBuffer(qPrintable(vmemFilename), reinterpret_cast<GByte*>(data.data()), data.length(), FALSE);
-    auto dataset = reinterpret_cast<GDALDataset*>(GDALOpen(qPrintable(vmemFilename), GA_ReadOnly));
-    if (dataset != nullptr)
+    const auto buffer = new float[tileSize*tileSize];
+    if (!HeightmapTileDecoder::decode(data, tileSize, buffer))
     {
-        bool bad = false;
-        bad = bad || dataset->GetRasterCount() != 1;
-        bad = bad || dataset->GetRasterXSize() != tileSize;
-        bad = bad || dataset->GetRasterYSize() != tileSize;
-        if (bad)
-        {
-            if (dataset->GetRasterCount() != 1)
-            {
-                LogPrintf(LogSeverityLevel::Error,
-                    "Height tile %dx%d@%d has %d bands instead of 1",
-                    request.tileId.x,
-                    request.tileId.y,
-                    request.zoom,
-                    dataset->GetRasterCount());
-            }
-            if (dataset->GetRasterXSize() != tileSize || dataset->GetRasterYSize() != tileSize)
-            {
-                LogPrintf(LogSeverityLevel::Error,
-                    "Height tile %dx%d@%d has %dx%x size instead of %d",
-                    request.tileId.x,
-                    request.tileId.y,
-                    request.zoom,
-                    dataset->GetRasterXSize(),
-                    dataset->GetRasterYSize(),
-                    tileSize);
-            }
-        }
-        else
-        {
-            auto band = dataset->GetRasterBand(1);
-
-            bad = bad || band->GetColorTable() != nullptr;
-            bad = bad || band->GetRasterDataType() != GDT_Int16;
-
-            if (bad)
-            {
-                if (band->GetColorTable() != nullptr)
-                {
-                    LogPrintf(LogSeverityLevel::Error,
-                        "Height tile %dx%d@%d has color table",
-                        request.tileId.x,
-                        request.tileId.y,
-                        request.zoom);
-                }
-                if (band->GetRasterDataType() != GDT_Int16)
-                {
-                    LogPrintf(LogSeverityLevel::Error,
-                        "Height tile %dx%d@%d has %s data type in band 1",
-                        request.tileId.x,
-                        request.tileId.y,
-                        request.zoom,
-                        GDALGetDataTypeName(band->GetRasterDataType()));
-                }
-            }
-            else
-            {
-                const auto buffer = new float[tileSize*tileSize];
-                const auto res = dataset->RasterIO(
-                    GF_Read,
-                    0,
-                    0,
-                    tileSize,
-                    tileSize,
-                    buffer,
-                    tileSize,
-                    tileSize,
-                    GDT_Float32,
-                    1,
-                    nullptr,
-                    0,
-                    0,
-                    0);
-                if (res != CE_None)
-                {
-                    delete[] buffer;
-                    LogPrintf(LogSeverityLevel::Error,
-                        "Failed to decode height tile %dx%d@%d: %s",
-                        request.tileId.x,
-                        request.tileId.y,
-                        request.zoom,
-                        CPLGetLastErrorMsg());
-                }
-                else
-                {
-                    outData.reset(new IMapElevationDataProvider::Data(
-                        request.tileId,
-                        request.zoom,
-                        tileSize,
-                        sizeof(float)*tileSize,
-                        buffer));
-                    success = true;
-                }
-            }
-        }
-
-        GDALClose(dataset);
+        delete[] buffer;
+        LogPrintf(LogSeverityLevel::Error,
+            "Failed to decode height tile %dx%d@%d",
+            request.tileId.x,
+            request.tileId.y,
+            request.zoom);
+        return false;
     }
-    VSIUnlink(qPrintable(vmemFilename));
 
-    return success;
+    outData.reset(new IMapElevationDataProvider::Data(
+        request.tileId,
+        request.zoom,
+        sizeof(float)*tileSize,
+        tileSize,
+        buffer));
+    return true;
 }
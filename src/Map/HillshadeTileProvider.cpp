@@ -0,0 +1,223 @@
+#include "HillshadeTileProvider.h"
+#include "HillshadeTileProvider_P.h"
+
+#include "QtExtensions.h"
+#include <QtMath>
+
+#include "MapDataProviderHelpers.h"
+
+OsmAnd::HillshadeTileProvider::HillshadeTileProvider(
+    const std::shared_ptr<IMapElevationDataProvider>& elevationDataProvider_,
+    const Mode mode_ /*= Mode::Hillshade*/,
+    const float sunAzimuth_ /*= 315.0f*/,
+    const float sunAltitude_ /*= 45.0f*/,
+    const float zFactor_ /*= 1.0f*/,
+    const uint32_t tileSize_ /*= 256*/,
+    const float densityFactor_ /*= 1.0f*/)
+    : _p(new HillshadeTileProvider_P(this))
+    , elevationDataProvider(elevationDataProvider_)
+    , mode(mode_)
+    , sunAzimuth(sunAzimuth_)
+    , sunAltitude(sunAltitude_)
+    , zFactor(zFactor_)
+    , tileSize(tileSize_)
+    , densityFactor(densityFactor_)
+{
+}
+
+OsmAnd::HillshadeTileProvider::~HillshadeTileProvider()
+{
+}
+
+OsmAnd::MapStubStyle OsmAnd::HillshadeTileProvider::getDesiredStubsStyle() const
+{
+    return MapStubStyle::Unspecified;
+}
+
+float OsmAnd::HillshadeTileProvider::getTileDensityFactor() const
+{
+    return densityFactor;
+}
+
+uint32_t OsmAnd::HillshadeTileProvider::getTileSize() const
+{
+    return tileSize;
+}
+
+bool OsmAnd::HillshadeTileProvider::supportsNaturalObtainData() const
+{
+    return true;
+}
+
+bool OsmAnd::HillshadeTileProvider::obtainData(
+    const IMapDataProvider::Request& request,
+    std::shared_ptr<IMapDataProvider::Data>& outData,
+    std::shared_ptr<Metric>* const pOutMetric /*= nullptr*/)
+{
+    return _p->obtainData(request, outData, pOutMetric);
+}
+
+bool OsmAnd::HillshadeTileProvider::supportsNaturalObtainDataAsync() const
+{
+    return false;
+}
+
+void OsmAnd::HillshadeTileProvider::obtainDataAsync(
+    const IMapDataProvider::Request& request,
+    const IMapDataProvider::ObtainDataAsyncCallback callback,
+    const bool collectMetric /*= false*/)
+{
+    MapDataProviderHelpers::nonNaturalObtainDataAsync(this, request, callback, collectMetric);
+}
+
+OsmAnd::ZoomLevel OsmAnd::HillshadeTileProvider::getMinZoom() const
+{
+    return elevationDataProvider->getMinZoom();
+}
+
+OsmAnd::ZoomLevel OsmAnd::HillshadeTileProvider::getMaxZoom() const
+{
+    return elevationDataProvider->getMaxZoom();
+}
+
+OsmAnd::HillshadeTileProvider::TilesCacheStatistics OsmAnd::HillshadeTileProvider::getTilesCacheStatistics() const
+{
+    return _p->getTilesCacheStatistics();
+}
+
+void OsmAnd::HillshadeTileProvider::setTilesCacheSizeLimit(const unsigned int sizeLimitInBytes)
+{
+    _p->setTilesCacheSizeLimit(sizeLimitInBytes);
+}
+
+void OsmAnd::HillshadeTileProvider::clearTilesCache()
+{
+    _p->clearTilesCache();
+}
+
+bool OsmAnd::HillshadeTileProvider::obtainPaddedElevationHeights(
+    const TileId tileId,
+    const ZoomLevel zoom,
+    QVector<float>& outHeights,
+    uint32_t& outSize,
+    const std::shared_ptr<const IQueryController>& queryController /*= nullptr*/)
+{
+    return _p->obtainPaddedElevationHeights(tileId, zoom, outHeights, outSize, queryController);
+}
+
+void OsmAnd::HillshadeTileProvider::computeShading(
+    const float* const paddedHeights,
+    const unsigned int size,
+    const float cellSize,
+    const Mode mode,
+    const float sunAzimuth,
+    const float sunAltitude,
+    const float zFactor,
+    uint8_t* const outValues)
+{
+    // Gradients are computed for whole row first, and then converted to values
+    const auto stride = size + 2;
+    const auto gradientScale = zFactor / (8.0f * cellSize);
+    const auto azimuth = qDegreesToRadians(sunAzimuth);
+    const auto altitude = qDegreesToRadians(sunAltitude);
+    const auto sinAltitude = qSin(altitude);
+    const auto eastLight = qSin(azimuth) * qCos(altitude);
+    const auto northLight = qCos(azimuth) * qCos(altitude);
+    const auto pi = static_cast<float>(M_PI);
+
+    std::vector<float> eastGradients(size);
+    std::vector<float> northGradients(size);
+    const auto pEastGradients = eastGradients.data();
+    const auto pNorthGradients = northGradients.data();
+    for (auto y = 0u; y < size; y++)
+    {
+        const auto pTop = paddedHeights + y * stride;
+        const auto pMiddle = pTop + stride;
+        const auto pBottom = pMiddle + stride;
+        for (auto x = 0u; x < size; x++)
+        {
+            pEastGradients[x] = gradientScale * (
+                (pTop[x + 2] + 2.0f * pMiddle[x + 2] + pBottom[x + 2]) -
+                (pTop[x] + 2.0f * pMiddle[x] + pBottom[x]));
+            pNorthGradients[x] = gradientScale * (
+                (pTop[x] + 2.0f * pTop[x + 1] + pTop[x + 2]) -
+                (pBottom[x] + 2.0f * pBottom[x + 1] + pBottom[x + 2]));
+        }
+
+        const auto pOutValues = outValues + y * size;
+        switch (mode)
+        {
+            case Mode::Hillshade:
+                for (auto x = 0u; x < size; x++)
+                {
+                    const auto east = pEastGradients[x];
+                    const auto north = pNorthGradients[x];
+                    const auto shade = (sinAltitude - east * eastLight - north * northLight) /
+                        std::sqrt(1.0f + east * east + north * north);
+                    pOutValues[x] = static_cast<uint8_t>(qBound(0.0f, shade * 255.0f + 0.5f, 255.0f));
+                }
+                break;
+
+            case Mode::Slope:
+                for (auto x = 0u; x < size; x++)
+                {
+                    const auto east = pEastGradients[x];
+                    const auto north = pNorthGradients[x];
+                    const auto slope = std::atan(std::sqrt(east * east + north * north));
+                    pOutValues[x] = static_cast<uint8_t>(slope * (255.0f / (0.5f * pi)) + 0.5f);
+                }
+                break;
+
+            case Mode::Aspect:
+                for (auto x = 0u; x < size; x++)
+                {
+                    // Flat samples have no downslope direction, they get 0
+                    const auto east = pEastGradients[x];
+                    const auto north = pNorthGradients[x];
+                    const auto isFlat = (east == 0.0f && north == 0.0f);
+                    auto aspect = isFlat ? 0.0f : std::atan2(-east, -north);
+                    aspect += (aspect < 0.0f) ? 2.0f * pi : 0.0f;
+                    pOutValues[x] = static_cast<uint8_t>(qMin(aspect * (255.0f / (2.0f * pi)) + 0.5f, 255.0f));
+                }
+                break;
+        }
+    }
+}
+
+void OsmAnd::HillshadeTileProvider::resampleHeights(
+    const float* const paddedHeights,
+    const uint32_t size,
+    const uint32_t resampledSize,
+    float* const outPaddedHeights)
+{
+    // Bilinear resampling, where samples are in centers of their cells. Padding samples of output are
+    // resampled from padding of input too, so that edges of output tiles match.
+    const auto paddedSize = size + 2;
+    const auto resampledPaddedSize = resampledSize + 2;
+    const auto scale = static_cast<float>(size) / resampledSize;
+
+    std::vector<uint32_t> indices(resampledPaddedSize);
+    std::vector<float> weights(resampledPaddedSize);
+    for (auto idx = 0u; idx < resampledPaddedSize; idx++)
+    {
+        const auto position = qBound(0.0f, (idx - 0.5f) * scale + 0.5f, static_cast<float>(size + 1));
+        indices[idx] = qMin(static_cast<uint32_t>(position), size);
+        weights[idx] = position - indices[idx];
+    }
+
+    for (auto y = 0u; y < resampledPaddedSize; y++)
+    {
+        const auto pTop = paddedHeights + indices[y] * paddedSize;
+        const auto pBottom = pTop + paddedSize;
+        const auto rowWeight = weights[y];
+        const auto pOutRow = outPaddedHeights + y * resampledPaddedSize;
+        for (auto x = 0u; x < resampledPaddedSize; x++)
+        {
+            const auto column = indices[x];
+            const auto columnWeight = weights[x];
+            const auto top = pTop[column] + (pTop[column + 1] - pTop[column]) * columnWeight;
+            const auto bottom = pBottom[column] + (pBottom[column + 1] - pBottom[column]) * columnWeight;
+            pOutRow[x] = top + (bottom - top) * rowWeight;
+        }
+    }
+}
@@ -0,0 +1,316 @@
+#include "HillshadeTileProvider_P.h"
+#include "HillshadeTileProvider.h"
+
+#include "ignore_warnings_on_external_includes.h"
+#include <SkBitmap.h>
+#include <SkColorPriv.h>
+#include "restore_internal_warnings.h"
+
+#include "MapDataProviderHelpers.h"
+#include "Utilities.h"
+#include "Logging.h"
+
+OsmAnd::HillshadeTileProvider_P::HillshadeTileProvider_P(HillshadeTileProvider* const owner_)
+    : _tilesCache(HillshadeTileProvider::DefaultTilesCacheSizeLimitInBytes)
+    , _tilesCacheHits(0)
+    , _tilesCacheMisses(0)
+    , _elevationTilesCache(HillshadeTileProvider::ElevationTilesCacheSize)
+    , owner(owner_)
+{
+}
+
+OsmAnd::HillshadeTileProvider_P::~HillshadeTileProvider_P()
+{
+}
+
+bool OsmAnd::HillshadeTileProvider_P::obtainData(
+    const IMapDataProvider::Request& request_,
+    std::shared_ptr<IMapDataProvider::Data>& outData,
+    std::shared_ptr<Metric>* const pOutMetric)
+{
+    const auto& request = MapDataProviderHelpers::castRequest<HillshadeTileProvider::Request>(request_);
+
+    if (pOutMetric)
+        pOutMetric->reset();
+
+    TileKey key;
+    key.tileId = request.tileId;
+    key.zoom = request.zoom;
+
+    std::shared_ptr<const SkBitmap> bitmap;
+    if (!obtainCachedTile(key, bitmap))
+    {
+        QVector<float> elevationHeights;
+        uint32_t elevationSize = 0;
+        if (!obtainPaddedElevationHeights(request, elevationHeights, elevationSize))
+            return false;
+        if (elevationSize == 0)
+        {
+            // There's no elevation data for this tile, so there's nothing to shade
+            outData.reset();
+            return true;
+        }
+
+        const auto tileSize = owner->tileSize;
+        QVector<float> heights((tileSize + 2) * (tileSize + 2));
+        HillshadeTileProvider::resampleHeights(elevationHeights.constData(), elevationSize, tileSize, heights.data());
+
+        const auto cellSize = static_cast<float>(Utilities::getMetersPerTileUnit(
+            request.zoom,
+            request.tileId.y + 0.5,
+            tileSize));
+        QVector<uint8_t> values(tileSize * tileSize);
+        HillshadeTileProvider::computeShading(
+            heights.constData(),
+            tileSize,
+            cellSize,
+            owner->mode,
+            owner->sunAzimuth,
+            owner->sunAltitude,
+            owner->zFactor,
+            values.data());
+
+        const std::shared_ptr<SkBitmap> newBitmap(new SkBitmap());
+        if (!newBitmap->tryAllocPixels(SkImageInfo::MakeN32Premul(tileSize, tileSize)))
+        {
+            LogPrintf(LogSeverityLevel::Error,
+                "Failed to allocate buffer for hillshade tile %dx%d",
+                tileSize,
+                tileSize);
+            return false;
+        }
+        const auto pValues = values.constData();
+        for (auto y = 0u; y < tileSize; y++)
+        {
+            const auto pPixels = reinterpret_cast<SkPMColor*>(
+                reinterpret_cast<uint8_t*>(newBitmap->getPixels()) + y * newBitmap->rowBytes());
+            const auto pRowValues = pValues + y * tileSize;
+            for (auto x = 0u; x < tileSize; x++)
+                pPixels[x] = SkPackARGB32(0xFF, pRowValues[x], pRowValues[x], pRowValues[x]);
+        }
+
+        bitmap = newBitmap;
+        cacheTile(key, bitmap);
+    }
+
+    outData.reset(new HillshadeTileProvider::Data(
+        request.tileId,
+        request.zoom,
+        AlphaChannelPresence::NotPresent,
+        owner->densityFactor,
+        bitmap));
+    return true;
+}
+
+bool OsmAnd::HillshadeTileProvider_P::obtainCachedTile(const TileKey& key, std::shared_ptr<const SkBitmap>& outBitmap)
+{
+    QMutexLocker scopedLocker(&_tilesCacheMutex);
+
+    const auto pCachedTile = _tilesCache.object(key);
+    if (!pCachedTile)
+    {
+        _tilesCacheMisses++;
+        return false;
+    }
+    _tilesCacheHits++;
+
+    outBitmap = pCachedTile->bitmap;
+    return true;
+}
+
+void OsmAnd::HillshadeTileProvider_P::cacheTile(const TileKey& key, const std::shared_ptr<const SkBitmap>& bitmap)
+{
+    const auto cost = static_cast<int>(sizeof(CachedTile) + bitmap->getSize());
+
+    QMutexLocker scopedLocker(&_tilesCacheMutex);
+
+    if (_tilesCache.maxCost() <= 0)
+        return;
+    const auto pCachedTile = new CachedTile();
+    pCachedTile->bitmap = bitmap;
+    _tilesCache.insert(key, pCachedTile, cost);
+}
+
+bool OsmAnd::HillshadeTileProvider_P::obtainElevationTile(
+    const TileKey& key,
+    const std::shared_ptr<const IQueryController>& queryController,
+    std::shared_ptr<IMapElevationDataProvider::Data>& outData)
+{
+    {
+        QMutexLocker scopedLocker(&_elevationTilesCacheMutex);
+
+        if (const auto pCachedElevationTile = _elevationTilesCache.object(key))
+        {
+            outData = pCachedElevationTile->data;
+            return true;
+        }
+    }
+
+    IMapElevationDataProvider::Request request;
+    request.tileId = key.tileId;
+    request.zoom = key.zoom;
+    request.queryController = queryController;
+    if (!owner->elevationDataProvider->obtainElevationData(request, outData))
+        return false;
+
+    // Missing tiles are cached too, since there are no heights over the sea
+    QMutexLocker scopedLocker(&_elevationTilesCacheMutex);
+
+    const auto pCachedElevationTile = new CachedElevationTile();
+    pCachedElevationTile->data = outData;
+    _elevationTilesCache.insert(key, pCachedElevationTile);
+    return true;
+}
+
+bool OsmAnd::HillshadeTileProvider_P::obtainPaddedElevationHeights(
+    const TileId tileId,
+    const ZoomLevel zoom,
+    QVector<float>& outHeights,
+    uint32_t& outSize,
+    const std::shared_ptr<const IQueryController>& queryController)
+{
+    HillshadeTileProvider::Request request;
+    request.tileId = tileId;
+    request.zoom = zoom;
+    request.queryController = queryController;
+    return obtainPaddedElevationHeights(request, outHeights, outSize);
+}
+
+bool OsmAnd::HillshadeTileProvider_P::obtainPaddedElevationHeights(
+    const HillshadeTileProvider::Request& request,
+    QVector<float>& outHeights,
+    uint32_t& outSize)
+{
+    // Tiles are indexed as [1 + dy][1 + dx], where dx and dy are offsets from requested tile
+    std::shared_ptr<IMapElevationDataProvider::Data> tiles[3][3];
+
+    TileKey key;
+    key.tileId = request.tileId;
+    key.zoom = request.zoom;
+    if (!obtainElevationTile(key, request.queryController, tiles[1][1]))
+        return false;
+    const auto centerTile = tiles[1][1];
+    if (!centerTile)
+    {
+        outSize = 0;
+        return true;
+    }
+    const auto size = static_cast<int>(centerTile->size);
+
+    // Tiles are wrapped around antimeridian, but not across poles. Neighbours that are missing or failed
+    // to load are substituted by nearest samples of requested tile.
+    const auto tilesCount = static_cast<int64_t>(1) << request.zoom;
+    for (auto dy = -1; dy <= 1; dy++)
+    {
+        const auto y = static_cast<int64_t>(request.tileId.y) + dy;
+        if (y < 0 || y >= tilesCount)
+            continue;
+
+        for (auto dx = -1; dx <= 1; dx++)
+        {
+            if (dx == 0 && dy == 0)
+                continue;
+
+            TileKey neighbourKey;
+            neighbourKey.tileId = Utilities::normalizeTileId(
+                TileId::fromXY(request.tileId.x + dx, static_cast<int32_t>(y)),
+                request.zoom);
+            neighbourKey.zoom = request.zoom;
+
+            std::shared_ptr<IMapElevationDataProvider::Data> neighbourTile;
+            if (!obtainElevationTile(neighbourKey, request.queryController, neighbourTile))
+                continue;
+            if (neighbourTile && static_cast<int>(neighbourTile->size) == size)
+                tiles[1 + dy][1 + dx] = neighbourTile;
+        }
+    }
+
+    const auto getRow =
+        []
+        (const std::shared_ptr<IMapElevationDataProvider::Data>& tile, const int row) -> const float*
+        {
+            return reinterpret_cast<const float*>(
+                reinterpret_cast<const uint8_t*>(tile->pRawData) + row * tile->rowLength);
+        };
+    const auto getSample =
+        [&tiles, &centerTile, size, getRow]
+        (const int x, const int y) -> float
+        {
+            const auto tileColumn = (x < 0) ? 0 : (x >= size ? 2 : 1);
+            const auto tileRow = (y < 0) ? 0 : (y >= size ? 2 : 1);
+            const auto& tile = tiles[tileRow][tileColumn];
+            if (!tile)
+                return getRow(centerTile, qBound(0, y, size - 1))[qBound(0, x, size - 1)];
+            return getRow(tile, y - (tileRow - 1) * size)[x - (tileColumn - 1) * size];
+        };
+
+    const auto paddedSize = size + 2;
+    outHeights.resize(paddedSize * paddedSize);
+    const auto pHeights = outHeights.data();
+    for (auto y = -1; y <= size; y++)
+    {
+        const auto pRow = pHeights + (y + 1) * paddedSize + 1;
+        if (y < 0 || y == size)
+        {
+            for (auto x = -1; x <= size; x++)
+                pRow[x] = getSample(x, y);
+            continue;
+        }
+
+        pRow[-1] = getSample(-1, y);
+        memcpy(pRow, getRow(centerTile, y), size * sizeof(float));
+        pRow[size] = getSample(size, y);
+    }
+
+    outSize = static_cast<uint32_t>(size);
+    return true;
+}
+
+OsmAnd::HillshadeTileProvider_P::TilesCacheStatistics OsmAnd::HillshadeTileProvider_P::getTilesCacheStatistics() const
+{
+    QMutexLocker scopedLocker(&_tilesCacheMutex);
+
+    TilesCacheStatistics statistics;
+    statistics.hits = _tilesCacheHits;
+    statistics.misses = _tilesCacheMisses;
+    statistics.entriesCount = _tilesCache.count();
+    statistics.sizeInBytes = _tilesCache.totalCost();
+    statistics.sizeLimitInBytes = _tilesCache.maxCost();
+    return statistics;
+}
+
+void OsmAnd::HillshadeTileProvider_P::setTilesCacheSizeLimit(const unsigned int sizeLimitInBytes)
+{
+    QMutexLocker scopedLocker(&_tilesCacheMutex);
+
+    _tilesCache.setMaxCost(static_cast<int>(sizeLimitInBytes));
+}
+
+void OsmAnd::HillshadeTileProvider_P::clearTilesCache()
+{
+    {
+        QMutexLocker scopedLocker(&_elevationTilesCacheMutex);
+
+        _elevationTilesCache.clear();
+    }
+
+    QMutexLocker scopedLocker(&_tilesCacheMutex);
+
+    _tilesCache.clear();
+    _tilesCacheHits = 0;
+    _tilesCacheMisses = 0;
+}
+
+bool OsmAnd::HillshadeTileProvider_P::TileKey::operator==(const TileKey& that) const
+{
+    return
+        tileId == that.tileId &&
+        zoom == that.zoom;
+}
+
+uint OsmAnd::HillshadeTileProvider_P::TileKey::qHash() const
+{
+    uint hash = ::qHash(tileId.id);
+    hash = hash * 31 + static_cast<uint>(zoom);
+    return hash;
+}
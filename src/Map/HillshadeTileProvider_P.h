@@ -0,0 +1,93 @@
+#ifndef _OSMAND_CORE_HILLSHADE_TILE_PROVIDER_P_H_
+#define _OSMAND_CORE_HILLSHADE_TILE_PROVIDER_P_H_
+
+#include "stdlib_common.h"
+
+#include "QtExtensions.h"
+#include <QCache>
+#include <QMutex>
+#include <QVector>
+
+#include "OsmAndCore.h"
+#include "CommonTypes.h"
+#include "PrivateImplementation.h"
+#include "IRasterMapLayerProvider.h"
+#include "IMapElevationDataProvider.h"
+#include "HillshadeTileProvider.h"
+
+class SkBitmap;
+
+namespace OsmAnd
+{
+    class HillshadeTileProvider_P Q_DECL_FINAL
+    {
+        Q_DISABLE_COPY_AND_MOVE(HillshadeTileProvider_P);
+    public:
+        typedef HillshadeTileProvider::TilesCacheStatistics TilesCacheStatistics;
+
+    private:
+        struct TileKey Q_DECL_FINAL
+        {
+            TileId tileId;
+            ZoomLevel zoom;
+
+            bool operator==(const TileKey& that) const;
+            uint qHash() const;
+        };
+
+        struct CachedTile Q_DECL_FINAL
+        {
+            std::shared_ptr<const SkBitmap> bitmap;
+        };
+        mutable QMutex _tilesCacheMutex;
+        QCache<TileKey, CachedTile> _tilesCache;
+        unsigned int _tilesCacheHits;
+        unsigned int _tilesCacheMisses;
+
+        bool obtainCachedTile(const TileKey& key, std::shared_ptr<const SkBitmap>& outBitmap);
+        void cacheTile(const TileKey& key, const std::shared_ptr<const SkBitmap>& bitmap);
+
+        // Each elevation tile is needed by 9 hillshade tiles, so recently used ones are kept
+        struct CachedElevationTile Q_DECL_FINAL
+        {
+            std::shared_ptr<IMapElevationDataProvider::Data> data;
+        };
+        mutable QMutex _elevationTilesCacheMutex;
+        QCache<TileKey, CachedElevationTile> _elevationTilesCache;
+
+        bool obtainElevationTile(
+            const TileKey& key,
+            const std::shared_ptr<const IQueryController>& queryController,
+            std::shared_ptr<IMapElevationDataProvider::Data>& outData);
+        bool obtainPaddedElevationHeights(
+            const HillshadeTileProvider::Request& request,
+            QVector<float>& outHeights,
+            uint32_t& outSize);
+    protected:
+        HillshadeTileProvider_P(HillshadeTileProvider* const owner);
+    public:
+        ~HillshadeTileProvider_P();
+
+        ImplementationInterface<HillshadeTileProvider> owner;
+
+        bool obtainData(
+            const IMapDataProvider::Request& request,
+            std::shared_ptr<IMapDataProvider::Data>& outData,
+            std::shared_ptr<Metric>* const pOutMetric);
+
+        TilesCacheStatistics getTilesCacheStatistics() const;
+        void setTilesCacheSizeLimit(const unsigned int sizeLimitInBytes);
+        void clearTilesCache();
+
+        bool obtainPaddedElevationHeights(
+            const TileId tileId,
+            const ZoomLevel zoom,
+            QVector<float>& outHeights,
+            uint32_t& outSize,
+            const std::shared_ptr<const IQueryController>& queryController);
+
+    friend class OsmAnd::HillshadeTileProvider;
+    };
+}
+
+#endif // !defined(_OSMAND_CORE_HILLSHADE_TILE_PROVIDER_P_H_)
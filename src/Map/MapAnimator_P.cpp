@@ -30,6 +30,11 @@ void OsmAnd::MapAnimator_P::setMapRenderer(const std::shared_ptr<IMapRenderer>&
     QMutexLocker scopedLocker(&_updateLock);
 
     _isPaused = true;
+    {
+        QWriteLocker scopedAnimationsLocker(&_animationsCollectionLock);
+
+        withdrawPredictedCameraPositions();
+    }
     _animationsByKey.clear();
     _renderer = mapRenderer;
 }
@@ -42,6 +47,10 @@ bool OsmAnd::MapAnimator_P::isPaused() const
 void OsmAnd::MapAnimator_P::pause()
 {
     _isPaused = true;
+
+    QWriteLocker scopedLocker(&_animationsCollectionLock);
+
+    withdrawPredictedCameraPositions();
 }
 
 void OsmAnd::MapAnimator_P::resume()
@@ -227,6 +236,7 @@ void OsmAnd::MapAnimator_P::cancelAllAnimations()
     QWriteLocker scopedLocker(&_animationsCollectionLock);
 
     _animationsByKey.clear();
+    withdrawPredictedCameraPositions();
 }
 
 void OsmAnd::MapAnimator_P::update(const float timePassed)
@@ -238,6 +248,11 @@ void OsmAnd::MapAnimator_P::update(const float timePassed)
             _renderer->resumeSymbolsUpdate();
             _rendererSymbolsUpdateSuspended = false;
         }
+
+        // Animator may have been paused while update was in progress
+        QWriteLocker scopedLocker(&_animationsCollectionLock);
+        withdrawPredictedCameraPositions();
+
         return;
     }
 
@@ -281,6 +296,135 @@ void OsmAnd::MapAnimator_P::update(const float timePassed)
         if (animations.isEmpty())
             itAnimations.remove();
     }
+
+    updatePredictedCameraPositions();
+}
+
+void OsmAnd::MapAnimator_P::updatePredictedCameraPositions()
+{
+    // Only target and zoom affect set of tiles that are needed, so positions where camera will be are
+    // predicted from the longest-running target and zoom animations
+    bool hasTargetPrediction = false;
+    PointI64 currentTarget;
+    PointI64 finalTarget;
+    float targetTimeLeft = 0.0f;
+    bool hasZoomPrediction = false;
+    float currentZoom = 0.0f;
+    float finalZoom = 0.0f;
+    float zoomTimeLeft = 0.0f;
+    for (const auto& animations : constOf(_animationsByKey))
+    {
+        for (const auto& animation : constOf(animations))
+        {
+            if (animation->isPaused())
+                continue;
+
+            const auto timeLeft = animation->getDelay() + animation->getDuration() - animation->getTimePassed();
+            if (animation->getAnimatedValue() == AnimatedValue::Target && timeLeft > targetTimeLeft)
+            {
+                PointI64 initialValue;
+                PointI64 deltaValue;
+                if (!animation->obtainInitialValueAsPointI64(initialValue) ||
+                    !animation->obtainDeltaValueAsPointI64(deltaValue))
+                {
+                    continue;
+                }
+
+                // Values of animation are not normalized, so current value is taken from animation too
+                if (!animation->obtainCurrentValueAsPointI64(currentTarget))
+                    currentTarget = initialValue;
+                finalTarget = initialValue + deltaValue;
+                targetTimeLeft = timeLeft;
+                hasTargetPrediction = true;
+            }
+            else if (animation->getAnimatedValue() == AnimatedValue::Zoom && timeLeft > zoomTimeLeft)
+            {
+                float initialValue;
+                float deltaValue;
+                if (!animation->obtainInitialValueAsFloat(initialValue) ||
+                    !animation->obtainDeltaValueAsFloat(deltaValue))
+                {
+                    continue;
+                }
+
+                if (!animation->obtainCurrentValueAsFloat(currentZoom))
+                    currentZoom = initialValue;
+                finalZoom = initialValue + deltaValue;
+                zoomTimeLeft = timeLeft;
+                hasZoomPrediction = true;
+            }
+        }
+    }
+
+    if (!hasTargetPrediction && !hasZoomPrediction)
+    {
+        withdrawPredictedCameraPositions();
+        return;
+    }
+
+    const auto state = _renderer->getState();
+    if (!hasTargetPrediction)
+        currentTarget = finalTarget = PointI64(state.target31);
+    if (!hasZoomPrediction)
+        currentZoom = finalZoom = state.zoomLevel;
+    const auto minZoomLevel = _renderer->getMinZoomLevel();
+    const auto maxZoomLevel = _renderer->getMaxZoomLevel();
+
+    QVector<IMapRenderer::PredictedCameraPosition> predictedCameraPositions;
+    predictedCameraPositions.reserve(PredictedCameraPositionsCount);
+    for (auto step = 1; step <= PredictedCameraPositionsCount; step++)
+    {
+        const auto fraction = static_cast<double>(step) / PredictedCameraPositionsCount;
+
+        const PointI64 target(
+            currentTarget.x + static_cast<int64_t>((finalTarget.x - currentTarget.x) * fraction),
+            currentTarget.y + static_cast<int64_t>((finalTarget.y - currentTarget.y) * fraction));
+        const auto zoomLevel = qBound(
+            minZoomLevel,
+            static_cast<ZoomLevel>(qRound(currentZoom + (finalZoom - currentZoom) * fraction)),
+            maxZoomLevel);
+
+        const IMapRenderer::PredictedCameraPosition predictedCameraPosition(
+            Utilities::normalizeCoordinates(target, ZoomLevel31),
+            zoomLevel);
+        if (!predictedCameraPositions.isEmpty() &&
+            predictedCameraPositions.last().target31 == predictedCameraPosition.target31 &&
+            predictedCameraPositions.last().zoomLevel == predictedCameraPosition.zoomLevel)
+        {
+            continue;
+        }
+        predictedCameraPositions.push_back(predictedCameraPosition);
+    }
+
+    publishPredictedCameraPositions(predictedCameraPositions);
+}
+
+void OsmAnd::MapAnimator_P::publishPredictedCameraPositions(
+    const QVector<IMapRenderer::PredictedCameraPosition>& positions)
+{
+    // Prediction that was set by other source (e.g. navigation) is kept until that source withdraws it
+    const auto currentPositions = _renderer->getPredictedCameraPositions();
+    if (!currentPositions.isEmpty() && currentPositions != _publishedPredictedCameraPositions)
+    {
+        _publishedPredictedCameraPositions.clear();
+        return;
+    }
+
+    if (currentPositions == positions)
+        return;
+    _renderer->setPredictedCameraPositions(positions);
+    _publishedPredictedCameraPositions = positions;
+}
+
+void OsmAnd::MapAnimator_P::withdrawPredictedCameraPositions()
+{
+    if (_publishedPredictedCameraPositions.isEmpty())
+        return;
+
+    // Prediction is withdrawn only if it was made by animator, since it may be provided by other source
+    if (_renderer && _renderer->getPredictedCameraPositions() == _publishedPredictedCameraPositions)
+        _renderer->setPredictedCameraPositions(QVector<IMapRenderer::PredictedCameraPosition>());
+    _publishedPredictedCameraPositions.clear();
 }
 
 void OsmAnd::MapAnimator_P::animateZoomBy(
@@ -10,6 +10,7 @@
 #include <QHash>
 #include <QMap>
 #include <QList>
+#include <QVector>
 #include <QReadWriteLock>
 #include <QMutex>
 #include <QVariant>
@@ -19,6 +20,7 @@
 #include "PrivateImplementation.h"
 #include "MapAnimator.h"
 #include "MapCommonTypes.h"
+#include "IMapRenderer.h"
 
 namespace OsmAnd
 {
@@ -483,6 +485,18 @@ namespace OsmAnd
         mutable QReadWriteLock _animationsCollectionLock;
         QHash<Key, AnimationsCollection> _animationsByKey;
 
+        enum {
+            // Number of positions along running target and zoom animations that are reported to renderer
+            // as predicted camera positions
+            PredictedCameraPositionsCount = 4,
+        };
+        // Prediction that animator has set to renderer. Prediction that was set by other source is never
+        // replaced nor withdrawn by animator.
+        QVector<IMapRenderer::PredictedCameraPosition> _publishedPredictedCameraPositions;
+        void updatePredictedCameraPositions();
+        void publishPredictedCameraPositions(const QVector<IMapRenderer::PredictedCameraPosition>& positions);
+        void withdrawPredictedCameraPositions();
+
         void constructZoomAnimationByDelta(
             AnimationsCollection& outAnimation,
             const Key key,
@@ -45,6 +45,21 @@ void OsmAnd::MapPresentationEnvironment::setSettings(const QHash< QString, QStri
     _p->setSettings(newSettings);
 }
 
+unsigned int OsmAnd::MapPresentationEnvironment::getSettingsRevision() const
+{
+    return _p->getSettingsRevision();
+}
+
+bool OsmAnd::MapPresentationEnvironment::isStyleEvaluationsCacheEnabled() const
+{
+    return _p->isStyleEvaluationsCacheEnabled();
+}
+
+void OsmAnd::MapPresentationEnvironment::setStyleEvaluationsCacheEnabled(const bool enabled)
+{
+    _p->setStyleEvaluationsCacheEnabled(enabled);
+}
+
 void OsmAnd::MapPresentationEnvironment::applyTo(MapStyleEvaluator& evaluator) const
 {
     _p->applyTo(evaluator);
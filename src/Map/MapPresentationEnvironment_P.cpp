@@ -23,7 +23,9 @@
 #include "Logging.h"
 
 OsmAnd::MapPresentationEnvironment_P::MapPresentationEnvironment_P(MapPresentationEnvironment* owner_)
-    : owner(owner_)
+    : _settingsRevision(0)
+    , _styleEvaluationsCacheEnabled(0)
+    , owner(owner_)
 {
 }
 
@@ -73,6 +75,34 @@ void OsmAnd::MapPresentationEnvironment_P::setSettings(const QHash< OsmAnd::IMap
     QMutexLocker scopedLocker(&_settingsChangeMutex);
 
     _settings = newSettings;
+    _settingsRevision.fetchAndAddOrdered(1);
+
+    // Settings are evaluator inputs, so all memoized evaluations are now invalid
+    _styleEvaluationsCache.clear();
+}
+
+unsigned int OsmAnd::MapPresentationEnvironment_P::getSettingsRevision() const
+{
+    return static_cast<unsigned int>(_settingsRevision.loadAcquire());
+}
+
+bool OsmAnd::MapPresentationEnvironment_P::isStyleEvaluationsCacheEnabled() const
+{
+    return _styleEvaluationsCacheEnabled.loadAcquire() != 0;
+}
+
+void OsmAnd::MapPresentationEnvironment_P::setStyleEvaluationsCacheEnabled(const bool enabled)
+{
+    _styleEvaluationsCacheEnabled.storeRelease(enabled ? 1 : 0);
+    if (!enabled)
+        _styleEvaluationsCache.clear();
+}
+
+OsmAnd::MapStyleEvaluationsCache* OsmAnd::MapPresentationEnvironment_P::getStyleEvaluationsCache() const
+{
+    if (!isStyleEvaluationsCacheEnabled())
+        return nullptr;
+    return &_styleEvaluationsCache;
 }
 
 QHash<OsmAnd::IMapStyle::ValueDefinitionId, OsmAnd::MapStyleConstantValue> OsmAnd::MapPresentationEnvironment_P::resolveSettings(const QHash<QString, QString> &newSettings) const
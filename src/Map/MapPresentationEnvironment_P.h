@@ -18,6 +18,7 @@
 #include "CommonTypes.h"
 #include "PrivateImplementation.h"
 #include "MapStyleConstantValue.h"
+#include "MapStyleEvaluationsCache.h"
 #include "MapRasterizer.h"
 #include "MapPresentationEnvironment.h"
 
@@ -46,6 +47,10 @@ namespace OsmAnd
 
         mutable QMutex _settingsChangeMutex;
         QHash< IMapStyle::ValueDefinitionId, MapStyleConstantValue > _settings;
+        QAtomicInt _settingsRevision;
+
+        QAtomicInt _styleEvaluationsCacheEnabled;
+        mutable MapStyleEvaluationsCache _styleEvaluationsCache;
 
         std::shared_ptr<const IMapStyle::IAttribute> _defaultBackgroundColorAttribute;
         ColorARGB _defaultBackgroundColor;
@@ -96,6 +101,11 @@ namespace OsmAnd
         void setSettings(const QHash< OsmAnd::IMapStyle::ValueDefinitionId, MapStyleConstantValue >& newSettings);
         
         void setSettings(const QHash< QString, QString >& newSettings);
+        unsigned int getSettingsRevision() const;
+
+        bool isStyleEvaluationsCacheEnabled() const;
+        void setStyleEvaluationsCacheEnabled(const bool enabled);
+        MapStyleEvaluationsCache* getStyleEvaluationsCache() const;
 
         void applyTo(MapStyleEvaluator& evaluator) const;
         void applyTo(MapStyleEvaluator &evaluator, const QHash< IMapStyle::ValueDefinitionId, MapStyleConstantValue > &settings) const;
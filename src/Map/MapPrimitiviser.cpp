@@ -14,6 +14,23 @@ OsmAnd::MapPrimitiviser::~MapPrimitiviser()
 {
 }
 
+QThreadPool* OsmAnd::MapPrimitiviser::getParallelPrimitivisationThreadPool() const
+{
+    return _p->getParallelPrimitivisationThreadPool();
+}
+
+int OsmAnd::MapPrimitiviser::getMaxParallelPrimitivisationTasks() const
+{
+    return _p->getMaxParallelPrimitivisationTasks();
+}
+
+void OsmAnd::MapPrimitiviser::setParallelPrimitivisation(
+    QThreadPool* const threadPool,
+    const int maxParallelTasks /*= 0*/)
+{
+    _p->setParallelPrimitivisation(threadPool, maxParallelTasks);
+}
+
 std::shared_ptr<OsmAnd::MapPrimitiviser::PrimitivisedObjects> OsmAnd::MapPrimitiviser::primitiviseAllMapObjects(
     const ZoomLevel zoom,
     const QList< std::shared_ptr<const MapObject> >& objects,
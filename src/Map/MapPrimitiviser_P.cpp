@@ -12,6 +12,7 @@
 #include "Nullable.h"
 #include "ICU.h"
 #include "MapStyleEvaluator.h"
+#include "MapPresentationEnvironment_P.h"
 #include "MapStyleEvaluationResult.h"
 #include "MapStyleBuiltinValueDefinitions.h"
 #include "ObfMapSectionInfo.h"
@@ -23,6 +24,7 @@
 #include "QKeyValueIterator.h"
 #include "QCachingIterator.h"
 #include "Logging.h"
+#include "ParallelFor.h"
 
 //#define OSMAND_VERBOSE_MAP_PRIMITIVISER 1
 #if !defined(OSMAND_VERBOSE_MAP_PRIMITIVISER)
@@ -30,7 +32,9 @@
 #endif // !defined(OSMAND_VERBOSE_MAP_PRIMITIVISER)
 
 OsmAnd::MapPrimitiviser_P::MapPrimitiviser_P(MapPrimitiviser* const owner_)
-    : owner(owner_)
+    : _parallelPrimitivisationThreadPool(nullptr)
+    , _maxParallelPrimitivisationTasks(0)
+    , owner(owner_)
 {
 }
 
@@ -38,6 +42,22 @@ OsmAnd::MapPrimitiviser_P::~MapPrimitiviser_P()
 {
 }
 
+QThreadPool* OsmAnd::MapPrimitiviser_P::getParallelPrimitivisationThreadPool() const
+{
+    return _parallelPrimitivisationThreadPool;
+}
+
+int OsmAnd::MapPrimitiviser_P::getMaxParallelPrimitivisationTasks() const
+{
+    return _maxParallelPrimitivisationTasks;
+}
+
+void OsmAnd::MapPrimitiviser_P::setParallelPrimitivisation(QThreadPool* const threadPool, const int maxParallelTasks)
+{
+    _parallelPrimitivisationThreadPool = threadPool;
+    _maxParallelPrimitivisationTasks = maxParallelTasks;
+}
+
 std::shared_ptr<OsmAnd::MapPrimitiviser_P::PrimitivisedObjects> OsmAnd::MapPrimitiviser_P::primitiviseAllMapObjects(
     const ZoomLevel zoom,
     const QList< std::shared_ptr<const MapObject> >& objects,
@@ -64,7 +84,11 @@ std::shared_ptr<OsmAnd::MapPrimitiviser_P::PrimitivisedObjects> OsmAnd::MapPrimi
 {
     const Stopwatch totalStopwatch(metric != nullptr);
 
-    const Context context(owner->environment, zoom);
+    const Context context(
+        owner->environment,
+        zoom,
+        _parallelPrimitivisationThreadPool,
+        _maxParallelPrimitivisationTasks);
     const std::shared_ptr<PrimitivisedObjects> primitivisedObjects(new PrimitivisedObjects(
         owner->environment,
         cache,
@@ -131,7 +155,11 @@ std::shared_ptr<OsmAnd::MapPrimitiviser_P::PrimitivisedObjects> OsmAnd::MapPrimi
     //}
     //////////////////////////////////////////////////////////////////////////
 
-    const Context context(owner->environment, zoom);
+    const Context context(
+        owner->environment,
+        zoom,
+        _parallelPrimitivisationThreadPool,
+        _maxParallelPrimitivisationTasks);
     const std::shared_ptr<PrimitivisedObjects> primitivisedObjects(new PrimitivisedObjects(
         owner->environment,
         cache,
@@ -479,7 +507,11 @@ std::shared_ptr<OsmAnd::MapPrimitiviser_P::PrimitivisedObjects> OsmAnd::MapPrimi
 {
     const Stopwatch totalStopwatch(metric != nullptr);
 
-    const Context context(owner->environment, zoom);
+    const Context context(
+        owner->environment,
+        zoom,
+        _parallelPrimitivisationThreadPool,
+        _maxParallelPrimitivisationTasks);
     const std::shared_ptr<PrimitivisedObjects> primitivisedObjects(new PrimitivisedObjects(
         owner->environment,
         cache, 
@@ -1235,6 +1267,18 @@ void OsmAnd::MapPrimitiviser_P::obtainPrimitives(
 
     const Stopwatch obtainPrimitivesStopwatch(metric != nullptr);
 
+    // Large sources are split among parallel tasks, if that was enabled
+    if (context.parallelPrimitivisationThreadPool &&
+        context.maxParallelPrimitivisationTasks != 1 &&
+        source.size() >= 2 * MinObjectsPerParallelChunk)
+    {
+        obtainPrimitivesInParallel(context, primitivisedObjects, source, cache, queryController, metric);
+
+        if (metric)
+            metric->elapsedTimeForPrimitives += obtainPrimitivesStopwatch.elapsed();
+        return;
+    }
+
     // Initialize shared settings for order evaluation
     MapStyleEvaluator orderEvaluator(env->mapStyle, env->displayDensityFactor * env->mapScaleFactor);
     env->applyTo(orderEvaluator);
@@ -1304,7 +1348,8 @@ void OsmAnd::MapPrimitiviser_P::obtainPrimitives(
             }
         }
 
-        // Create a primitives group
+        // Create a primitives group. Primitives of group that is shared with other tiles are not placed
+        // into arena of this tile, otherwise that group would keep entire arena alive
         const Stopwatch obtainPrimitivesGroupStopwatch(metric != nullptr);
         const auto group = obtainPrimitivesGroup(
             context,
@@ -1315,6 +1360,7 @@ void OsmAnd::MapPrimitiviser_P::obtainPrimitives(
             polygonEvaluator,
             polylineEvaluator,
             pointEvaluator,
+            (pSharedPrimitivesGroups && isShareable) ? nullptr : context.primitivesArena,
             metric);
         if (metric)
             metric->elapsedTimeForObtainingPrimitivesGroups += obtainPrimitivesGroupStopwatch.elapsed();
@@ -1353,6 +1399,189 @@ void OsmAnd::MapPrimitiviser_P::obtainPrimitives(
         metric->elapsedTimeForPrimitives += obtainPrimitivesStopwatch.elapsed();
 }
 
+void OsmAnd::MapPrimitiviser_P::obtainPrimitivesInParallel(
+    const Context& context,
+    const std::shared_ptr<PrimitivisedObjects>& primitivisedObjects,
+    const QList< std::shared_ptr<const OsmAnd::MapObject> >& source,
+    const std::shared_ptr<Cache>& cache,
+    const std::shared_ptr<const IQueryController>& queryController,
+    MapPrimitiviser_Metrics::Metric_primitivise* const metric)
+{
+    const auto& env = context.env;
+    const auto zoom = primitivisedObjects->zoom;
+    const auto pSharedPrimitivesGroups = cache ? cache->getPrimitivesGroupsPtr(zoom) : nullptr;
+
+    // Each source object gets own slot, so that merge does not depend on order of processing
+    struct ObjectSlot
+    {
+        ObjectSlot()
+            : hasFutureGroup(false)
+        {
+        }
+
+        std::shared_ptr<const PrimitivesGroup> group;
+        proper::shared_future< std::shared_ptr<const PrimitivesGroup> > futureGroup;
+        bool hasFutureGroup;
+    };
+    const auto objectsCount = source.size();
+    std::vector<ObjectSlot> objectSlots(objectsCount);
+
+    auto chunksCount = qMin(
+        objectsCount / MinObjectsPerParallelChunk,
+        context.parallelPrimitivisationThreadPool->maxThreadCount() * MaxParallelChunksPerThread);
+    if (context.maxParallelPrimitivisationTasks > 0)
+        chunksCount = qMin(chunksCount, context.maxParallelPrimitivisationTasks * MaxParallelChunksPerThread);
+    chunksCount = qMax(chunksCount, 1);
+    std::vector< std::shared_ptr<MapPrimitiviser_Metrics::Metric_primitivise> > chunksMetrics(chunksCount);
+
+    Concurrent::ParallelFor::run(
+        context.parallelPrimitivisationThreadPool,
+        chunksCount,
+        [&context, &env, zoom, primitivisedObjects, &source, objectsCount, chunksCount, &objectSlots, &chunksMetrics, pSharedPrimitivesGroups, queryController, metric]
+        (const int chunkIndex)
+        {
+            const auto chunkBegin = static_cast<int>((static_cast<qint64>(objectsCount) * chunkIndex) / chunksCount);
+            const auto chunkEnd = static_cast<int>((static_cast<qint64>(objectsCount) * (chunkIndex + 1)) / chunksCount);
+
+            // Metrics are not thread-safe, so each chunk collects own
+            MapPrimitiviser_Metrics::Metric_primitivise* chunkMetric = nullptr;
+            if (metric)
+            {
+                chunksMetrics[chunkIndex].reset(new MapPrimitiviser_Metrics::Metric_primitiviseAllMapObjects());
+                chunkMetric = chunksMetrics[chunkIndex].get();
+            }
+
+            // Evaluators hold evaluation state, so each chunk needs own set
+            MapStyleEvaluationResult evaluationResult(env->mapStyle->getValueDefinitionsCount());
+
+            MapStyleEvaluator orderEvaluator(env->mapStyle, env->displayDensityFactor * env->mapScaleFactor);
+            env->applyTo(orderEvaluator);
+            orderEvaluator.setIntegerValue(env->styleBuiltinValueDefs->id_INPUT_MINZOOM, zoom);
+            orderEvaluator.setIntegerValue(env->styleBuiltinValueDefs->id_INPUT_MAXZOOM, zoom);
+
+            MapStyleEvaluator polygonEvaluator(env->mapStyle, env->displayDensityFactor * env->mapScaleFactor);
+            env->applyTo(polygonEvaluator);
+            polygonEvaluator.setIntegerValue(env->styleBuiltinValueDefs->id_INPUT_MINZOOM, zoom);
+            polygonEvaluator.setIntegerValue(env->styleBuiltinValueDefs->id_INPUT_MAXZOOM, zoom);
+
+            MapStyleEvaluator polylineEvaluator(env->mapStyle, env->displayDensityFactor * env->mapScaleFactor);
+            env->applyTo(polylineEvaluator);
+            polylineEvaluator.setIntegerValue(env->styleBuiltinValueDefs->id_INPUT_MINZOOM, zoom);
+            polylineEvaluator.setIntegerValue(env->styleBuiltinValueDefs->id_INPUT_MAXZOOM, zoom);
+
+            MapStyleEvaluator pointEvaluator(env->mapStyle, env->displayDensityFactor * env->mapScaleFactor);
+            env->applyTo(pointEvaluator);
+            pointEvaluator.setIntegerValue(env->styleBuiltinValueDefs->id_INPUT_MINZOOM, zoom);
+            pointEvaluator.setIntegerValue(env->styleBuiltinValueDefs->id_INPUT_MAXZOOM, zoom);
+
+            // Arena is not thread-safe, so each chunk fills own one
+            const std::shared_ptr<PrimitivesArena> chunkPrimitivesArena(new PrimitivesArena());
+
+            for (auto objectIndex = chunkBegin; objectIndex < chunkEnd; objectIndex++)
+            {
+                if (queryController && queryController->isAborted())
+                    return;
+
+                const auto& mapObject = source[objectIndex];
+                auto& objectSlot = objectSlots[objectIndex];
+
+                MapObject::SharingKey sharingKey;
+                const auto isShareable = mapObject->obtainSharingKey(sharingKey);
+
+                // If group can be shared, use already-processed or reserve pending. Promise is made right before
+                // processing, so it's always fulfilled unless this task was aborted before reaching it
+                if (pSharedPrimitivesGroups && isShareable)
+                {
+                    if (pSharedPrimitivesGroups->obtainReferenceOrFutureReferenceOrMakePromise(
+                        sharingKey,
+                        objectSlot.group,
+                        objectSlot.futureGroup))
+                    {
+                        objectSlot.hasFutureGroup = !objectSlot.group;
+                        continue;
+                    }
+                }
+
+                // Create a primitives group, shared one does not use arena of this chunk
+                const Stopwatch obtainPrimitivesGroupStopwatch(chunkMetric != nullptr);
+                objectSlot.group = obtainPrimitivesGroup(
+                    context,
+                    primitivisedObjects,
+                    mapObject,
+                    evaluationResult,
+                    orderEvaluator,
+                    polygonEvaluator,
+                    polylineEvaluator,
+                    pointEvaluator,
+                    (pSharedPrimitivesGroups && isShareable) ? nullptr : chunkPrimitivesArena,
+                    chunkMetric);
+                if (chunkMetric)
+                    chunkMetric->elapsedTimeForObtainingPrimitivesGroups += obtainPrimitivesGroupStopwatch.elapsed();
+
+                // Add this group to shared cache
+                if (pSharedPrimitivesGroups && isShareable)
+                    pSharedPrimitivesGroups->fulfilPromiseAndReference(sharingKey, objectSlot.group);
+            }
+        },
+        context.maxParallelPrimitivisationTasks);
+
+    // Sum up metrics of all chunks (times are summed across tasks)
+    if (metric)
+    {
+        for (const auto& chunkMetric : chunksMetrics)
+        {
+            if (!chunkMetric)
+                continue;
+
+#define ACCUMULATE_METRIC_FIELD(type, name, measurement)                                                                        \
+            metric->name += chunkMetric->name
+            OsmAnd__MapPrimitiviser_Metrics__Metric_primitivise__FIELDS(ACCUMULATE_METRIC_FIELD);
+#undef ACCUMULATE_METRIC_FIELD
+        }
+    }
+
+    if (queryController && queryController->isAborted())
+        return;
+
+    // Merge in same order as sequential processing would: own and already-processed groups in order of source,
+    // then groups that are processed by someone else
+    for (auto& objectSlot : objectSlots)
+    {
+        if (objectSlot.hasFutureGroup)
+            continue;
+
+        const auto& group = objectSlot.group;
+
+        // Add polygons, polylines and points from group to current context
+        primitivisedObjects->polygons.append(group->polygons);
+        primitivisedObjects->polylines.append(group->polylines);
+        primitivisedObjects->points.append(group->points);
+
+        // Empty groups are also inserted, to indicate that they are empty
+        primitivisedObjects->primitivesGroups.push_back(qMove(objectSlot.group));
+    }
+
+    // Wait for future primitives groups
+    Stopwatch futureSharedPrimitivesGroupsStopwatch(metric != nullptr);
+    for (auto& objectSlot : objectSlots)
+    {
+        if (!objectSlot.hasFutureGroup)
+            continue;
+
+        auto group = objectSlot.futureGroup.get();
+
+        // Add polygons, polylines and points from group to current context
+        primitivisedObjects->polygons.append(group->polygons);
+        primitivisedObjects->polylines.append(group->polylines);
+        primitivisedObjects->points.append(group->points);
+
+        // Add shared group to current context
+        primitivisedObjects->primitivesGroups.push_back(qMove(group));
+    }
+    if (metric)
+        metric->elapsedTimeForFutureSharedPrimitivesGroups += futureSharedPrimitivesGroupsStopwatch.elapsed();
+}
+
 std::shared_ptr<const OsmAnd::MapPrimitiviser_P::PrimitivesGroup> OsmAnd::MapPrimitiviser_P::obtainPrimitivesGroup(
     const Context& context,
     const std::shared_ptr<PrimitivisedObjects>& primitivisedObjects,
@@ -1362,6 +1591,7 @@ std::shared_ptr<const OsmAnd::MapPrimitiviser_P::PrimitivesGroup> OsmAnd::MapPri
     MapStyleEvaluator& polygonEvaluator,
     MapStyleEvaluator& polylineEvaluator,
     MapStyleEvaluator& pointEvaluator,
+    const std::shared_ptr<PrimitivesArena>& primitivesArena,
     MapPrimitiviser_Metrics::Metric_primitivise* const metric)
 {
     const auto& env = context.env;
@@ -1389,6 +1619,21 @@ std::shared_ptr<const OsmAnd::MapPrimitiviser_P::PrimitivesGroup> OsmAnd::MapPri
     orderEvaluator.setBooleanValue(env->styleBuiltinValueDefs->id_INPUT_CYCLE, mapObject->isClosedFigure());
     polylineEvaluator.setIntegerValue(env->styleBuiltinValueDefs->id_INPUT_LAYER, static_cast<int>(layerType));
 
+    // Setup keys for cached evaluations, each one describes exactly the inputs of respective evaluator
+    MapStyleEvaluationsCache::Key orderCacheKey;
+    orderCacheKey.zoom = context.zoom;
+    orderCacheKey.layer = static_cast<int>(layerType);
+    orderCacheKey.isArea = mapObject->isArea;
+    orderCacheKey.isPoint = mapObject->points31.size() == 1;
+    orderCacheKey.isCycle = mapObject->isClosedFigure();
+    MapStyleEvaluationsCache::Key polygonCacheKey;
+    polygonCacheKey.zoom = context.zoom;
+    MapStyleEvaluationsCache::Key polylineCacheKey;
+    polylineCacheKey.zoom = context.zoom;
+    polylineCacheKey.layer = static_cast<int>(layerType);
+    MapStyleEvaluationsCache::Key pointCacheKey;
+    pointCacheKey.zoom = context.zoom;
+
     const auto& decRules = mapObject->attributeMapping->decodeMap;
     auto pAttributeId = mapObject->attributeIds.constData();
     const auto attributeIdsCount = mapObject->attributeIds.size();
@@ -1406,12 +1651,15 @@ std::shared_ptr<const OsmAnd::MapPrimitiviser_P::PrimitivesGroup> OsmAnd::MapPri
 
         const Stopwatch orderEvaluationStopwatch(metric != nullptr);
 
-        // Setup tag+value-specific input data
-        orderEvaluator.setStringValue(env->styleBuiltinValueDefs->id_INPUT_TAG, decodedAttribute.tag);
-        orderEvaluator.setStringValue(env->styleBuiltinValueDefs->id_INPUT_VALUE, decodedAttribute.value);
-
-        evaluationResult.clear();
-        ok = orderEvaluator.evaluate(mapObject, MapStyleRulesetType::Order, &evaluationResult);
+        ok = evaluateStyle(
+            context,
+            mapObject,
+            decodedAttribute,
+            MapStyleRulesetType::Order,
+            orderCacheKey,
+            orderEvaluator,
+            evaluationResult,
+            metric);
 
         if (metric)
         {
@@ -1543,13 +1791,16 @@ std::shared_ptr<const OsmAnd::MapPrimitiviser_P::PrimitivesGroup> OsmAnd::MapPri
             {
                 const Stopwatch polygonEvaluationStopwatch(metric != nullptr);
 
-                // Setup tag+value-specific input data (for Polygon)
-                polygonEvaluator.setStringValue(env->styleBuiltinValueDefs->id_INPUT_TAG, decodedAttribute.tag);
-                polygonEvaluator.setStringValue(env->styleBuiltinValueDefs->id_INPUT_VALUE, decodedAttribute.value);
-
                 // Evaluate style for this primitive to check if it passes (for Polygon)
-                evaluationResult.clear();
-                ok = polygonEvaluator.evaluate(mapObject, MapStyleRulesetType::Polygon, &evaluationResult);
+                ok = evaluateStyle(
+                    context,
+                    mapObject,
+                    decodedAttribute,
+                    MapStyleRulesetType::Polygon,
+                    polygonCacheKey,
+                    polygonEvaluator,
+                    evaluationResult,
+                    metric);
 
                 if (metric)
                 {
@@ -1561,11 +1812,12 @@ std::shared_ptr<const OsmAnd::MapPrimitiviser_P::PrimitivesGroup> OsmAnd::MapPri
                 if (ok)
                 {
                     // Create new primitive
-                    const std::shared_ptr<Primitive> primitive(new Primitive(
+                    const auto primitive = createPrimitive(
+                        primitivesArena,
                         group,
                         objectType,
                         attributeIdIndex,
-                        evaluationResult));
+                        &evaluationResult);
                     primitive->zOrder = (std::dynamic_pointer_cast<const SurfaceMapObject>(mapObject) || std::dynamic_pointer_cast<const CoastlineMapObject>(mapObject))
                         ? std::numeric_limits<int>::min()
                         : zOrder;
@@ -1597,13 +1849,16 @@ std::shared_ptr<const OsmAnd::MapPrimitiviser_P::PrimitivesGroup> OsmAnd::MapPri
             {
                 const Stopwatch pointEvaluationStopwatch(metric != nullptr);
 
-                // Setup tag+value-specific input data (for Point)
-                pointEvaluator.setStringValue(env->styleBuiltinValueDefs->id_INPUT_TAG, decodedAttribute.tag);
-                pointEvaluator.setStringValue(env->styleBuiltinValueDefs->id_INPUT_VALUE, decodedAttribute.value);
-
                 // Evaluate Point rules
-                evaluationResult.clear();
-                const auto hasIcon = pointEvaluator.evaluate(mapObject, MapStyleRulesetType::Point, &evaluationResult);
+                const auto hasIcon = evaluateStyle(
+                    context,
+                    mapObject,
+                    decodedAttribute,
+                    MapStyleRulesetType::Point,
+                    pointCacheKey,
+                    pointEvaluator,
+                    evaluationResult,
+                    metric);
 
                 // Update metric
                 if (metric)
@@ -1622,18 +1877,21 @@ std::shared_ptr<const OsmAnd::MapPrimitiviser_P::PrimitivesGroup> OsmAnd::MapPri
                     if (hasIcon)
                     {
                         // Point evaluation is a bit special, it's success only indicates that point has an icon
-                        pointPrimitive.reset(new Primitive(
+                        pointPrimitive = createPrimitive(
+                            primitivesArena,
                             group,
                             PrimitiveType::Point,
                             attributeIdIndex,
-                            evaluationResult));
+                            &evaluationResult);
                     }
                     else
                     {
-                        pointPrimitive.reset(new Primitive(
+                        pointPrimitive = createPrimitive(
+                            primitivesArena,
                             group,
                             PrimitiveType::Point,
-                            attributeIdIndex));
+                            attributeIdIndex,
+                            nullptr);
                     }
                     pointPrimitive->zOrder = (std::dynamic_pointer_cast<const SurfaceMapObject>(mapObject) || std::dynamic_pointer_cast<const CoastlineMapObject>(mapObject))
                         ? std::numeric_limits<int>::min()
@@ -1667,13 +1925,16 @@ std::shared_ptr<const OsmAnd::MapPrimitiviser_P::PrimitivesGroup> OsmAnd::MapPri
 
             const Stopwatch polylineEvaluationStopwatch(metric != nullptr);
 
-            // Setup tag+value-specific input data
-            polylineEvaluator.setStringValue(env->styleBuiltinValueDefs->id_INPUT_TAG, decodedAttribute.tag);
-            polylineEvaluator.setStringValue(env->styleBuiltinValueDefs->id_INPUT_VALUE, decodedAttribute.value);
-
             // Evaluate style for this primitive to check if it passes
-            evaluationResult.clear();
-            ok = polylineEvaluator.evaluate(mapObject, MapStyleRulesetType::Polyline, &evaluationResult);
+            ok = evaluateStyle(
+                context,
+                mapObject,
+                decodedAttribute,
+                MapStyleRulesetType::Polyline,
+                polylineCacheKey,
+                polylineEvaluator,
+                evaluationResult,
+                metric);
 
             if (metric)
             {
@@ -1696,11 +1957,12 @@ std::shared_ptr<const OsmAnd::MapPrimitiviser_P::PrimitivesGroup> OsmAnd::MapPri
             }
 
             // Create new primitive
-            const std::shared_ptr<Primitive> primitive(new Primitive(
+            const auto primitive = createPrimitive(
+                primitivesArena,
                 group,
                 objectType,
                 attributeIdIndex,
-                evaluationResult));
+                &evaluationResult);
             primitive->zOrder = zOrder;
 
             // Accept this primitive
@@ -1728,13 +1990,16 @@ std::shared_ptr<const OsmAnd::MapPrimitiviser_P::PrimitivesGroup> OsmAnd::MapPri
 
             const Stopwatch pointEvaluationStopwatch(metric != nullptr);
 
-            // Setup tag+value-specific input data
-            pointEvaluator.setStringValue(env->styleBuiltinValueDefs->id_INPUT_TAG, decodedAttribute.tag);
-            pointEvaluator.setStringValue(env->styleBuiltinValueDefs->id_INPUT_VALUE, decodedAttribute.value);
-
             // Evaluate Point rules
-            evaluationResult.clear();
-            const bool hasIcon = pointEvaluator.evaluate(mapObject, MapStyleRulesetType::Point, &evaluationResult);
+            const bool hasIcon = evaluateStyle(
+                context,
+                mapObject,
+                decodedAttribute,
+                MapStyleRulesetType::Point,
+                pointCacheKey,
+                pointEvaluator,
+                evaluationResult,
+                metric);
 
             // Update metric
             if (metric)
@@ -1762,18 +2027,21 @@ std::shared_ptr<const OsmAnd::MapPrimitiviser_P::PrimitivesGroup> OsmAnd::MapPri
             if (hasIcon)
             {
                 // Point evaluation is a bit special, it's success only indicates that point has an icon
-                primitive.reset(new Primitive(
+                primitive = createPrimitive(
+                    primitivesArena,
                     group,
                     PrimitiveType::Point,
                     attributeIdIndex,
-                    evaluationResult));
+                    &evaluationResult);
             }
             else
             {
-                primitive.reset(new Primitive(
+                primitive = createPrimitive(
+                    primitivesArena,
                     group,
                     PrimitiveType::Point,
-                    attributeIdIndex));
+                    attributeIdIndex,
+                    nullptr);
             }
             primitive->zOrder = zOrder;
 
@@ -1803,6 +2071,71 @@ std::shared_ptr<const OsmAnd::MapPrimitiviser_P::PrimitivesGroup> OsmAnd::MapPri
     return group;
 }
 
+std::shared_ptr<OsmAnd::MapPrimitiviser_P::Primitive> OsmAnd::MapPrimitiviser_P::createPrimitive(
+    const std::shared_ptr<PrimitivesArena>& primitivesArena,
+    const std::shared_ptr<const PrimitivesGroup>& group,
+    const PrimitiveType type,
+    const uint32_t attributeIdIndex,
+    const MapStyleEvaluationResult* const evaluationResult)
+{
+    // Without arena, primitive is allocated separately
+    if (!primitivesArena)
+    {
+        return std::shared_ptr<Primitive>(evaluationResult
+            ? new Primitive(group, type, attributeIdIndex, *evaluationResult)
+            : new Primitive(group, type, attributeIdIndex));
+    }
+
+    const auto primitive = evaluationResult
+        ? primitivesArena->emplace(group, type, attributeIdIndex, *evaluationResult)
+        : primitivesArena->emplace(group, type, attributeIdIndex);
+
+    return primitivesArena->adopt(primitive);
+}
+
+bool OsmAnd::MapPrimitiviser_P::evaluateStyle(
+    const Context& context,
+    const std::shared_ptr<const MapObject>& mapObject,
+    const MapObject::AttributeMapping::TagValue& decodedAttribute,
+    const MapStyleRulesetType rulesetType,
+    MapStyleEvaluationsCache::Key& cacheKey,
+    MapStyleEvaluator& evaluator,
+    MapStyleEvaluationResult& evaluationResult,
+    MapPrimitiviser_Metrics::Metric_primitivise* const metric)
+{
+    const auto& env = context.env;
+    const auto cache = context.styleEvaluationsCache;
+
+    if (cache)
+    {
+        cacheKey.rulesetType = rulesetType;
+        cacheKey.tag = decodedAttribute.tag;
+        cacheKey.value = decodedAttribute.value;
+
+        bool accepted = false;
+        if (cache->lookup(cacheKey, context.styleEvaluationsCacheGeneration, accepted, evaluationResult))
+        {
+            if (metric)
+                metric->styleEvaluationsCacheHits++;
+
+            return accepted;
+        }
+    }
+
+    // Setup tag+value-specific input data
+    evaluator.setStringValue(env->styleBuiltinValueDefs->id_INPUT_TAG, decodedAttribute.tag);
+    evaluator.setStringValue(env->styleBuiltinValueDefs->id_INPUT_VALUE, decodedAttribute.value);
+
+    evaluationResult.clear();
+    const auto accepted = evaluator.evaluate(mapObject, rulesetType, &evaluationResult);
+
+    // Result that depends on map object itself can not be shared with other map objects
+    if (cache && !evaluator.wasMapObjectInspected())
+        cache->insert(cacheKey, context.styleEvaluationsCacheGeneration, accepted, evaluationResult);
+
+    return accepted;
+}
+
 void OsmAnd::MapPrimitiviser_P::sortAndFilterPrimitives(
     const Context& context,
     const std::shared_ptr<PrimitivisedObjects>& primitivisedObjects,
@@ -2855,13 +3188,21 @@ void OsmAnd::MapPrimitiviser_P::obtainPrimitiveIcon(
 
 OsmAnd::MapPrimitiviser_P::Context::Context(
     const std::shared_ptr<const MapPresentationEnvironment>& env_,
-    const ZoomLevel zoom_)
+    const ZoomLevel zoom_,
+    QThreadPool* const parallelPrimitivisationThreadPool_,
+    const int maxParallelPrimitivisationTasks_)
     : env(env_)
     , zoom(zoom_)
+    , parallelPrimitivisationThreadPool(parallelPrimitivisationThreadPool_)
+    , maxParallelPrimitivisationTasks(maxParallelPrimitivisationTasks_)
+    , primitivesArena(new PrimitivesArena())
 {
     polygonAreaMinimalThreshold = env->getPolygonAreaMinimalThreshold(zoom);
     roadDensityZoomTile = env->getRoadDensityZoomTile(zoom);
     roadsDensityLimitPerTile = env->getRoadsDensityLimitPerTile(zoom);
     defaultSymbolPathSpacing = env->getDefaultSymbolPathSpacing();
     defaultBlockPathSpacing = env->getDefaultBlockPathSpacing();
+
+    styleEvaluationsCache = env->_p->getStyleEvaluationsCache();
+    styleEvaluationsCacheGeneration = styleEvaluationsCache ? styleEvaluationsCache->getGeneration() : 0u;
 }
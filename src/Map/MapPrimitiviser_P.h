@@ -13,6 +13,8 @@
 #include "MapCommonTypes.h"
 #include "MapPresentationEnvironment.h"
 #include "MapPrimitiviser.h"
+#include "MapStyleEvaluationsCache.h"
+#include "SharedObjectsArena.h"
 
 namespace OsmAnd
 {
@@ -22,6 +24,12 @@ namespace OsmAnd
         Q_DISABLE_COPY_AND_MOVE(MapPrimitiviser_P);
 
     public:
+        enum {
+            // Smaller sources are not worth splitting among parallel tasks
+            MinObjectsPerParallelChunk = 512,
+            MaxParallelChunksPerThread = 4,
+        };
+
         typedef MapPrimitiviser::CoastlineMapObject CoastlineMapObject;
         typedef MapPrimitiviser::SurfaceMapObject SurfaceMapObject;
         typedef MapPrimitiviser::PrimitiveType PrimitiveType;
@@ -37,8 +45,11 @@ namespace OsmAnd
         typedef MapPrimitiviser::IconSymbol IconSymbol;
         typedef MapPrimitiviser::PrimitivisedObjects PrimitivisedObjects;
         typedef MapPrimitiviser::Cache Cache;
+        typedef SharedObjectsArena<Primitive, 64> PrimitivesArena;
 
     private:
+        QThreadPool* _parallelPrimitivisationThreadPool;
+        int _maxParallelPrimitivisationTasks;
     protected:
         MapPrimitiviser_P(MapPrimitiviser* const owner);
 
@@ -54,7 +65,9 @@ namespace OsmAnd
         {
             Context(
                 const std::shared_ptr<const MapPresentationEnvironment>& env,
-                const ZoomLevel zoom);
+                const ZoomLevel zoom,
+                QThreadPool* const parallelPrimitivisationThreadPool,
+                const int maxParallelPrimitivisationTasks);
 
             const std::shared_ptr<const MapPresentationEnvironment> env;
             const ZoomLevel zoom;
@@ -65,6 +78,16 @@ namespace OsmAnd
             float defaultSymbolPathSpacing;
             float defaultBlockPathSpacing;
 
+            MapStyleEvaluationsCache* styleEvaluationsCache;
+            unsigned int styleEvaluationsCacheGeneration;
+
+            QThreadPool* const parallelPrimitivisationThreadPool;
+            const int maxParallelPrimitivisationTasks;
+
+            // Primitives of entire tile are stored in single arena, that is filled by calling thread only.
+            // Groups shared with other tiles allocate their primitives separately, so they never keep it alive.
+            const std::shared_ptr<PrimitivesArena> primitivesArena;
+
         private:
             Q_DISABLE_COPY_AND_MOVE(Context);
         };
@@ -115,6 +138,14 @@ namespace OsmAnd
             const std::shared_ptr<const IQueryController>& queryController,
             MapPrimitiviser_Metrics::Metric_primitivise* const metric);
 
+        static void obtainPrimitivesInParallel(
+            const Context& context,
+            const std::shared_ptr<PrimitivisedObjects>& primitivisedObjects,
+            const QList< std::shared_ptr<const OsmAnd::MapObject> >& source,
+            const std::shared_ptr<Cache>& cache,
+            const std::shared_ptr<const IQueryController>& queryController,
+            MapPrimitiviser_Metrics::Metric_primitivise* const metric);
+
         static std::shared_ptr<const PrimitivesGroup> obtainPrimitivesGroup(
             const Context& context,
             const std::shared_ptr<PrimitivisedObjects>& primitivisedObjects,
@@ -124,6 +155,24 @@ namespace OsmAnd
             MapStyleEvaluator& polygonEvaluator,
             MapStyleEvaluator& polylineEvaluator,
             MapStyleEvaluator& pointEvaluator,
+            const std::shared_ptr<PrimitivesArena>& primitivesArena,
+            MapPrimitiviser_Metrics::Metric_primitivise* const metric);
+
+        static std::shared_ptr<Primitive> createPrimitive(
+            const std::shared_ptr<PrimitivesArena>& primitivesArena,
+            const std::shared_ptr<const PrimitivesGroup>& group,
+            const PrimitiveType type,
+            const uint32_t attributeIdIndex,
+            const MapStyleEvaluationResult* const evaluationResult);
+
+        static bool evaluateStyle(
+            const Context& context,
+            const std::shared_ptr<const MapObject>& mapObject,
+            const MapObject::AttributeMapping::TagValue& decodedAttribute,
+            const MapStyleRulesetType rulesetType,
+            MapStyleEvaluationsCache::Key& cacheKey,
+            MapStyleEvaluator& evaluator,
+            MapStyleEvaluationResult& evaluationResult,
             MapPrimitiviser_Metrics::Metric_primitivise* const metric);
 
         static void sortAndFilterPrimitives(
@@ -209,6 +258,10 @@ namespace OsmAnd
 
         ImplementationInterface<MapPrimitiviser> owner;
 
+        QThreadPool* getParallelPrimitivisationThreadPool() const;
+        int getMaxParallelPrimitivisationTasks() const;
+        void setParallelPrimitivisation(QThreadPool* const threadPool, const int maxParallelTasks);
+
         std::shared_ptr<PrimitivisedObjects> primitiviseAllMapObjects(
             const ZoomLevel zoom,
             const QList< std::shared_ptr<const MapObject> >& objects,
@@ -80,6 +80,48 @@ OsmAnd::ZoomLevel OsmAnd::MapRasterLayerProvider::getMaxZoom() const
     return _p->getMaxZoom();
 }
 
+OsmAnd::MapRasterLayerProvider::CompressedTilesCacheStatistics OsmAnd::MapRasterLayerProvider::getCompressedTilesCacheStatistics() const
+{
+    return _p->getCompressedTilesCacheStatistics();
+}
+
+void OsmAnd::MapRasterLayerProvider::setCompressedTilesCacheSizeLimit(const unsigned int sizeLimitInBytes)
+{
+    _p->setCompressedTilesCacheSizeLimit(sizeLimitInBytes);
+}
+
+void OsmAnd::MapRasterLayerProvider::setCompressedTilesCompressionLevel(const int compressionLevel)
+{
+    _p->setCompressedTilesCompressionLevel(compressionLevel);
+}
+
+void OsmAnd::MapRasterLayerProvider::clearCompressedTilesCache()
+{
+    _p->clearCompressedTilesCache();
+}
+
+QString OsmAnd::MapRasterLayerProvider::getDiskCachePath() const
+{
+    return _p->getDiskCachePath();
+}
+
+void OsmAnd::MapRasterLayerProvider::setDiskCachePath(
+    const QString& diskCachePath,
+    const QString& versionTag /*= QString()*/)
+{
+    _p->setDiskCachePath(diskCachePath, versionTag);
+}
+
+uint64_t OsmAnd::MapRasterLayerProvider::getDiskCacheSizeLimit() const
+{
+    return _p->getDiskCacheSizeLimit();
+}
+
+void OsmAnd::MapRasterLayerProvider::setDiskCacheSizeLimit(const uint64_t sizeLimitInBytes)
+{
+    _p->setDiskCacheSizeLimit(sizeLimitInBytes);
+}
+
 OsmAnd::MapRasterLayerProvider::Data::Data(
     const TileId tileId_,
     const ZoomLevel zoom_,
@@ -6,15 +6,46 @@
 #   define OSMAND_PERFORMANCE_METRICS 0
 #endif // !defined(OSMAND_PERFORMANCE_METRICS)
 
+#include "ignore_warnings_on_external_includes.h"
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QMap>
+#include <QSaveFile>
+#include <QStringList>
+#include <QVector>
+#include "restore_internal_warnings.h"
+
 #include "MapDataProviderHelpers.h"
 #include "MapPrimitivesProvider.h"
 #include "MapPrimitivesProvider_Metrics.h"
 #include "MapPrimitiviser.h"
+#include "MapPresentationEnvironment.h"
 #include "MapRasterizer.h"
+#include "ResolvedMapStyle.h"
+#include "UnresolvedMapStyle.h"
+#include "ObfMapObjectsProvider.h"
+#include "IObfsCollection.h"
+#include "ObfFile.h"
+#include "IQueryController.h"
 #include "Stopwatch.h"
+#include "Logging.h"
 
 OsmAnd::MapRasterLayerProvider_P::MapRasterLayerProvider_P(MapRasterLayerProvider* const owner_)
-    : owner(owner_)
+    : _tilesFingerprintValid(false)
+    , _fingerprintedSettingsRevision(0)
+    , _compressedTilesCache(MapRasterLayerProvider::DefaultCompressedTilesCacheSizeLimitInBytes)
+    , _compressedTilesCompressionLevel(MapRasterLayerProvider::DefaultCompressedTilesCompressionLevel)
+    , _compressedTilesCacheHits(0)
+    , _compressedTilesCacheMisses(0)
+    , _diskCacheSizeLimit(MapRasterLayerProvider::DefaultDiskCacheSizeLimitInBytes)
+    , _diskCacheSize(-1)
+    , _diskCacheTrimInProgress(false)
+    , owner(owner_)
 {
 }
 
@@ -65,6 +96,39 @@ bool OsmAnd::MapRasterLayerProvider_P::obtainRasterizedTile(
 #endif // OSMAND_PERFORMANCE_METRICS
         );
 
+    // Decompressing previously rasterized tile is much cheaper than obtaining primitives and rasterizing them.
+    // Tile read from disk is also put to memory cache.
+    const auto fingerprint = getTilesFingerprint();
+    CompressedTileKey compressedTileKey;
+    compressedTileKey.tileId = request.tileId;
+    compressedTileKey.zoom = request.zoom;
+    compressedTileKey.fingerprint = fingerprint.key;
+    CompressedTile compressedTile;
+    const auto diskCacheFilename = getDiskCacheFilename(fingerprint, request.tileId, request.zoom);
+    bool compressedTileAvailable = obtainCompressedTile(compressedTileKey, compressedTile);
+    if (!compressedTileAvailable && !diskCacheFilename.isEmpty() && readDiskCachedTile(diskCacheFilename, compressedTile))
+    {
+        storeCompressedTile(compressedTileKey, compressedTile);
+        compressedTileAvailable = true;
+    }
+    const auto cachedBitmap = compressedTileAvailable ? decompressTile(compressedTile) : nullptr;
+    if (cachedBitmap)
+    {
+        outData.reset(new MapRasterLayerProvider::Data(
+            request.tileId,
+            request.zoom,
+            AlphaChannelPresence::NotPresent,
+            owner->getTileDensityFactor(),
+            cachedBitmap,
+            nullptr,
+            new RetainableCacheMetadata(nullptr)));
+
+        if (metric)
+            metric->elapsedTime += totalStopwatch.elapsed();
+
+        return true;
+    }
+
     // Obtain offline map primitives tile
     std::shared_ptr<MapPrimitivesProvider::Data> primitivesTile;
     owner->primitivesProvider->obtainTiledPrimitives(
@@ -91,6 +155,15 @@ bool OsmAnd::MapRasterLayerProvider_P::obtainRasterizedTile(
         return false;
     }
 
+    // Tile rasterization of which was aborted may be incomplete
+    if ((!request.queryController || !request.queryController->isAborted()) &&
+        compressTile(*bitmap, compressedTile))
+    {
+        storeCompressedTile(compressedTileKey, compressedTile);
+        if (!diskCacheFilename.isEmpty())
+            accountDiskCachedTile(writeDiskCachedTile(diskCacheFilename, compressedTile));
+    }
+
     // Or supply newly rasterized tile
     outData.reset(new MapRasterLayerProvider::Data(
         request.tileId,
@@ -122,6 +195,484 @@ OsmAnd::ZoomLevel OsmAnd::MapRasterLayerProvider_P::getMaxZoom() const
     return owner->primitivesProvider->getMaxZoom();
 }
 
+bool OsmAnd::MapRasterLayerProvider_P::compressTile(const SkBitmap& bitmap, CompressedTile& outCompressedTile) const
+{
+    int compressionLevel;
+    {
+        QMutexLocker scopedLocker(&_compressedTilesCacheMutex);
+
+        compressionLevel = _compressedTilesCompressionLevel;
+    }
+
+    outCompressedTile.info = bitmap.info();
+    outCompressedTile.rowBytes = bitmap.rowBytes();
+    outCompressedTile.data = qCompress(
+        reinterpret_cast<const uchar*>(bitmap.getPixels()),
+        static_cast<int>(bitmap.getSize()),
+        compressionLevel);
+
+    return !outCompressedTile.data.isEmpty();
+}
+
+std::shared_ptr<SkBitmap> OsmAnd::MapRasterLayerProvider_P::decompressTile(const CompressedTile& compressedTile)
+{
+    const auto pixels = qUncompress(compressedTile.data);
+    if (pixels.size() != static_cast<int>(compressedTile.rowBytes * compressedTile.info.height()))
+        return nullptr;
+
+    const std::shared_ptr<SkBitmap> bitmap(new SkBitmap());
+    if (!bitmap->tryAllocPixels(compressedTile.info, compressedTile.rowBytes))
+    {
+        LogPrintf(LogSeverityLevel::Error,
+            "Failed to allocate buffer for decompressed tile %dx%d",
+            compressedTile.info.width(),
+            compressedTile.info.height());
+        return nullptr;
+    }
+    memcpy(bitmap->getPixels(), pixels.constData(), pixels.size());
+
+    return bitmap;
+}
+
+bool OsmAnd::MapRasterLayerProvider_P::obtainCompressedTile(
+    const CompressedTileKey& key,
+    CompressedTile& outCompressedTile)
+{
+    QMutexLocker scopedLocker(&_compressedTilesCacheMutex);
+
+    const auto pCompressedTile = _compressedTilesCache.object(key);
+    if (!pCompressedTile)
+    {
+        _compressedTilesCacheMisses++;
+        return false;
+    }
+    _compressedTilesCacheHits++;
+
+    // Data is implicitly shared, so it's safe to decompress it without lock
+    outCompressedTile = *pCompressedTile;
+    return true;
+}
+
+void OsmAnd::MapRasterLayerProvider_P::storeCompressedTile(
+    const CompressedTileKey& key,
+    const CompressedTile& compressedTile)
+{
+    const auto cost = static_cast<int>(sizeof(CompressedTile) + compressedTile.data.size());
+
+    QMutexLocker scopedLocker(&_compressedTilesCacheMutex);
+
+    if (_compressedTilesCache.maxCost() <= 0)
+        return;
+    _compressedTilesCache.insert(key, new CompressedTile(compressedTile), cost);
+}
+
+OsmAnd::MapRasterLayerProvider_P::CompressedTilesCacheStatistics OsmAnd::MapRasterLayerProvider_P::getCompressedTilesCacheStatistics() const
+{
+    QMutexLocker scopedLocker(&_compressedTilesCacheMutex);
+
+    CompressedTilesCacheStatistics statistics;
+    statistics.hits = _compressedTilesCacheHits;
+    statistics.misses = _compressedTilesCacheMisses;
+    statistics.entriesCount = _compressedTilesCache.count();
+    statistics.sizeInBytes = _compressedTilesCache.totalCost();
+    statistics.sizeLimitInBytes = _compressedTilesCache.maxCost();
+    return statistics;
+}
+
+void OsmAnd::MapRasterLayerProvider_P::setCompressedTilesCacheSizeLimit(const unsigned int sizeLimitInBytes)
+{
+    QMutexLocker scopedLocker(&_compressedTilesCacheMutex);
+
+    _compressedTilesCache.setMaxCost(static_cast<int>(sizeLimitInBytes));
+}
+
+void OsmAnd::MapRasterLayerProvider_P::setCompressedTilesCompressionLevel(const int compressionLevel)
+{
+    QMutexLocker scopedLocker(&_compressedTilesCacheMutex);
+
+    _compressedTilesCompressionLevel = qBound(1, compressionLevel, 9);
+}
+
+void OsmAnd::MapRasterLayerProvider_P::clearCompressedTilesCache()
+{
+    QMutexLocker scopedLocker(&_compressedTilesCacheMutex);
+
+    _compressedTilesCache.clear();
+    _compressedTilesCacheHits = 0;
+    _compressedTilesCacheMisses = 0;
+}
+
+QString OsmAnd::MapRasterLayerProvider_P::getDiskCachePath() const
+{
+    QMutexLocker scopedLocker(&_diskCacheMutex);
+
+    return _diskCachePath;
+}
+
+void OsmAnd::MapRasterLayerProvider_P::setDiskCachePath(const QString& diskCachePath, const QString& versionTag)
+{
+    QMutexLocker scopedLocker(&_diskCacheMutex);
+
+    _diskCachePath = diskCachePath;
+    _diskCacheVersionTag = versionTag;
+    _diskCacheSize = -1;
+    scopedLocker.unlock();
+
+    // Version tag is part of fingerprint
+    invalidateTilesFingerprint();
+}
+
+uint64_t OsmAnd::MapRasterLayerProvider_P::getDiskCacheSizeLimit() const
+{
+    QMutexLocker scopedLocker(&_diskCacheMutex);
+
+    return _diskCacheSizeLimit;
+}
+
+void OsmAnd::MapRasterLayerProvider_P::setDiskCacheSizeLimit(const uint64_t sizeLimitInBytes)
+{
+    QMutexLocker scopedLocker(&_diskCacheMutex);
+
+    _diskCacheSizeLimit = sizeLimitInBytes;
+
+    // Size is checked against new limit on next written tile
+    _diskCacheSize = -1;
+}
+
+OsmAnd::MapRasterLayerProvider_P::TilesFingerprint OsmAnd::MapRasterLayerProvider_P::getTilesFingerprint() const
+{
+    const auto settingsRevision = owner->primitivesProvider->primitiviser->environment->getSettingsRevision();
+    QList< std::shared_ptr<const ObfFile> > obfFiles;
+    const auto obfMapObjectsProvider =
+        std::dynamic_pointer_cast<ObfMapObjectsProvider>(owner->primitivesProvider->mapObjectsProvider);
+    if (obfMapObjectsProvider)
+        obfFiles = obfMapObjectsProvider->obfsCollection->getObfFiles();
+
+    TilesFingerprint fingerprint;
+    bool fingerprintChanged = false;
+    {
+        QMutexLocker scopedLocker(&_tilesFingerprintMutex);
+
+        if (!_tilesFingerprintValid || _fingerprintedSettingsRevision != settingsRevision)
+        {
+            _tilesFingerprint.settings = calculateSettingsFingerprint();
+            _fingerprintedSettingsRevision = settingsRevision;
+            fingerprintChanged = true;
+        }
+        if (!_tilesFingerprintValid || _fingerprintedObfFiles != obfFiles)
+        {
+            _tilesFingerprint.obfFiles = obfMapObjectsProvider ? calculateObfFilesVersion(obfFiles) : QString();
+            _fingerprintedObfFiles = obfFiles;
+            fingerprintChanged = true;
+        }
+        if (fingerprintChanged)
+        {
+            _tilesFingerprint.key =
+                (_tilesFingerprint.settings + QLatin1String("-") + _tilesFingerprint.obfFiles).toLatin1();
+            _tilesFingerprintValid = true;
+        }
+
+        fingerprint = _tilesFingerprint;
+    }
+
+    // Tiles cached with previous fingerprint are never going to be requested again
+    if (fingerprintChanged)
+    {
+        QMutexLocker scopedLocker(&_compressedTilesCacheMutex);
+
+        _compressedTilesCache.clear();
+    }
+
+    return fingerprint;
+}
+
+void OsmAnd::MapRasterLayerProvider_P::invalidateTilesFingerprint()
+{
+    QMutexLocker scopedLocker(&_tilesFingerprintMutex);
+
+    _tilesFingerprintValid = false;
+}
+
+QString OsmAnd::MapRasterLayerProvider_P::calculateObfFilesVersion(const QList< std::shared_ptr<const ObfFile> >& obfFiles)
+{
+    // Files are ordered by path, since collection does not guarantee any order
+    QMap<QString, QFileInfo> obfFilesInfo;
+    for (const auto& obfFile : constOf(obfFiles))
+        obfFilesInfo.insert(obfFile->filePath, QFileInfo(obfFile->filePath));
+
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    for (const auto& obfFileInfo : constOf(obfFilesInfo))
+    {
+        hash.addData(obfFileInfo.absoluteFilePath().toUtf8());
+        hash.addData(QByteArray::number(obfFileInfo.size()));
+        hash.addData(QByteArray::number(obfFileInfo.lastModified().toMSecsSinceEpoch()));
+    }
+
+    return QString::fromLatin1(hash.result().toHex());
+}
+
+QString OsmAnd::MapRasterLayerProvider_P::calculateSettingsFingerprint() const
+{
+    const auto& environment = owner->primitivesProvider->primitiviser->environment;
+
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    {
+        QMutexLocker scopedLocker(&_diskCacheMutex);
+
+        hash.addData(_diskCacheVersionTag.toUtf8());
+    }
+
+    // Map style is identified by names of styles it was resolved from
+    if (const auto resolvedMapStyle = std::dynamic_pointer_cast<const ResolvedMapStyle>(environment->mapStyle))
+    {
+        for (const auto& unresolvedMapStyle : constOf(resolvedMapStyle->unresolvedMapStylesChain))
+            hash.addData(unresolvedMapStyle->name.toUtf8());
+    }
+
+    // Settings are ordered by value definition, since order of hash is not stable between runs
+    const auto settings = environment->getSettings();
+    auto valueDefinitionIds = settings.keys();
+    std::sort(valueDefinitionIds.begin(), valueDefinitionIds.end());
+    for (const auto valueDefinitionId : constOf(valueDefinitionIds))
+    {
+        const auto& value = settings[valueDefinitionId];
+        hash.addData(QByteArray::number(valueDefinitionId));
+        hash.addData(QByteArray::number(value.isComplex ? 1 : 0));
+        hash.addData(QByteArray::number(value.asSimple.asUInt64));
+    }
+
+    hash.addData(QByteArray::number(environment->displayDensityFactor));
+    hash.addData(QByteArray::number(environment->mapScaleFactor));
+    hash.addData(QByteArray::number(environment->symbolsScaleFactor));
+    hash.addData(environment->localeLanguageId.toUtf8());
+    hash.addData(QByteArray::number(static_cast<int>(environment->languagePreference)));
+    hash.addData(QByteArray::number(owner->getTileSize()));
+    hash.addData(QByteArray::number(owner->fillBackground ? 1 : 0));
+
+    return QString::fromLatin1(hash.result().toHex());
+}
+
+QString OsmAnd::MapRasterLayerProvider_P::getDiskCacheFilename(
+    const TilesFingerprint& fingerprint,
+    const TileId tileId,
+    const ZoomLevel zoom) const
+{
+    if (fingerprint.obfFiles.isEmpty())
+        return QString();
+
+    QString diskCachePath;
+    {
+        QMutexLocker scopedLocker(&_diskCacheMutex);
+
+        diskCachePath = _diskCachePath;
+    }
+    if (diskCachePath.isEmpty())
+        return QString();
+
+    const auto tileRelativePath =
+        fingerprint.settings + QDir::separator() +
+        QString::number(zoom) + QDir::separator() +
+        QString::number(tileId.x) + QDir::separator() +
+        QString::number(tileId.y) + QLatin1String("-") + fingerprint.obfFiles + QLatin1String(".tile");
+    return QDir(diskCachePath).absoluteFilePath(tileRelativePath);
+}
+
+bool OsmAnd::MapRasterLayerProvider_P::readDiskCachedTile(const QString& filename, CompressedTile& outCompressedTile)
+{
+    QFile tileFile(filename);
+    if (!tileFile.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream stream(&tileFile);
+    stream.setVersion(QDataStream::Qt_5_0);
+    qint32 width;
+    qint32 height;
+    qint32 colorType;
+    qint32 alphaType;
+    quint64 rowBytes;
+    stream >> width >> height >> colorType >> alphaType >> rowBytes >> outCompressedTile.data;
+    if (stream.status() != QDataStream::Ok)
+    {
+        LogPrintf(LogSeverityLevel::Warning,
+            "Failed to read cached tile '%s'",
+            qPrintable(filename));
+
+        tileFile.close();
+        tileFile.remove();
+        return false;
+    }
+
+    outCompressedTile.info = SkImageInfo::Make(
+        width,
+        height,
+        static_cast<SkColorType>(colorType),
+        static_cast<SkAlphaType>(alphaType));
+    outCompressedTile.rowBytes = rowBytes;
+
+    // Modification time marks when tile was used last, so that least recently used tiles are trimmed first
+    tileFile.setFileTime(QDateTime::currentDateTimeUtc(), QFileDevice::FileModificationTime);
+
+    return true;
+}
+
+int64_t OsmAnd::MapRasterLayerProvider_P::writeDiskCachedTile(const QString& filename, const CompressedTile& compressedTile)
+{
+    const QFileInfo tileFileInfo(filename);
+    auto tileDir = tileFileInfo.dir();
+    tileDir.mkpath(QLatin1String("."));
+
+    // Tile is written to temporary file first, so that concurrent readers never see partially written tile
+    QSaveFile tileFile(filename);
+    if (!tileFile.open(QIODevice::WriteOnly))
+    {
+        LogPrintf(LogSeverityLevel::Error,
+            "Failed to save tile to '%s'",
+            qPrintable(filename));
+        return 0;
+    }
+
+    QDataStream stream(&tileFile);
+    stream.setVersion(QDataStream::Qt_5_0);
+    stream
+        << static_cast<qint32>(compressedTile.info.width())
+        << static_cast<qint32>(compressedTile.info.height())
+        << static_cast<qint32>(compressedTile.info.colorType())
+        << static_cast<qint32>(compressedTile.info.alphaType())
+        << static_cast<quint64>(compressedTile.rowBytes)
+        << compressedTile.data;
+    if (!tileFile.commit())
+    {
+        LogPrintf(LogSeverityLevel::Error,
+            "Failed to save tile to '%s'",
+            qPrintable(filename));
+        return 0;
+    }
+    int64_t sizeDelta = QFileInfo(filename).size();
+
+    // Versions of this tile made from other OBF files are never going to be used
+    const auto tileNamePrefix = tileFileInfo.fileName().section(QLatin1Char('-'), 0, 0) + QLatin1String("-");
+    const auto outdatedTilesInfo = tileDir.entryInfoList(
+        QStringList() << (tileNamePrefix + QLatin1String("*.tile")),
+        QDir::Files);
+    for (const auto& outdatedTileInfo : constOf(outdatedTilesInfo))
+    {
+        if (outdatedTileInfo.fileName() != tileFileInfo.fileName() && tileDir.remove(outdatedTileInfo.fileName()))
+            sizeDelta -= outdatedTileInfo.size();
+    }
+
+    return sizeDelta;
+}
+
+void OsmAnd::MapRasterLayerProvider_P::accountDiskCachedTile(const int64_t sizeDelta)
+{
+    QMutexLocker scopedLocker(&_diskCacheMutex);
+
+    if (_diskCacheSize >= 0)
+        _diskCacheSize += sizeDelta;
+
+    // Size of cache is not known until it's scanned, which is done by trimming as well
+    if (_diskCacheTrimInProgress || _diskCachePath.isEmpty() || _diskCacheSizeLimit == 0)
+        return;
+    if (_diskCacheSize >= 0 && static_cast<uint64_t>(_diskCacheSize) <= _diskCacheSizeLimit)
+        return;
+    const auto diskCachePath = _diskCachePath;
+    const auto diskCacheSizeLimit = _diskCacheSizeLimit;
+    _diskCacheTrimInProgress = true;
+    scopedLocker.unlock();
+
+    const auto diskCacheSize = trimDiskCache(diskCachePath, diskCacheSizeLimit);
+
+    scopedLocker.relock();
+    _diskCacheTrimInProgress = false;
+    if (_diskCachePath == diskCachePath && _diskCacheSizeLimit == diskCacheSizeLimit)
+        _diskCacheSize = diskCacheSize;
+}
+
+int64_t OsmAnd::MapRasterLayerProvider_P::trimDiskCache(const QString& diskCachePath, const uint64_t sizeLimit)
+{
+    struct DiskCachedTile
+    {
+        QString filename;
+        QDateTime lastUsed;
+        int64_t size;
+    };
+    QVector<DiskCachedTile> tiles;
+    int64_t diskCacheSize = 0;
+    QDirIterator itTile(
+        diskCachePath,
+        QStringList() << QLatin1String("*.tile"),
+        QDir::Files,
+        QDirIterator::Subdirectories);
+    while (itTile.hasNext())
+    {
+        itTile.next();
+        const auto tileFileInfo = itTile.fileInfo();
+
+        DiskCachedTile tile;
+        tile.filename = tileFileInfo.absoluteFilePath();
+        tile.lastUsed = tileFileInfo.lastModified();
+        tile.size = tileFileInfo.size();
+        tiles.push_back(tile);
+        diskCacheSize += tile.size;
+    }
+    if (static_cast<uint64_t>(diskCacheSize) <= sizeLimit)
+        return diskCacheSize;
+
+    // Tiles of outdated fingerprints are never used, so they are the first to be removed
+    std::sort(tiles,
+        []
+        (const DiskCachedTile& l, const DiskCachedTile& r) -> bool
+        {
+            return l.lastUsed < r.lastUsed;
+        });
+    const auto trimmedSize = static_cast<int64_t>(sizeLimit / 100 * DiskCacheTrimmedSizePercent);
+    for (const auto& tile : constOf(tiles))
+    {
+        if (diskCacheSize <= trimmedSize)
+            break;
+        if (QFile::remove(tile.filename))
+            diskCacheSize -= tile.size;
+    }
+
+    // Remove directories left empty, deepest first. Directory that is not empty is never removed.
+    QStringList directories;
+    QDirIterator itDirectory(diskCachePath, QDir::Dirs | QDir::NoDotAndDotDot, QDirIterator::Subdirectories);
+    while (itDirectory.hasNext())
+        directories.push_back(itDirectory.next());
+    std::sort(directories,
+        []
+        (const QString& l, const QString& r) -> bool
+        {
+            return l.size() > r.size();
+        });
+    QDir diskCacheDir(diskCachePath);
+    for (const auto& directory : constOf(directories))
+        diskCacheDir.rmdir(directory);
+
+    LogPrintf(LogSeverityLevel::Info,
+        "Trimmed map tiles disk cache '%s' to %" PRIi64 " bytes",
+        qPrintable(diskCachePath),
+        diskCacheSize);
+
+    return diskCacheSize;
+}
+
+bool OsmAnd::MapRasterLayerProvider_P::CompressedTileKey::operator==(const CompressedTileKey& that) const
+{
+    return
+        tileId == that.tileId &&
+        zoom == that.zoom &&
+        fingerprint == that.fingerprint;
+}
+
+uint OsmAnd::MapRasterLayerProvider_P::CompressedTileKey::qHash() const
+{
+    uint hash = ::qHash(tileId.id);
+    hash = hash * 31 + static_cast<uint>(zoom);
+    hash = hash * 31 + ::qHash(fingerprint);
+    return hash;
+}
+
 OsmAnd::MapRasterLayerProvider_P::RetainableCacheMetadata::RetainableCacheMetadata(
     const std::shared_ptr<const IMapDataProvider::RetainableCacheMetadata>& binaryMapPrimitivesRetainableCacheMetadata_)
     : binaryMapPrimitivesRetainableCacheMetadata(binaryMapPrimitivesRetainableCacheMetadata_)
@@ -6,8 +6,18 @@
 #include <array>
 
 #include "QtExtensions.h"
+#include "ignore_warnings_on_external_includes.h"
 #include <QMutex>
 #include <QSet>
+#include <QByteArray>
+#include <QCache>
+#include <QList>
+#include <QString>
+#include "restore_internal_warnings.h"
+
+#include "ignore_warnings_on_external_includes.h"
+#include <SkImageInfo.h>
+#include "restore_internal_warnings.h"
 
 #include "OsmAndCore.h"
 #include "CommonTypes.h"
@@ -19,11 +29,84 @@
 namespace OsmAnd
 {
     class MapRasterizer;
+    class ObfFile;
 
     class MapRasterLayerProvider_P
     {
         Q_DISABLE_COPY_AND_MOVE(MapRasterLayerProvider_P);
+    public:
+        typedef MapRasterLayerProvider::CompressedTilesCacheStatistics CompressedTilesCacheStatistics;
+
     private:
+        // Rasterized tile depends on map style, its settings, provider parameters and OBF files, so cached
+        // tiles are identified by fingerprint of all of them. Fingerprint is recalculated only when settings
+        // or set of OBF files change.
+        struct TilesFingerprint Q_DECL_FINAL
+        {
+            // Fingerprint of map style, its settings and provider parameters
+            QString settings;
+            // Version of OBF files, empty if map objects are not provided from OBF files
+            QString obfFiles;
+            // Both of the above, used in keys of cached tiles
+            QByteArray key;
+        };
+        mutable QMutex _tilesFingerprintMutex;
+        mutable bool _tilesFingerprintValid;
+        mutable TilesFingerprint _tilesFingerprint;
+        mutable unsigned int _fingerprintedSettingsRevision;
+        mutable QList< std::shared_ptr<const ObfFile> > _fingerprintedObfFiles;
+
+        TilesFingerprint getTilesFingerprint() const;
+        void invalidateTilesFingerprint();
+        QString calculateSettingsFingerprint() const;
+        static QString calculateObfFilesVersion(const QList< std::shared_ptr<const ObfFile> >& obfFiles);
+
+        struct CompressedTileKey Q_DECL_FINAL
+        {
+            TileId tileId;
+            ZoomLevel zoom;
+            QByteArray fingerprint;
+
+            bool operator==(const CompressedTileKey& that) const;
+            uint qHash() const;
+        };
+        struct CompressedTile Q_DECL_FINAL
+        {
+            SkImageInfo info;
+            size_t rowBytes;
+            QByteArray data;
+        };
+        mutable QMutex _compressedTilesCacheMutex;
+        QCache<CompressedTileKey, CompressedTile> _compressedTilesCache;
+        int _compressedTilesCompressionLevel;
+        unsigned int _compressedTilesCacheHits;
+        unsigned int _compressedTilesCacheMisses;
+
+        bool compressTile(const SkBitmap& bitmap, CompressedTile& outCompressedTile) const;
+        static std::shared_ptr<SkBitmap> decompressTile(const CompressedTile& compressedTile);
+        bool obtainCompressedTile(const CompressedTileKey& key, CompressedTile& outCompressedTile);
+        void storeCompressedTile(const CompressedTileKey& key, const CompressedTile& compressedTile);
+
+        mutable QMutex _diskCacheMutex;
+        QString _diskCachePath;
+        QString _diskCacheVersionTag;
+        uint64_t _diskCacheSizeLimit;
+        // Size of all tiles under disk cache path, negative if not yet known
+        int64_t _diskCacheSize;
+        bool _diskCacheTrimInProgress;
+        enum {
+            // Disk cache is trimmed below the limit, so that it's not trimmed again after each written tile
+            DiskCacheTrimmedSizePercent = 75,
+        };
+
+        QString getDiskCacheFilename(
+            const TilesFingerprint& fingerprint,
+            const TileId tileId,
+            const ZoomLevel zoom) const;
+        static bool readDiskCachedTile(const QString& filename, CompressedTile& outCompressedTile);
+        static int64_t writeDiskCachedTile(const QString& filename, const CompressedTile& compressedTile);
+        void accountDiskCachedTile(const int64_t sizeDelta);
+        static int64_t trimDiskCache(const QString& diskCachePath, const uint64_t sizeLimit);
     protected:
         MapRasterLayerProvider_P(MapRasterLayerProvider* const owner);
 
@@ -61,6 +144,16 @@ namespace OsmAnd
         ZoomLevel getMinZoom() const;
         ZoomLevel getMaxZoom() const;
 
+        CompressedTilesCacheStatistics getCompressedTilesCacheStatistics() const;
+        void setCompressedTilesCacheSizeLimit(const unsigned int sizeLimitInBytes);
+        void setCompressedTilesCompressionLevel(const int compressionLevel);
+        void clearCompressedTilesCache();
+
+        QString getDiskCachePath() const;
+        void setDiskCachePath(const QString& diskCachePath, const QString& versionTag);
+        uint64_t getDiskCacheSizeLimit() const;
+        void setDiskCacheSizeLimit(const uint64_t sizeLimitInBytes);
+
     friend class OsmAnd::MapRasterLayerProvider;
     };
 }
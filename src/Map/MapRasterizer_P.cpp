@@ -350,42 +350,23 @@ void OsmAnd::MapRasterizer_P::rasterizePolygon(
 
     // Construct and test geometry against bbox area
     SkPath path;
-    bool containsAtLeastOnePoint = false;
-    int pointIdx = 0;
-    PointF vertex;
-    Utilities::CHValue prevChValue;
-    QVector< PointI > outerPoints;
     const auto pointsCount = points31.size();
-    auto pPoint = points31.constData();
-    for (auto pointIdx = 0; pointIdx < pointsCount; pointIdx++, pPoint++)
+    const auto vertices = context.obtainVerticesBuffer(pointsCount);
+    const auto clipCodes = context.obtainClipCodesBuffer(pointsCount);
+    calculateVertices(context, points31.constData(), pointsCount, vertices);
+    calculateClipCodes(area31, points31.constData(), pointsCount, clipCodes);
+    path.addPoly(vertices, pointsCount, false);
+
+    // Hit-test
+    bool containsAtLeastOnePoint = (clipCodes[0] == 0);
+    for (auto pointIdx = 1; pointIdx < pointsCount && !containsAtLeastOnePoint; pointIdx++)
     {
-        const auto& point = *pPoint;
-        calculateVertex(context, point, vertex);
+        if (clipCodes[pointIdx] == 0)
+            containsAtLeastOnePoint = true;
 
-        // Hit-test
-        if (!containsAtLeastOnePoint)
-        {
-            if (area31.contains(point))
-                containsAtLeastOnePoint = true;
-            else
-                outerPoints.push_back(point);
-
-            const auto chValue = Utilities::computeCohenSutherlandValue(point, area31);
-            if (Q_LIKELY(pointIdx > 0))
-            {
-                // Check if line crosses area (reject only if points are on the same side)
-                const auto intersectedChValue = prevChValue & chValue;
-                if (static_cast<unsigned int>(intersectedChValue) != 0)
-                    containsAtLeastOnePoint = true;
-            }
-            prevChValue = chValue;
-        }
-
-        // Plot vertex
-        if (pointIdx == 0)
-            path.moveTo(vertex.x, vertex.y);
-        else
-            path.lineTo(vertex.x, vertex.y);
+        // Check if line crosses area (reject only if points are on the same side)
+        if ((clipCodes[pointIdx - 1] & clipCodes[pointIdx]) != 0)
+            containsAtLeastOnePoint = true;
     }
 
     //////////////////////////////////////////////////////////////////////////
@@ -399,10 +380,10 @@ void OsmAnd::MapRasterizer_P::rasterizePolygon(
     {
         // Check area is inside polygon
         bool ok = true;
-        ok = ok || containsHelper(outerPoints, area31.topLeft);
-        ok = ok || containsHelper(outerPoints, area31.bottomRight);
-        ok = ok || containsHelper(outerPoints, PointI(0, area31.bottom()));
-        ok = ok || containsHelper(outerPoints, PointI(area31.right(), 0));
+        ok = ok || containsHelper(points31, area31.topLeft);
+        ok = ok || containsHelper(points31, area31.bottomRight);
+        ok = ok || containsHelper(points31, PointI(0, area31.bottom()));
+        ok = ok || containsHelper(points31, PointI(area31.right(), 0));
         if (!ok)
             return;
     }
@@ -419,17 +400,12 @@ void OsmAnd::MapRasterizer_P::rasterizePolygon(
         path.setFillType(SkPath::kEvenOdd_FillType);
         for (const auto& polygon : constOf(primitive->sourceObject->innerPolygonsPoints31))
         {
-            pointIdx = 0;
-            for (auto itVertex = cachingIteratorOf(constOf(polygon)); itVertex; ++itVertex, pointIdx++)
-            {
-                const auto& point = *itVertex;
-                calculateVertex(context, point, vertex);
+            if (polygon.isEmpty())
+                continue;
 
-                if (pointIdx == 0)
-                    path.moveTo(vertex.x, vertex.y);
-                else
-                    path.lineTo(vertex.x, vertex.y);
-            }
+            const auto polygonVertices = context.obtainVerticesBuffer(polygon.size());
+            calculateVertices(context, polygon.constData(), polygon.size(), polygonVertices);
+            path.addPoly(polygonVertices, polygon.size(), false);
         }
     }
 
@@ -470,40 +446,32 @@ void OsmAnd::MapRasterizer_P::rasterizePolyline(
         return;
 
     SkPath path;
-    int pointIdx = 0;
     bool intersect = false;
-    int prevCross = 0;
-    PointF vertex;
     const auto pointsCount = points31.size();
-    auto pPoint = points31.constData();
-    PointF pVertex;
+    const auto vertices = context.obtainVerticesBuffer(pointsCount);
+    const auto clipCodes = context.obtainClipCodesBuffer(pointsCount);
+    calculateVertices(context, points31.constData(), pointsCount, vertices);
+    calculateClipCodes(area31, points31.constData(), pointsCount, clipCodes);
     PointF tempVertex;
-    for (pointIdx = 0; pointIdx < pointsCount; pointIdx++, pPoint++)
+    for (auto pointIdx = 1; pointIdx < pointsCount; pointIdx++)
     {
-        const auto& point = *pPoint;
-        calculateVertex(context, point, vertex);
-
-        int cross = 0;
-        cross |= (point.x < area31.left() ? 1 : 0);
-        cross |= (point.x > area31.right() ? 2 : 0);
-        cross |= (point.y < area31.top() ? 4 : 0);
-        cross |= (point.y > area31.bottom() ? 8 : 0);
-        if (pointIdx > 0)
+        const auto prevCross = clipCodes[pointIdx - 1];
+        const auto cross = clipCodes[pointIdx];
+
+        // Skip segments that lay entirely on one side of the area
+        if ((prevCross & cross) != 0)
+            continue;
+
+        const PointF pVertex(vertices[pointIdx - 1].fX, vertices[pointIdx - 1].fY);
+        const PointF vertex(vertices[pointIdx].fX, vertices[pointIdx].fY);
+        if (prevCross != 0 || !intersect)
         {
-            if ((prevCross & cross) == 0)
-            {
-                if (prevCross != 0 || !intersect)
-                {
-                    simplifyVertexToDirection(context, pVertex, vertex, tempVertex);
-                    path.moveTo(tempVertex.x, tempVertex.y);
-                }
-                simplifyVertexToDirection(context, vertex, pVertex, tempVertex);
-                path.lineTo(tempVertex.x, tempVertex.y);
-                intersect = true;
-            }
+            simplifyVertexToDirection(context, pVertex, vertex, tempVertex);
+            path.moveTo(tempVertex.x, tempVertex.y);
         }
-        prevCross = cross;
-        pVertex = vertex;
+        simplifyVertexToDirection(context, vertex, pVertex, tempVertex);
+        path.lineTo(tempVertex.x, tempVertex.y);
+        intersect = true;
     }
 
     if (!intersect)
@@ -675,12 +643,52 @@ void OsmAnd::MapRasterizer_P::simplifyVertexToDirection(
     }
 }
 
-void OsmAnd::MapRasterizer_P::calculateVertex(const Context& context, const PointI& point31, PointF& vertex)
+void OsmAnd::MapRasterizer_P::calculateVertices(
+    const Context& context,
+    const PointI* const points31,
+    const int pointsCount,
+    SkPoint* const outVertices)
+{
+    const auto originX = context.area31.left();
+    const auto originY = context.area31.top();
+    const auto scaleDivisorX = context.primitivisedObjects->scaleDivisor31ToPixel.x;
+    const auto scaleDivisorY = context.primitivisedObjects->scaleDivisor31ToPixel.y;
+    const auto offsetX = static_cast<float>(context.pixelArea.left());
+    const auto offsetY = static_cast<float>(context.pixelArea.top());
+
+    // Loop has no branches and no dependencies between iterations, so that compiler is able to vectorize it
+    for (auto pointIdx = 0; pointIdx < pointsCount; pointIdx++)
+    {
+        const auto& point31 = points31[pointIdx];
+        auto& vertex = outVertices[pointIdx];
+
+        vertex.fX = static_cast<float>(static_cast<float>(point31.x - originX) / scaleDivisorX) + offsetX;
+        vertex.fY = static_cast<float>(static_cast<float>(point31.y - originY) / scaleDivisorY) + offsetY;
+    }
+}
+
+void OsmAnd::MapRasterizer_P::calculateClipCodes(
+    const AreaI& area31,
+    const PointI* const points31,
+    const int pointsCount,
+    uint8_t* const outClipCodes)
 {
-    vertex.x = static_cast<float>(point31.x - context.area31.left()) / context.primitivisedObjects->scaleDivisor31ToPixel.x;
-    vertex.y = static_cast<float>(point31.y - context.area31.top()) / context.primitivisedObjects->scaleDivisor31ToPixel.y;
+    const auto left = area31.left();
+    const auto right = area31.right();
+    const auto top = area31.top();
+    const auto bottom = area31.bottom();
+
+    // Same as Cohen-Sutherland value, but computed without branches for entire set of points
+    for (auto pointIdx = 0; pointIdx < pointsCount; pointIdx++)
+    {
+        const auto& point31 = points31[pointIdx];
 
-    vertex += PointF(context.pixelArea.topLeft);
+        outClipCodes[pointIdx] = static_cast<uint8_t>(
+            (point31.x < left ? 1 : 0) |
+            (point31.x > right ? 2 : 0) |
+            (point31.y < top ? 4 : 0) |
+            (point31.y > bottom ? 8 : 0));
+    }
 }
 
 bool OsmAnd::MapRasterizer_P::containsHelper(const QVector< PointI >& points, const PointI& otherPoint)
@@ -790,3 +798,17 @@ OsmAnd::MapRasterizer_P::Context::Context(
 {
     env->obtainShadowOptions(zoom, shadowMode, shadowColor);
 }
+
+SkPoint* OsmAnd::MapRasterizer_P::Context::obtainVerticesBuffer(const int size) const
+{
+    if (verticesBuffer.size() < size)
+        verticesBuffer.resize(size);
+    return verticesBuffer.data();
+}
+
+uint8_t* OsmAnd::MapRasterizer_P::Context::obtainClipCodesBuffer(const int size) const
+{
+    if (clipCodesBuffer.size() < size)
+        clipCodesBuffer.resize(size);
+    return clipCodesBuffer.data();
+}
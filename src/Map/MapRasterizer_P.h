@@ -51,6 +51,12 @@ namespace OsmAnd
             MapPresentationEnvironment::ShadowMode shadowMode;
             ColorARGB shadowColor;
 
+            // Scratch buffers, reused by all primitives rasterized within this context
+            mutable QVector<SkPoint> verticesBuffer;
+            mutable QVector<uint8_t> clipCodesBuffer;
+            SkPoint* obtainVerticesBuffer(const int size) const;
+            uint8_t* obtainClipCodesBuffer(const int size) const;
+
         private:
             Q_DISABLE_COPY_AND_MOVE(Context);
         };
@@ -114,7 +120,16 @@ namespace OsmAnd
             const SkPath& path,
             const MapStyleEvaluationResult::Packed& evalResult);
 
-        inline void calculateVertex(const Context& context, const PointI& point31, PointF& vertex);
+        static void calculateVertices(
+            const Context& context,
+            const PointI* const points31,
+            const int pointsCount,
+            SkPoint* const outVertices);
+        static void calculateClipCodes(
+            const AreaI& area31,
+            const PointI* const points31,
+            const int pointsCount,
+            uint8_t* const outClipCodes);
         inline float lineEquation(float x1, float y1, float x2, float y2, float x);
         inline void simplifyVertexToDirection(const Context& , const PointF& , const PointF& , PointF&);
         static bool containsHelper(const QVector< PointI >& points, const PointI& otherPoint);
@@ -41,6 +41,7 @@ OsmAnd::MapRenderer::MapRenderer(
     , _currentConfigurationAsConst(_currentConfiguration)
     , _requestedConfiguration(baseConfiguration_->createCopy())
     , _suspendSymbolsUpdateCounter(0)
+    , _symbolsRevision(0)
     , _gpuWorkerThreadId(nullptr)
     , _gpuWorkerThreadIsAlive(false)
     , _gpuWorkerIsSuspended(false)
@@ -391,7 +392,10 @@ bool OsmAnd::MapRenderer::preUpdate(IMapRenderer_Metrics::Metric_update* const m
     Stopwatch updatesStopwatch(metric != nullptr);
     const auto& mapState = getMapState();
     if (_resources->checkForUpdatesAndApply(mapState))
+    {
+        incrementSymbolsRevision();
         invalidateFrame();
+    }
     if (metric)
         metric->elapsedTimeForUpdatesProcessing = updatesStopwatch.elapsed();
 
@@ -451,6 +455,7 @@ bool OsmAnd::MapRenderer::prePrepareFrame()
     if (currentDebugSettingsInvalidatedCounter > 0)
     {
         updateCurrentDebugSettings();
+        incrementSymbolsRevision();
 
         _currentDebugSettingsInvalidatedCounter.fetchAndAddOrdered(-currentDebugSettingsInvalidatedCounter);
     }
@@ -505,6 +510,15 @@ bool OsmAnd::MapRenderer::prePrepareFrame()
     {
         ok = updateInternalState(*getInternalStateRef(), _currentState, *currentConfiguration);
 
+        // Camera moves are tracked by symbols stage itself, so that it can re-place symbols incrementally
+        const auto cameraStateChangesMask =
+            (1u << static_cast<uint32_t>(MapRendererStateChange::Azimuth)) |
+            (1u << static_cast<uint32_t>(MapRendererStateChange::ElevationAngle)) |
+            (1u << static_cast<uint32_t>(MapRendererStateChange::Target)) |
+            (1u << static_cast<uint32_t>(MapRendererStateChange::Zoom));
+        if (currentConfigurationInvalidatedMask != 0 || (requestedStateUpdatedMask & ~cameraStateChangesMask) != 0)
+            incrementSymbolsRevision();
+
         _currentState.metersPerPixel = getCurrentPixelsToMetersScaleFactor(_currentState.zoomLevel, getInternalStateRef());
                 
         // Anyways, invalidate the frame
@@ -902,6 +916,7 @@ void OsmAnd::MapRenderer::doPublishMapSymbol(
     symbolReferencedResources.insert(resource);
 
     _publishedMapSymbolsGroups[symbolGroup] += 1;
+    incrementSymbolsRevision();
 
 #if OSMAND_LOG_MAP_SYMBOLS_REGISTRATION_LIFECYCLE
     LogPrintf(LogSeverityLevel::Debug,
@@ -988,6 +1003,7 @@ void OsmAnd::MapRenderer::doUnpublishMapSymbol(
     }
     if (publishedMapSymbols.isEmpty())
         publishedMapSymbolsByGroup.erase(itPublishedMapSymbols);
+    incrementSymbolsRevision();
     if (publishedMapSymbolsByGroup.size() == 0)
         _publishedMapSymbolsByOrder.erase(itPublishedMapSymbolsByGroup);
 
@@ -1071,7 +1087,10 @@ bool OsmAnd::MapRenderer::suspendSymbolsUpdate()
 {
     const auto prevCounter = _suspendSymbolsUpdateCounter.fetchAndAddOrdered(+1);
     if (prevCounter == 0)
+    {
+        incrementSymbolsRevision();
         invalidateFrame();
+    }
 
     return (prevCounter >= 0);
 }
@@ -1088,11 +1107,24 @@ bool OsmAnd::MapRenderer::resumeSymbolsUpdate()
     }
 
     if (prevCounter == 1)
+    {
+        incrementSymbolsRevision();
         invalidateFrame();
+    }
 
     return (prevCounter <= 1);
 }
 
+unsigned int OsmAnd::MapRenderer::getSymbolsRevision() const
+{
+    return _symbolsRevision.loadAcquire();
+}
+
+void OsmAnd::MapRenderer::incrementSymbolsRevision()
+{
+    _symbolsRevision.fetchAndAddOrdered(1);
+}
+
 OsmAnd::MapRendererState OsmAnd::MapRenderer::getState() const
 {
     QMutexLocker scopedLocker(&_requestedStateMutex);
@@ -1606,6 +1638,20 @@ bool OsmAnd::MapRenderer::setStubsStyle(const MapStubStyle style, bool forcedUpd
     return true;
 }
 
+QVector<OsmAnd::IMapRenderer::PredictedCameraPosition> OsmAnd::MapRenderer::getPredictedCameraPositions() const
+{
+    QMutexLocker scopedLocker(&_predictedCameraPositionsMutex);
+
+    return _predictedCameraPositions;
+}
+
+void OsmAnd::MapRenderer::setPredictedCameraPositions(const QVector<PredictedCameraPosition>& positions)
+{
+    QMutexLocker scopedLocker(&_predictedCameraPositionsMutex);
+
+    _predictedCameraPositions = positions;
+}
+
 OsmAnd::ZoomLevel OsmAnd::MapRenderer::getMinZoomLevel() const
 {
     return MinZoomLevel;
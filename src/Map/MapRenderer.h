@@ -11,6 +11,7 @@
 #include <QMap>
 #include <QReadWriteLock>
 #include <QSet>
+#include <QVector>
 #include "restore_internal_warnings.h"
 
 #include "OsmAndCore.h"
@@ -70,6 +71,8 @@ namespace OsmAnd
         MapRendererState _currentState;
         QAtomicInt _requestedStateUpdatedMask;
         void notifyRequestedStateWasUpdated(const MapRendererStateChange change);
+        mutable QMutex _predictedCameraPositionsMutex;
+        QVector<PredictedCameraPosition> _predictedCameraPositions;
 
         // Resources-related:
         std::unique_ptr<MapRendererResourcesManager> _resources;
@@ -90,6 +93,8 @@ namespace OsmAnd
             const std::shared_ptr<MapRendererBaseResource>& resource);
         bool validatePublishedMapSymbolsIntegrity();
         QAtomicInt _suspendSymbolsUpdateCounter;
+        QAtomicInt _symbolsRevision;
+        void incrementSymbolsRevision();
         
         // GPU worker related:
         Qt::HANDLE _gpuWorkerThreadId;
@@ -279,6 +284,9 @@ namespace OsmAnd
 
         virtual bool setStubsStyle(const MapStubStyle style, bool forcedUpdate = false);
 
+        virtual QVector<PredictedCameraPosition> getPredictedCameraPositions() const;
+        virtual void setPredictedCameraPositions(const QVector<PredictedCameraPosition>& positions);
+
         virtual ZoomLevel getMinZoomLevel() const;
         virtual ZoomLevel getMaxZoomLevel() const;
 
@@ -292,6 +300,7 @@ namespace OsmAnd
         virtual bool isSymbolsUpdateSuspended(int* const pOutSuspendsCounter = nullptr) const;
         virtual bool suspendSymbolsUpdate();
         virtual bool resumeSymbolsUpdate();
+        unsigned int getSymbolsRevision() const;
 
         // Debug-related:
         virtual std::shared_ptr<MapRendererDebugSettings> getDebugSettings() const;
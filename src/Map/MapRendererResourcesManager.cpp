@@ -411,6 +411,7 @@ void OsmAnd::MapRendererResourcesManager::updateSymbolProviderBindings(const Map
 }
 
 void OsmAnd::MapRendererResourcesManager::updateActiveZone(
+    const PointI& target31,
     const TileId centerTileId,
     const QVector<TileId>& tiles,
     const ZoomLevel zoom)
@@ -431,6 +432,38 @@ void OsmAnd::MapRendererResourcesManager::updateActiveZone(
         _activeTiles = tiles;
         _activeZoom = zoom;
 
+        // Estimate camera velocity, smoothing it over several frames
+        if (!_activeZoneUpdateTimer.isValid())
+        {
+            _activeZoneUpdateTimer.start();
+            _activeZoneTarget31 = target31;
+        }
+        else
+        {
+            const auto elapsedTime = _activeZoneUpdateTimer.elapsed();
+            if (elapsedTime > MaxMotionEstimationIntervalInMilliseconds)
+            {
+                _activeZoneVelocity31 = PointF();
+                _activeZoneUpdateTimer.restart();
+                _activeZoneTarget31 = target31;
+            }
+            else if (elapsedTime > 0)
+            {
+                // Shortest way is taken, since 31-coordinates wrap around 180th meridian
+                auto delta = PointI64(target31) - PointI64(_activeZoneTarget31);
+                const auto worldSize31 = static_cast<int64_t>(1) << ZoomLevel31;
+                if (delta.x > worldSize31 / 2)
+                    delta.x -= worldSize31;
+                else if (delta.x < -worldSize31 / 2)
+                    delta.x += worldSize31;
+
+                const auto velocity = PointF(delta.x, delta.y) * (1000.0f / elapsedTime);
+                _activeZoneVelocity31 = _activeZoneVelocity31 * 0.75f + velocity * 0.25f;
+                _activeZoneUpdateTimer.restart();
+                _activeZoneTarget31 = target31;
+            }
+        }
+
         // Wake up the worker
         _workerThreadWakeup.wakeAll();
     }
@@ -605,6 +638,7 @@ void OsmAnd::MapRendererResourcesManager::workerThreadProcedure()
         TileId centerTileId;
         QVector<TileId> activeTiles;
         ZoomLevel activeZoom;
+        PointF motionVector;
 
         // Wait until we're unblocked by host
         {
@@ -615,12 +649,16 @@ void OsmAnd::MapRendererResourcesManager::workerThreadProcedure()
             centerTileId = _centerTileId;
             activeTiles = _activeTiles;
             activeZoom = _activeZoom;
+
+            // Expected movement of center during lookahead interval, in tiles of active zoom
+            const auto tileSize31 = static_cast<float>(1u << (ZoomLevel31 - activeZoom));
+            motionVector = _activeZoneVelocity31 * (MotionLookaheadInMilliseconds / 1000.0f / tileSize31);
         }
         if (!_workerThreadIsAlive)
             break;
 
         // Update resources
-        updateResources(centerTileId, activeTiles, activeZoom);
+        updateResources(centerTileId, activeTiles, activeZoom, motionVector);
     }
 
     _workerThreadId = nullptr;
@@ -630,7 +668,9 @@ void OsmAnd::MapRendererResourcesManager::requestNeededResources(
     const QList< std::shared_ptr<MapRendererBaseResourcesCollection> >& resourcesCollections,
     const TileId centerTileId,
     const QVector<TileId>& activeTiles,
-    const ZoomLevel activeZoom)
+    const ZoomLevel activeZoom,
+    const PointF& motionVector,
+    const QHash< ZoomLevel, QSet<TileId> >& prefetchedTiles)
 {
     _requestedResourcesTasks.resize(0);
     for (const auto& resourcesCollection : constOf(resourcesCollections))
@@ -638,28 +678,41 @@ void OsmAnd::MapRendererResourcesManager::requestNeededResources(
         if (!resourcesCollection)
             continue;
 
-        requestNeededResources(resourcesCollection, activeTiles, activeZoom);
+        requestNeededResources(resourcesCollection, activeTiles, activeZoom, prefetchedTiles);
     }
 
-    _resourcesRequestWorkerPool.enqueue(
-        _requestedResourcesTasks,
-        [centerTileId, activeTiles, activeZoom]
-        (QRunnable* const l_, QRunnable* const r_) -> bool
+    const Concurrent::WorkerPool::PriorityFunction priorityFunction =
+        [centerTileId, activeTiles, activeZoom, motionVector, prefetchedTiles]
+        (QRunnable* const runnable) -> int64_t
         {
-            const auto l = static_cast<ResourceRequestTask*>(l_);
-            const auto r = static_cast<ResourceRequestTask*>(r_);
+            const auto task = static_cast<ResourceRequestTask*>(runnable);
 
-            const auto lPriority = l->calculatePriority(centerTileId, activeTiles, activeZoom);
-            const auto rPriority = r->calculatePriority(centerTileId, activeTiles, activeZoom);
+            return task->calculatePriority(centerTileId, activeTiles, activeZoom, motionVector, prefetchedTiles);
+        };
 
-            return lPriority < rPriority;
-        });
+    // Already queued requests are re-prioritized only if anything that affects priority has changed,
+    // otherwise only new requests need to be prioritized. Requests of tiles that have left active
+    // zone are not re-prioritized but cancelled during junk resources cleanup.
+    RequestsPrioritization prioritization;
+    prioritization.isValid = true;
+    prioritization.centerTileId = centerTileId;
+    prioritization.zoom = activeZoom;
+    prioritization.motionVector = PointI(qRound(motionVector.x), qRound(motionVector.y));
+    prioritization.prefetchedTiles = prefetchedTiles;
+    if (_requestsPrioritization != prioritization)
+    {
+        _resourcesRequestWorkerPool.updatePriorities(priorityFunction);
+        _requestsPrioritization = prioritization;
+    }
+    if (!_requestedResourcesTasks.isEmpty())
+        _resourcesRequestWorkerPool.enqueueWithPriorities(_requestedResourcesTasks, priorityFunction);
 }
 
 void OsmAnd::MapRendererResourcesManager::requestNeededResources(
     const std::shared_ptr<MapRendererBaseResourcesCollection>& resourcesCollection,
     const QVector<TileId>& activeTiles,
-    const ZoomLevel activeZoom)
+    const ZoomLevel activeZoom,
+    const QHash< ZoomLevel, QSet<TileId> >& prefetchedTiles)
 {
     // Skip resource types that do not have an available data source
     std::shared_ptr<IMapDataProvider> mapDataProvider;
@@ -672,7 +725,8 @@ void OsmAnd::MapRendererResourcesManager::requestNeededResources(
         requestNeededTiledResources(
             tiledResourcesCollection,
             activeTiles,
-            activeZoom);
+            activeZoom,
+            prefetchedTiles);
     }
     else if (const auto keyedResourcesCollection =
             std::dynamic_pointer_cast<MapRendererKeyedResourcesCollection>(resourcesCollection))
@@ -685,7 +739,8 @@ void OsmAnd::MapRendererResourcesManager::requestNeededResources(
 void OsmAnd::MapRendererResourcesManager::requestNeededTiledResources(
     const std::shared_ptr<MapRendererTiledResourcesCollection>& resourcesCollection,
     const QVector<TileId>& activeTiles,
-    const ZoomLevel activeZoom)
+    const ZoomLevel activeZoom,
+    const QHash< ZoomLevel, QSet<TileId> >& prefetchedTiles)
 {
     const auto resourceType = resourcesCollection->type;
     const auto resourceAllocator =
@@ -711,6 +766,7 @@ void OsmAnd::MapRendererResourcesManager::requestNeededTiledResources(
     auto maxVisibleZoom = MaxZoomLevel;
 
     bool isMapLayer = resourcesCollection->getType() == MapRendererResourceType::MapLayer;
+    bool isCustomVisibility = false;
     
     if (isMapLayer)
     {
@@ -726,12 +782,30 @@ void OsmAnd::MapRendererResourcesManager::requestNeededTiledResources(
             maxVisibleZoom = tiledProvider->getMaxVisibleZoom();
         }
         
-        bool isCustomVisibility = minZoom != minVisibleZoom || maxZoom != maxVisibleZoom;
-        
-        if (isCustomVisibility && (activeZoom < minVisibleZoom || activeZoom > maxVisibleZoom))
-            return;
+        isCustomVisibility = minZoom != minVisibleZoom || maxZoom != maxVisibleZoom;
+    }
+
+    // Request tiles that are expected to become active soon. Predicted zoom may differ from active one,
+    // so these are requested regardless of visibility at active zoom
+    for (const auto& prefetchedTilesEntry : rangeOf(constOf(prefetchedTiles)))
+    {
+        const auto zoom = prefetchedTilesEntry.key();
+        if (zoom < minZoom || zoom > maxZoom)
+            continue;
+        if (isCustomVisibility && (zoom < minVisibleZoom || zoom > maxVisibleZoom))
+            continue;
+
+        for (const auto& prefetchedTileId : constOf(prefetchedTilesEntry.value()))
+        {
+            std::shared_ptr<MapRendererBaseTiledResource> resource;
+            resourcesCollection->obtainOrAllocateEntry(resource, prefetchedTileId, zoom, resourceAllocator);
+            requestNeededResource(resource);
+        }
     }
 
+    if (isCustomVisibility && (activeZoom < minVisibleZoom || activeZoom > maxVisibleZoom))
+        return;
+
     // Request all tiles on active zoom
     for (const auto& activeTileId : constOf(activeTiles))
     {
@@ -1197,20 +1271,96 @@ bool OsmAnd::MapRendererResourcesManager::checkForUpdatesAndApply(const MapState
 void OsmAnd::MapRendererResourcesManager::updateResources(
     const TileId centerTileId,
     const QVector<TileId>& tiles,
-    const ZoomLevel zoom)
+    const ZoomLevel zoom,
+    const PointF& motionVector)
 {
     QList< std::shared_ptr<MapRendererBaseResourcesCollection> > pendingRemovalResourcesCollections;
     QList< std::shared_ptr<MapRendererBaseResourcesCollection> > otherResourcesCollections;
     safeGetAllResourcesCollections(pendingRemovalResourcesCollections, otherResourcesCollections);
 
+    // Tiles that are not visible yet, but are expected to become visible soon
+    const auto prefetchedTiles = collectPrefetchedTiles(centerTileId, tiles, zoom, motionVector);
+
     // Before requesting missing tiled resources, clean up cache to free some space
     if (!renderer->currentDebugSettings->disableJunkResourcesCleanup)
-        cleanupJunkResources(pendingRemovalResourcesCollections, otherResourcesCollections, tiles, zoom);
+        cleanupJunkResources(pendingRemovalResourcesCollections, otherResourcesCollections, tiles, zoom, prefetchedTiles);
 
     // In the end of rendering processing, request tiled resources that are neither
     // present in requested list, nor in pending, nor in uploaded
     if (!renderer->currentDebugSettings->disableNeededResourcesRequests)
-        requestNeededResources(otherResourcesCollections, centerTileId, tiles, zoom);
+        requestNeededResources(otherResourcesCollections, centerTileId, tiles, zoom, motionVector, prefetchedTiles);
+}
+
+QHash< OsmAnd::ZoomLevel, QSet<OsmAnd::TileId> > OsmAnd::MapRendererResourcesManager::collectPrefetchedTiles(
+    const TileId centerTileId,
+    const QVector<TileId>& activeTiles,
+    const ZoomLevel activeZoom,
+    const PointF& motionVector) const
+{
+    QHash< ZoomLevel, QSet<TileId> > prefetchedTiles;
+
+    const auto maxPrefetchedTilesCount = renderer->setupOptions.maxPrefetchedTilesCount;
+    if (maxPrefetchedTilesCount == 0 || activeTiles.isEmpty())
+        return prefetchedTiles;
+
+    const auto activeTilesSet = activeTiles.toList().toSet();
+    unsigned int prefetchedTilesCount = 0;
+
+    // Area visible from predicted position is approximated by active tiles moved to predicted center tile.
+    // Active tiles are sorted by distance from center, so nearest tiles are taken first if limit is reached.
+    const auto collectAround =
+        [&prefetchedTiles, &prefetchedTilesCount, maxPrefetchedTilesCount, centerTileId, &activeTiles, activeZoom, &activeTilesSet]
+        (const TileId predictedCenterTileId, const ZoomLevel zoom)
+        {
+            const auto tilesCount = static_cast<int32_t>(1u << zoom);
+            for (const auto& activeTileId : constOf(activeTiles))
+            {
+                if (prefetchedTilesCount >= maxPrefetchedTilesCount)
+                    return;
+
+                const auto tileId = TileId::fromXY(
+                    predictedCenterTileId.x + activeTileId.x - centerTileId.x,
+                    predictedCenterTileId.y + activeTileId.y - centerTileId.y);
+                if (tileId.y < 0 || tileId.y >= tilesCount)
+                    continue;
+                const auto normalizedTileId = Utilities::normalizeTileId(tileId, zoom);
+                if (zoom == activeZoom && activeTilesSet.contains(normalizedTileId))
+                    continue;
+
+                auto& prefetchedTilesAtZoom = prefetchedTiles[zoom];
+                if (prefetchedTilesAtZoom.contains(normalizedTileId))
+                    continue;
+                prefetchedTilesAtZoom.insert(normalizedTileId);
+                prefetchedTilesCount++;
+            }
+        };
+
+    // Explicitly predicted positions (e.g. from running animations or a known route) take precedence over
+    // extrapolation of current camera motion
+    const auto predictedCameraPositions = renderer->getPredictedCameraPositions();
+    if (!predictedCameraPositions.isEmpty())
+    {
+        for (const auto& predictedCameraPosition : constOf(predictedCameraPositions))
+        {
+            const auto zoom = predictedCameraPosition.zoomLevel;
+            if (zoom < MinZoomLevel || zoom > MaxZoomLevel)
+                continue;
+
+            const auto predictedCenterTileId = TileId::fromXY(
+                predictedCameraPosition.target31.x >> (ZoomLevel31 - zoom),
+                predictedCameraPosition.target31.y >> (ZoomLevel31 - zoom));
+            collectAround(predictedCenterTileId, zoom);
+        }
+    }
+    else if (motionVector.squareNorm() >= 1.0)
+    {
+        const auto predictedCenterTileId = TileId::fromXY(
+            centerTileId.x + qRound(motionVector.x),
+            centerTileId.y + qRound(motionVector.y));
+        collectAround(predictedCenterTileId, activeZoom);
+    }
+
+    return prefetchedTiles;
 }
 
 unsigned int OsmAnd::MapRendererResourcesManager::unloadResources()
@@ -1381,7 +1531,8 @@ void OsmAnd::MapRendererResourcesManager::cleanupJunkResources(
     const QList< std::shared_ptr<MapRendererBaseResourcesCollection> >& pendingRemovalResourcesCollections,
     const QList< std::shared_ptr<MapRendererBaseResourcesCollection> >& resourcesCollections,
     const QVector<TileId>& activeTiles,
-    const ZoomLevel activeZoom)
+    const ZoomLevel activeZoom,
+    const QHash< ZoomLevel, QSet<TileId> >& prefetchedTiles)
 {
     const auto debugSettings = renderer->getDebugSettings();
 
@@ -1519,7 +1670,7 @@ void OsmAnd::MapRendererResourcesManager::cleanupJunkResources(
             bool isCustomVisibility = minZoom != minVisibleZoom || maxZoom != maxVisibleZoom;
             
             resourcesCollection->removeResources(
-                [this, activeZoom, activeTiles, &needsResourcesUploadOrUnload]
+                [this, activeZoom, activeTiles, &prefetchedTiles, &needsResourcesUploadOrUnload]
                 (const std::shared_ptr<MapRendererBaseResource>& entry, bool& cancel) -> bool
                 {
                     // If it was previously marked as junk, just leave it
@@ -1528,6 +1679,14 @@ void OsmAnd::MapRendererResourcesManager::cleanupJunkResources(
 
                     const auto tiledEntry = std::static_pointer_cast<MapRendererBaseTiledResource>(entry);
 
+                    // Prefetched tiles are not junk while they are still predicted to be needed
+                    const auto citPrefetchedTilesAtZoom = prefetchedTiles.constFind(tiledEntry->zoom);
+                    if (citPrefetchedTilesAtZoom != prefetchedTiles.cend() &&
+                        citPrefetchedTilesAtZoom->contains(tiledEntry->tileId))
+                    {
+                        return false;
+                    }
+
                     // Determine if resource is junk:
                     bool isJunk = false;
                         
@@ -1675,6 +1834,8 @@ void OsmAnd::MapRendererResourcesManager::cleanupJunkResources(
                     }
                 }
             }
+            for (const auto& prefetchedTilesEntry : rangeOf(constOf(prefetchedTiles)))
+                neededTilesMap[prefetchedTilesEntry.key()].unite(prefetchedTilesEntry.value());
             resourcesCollection->removeResources(
                 [this, neededTilesMap, &needsResourcesUploadOrUnload]
                 (const std::shared_ptr<MapRendererBaseResource>& entry, bool& cancel) -> bool
@@ -2317,7 +2478,9 @@ void OsmAnd::MapRendererResourcesManager::ResourceRequestTask::postExecuteWrappe
 int64_t OsmAnd::MapRendererResourcesManager::ResourceRequestTask::calculatePriority(
     const TileId centerTileId,
     const QVector<TileId>& activeTiles,
-    const ZoomLevel activeZoom) const
+    const ZoomLevel activeZoom,
+    const PointF& motionVector,
+    const QHash< ZoomLevel, QSet<TileId> >& prefetchedTiles) const
 {
     // Priority calculation does not need to be stable
 
@@ -2348,11 +2511,60 @@ int64_t OsmAnd::MapRendererResourcesManager::ResourceRequestTask::calculatePrior
             break;
     }
 
+    // Prefetched resources go after all resources that are needed right now
+    const auto citPrefetchedTilesAtZoom = prefetchedTiles.constFind(tiledResource->zoom);
+    if (citPrefetchedTilesAtZoom != prefetchedTiles.cend() &&
+        citPrefetchedTilesAtZoom->contains(tiledResource->tileId))
+    {
+        priority -= 4000000000;
+    }
+
     priority -= qAbs(static_cast<int>(tiledResource->zoom) - static_cast<int>(activeZoom)) * 10000000;
 
-    const auto dX = tiledResource->tileId.x - centerTileId.x;
-    const auto dY = tiledResource->tileId.y - centerTileId.y;
-    priority -= dX*dX + dY*dY;
+    // Distance is measured to the path that center is about to pass, so that tiles ahead of moving camera
+    // are not delayed by tiles that are about to leave active zone
+    const auto zoomShift = static_cast<int>(tiledResource->zoom) - static_cast<int>(activeZoom);
+    auto tileOffset = PointF(
+        tiledResource->tileId.x - centerTileId.x,
+        tiledResource->tileId.y - centerTileId.y);
+    auto pathVector = motionVector;
+    if (zoomShift > 0)
+        pathVector *= static_cast<float>(1u << zoomShift);
+    else if (zoomShift < 0)
+        pathVector /= static_cast<float>(1u << -zoomShift);
+    const auto pathLengthSquared = static_cast<float>(pathVector.squareNorm());
+    if (pathLengthSquared > 0.0f)
+    {
+        const auto t = qBound(
+            0.0f,
+            (tileOffset.x * pathVector.x + tileOffset.y * pathVector.y) / pathLengthSquared,
+            1.0f);
+        tileOffset -= pathVector * t;
+    }
+    priority -= qRound64(tileOffset.squareNorm());
 
     return priority;
 }
+
+OsmAnd::MapRendererResourcesManager::RequestsPrioritization::RequestsPrioritization()
+    : isValid(false)
+    , zoom(InvalidZoomLevel)
+{
+}
+
+bool OsmAnd::MapRendererResourcesManager::RequestsPrioritization::operator==(
+    const RequestsPrioritization& that) const
+{
+    return
+        isValid == that.isValid &&
+        centerTileId == that.centerTileId &&
+        zoom == that.zoom &&
+        motionVector == that.motionVector &&
+        prefetchedTiles == that.prefetchedTiles;
+}
+
+bool OsmAnd::MapRendererResourcesManager::RequestsPrioritization::operator!=(
+    const RequestsPrioritization& that) const
+{
+    return !(*this == that);
+}
@@ -13,6 +13,7 @@
 #include <QReadWriteLock>
 #include <QWaitCondition>
 #include <QVector>
+#include <QElapsedTimer>
 #include "restore_internal_warnings.h"
 
 #include "OsmAndCore.h"
@@ -59,6 +60,14 @@ namespace OsmAnd
             QList< std::shared_ptr<MapRendererBaseResourcesCollection> >,
             MapRendererResourceTypesCount > ResourcesStorage;
 
+        enum {
+            // Camera motion is extrapolated this far ahead to promote requests of tiles that are about to be visible
+            MotionLookaheadInMilliseconds = 500,
+
+            // Camera that has not moved for that long is considered still
+            MaxMotionEstimationIntervalInMilliseconds = 250,
+        };
+
     private:
         // Resource-requests related:
         const Concurrent::TaskHost::Bridge _taskHostBridge;
@@ -86,7 +95,9 @@ namespace OsmAnd
             int64_t calculatePriority(
                 const TileId centerTileId,
                 const QVector<TileId>& activeTiles,
-                const ZoomLevel activeZoom) const;
+                const ZoomLevel activeZoom,
+                const PointF& motionVector,
+                const QHash< ZoomLevel, QSet<TileId> >& prefetchedTiles) const;
         };
         void setResourceWorkerThreadsLimit(const unsigned int limit);
         void resetResourceWorkerThreadsLimit();
@@ -140,26 +151,53 @@ namespace OsmAnd
         TileId _centerTileId;
         QVector<TileId> _activeTiles;
         ZoomLevel _activeZoom;
+        PointI _activeZoneTarget31;
+        PointF _activeZoneVelocity31;
+        QElapsedTimer _activeZoneUpdateTimer;
         QVector<QRunnable*> _requestedResourcesTasks;
+        struct RequestsPrioritization
+        {
+            RequestsPrioritization();
+
+            bool isValid;
+            TileId centerTileId;
+            ZoomLevel zoom;
+            PointI motionVector;
+            QHash< ZoomLevel, QSet<TileId> > prefetchedTiles;
+
+            bool operator==(const RequestsPrioritization& that) const;
+            bool operator!=(const RequestsPrioritization& that) const;
+        };
+        RequestsPrioritization _requestsPrioritization;
         bool updatesPresent() const;
         virtual bool checkForUpdatesAndApply(const MapState& mapState) const;
         void updateResources(
             const TileId centerTileId,
             const QVector<TileId>& tiles,
-            const ZoomLevel zoom);
+            const ZoomLevel zoom,
+            const PointF& motionVector);
+        QHash< ZoomLevel, QSet<TileId> > collectPrefetchedTiles(
+            const TileId centerTileId,
+            const QVector<TileId>& activeTiles,
+            const ZoomLevel activeZoom,
+            const PointF& motionVector) const;
         void requestNeededResources(
             const QList< std::shared_ptr<MapRendererBaseResourcesCollection> >& resourcesCollections,
             const TileId centerTileId,
             const QVector<TileId>& activeTiles,
-            const ZoomLevel activeZoom);
+            const ZoomLevel activeZoom,
+            const PointF& motionVector,
+            const QHash< ZoomLevel, QSet<TileId> >& prefetchedTiles);
         void requestNeededResources(
             const std::shared_ptr<MapRendererBaseResourcesCollection>& resourcesCollection,
             const QVector<TileId>& tiles,
-            const ZoomLevel zoom);
+            const ZoomLevel zoom,
+            const QHash< ZoomLevel, QSet<TileId> >& prefetchedTiles);
         void requestNeededTiledResources(
             const std::shared_ptr<MapRendererTiledResourcesCollection>& resourcesCollection,
             const QVector<TileId>& tiles,
-            const ZoomLevel zoom);
+            const ZoomLevel zoom,
+            const QHash< ZoomLevel, QSet<TileId> >& prefetchedTiles);
         void requestNeededKeyedResources(
             const std::shared_ptr<MapRendererKeyedResourcesCollection>& resourcesCollection);
         void requestNeededResource(
@@ -174,7 +212,8 @@ namespace OsmAnd
             const QList< std::shared_ptr<MapRendererBaseResourcesCollection> >& pendingRemovalResourcesCollections,
             const QList< std::shared_ptr<MapRendererBaseResourcesCollection> >& resourcesCollections,
             const QVector<TileId>& activeTiles,
-            const ZoomLevel activeZoom);
+            const ZoomLevel activeZoom,
+            const QHash< ZoomLevel, QSet<TileId> >& prefetchedTiles);
         bool cleanupJunkResource(
             const std::shared_ptr<MapRendererBaseResource>& resource,
             bool& needsResourcesUploadOrUnload);
@@ -226,7 +265,11 @@ namespace OsmAnd
         void updateMapLayerProviderBindings(const MapRendererState& state);
         void updateSymbolProviderBindings(const MapRendererState& state);
 
-        void updateActiveZone(const TileId centerTileId, const QVector<TileId>& tiles, const ZoomLevel zoom);
+        void updateActiveZone(
+            const PointI& target31,
+            const TileId centerTileId,
+            const QVector<TileId>& tiles,
+            const ZoomLevel zoom);
         void syncResourcesInGPU(
             const unsigned int limitUploads = 0u,
             bool* const outMoreUploadsThanLimitAvailable = nullptr,
@@ -0,0 +1,180 @@
+#include "MapStyleCompiledRules.h"
+
+#include "QtCommon.h"
+
+#include "MapStyleBuiltinValueDefinitions.h"
+#include "MapStyleValueDefinition.h"
+#include "QKeyValueIterator.h"
+
+const OsmAnd::MapStyleCompiledRules::NodeIndex OsmAnd::MapStyleCompiledRules::InvalidNodeIndex =
+    std::numeric_limits<OsmAnd::MapStyleCompiledRules::NodeIndex>::max();
+
+OsmAnd::MapStyleCompiledRules::MapStyleCompiledRules(const IMapStyle* const mapStyle)
+    : _mapStyle(mapStyle)
+    , _builtinValueDefs(MapStyleBuiltinValueDefinitions::get())
+{
+    const auto mapStyleAttributes = _mapStyle->getAttributes();
+    for (const auto& attribute : constOf(mapStyleAttributes))
+        compileAttribute(attribute);
+
+    for (auto rulesetTypeIdx = 0u; rulesetTypeIdx < MapStyleRulesetTypesCount; rulesetTypeIdx++)
+    {
+        const auto rulesetType = static_cast<MapStyleRulesetType>(rulesetTypeIdx);
+        const auto ruleset = _mapStyle->getRuleset(rulesetType);
+
+        auto& compiledRuleset = rulesets[rulesetTypeIdx];
+        compiledRuleset.reserve(ruleset.size());
+        for (const auto& ruleEntry : rangeOf(constOf(ruleset)))
+            compiledRuleset.insert(ruleEntry.key(), compileNode(ruleEntry.value()->getRootNodeRef()));
+    }
+
+    // Compilation state is not needed anymore
+    _compiledNodes.clear();
+    nodes.squeeze();
+    conditions.squeeze();
+    outputs.squeeze();
+    subnodes.squeeze();
+}
+
+OsmAnd::MapStyleCompiledRules::~MapStyleCompiledRules()
+{
+}
+
+void OsmAnd::MapStyleCompiledRules::compileAttribute(const std::shared_ptr<const IMapStyle::IAttribute>& attribute)
+{
+    if (!attribute || attributes.contains(attribute.get()))
+        return;
+
+    // Register attribute before compiling its tree, since it may reference itself
+    attributes.insert(attribute.get(), InvalidNodeIndex);
+    attributes[attribute.get()] = compileNode(attribute->getRootNodeRef());
+}
+
+void OsmAnd::MapStyleCompiledRules::compileValue(const IMapStyle::Value& value)
+{
+    if (value.isDynamic)
+        compileAttribute(value.asDynamicValue.attribute);
+}
+
+OsmAnd::MapStyleCompiledRules::NodeIndex OsmAnd::MapStyleCompiledRules::compileNode(
+    const std::shared_ptr<const IMapStyle::IRuleNode>& ruleNode)
+{
+    const auto citCompiledNode = _compiledNodes.constFind(ruleNode.get());
+    if (citCompiledNode != _compiledNodes.cend())
+        return *citCompiledNode;
+
+    // Reserve slot for this node before compiling anything it references, so that nested compilation
+    // never reuses its index
+    const auto nodeIndex = static_cast<NodeIndex>(nodes.size());
+    _compiledNodes.insert(ruleNode.get(), nodeIndex);
+    nodes.push_back(Node());
+
+    // Attributes referenced by values append own conditions and outputs, so compile them before
+    // ranges of this node are recorded
+    const auto& ruleNodeValues = ruleNode->getValuesRef();
+    for (const auto& value : constOf(ruleNodeValues))
+        compileValue(value);
+
+    Node node;
+    node.isSwitch = ruleNode->getIsSwitch();
+    node.hasDisableValue = false;
+
+    // Classify values of the node once: inputs become conditions, outputs are stored as-is
+    node.conditionsOffset = conditions.size();
+    node.outputsOffset = outputs.size();
+    for (const auto& ruleValueEntry : rangeOf(constOf(ruleNodeValues)))
+    {
+        const auto valueDefId = ruleValueEntry.key();
+        const auto& value = ruleValueEntry.value();
+        const auto& valueDef = _mapStyle->getValueDefinitionRefById(valueDefId);
+
+        if (valueDefId == _builtinValueDefs->id_OUTPUT_DISABLE)
+        {
+            node.hasDisableValue = true;
+            node.disableValue = value;
+        }
+
+        if (valueDef->valueClass == MapStyleValueDefinition::Class::Output)
+        {
+            Output output;
+            output.valueDefId = valueDefId;
+            output.value = value;
+            outputs.push_back(qMove(output));
+            continue;
+        }
+        if (valueDef->valueClass != MapStyleValueDefinition::Class::Input)
+            continue;
+
+        Condition condition;
+        condition.valueDefId = valueDefId;
+        condition.dataType = valueDef->dataType;
+        condition.value = value;
+        condition.additionalHasValue = false;
+        if (valueDefId == _builtinValueDefs->id_INPUT_MINZOOM)
+            condition.type = ConditionType::MinZoom;
+        else if (valueDefId == _builtinValueDefs->id_INPUT_MAXZOOM)
+            condition.type = ConditionType::MaxZoom;
+        else if (valueDefId == _builtinValueDefs->id_INPUT_ADDITIONAL)
+        {
+            condition.type = ConditionType::Additional;
+            if (!value.isDynamic && !value.asConstantValue.isComplex)
+            {
+                const auto valueString = _mapStyle->getStringById(value.asConstantValue.asSimple.asUInt);
+                const auto equalSignIdx = valueString.indexOf(QLatin1Char('='));
+                if (equalSignIdx >= 0)
+                {
+                    condition.additionalHasValue = true;
+                    condition.additionalTag = valueString.mid(0, equalSignIdx);
+                    condition.additionalValue = valueString.mid(equalSignIdx + 1);
+                }
+                else
+                    condition.additionalTag = valueString;
+            }
+        }
+        else if (valueDefId == _builtinValueDefs->id_INPUT_TEST)
+            condition.type = ConditionType::Test;
+        else if (valueDef->dataType == MapStyleValueDataType::Float)
+            condition.type = ConditionType::Float;
+        else
+            condition.type = ConditionType::Integer;
+        conditions.push_back(qMove(condition));
+    }
+    node.conditionsCount = conditions.size() - node.conditionsOffset;
+    node.outputsCount = outputs.size() - node.outputsOffset;
+
+    // Compile subnodes first, since they append own subnodes while being compiled
+    QVector<NodeIndex> oneOfConditionalSubnodes;
+    for (const auto& subnode : constOf(ruleNode->getOneOfConditionalSubnodesRef()))
+        oneOfConditionalSubnodes.push_back(compileNode(subnode));
+    QVector<NodeIndex> applySubnodes;
+    for (const auto& subnode : constOf(ruleNode->getApplySubnodesRef()))
+        applySubnodes.push_back(compileNode(subnode));
+
+    node.oneOfConditionalSubnodesOffset = subnodes.size();
+    node.oneOfConditionalSubnodesCount = oneOfConditionalSubnodes.size();
+    subnodes += oneOfConditionalSubnodes;
+    node.applySubnodesOffset = subnodes.size();
+    node.applySubnodesCount = applySubnodes.size();
+    subnodes += applySubnodes;
+
+    nodes[nodeIndex] = node;
+
+    return nodeIndex;
+}
+
+OsmAnd::MapStyleCompiledRules::NodeIndex OsmAnd::MapStyleCompiledRules::findRule(
+    const MapStyleRulesetType rulesetType,
+    const TagValueId tagValueId) const
+{
+    const auto& ruleset = rulesets[static_cast<unsigned int>(rulesetType)];
+    const auto citRule = ruleset.constFind(tagValueId);
+    if (citRule == ruleset.cend())
+        return InvalidNodeIndex;
+    return *citRule;
+}
+
+OsmAnd::MapStyleCompiledRules::NodeIndex OsmAnd::MapStyleCompiledRules::findAttribute(
+    const IMapStyle::IAttribute* const attribute) const
+{
+    return attributes.value(attribute, InvalidNodeIndex);
+}
@@ -0,0 +1,103 @@
+#ifndef _OSMAND_CORE_MAP_STYLE_COMPILED_RULES_H_
+#define _OSMAND_CORE_MAP_STYLE_COMPILED_RULES_H_
+
+#include "stdlib_common.h"
+#include <array>
+
+#include "QtExtensions.h"
+#include "ignore_warnings_on_external_includes.h"
+#include <QString>
+#include <QVector>
+#include <QHash>
+#include "restore_internal_warnings.h"
+
+#include "OsmAndCore.h"
+#include "MapCommonTypes.h"
+#include "MapStyleConstantValue.h"
+#include "IMapStyle.h"
+
+namespace OsmAnd
+{
+    class MapStyleBuiltinValueDefinitions;
+
+    // Flat form of all rules and attributes of a map style. Each rule node becomes a record that references
+    // contiguous ranges of input conditions, outputs and subnodes. Conditions are already classified by kind, so
+    // evaluation needs no hash iteration, value-definition lookups or string parsing.
+    class MapStyleCompiledRules Q_DECL_FINAL
+    {
+        Q_DISABLE_COPY_AND_MOVE(MapStyleCompiledRules);
+    public:
+        typedef uint32_t NodeIndex;
+        static const NodeIndex InvalidNodeIndex;
+
+        enum class ConditionType : uint8_t
+        {
+            MinZoom,
+            MaxZoom,
+            Additional,
+            Test,
+            Float,
+            Integer,
+        };
+
+        struct Condition
+        {
+            IMapStyle::ValueDefinitionId valueDefId;
+            ConditionType type;
+            MapStyleValueDataType dataType;
+            IMapStyle::Value value;
+
+            // Constant 'additional' condition is split into tag and (optional) value once
+            bool additionalHasValue;
+            QString additionalTag;
+            QString additionalValue;
+        };
+
+        struct Output
+        {
+            IMapStyle::ValueDefinitionId valueDefId;
+            IMapStyle::Value value;
+        };
+
+        struct Node
+        {
+            bool isSwitch;
+            bool hasDisableValue;
+            IMapStyle::Value disableValue;
+
+            unsigned int conditionsOffset;
+            unsigned int conditionsCount;
+            unsigned int outputsOffset;
+            unsigned int outputsCount;
+            unsigned int oneOfConditionalSubnodesOffset;
+            unsigned int oneOfConditionalSubnodesCount;
+            unsigned int applySubnodesOffset;
+            unsigned int applySubnodesCount;
+        };
+
+    private:
+        const IMapStyle* const _mapStyle;
+        const std::shared_ptr<const MapStyleBuiltinValueDefinitions> _builtinValueDefs;
+        QHash<const IMapStyle::IRuleNode*, NodeIndex> _compiledNodes;
+
+        NodeIndex compileNode(const std::shared_ptr<const IMapStyle::IRuleNode>& ruleNode);
+        void compileValue(const IMapStyle::Value& value);
+        void compileAttribute(const std::shared_ptr<const IMapStyle::IAttribute>& attribute);
+    protected:
+    public:
+        MapStyleCompiledRules(const IMapStyle* const mapStyle);
+        ~MapStyleCompiledRules();
+
+        QVector<Node> nodes;
+        QVector<Condition> conditions;
+        QVector<Output> outputs;
+        QVector<NodeIndex> subnodes;
+        std::array< QHash<TagValueId, NodeIndex>, MapStyleRulesetTypesCount > rulesets;
+        QHash<const IMapStyle::IAttribute*, NodeIndex> attributes;
+
+        NodeIndex findRule(const MapStyleRulesetType rulesetType, const TagValueId tagValueId) const;
+        NodeIndex findAttribute(const IMapStyle::IAttribute* const attribute) const;
+    };
+}
+
+#endif // !defined(_OSMAND_CORE_MAP_STYLE_COMPILED_RULES_H_)
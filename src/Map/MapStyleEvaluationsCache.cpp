@@ -0,0 +1,199 @@
+#include "MapStyleEvaluationsCache.h"
+
+#include "QtCommon.h"
+
+static unsigned int roundUpToPowerOfTwo(const unsigned int value)
+{
+    unsigned int result = 1u;
+    while (result < value)
+        result <<= 1;
+    return result;
+}
+
+OsmAnd::MapStyleEvaluationsCache::MapStyleEvaluationsCache(const unsigned int capacity_ /*= DefaultCapacity*/)
+    : _capacity(roundUpToPowerOfTwo(qMax(capacity_, static_cast<unsigned int>(MaxProbesCount))))
+    , _table(new Table(_capacity))
+    , _generation(0)
+    , _activeUsers(0)
+{
+}
+
+OsmAnd::MapStyleEvaluationsCache::~MapStyleEvaluationsCache()
+{
+    delete _table.loadAcquire();
+    for (const auto retiredTable : constOf(_retiredTables))
+        delete retiredTable;
+}
+
+unsigned int OsmAnd::MapStyleEvaluationsCache::getGeneration() const
+{
+    return static_cast<unsigned int>(_generation.loadAcquire());
+}
+
+bool OsmAnd::MapStyleEvaluationsCache::lookup(
+    const Key& key,
+    const unsigned int generation,
+    bool& outAccepted,
+    MapStyleEvaluationResult& outResult) const
+{
+    const auto hash = key.hash();
+
+    bool found = false;
+    _activeUsers.ref();
+    const auto table = _table.loadAcquire();
+    const auto mask = table->capacity - 1;
+    for (auto probeIdx = 0u; probeIdx < MaxProbesCount; probeIdx++)
+    {
+        const auto entry = table->slots[(hash + probeIdx) & mask].loadAcquire();
+
+        // Slots are filled sequentially along probe sequence, so empty slot ends it
+        if (!entry)
+            break;
+        if (entry->hash != hash || entry->generation != generation || !(entry->key == key))
+            continue;
+
+        outAccepted = entry->accepted;
+        outResult.clear();
+        for (const auto& resultEntry : constOf(entry->result.entries))
+            outResult.setValue(resultEntry.first, resultEntry.second);
+        found = true;
+        break;
+    }
+    _activeUsers.deref();
+
+    return found;
+}
+
+void OsmAnd::MapStyleEvaluationsCache::insert(
+    const Key& key,
+    const unsigned int generation,
+    const bool accepted,
+    const MapStyleEvaluationResult& result)
+{
+    if (generation != getGeneration())
+        return;
+
+    const auto entry = new Entry();
+    entry->hash = key.hash();
+    entry->generation = generation;
+    entry->key = key;
+    entry->accepted = accepted;
+    result.pack(entry->result);
+
+    bool inserted = false;
+    bool isTableFull = false;
+    _activeUsers.ref();
+    const auto table = _table.loadAcquire();
+    const auto mask = table->capacity - 1;
+    for (auto probeIdx = 0u; probeIdx < MaxProbesCount; probeIdx++)
+    {
+        auto& slot = table->slots[(entry->hash + probeIdx) & mask];
+        if (slot.testAndSetOrdered(nullptr, entry))
+        {
+            inserted = true;
+            isTableFull = (static_cast<unsigned int>(table->size.fetchAndAddOrdered(1) + 1) * 4u >= table->capacity * 3u);
+            break;
+        }
+
+        // Same result may have been stored concurrently by another thread
+        const auto existingEntry = slot.loadAcquire();
+        if (existingEntry->hash == entry->hash && existingEntry->generation == generation && existingEntry->key == key)
+            break;
+    }
+    if (!inserted)
+        isTableFull = (static_cast<unsigned int>(table->size.loadAcquire()) * 4u >= table->capacity * 3u);
+    _activeUsers.deref();
+
+    if (!inserted)
+        delete entry;
+
+    // Once table becomes crowded, start over with an empty one instead of evicting single entries
+    if (isTableFull)
+        replaceTable();
+    else
+        releaseRetiredTables();
+}
+
+void OsmAnd::MapStyleEvaluationsCache::clear()
+{
+    _generation.fetchAndAddOrdered(1);
+    replaceTable();
+}
+
+void OsmAnd::MapStyleEvaluationsCache::replaceTable()
+{
+    QMutexLocker scopedLocker(&_retiredTablesMutex);
+
+    const auto oldTable = _table.fetchAndStoreOrdered(new Table(_capacity));
+    _retiredTables.push_back(oldTable);
+
+    scopedLocker.unlock();
+    releaseRetiredTables();
+}
+
+void OsmAnd::MapStyleEvaluationsCache::releaseRetiredTables()
+{
+    // Tables can be retired only after they were replaced, so if no one is using cache right now,
+    // no one can be using any of retired tables
+    if (_activeUsers.loadAcquire() != 0)
+        return;
+
+    QMutexLocker scopedLocker(&_retiredTablesMutex);
+    if (_retiredTables.isEmpty() || _activeUsers.loadAcquire() != 0)
+        return;
+
+    const auto retiredTables = qMove(_retiredTables);
+    _retiredTables.clear();
+    scopedLocker.unlock();
+
+    for (const auto retiredTable : constOf(retiredTables))
+        delete retiredTable;
+}
+
+OsmAnd::MapStyleEvaluationsCache::Table::Table(const unsigned int capacity_)
+    : capacity(capacity_)
+    , size(0)
+    , slots(new QAtomicPointer<const Entry>[capacity_])
+{
+}
+
+OsmAnd::MapStyleEvaluationsCache::Table::~Table()
+{
+    for (auto idx = 0u; idx < capacity; idx++)
+        delete slots[idx].loadAcquire();
+    delete[] slots;
+}
+
+OsmAnd::MapStyleEvaluationsCache::Key::Key()
+    : rulesetType(MapStyleRulesetType::Invalid)
+    , zoom(InvalidZoomLevel)
+    , layer(0)
+    , isArea(false)
+    , isPoint(false)
+    , isCycle(false)
+{
+}
+
+bool OsmAnd::MapStyleEvaluationsCache::Key::operator==(const Key& that) const
+{
+    return
+        rulesetType == that.rulesetType &&
+        zoom == that.zoom &&
+        layer == that.layer &&
+        isArea == that.isArea &&
+        isPoint == that.isPoint &&
+        isCycle == that.isCycle &&
+        tag == that.tag &&
+        value == that.value;
+}
+
+uint OsmAnd::MapStyleEvaluationsCache::Key::hash() const
+{
+    uint seed = static_cast<uint>(rulesetType);
+    seed = seed * 31u + static_cast<uint>(zoom);
+    seed = seed * 31u + static_cast<uint>(layer);
+    seed = seed * 31u + (isArea ? 1u : 0u) + (isPoint ? 2u : 0u) + (isCycle ? 4u : 0u);
+    seed = seed * 31u + qHash(tag);
+    seed = seed * 31u + qHash(value);
+    return seed;
+}
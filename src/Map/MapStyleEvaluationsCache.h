@@ -0,0 +1,106 @@
+#ifndef _OSMAND_CORE_MAP_STYLE_EVALUATIONS_CACHE_H_
+#define _OSMAND_CORE_MAP_STYLE_EVALUATIONS_CACHE_H_
+
+#include "stdlib_common.h"
+
+#include "QtExtensions.h"
+#include "ignore_warnings_on_external_includes.h"
+#include <QString>
+#include <QList>
+#include <QMutex>
+#include <QAtomicInt>
+#include <QAtomicPointer>
+#include "restore_internal_warnings.h"
+
+#include "OsmAndCore.h"
+#include "CommonTypes.h"
+#include "MapCommonTypes.h"
+#include "MapStyleEvaluationResult.h"
+
+namespace OsmAnd
+{
+    // Bounded memo of style evaluation results, keyed by everything that evaluator inputs consist of for a
+    // single tag+value of a map object. Results that depended on map object itself (e.g. its additional tags)
+    // must never be stored. Lookups take no locks: table slots are filled once and tables are only replaced
+    // as a whole, with replaced tables released once no lookup is in progress.
+    class MapStyleEvaluationsCache Q_DECL_FINAL
+    {
+        Q_DISABLE_COPY_AND_MOVE(MapStyleEvaluationsCache);
+    public:
+        enum {
+            DefaultCapacity = 16384,
+            MaxProbesCount = 8,
+        };
+
+        struct Key Q_DECL_FINAL
+        {
+            Key();
+
+            MapStyleRulesetType rulesetType;
+            ZoomLevel zoom;
+            int layer;
+            bool isArea;
+            bool isPoint;
+            bool isCycle;
+            QString tag;
+            QString value;
+
+            bool operator==(const Key& that) const;
+            uint hash() const;
+        };
+
+    private:
+        struct Entry Q_DECL_FINAL
+        {
+            uint hash;
+            unsigned int generation;
+            Key key;
+            bool accepted;
+            MapStyleEvaluationResult::Packed result;
+        };
+
+        struct Table Q_DECL_FINAL
+        {
+            Table(const unsigned int capacity);
+            ~Table();
+
+            const unsigned int capacity;
+            QAtomicInt size;
+            QAtomicPointer<const Entry>* const slots;
+
+        private:
+            Q_DISABLE_COPY_AND_MOVE(Table);
+        };
+
+        const unsigned int _capacity;
+        QAtomicPointer<Table> _table;
+        QAtomicInt _generation;
+        mutable QAtomicInt _activeUsers;
+
+        QMutex _retiredTablesMutex;
+        QList<Table*> _retiredTables;
+        void replaceTable();
+        void releaseRetiredTables();
+    protected:
+    public:
+        MapStyleEvaluationsCache(const unsigned int capacity = DefaultCapacity);
+        ~MapStyleEvaluationsCache();
+
+        // Generation changes on each clear(), results of older generations are never returned
+        unsigned int getGeneration() const;
+
+        bool lookup(
+            const Key& key,
+            const unsigned int generation,
+            bool& outAccepted,
+            MapStyleEvaluationResult& outResult) const;
+        void insert(
+            const Key& key,
+            const unsigned int generation,
+            const bool accepted,
+            const MapStyleEvaluationResult& result);
+        void clear();
+    };
+}
+
+#endif // !defined(_OSMAND_CORE_MAP_STYLE_EVALUATIONS_CACHE_H_)
@@ -58,3 +58,8 @@ bool OsmAnd::MapStyleEvaluator::evaluate(
 {
     return _p->evaluate(attribute, outResultStorage);
 }
+
+bool OsmAnd::MapStyleEvaluator::wasMapObjectInspected() const
+{
+    return _p->wasMapObjectInspected();
+}
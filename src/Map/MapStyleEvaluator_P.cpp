@@ -1,5 +1,7 @@
 #include "MapStyleEvaluator_P.h"
 #include "MapStyleEvaluator.h"
+#include "ResolvedMapStyle.h"
+#include "ResolvedMapStyle_P.h"
 
 #include "stdlib_common.h"
 #include <cassert>
@@ -17,6 +19,7 @@
 
 OsmAnd::MapStyleEvaluator_P::MapStyleEvaluator_P(MapStyleEvaluator* owner_)
     : _builtinValueDefs(MapStyleBuiltinValueDefinitions::get())
+    , _mapObjectInspected(false)
     , owner(owner_)
     , intermediateEvaluationResultAllocator(std::bind(&MapStyleEvaluator_P::allocateIntermediateEvaluationResult, this))
 {
@@ -30,6 +33,12 @@ void OsmAnd::MapStyleEvaluator_P::prepare()
 {
     const auto valueDefinitionsCount = owner->mapStyle->getValueDefinitionsCount();
 
+    // Resolved map style provides rules compiled ahead-of-time, for other styles compile them here
+    if (const auto resolvedMapStyle = std::dynamic_pointer_cast<const ResolvedMapStyle>(owner->mapStyle))
+        _compiledRules = resolvedMapStyle->_p->_compiledRules;
+    if (!_compiledRules)
+        _compiledRules.reset(new MapStyleCompiledRules(owner->mapStyle.get()));
+
     _inputValues.reset(new ArrayMap<InputValue>(valueDefinitionsCount));
     _inputValuesShadow.reset(new ArrayMap<InputValue>(valueDefinitionsCount));
     _intermediateEvaluationResult.reset(new ArrayMap<IMapStyle::Value>(valueDefinitionsCount));
@@ -56,7 +65,7 @@ OsmAnd::MapStyleConstantValue OsmAnd::MapStyleEvaluator_P::evaluateConstantValue
     OnDemand<IntermediateEvaluationResult> innerConstantEvaluationResult(intermediateEvaluationResultAllocator);
     evaluate(
         mapObject,
-        resolvedValue.asDynamicValue.attribute->getRootNodeRef(),
+        _compiledRules->findAttribute(resolvedValue.asDynamicValue.attribute.get()),
         inputValues,
         wasDisabled,
         intermediateEvaluationResult.get(),
@@ -95,17 +104,15 @@ OsmAnd::MapStyleConstantValue OsmAnd::MapStyleEvaluator_P::evaluateConstantValue
 
 bool OsmAnd::MapStyleEvaluator_P::evaluate(
     const std::shared_ptr<const MapObject>& mapObject,
-    const QHash< TagValueId, std::shared_ptr<const IMapStyle::IRule> >& ruleset,
+    const MapStyleRulesetType rulesetType,
     const ResolvedMapStyle::StringId tagStringId,
     const ResolvedMapStyle::StringId valueStringId,
     MapStyleEvaluationResult* const outResultStorage,
     OnDemand<IntermediateEvaluationResult>& constantEvaluationResult) const
 {
-    const auto ruleId = TagValueId::compose(tagStringId, valueStringId);
-    const auto citRule = ruleset.constFind(ruleId);
-    if (citRule == ruleset.cend())
+    const auto ruleNodeIndex = _compiledRules->findRule(rulesetType, TagValueId::compose(tagStringId, valueStringId));
+    if (ruleNodeIndex == MapStyleCompiledRules::InvalidNodeIndex)
         return false;
-    const auto& rule = *citRule;
 
     InputValue inputTag;
     inputTag.asUInt = tagStringId;
@@ -121,7 +128,7 @@ bool OsmAnd::MapStyleEvaluator_P::evaluate(
     bool wasDisabled = false;
     const auto success = evaluate(
         mapObject.get(),
-        rule->getRootNodeRef(),
+        ruleNodeIndex,
         _inputValuesShadow,
         wasDisabled,
         _intermediateEvaluationResult.get(),
@@ -142,99 +149,112 @@ bool OsmAnd::MapStyleEvaluator_P::evaluate(
     return true;
 }
 
-bool OsmAnd::MapStyleEvaluator_P::evaluate(
+bool OsmAnd::MapStyleEvaluator_P::evaluateCondition(
     const MapObject* const mapObject,
-    const std::shared_ptr<const IMapStyle::IRuleNode>& ruleNode,
+    const MapStyleCompiledRules::Condition& condition,
     const std::shared_ptr<const InputValues>& inputValues,
-    bool& outDisabled,
-    IntermediateEvaluationResult* const outResultStorage,
     OnDemand<IntermediateEvaluationResult>& constantEvaluationResult) const
 {
-    // Check all values of a rule until all are checked.
-    const auto& ruleNodeValues = ruleNode->getValuesRef();
-    for (const auto& ruleValueEntry : rangeOf(constOf(ruleNodeValues)))
-    {
-        const auto valueDefId = ruleValueEntry.key();
-        const auto& valueDef = owner->mapStyle->getValueDefinitionRefById(valueDefId);
-
-        // Test only input values
-        if (valueDef->valueClass != MapStyleValueDefinition::Class::Input)
-            continue;
-
-        const auto constantRuleValue = evaluateConstantValue(
-            mapObject,
-            valueDef->dataType,
-            ruleValueEntry.value(),
-            inputValues,
-            constantEvaluationResult);
+    const auto constantRuleValue = evaluateConstantValue(
+        mapObject,
+        condition.dataType,
+        condition.value,
+        inputValues,
+        constantEvaluationResult);
 
-        InputValue inputValue;
-        inputValues->get(valueDefId, inputValue);
+    InputValue inputValue;
+    inputValues->get(condition.valueDefId, inputValue);
 
-        bool evaluationResult = false;
-        if (valueDefId == _builtinValueDefs->id_INPUT_MINZOOM)
-        {
+    switch (condition.type)
+    {
+        case MapStyleCompiledRules::ConditionType::MinZoom:
             assert(!constantRuleValue.isComplex);
-            evaluationResult = (constantRuleValue.asSimple.asInt <= inputValue.asInt);
-        }
-        else if (valueDefId == _builtinValueDefs->id_INPUT_MAXZOOM)
-        {
+            return (constantRuleValue.asSimple.asInt <= inputValue.asInt);
+
+        case MapStyleCompiledRules::ConditionType::MaxZoom:
             assert(!constantRuleValue.isComplex);
-            evaluationResult = (constantRuleValue.asSimple.asInt >= inputValue.asInt);
-        }
-        else if (valueDefId == _builtinValueDefs->id_INPUT_ADDITIONAL)
+            return (constantRuleValue.asSimple.asInt >= inputValue.asInt);
+
+        case MapStyleCompiledRules::ConditionType::Additional:
         {
             if (!mapObject)
-                evaluationResult = constantRuleValue.asSimple.asInt == inputValue.asInt;
-            else
+                return constantRuleValue.asSimple.asInt == inputValue.asInt;
+            assert(!constantRuleValue.isComplex);
+            _mapObjectInspected = true;
+
+            // Constant condition was already split during compilation
+            if (!condition.value.isDynamic)
             {
-                assert(!constantRuleValue.isComplex);
-                const auto valueString = owner->mapStyle->getStringById(constantRuleValue.asSimple.asUInt);
-                auto equalSignIdx = valueString.indexOf(QLatin1Char('='));
-                if (equalSignIdx >= 0)
-                {
-                    const auto& tagRef = valueString.midRef(0, equalSignIdx);
-                    const auto& valueRef = valueString.midRef(equalSignIdx + 1);
-                    evaluationResult = mapObject->containsAttribute(tagRef, valueRef, true);
-                }
-                else
-                    evaluationResult = mapObject->containsTag(valueString, true);
+                if (condition.additionalHasValue)
+                    return mapObject->containsAttribute(condition.additionalTag, condition.additionalValue, true);
+                return mapObject->containsTag(condition.additionalTag, true);
             }
+
+            const auto valueString = owner->mapStyle->getStringById(constantRuleValue.asSimple.asUInt);
+            auto equalSignIdx = valueString.indexOf(QLatin1Char('='));
+            if (equalSignIdx >= 0)
+            {
+                const auto& tagRef = valueString.midRef(0, equalSignIdx);
+                const auto& valueRef = valueString.midRef(equalSignIdx + 1);
+                return mapObject->containsAttribute(tagRef, valueRef, true);
+            }
+            return mapObject->containsTag(valueString, true);
         }
-        else if (valueDefId == _builtinValueDefs->id_INPUT_TEST)
-        {
-            evaluationResult = (inputValue.asInt == 1);
-        }
-        else if (valueDef->dataType == MapStyleValueDataType::Float)
+
+        case MapStyleCompiledRules::ConditionType::Test:
+            return (inputValue.asInt == 1);
+
+        case MapStyleCompiledRules::ConditionType::Float:
         {
             const auto lvalue = constantRuleValue.isComplex
                 ? constantRuleValue.asComplex.asFloat.evaluate(owner->ptScaleFactor)
                 : constantRuleValue.asSimple.asFloat;
 
-            evaluationResult = qFuzzyCompare(lvalue, inputValue.asFloat);
+            return qFuzzyCompare(lvalue, inputValue.asFloat);
         }
-        else
+
+        case MapStyleCompiledRules::ConditionType::Integer:
         {
             const auto lvalue = constantRuleValue.isComplex
                 ? constantRuleValue.asComplex.asInt.evaluate(owner->ptScaleFactor)
                 : constantRuleValue.asSimple.asInt;
 
-            evaluationResult = (lvalue == inputValue.asInt);
+            return (lvalue == inputValue.asInt);
         }
+    }
+
+    return false;
+}
+
+bool OsmAnd::MapStyleEvaluator_P::evaluate(
+    const MapObject* const mapObject,
+    const MapStyleCompiledRules::NodeIndex nodeIndex,
+    const std::shared_ptr<const InputValues>& inputValues,
+    bool& outDisabled,
+    IntermediateEvaluationResult* const outResultStorage,
+    OnDemand<IntermediateEvaluationResult>& constantEvaluationResult) const
+{
+    if (nodeIndex == MapStyleCompiledRules::InvalidNodeIndex)
+        return false;
+    const auto& compiledRules = *_compiledRules;
+    const auto& node = compiledRules.nodes[nodeIndex];
 
+    // Check all conditions of a rule until all are checked.
+    const auto pConditionsEnd = compiledRules.conditions.constData() + node.conditionsOffset + node.conditionsCount;
+    for (auto pCondition = compiledRules.conditions.constData() + node.conditionsOffset; pCondition != pConditionsEnd; ++pCondition)
+    {
         // If at least one value of rule does not match, it's failure
-        if (!evaluationResult)
+        if (!evaluateCondition(mapObject, *pCondition, inputValues, constantEvaluationResult))
             return false;
     }
 
     // In case rule sets "disable", stop processing
-    const auto citDisabledValue = ruleNodeValues.constFind(_builtinValueDefs->id_OUTPUT_DISABLE);
-    if (citDisabledValue != ruleNodeValues.cend())
+    if (node.hasDisableValue)
     {
         const auto disableValue = evaluateConstantValue(
             mapObject,
             _builtinValueDefs->OUTPUT_DISABLE->dataType,
-            *citDisabledValue,
+            node.disableValue,
             inputValues,
             constantEvaluationResult);
 
@@ -246,16 +266,16 @@ bool OsmAnd::MapStyleEvaluator_P::evaluate(
         }
     }
 
-    if (outResultStorage && !ruleNode->getIsSwitch())
-        fillResultFromRuleNode(ruleNode, *outResultStorage, true);
+    if (outResultStorage && !node.isSwitch)
+        fillResultFromRuleNode(node, *outResultStorage, true);
 
     bool atLeastOneConditionalMatched = false;
-    const auto& oneOfConditionalSubnodes = ruleNode->getOneOfConditionalSubnodesRef();
-    for (const auto& oneOfConditionalSubnode : constOf(oneOfConditionalSubnodes))
+    const auto pSubnodes = compiledRules.subnodes.constData();
+    for (auto idx = 0u; idx < node.oneOfConditionalSubnodesCount; idx++)
     {
         const auto evaluationResult = evaluate(
             mapObject,
-            oneOfConditionalSubnode,
+            pSubnodes[node.oneOfConditionalSubnodesOffset + idx],
             inputValues,
             outDisabled,
             outResultStorage,
@@ -267,21 +287,20 @@ bool OsmAnd::MapStyleEvaluator_P::evaluate(
             break;
         }
     }
-    if (!atLeastOneConditionalMatched && ruleNode->getIsSwitch())
+    if (!atLeastOneConditionalMatched && node.isSwitch)
         return false;
 
-    if (outResultStorage && ruleNode->getIsSwitch())
+    if (outResultStorage && node.isSwitch)
     {
         // Fill values from <switch> keeping values previously set by <case>
-        fillResultFromRuleNode(ruleNode, *outResultStorage, false);
+        fillResultFromRuleNode(node, *outResultStorage, false);
     }
 
-    const auto& applySubnodes = ruleNode->getApplySubnodesRef();
-    for (const auto& applySubnode : constOf(applySubnodes))
+    for (auto idx = 0u; idx < node.applySubnodesCount; idx++)
     {
         evaluate(
             mapObject,
-            applySubnode,
+            pSubnodes[node.applySubnodesOffset + idx],
             inputValues,
             outDisabled,
             outResultStorage,
@@ -295,26 +314,20 @@ bool OsmAnd::MapStyleEvaluator_P::evaluate(
 }
 
 void OsmAnd::MapStyleEvaluator_P::fillResultFromRuleNode(
-    const std::shared_ptr<const IMapStyle::IRuleNode>& ruleNode,
+    const MapStyleCompiledRules::Node& node,
     IntermediateEvaluationResult& outResultStorage,
     const bool allowOverride) const
 {
-    const auto& values = ruleNode->getValuesRef();
-    for (const auto& ruleValueEntry : rangeOf(constOf(values)))
+    const auto pOutputsBegin = _compiledRules->outputs.constData() + node.outputsOffset;
+    const auto pOutputsEnd = pOutputsBegin + node.outputsCount;
+    for (auto pOutput = pOutputsBegin; pOutput != pOutputsEnd; ++pOutput)
     {
-        const auto valueDefId = ruleValueEntry.key();
-        const auto& valueDef = owner->mapStyle->getValueDefinitionRefById(valueDefId);
-
-        // Skip all non-Output values
-        if (valueDef->valueClass != MapStyleValueDefinition::Class::Output)
-            continue;
-
         // If value already defined and override not allowed, do nothing
-        if (outResultStorage.contains(valueDefId) && !allowOverride)
+        if (!allowOverride && outResultStorage.contains(pOutput->valueDefId))
             continue;
-        
+
         // Store result
-        outResultStorage.set(valueDefId, ruleValueEntry.value());
+        outResultStorage.set(pOutput->valueDefId, pOutput->value);
     }
 }
 
@@ -441,8 +454,7 @@ bool OsmAnd::MapStyleEvaluator_P::evaluate(
     //}
     //////////////////////////////////////////////////////////////////////////
 
-    const auto& ruleset = owner->mapStyle->getRuleset(rulesetType);
-
+    _mapObjectInspected = false;
     _constantIntermediateEvaluationResult->clear();
     OnDemand<IntermediateEvaluationResult> constantEvaluationResult(_constantIntermediateEvaluationResult);
 
@@ -450,7 +462,7 @@ bool OsmAnd::MapStyleEvaluator_P::evaluate(
     {
         const auto evaluationResult = evaluate(
             mapObject,
-            ruleset,
+            rulesetType,
             _inputValues->getRef(_builtinValueDefs->id_INPUT_TAG)->asUInt,
             _inputValues->getRef(_builtinValueDefs->id_INPUT_VALUE)->asUInt,
             outResultStorage,
@@ -463,7 +475,7 @@ bool OsmAnd::MapStyleEvaluator_P::evaluate(
     {
         const auto evaluationResult = evaluate(
             mapObject,
-            ruleset,
+            rulesetType,
             _inputValues->getRef(_builtinValueDefs->id_INPUT_TAG)->asUInt,
             ResolvedMapStyle::EmptyStringId,
             outResultStorage,
@@ -474,7 +486,7 @@ bool OsmAnd::MapStyleEvaluator_P::evaluate(
 
     const auto evaluationResult = evaluate(
         mapObject,
-        ruleset,
+        rulesetType,
         ResolvedMapStyle::EmptyStringId,
         ResolvedMapStyle::EmptyStringId,
         outResultStorage,
@@ -492,13 +504,14 @@ bool OsmAnd::MapStyleEvaluator_P::evaluate(
     if (outResultStorage)
         _intermediateEvaluationResult->clear();
 
+    _mapObjectInspected = false;
     _constantIntermediateEvaluationResult->clear();
     OnDemand<IntermediateEvaluationResult> constantEvaluationResult(_constantIntermediateEvaluationResult);
 
     bool wasDisabled = false;
     const auto success = evaluate(
         nullptr,
-        attribute->getRootNodeRef(),
+        _compiledRules->findAttribute(attribute.get()),
         _inputValues,
         wasDisabled,
         _intermediateEvaluationResult.get(),
@@ -518,3 +531,8 @@ bool OsmAnd::MapStyleEvaluator_P::evaluate(
 
     return true;
 }
+
+bool OsmAnd::MapStyleEvaluator_P::wasMapObjectInspected() const
+{
+    return _mapObjectInspected;
+}
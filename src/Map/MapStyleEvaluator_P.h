@@ -13,6 +13,7 @@
 #include "PrivateImplementation.h"
 #include "MapStyleConstantValue.h"
 #include "IMapStyle.h"
+#include "MapStyleCompiledRules.h"
 
 namespace OsmAnd
 {
@@ -38,6 +39,8 @@ namespace OsmAnd
 
     private:
         const std::shared_ptr<const MapStyleBuiltinValueDefinitions> _builtinValueDefs;
+        std::shared_ptr<const MapStyleCompiledRules> _compiledRules;
+        mutable bool _mapObjectInspected;
 
         typedef ArrayMap<InputValue> InputValues;
         std::shared_ptr<InputValues> _inputValues;
@@ -58,9 +61,15 @@ namespace OsmAnd
             const std::shared_ptr<const InputValues>& inputValues,
             OnDemand<IntermediateEvaluationResult>& intermediateEvaluationResult) const;
 
+        bool evaluateCondition(
+            const MapObject* const mapObject,
+            const MapStyleCompiledRules::Condition& condition,
+            const std::shared_ptr<const InputValues>& inputValues,
+            OnDemand<IntermediateEvaluationResult>& constantEvaluationResult) const;
+
         bool evaluate(
             const MapObject* const mapObject,
-            const std::shared_ptr<const IMapStyle::IRuleNode>& ruleNode,
+            const MapStyleCompiledRules::NodeIndex nodeIndex,
             const std::shared_ptr<const InputValues>& inputValues,
             bool& outDisabled,
             IntermediateEvaluationResult* const outResultStorage,
@@ -68,14 +77,14 @@ namespace OsmAnd
 
         bool evaluate(
             const std::shared_ptr<const MapObject>& mapObject,
-            const QHash< TagValueId, std::shared_ptr<const IMapStyle::IRule> >& ruleset,
+            const MapStyleRulesetType rulesetType,
             const IMapStyle::StringId tagStringId,
             const IMapStyle::StringId valueStringId,
             MapStyleEvaluationResult* const outResultStorage,
             OnDemand<IntermediateEvaluationResult>& constantEvaluationResult) const;
 
         void fillResultFromRuleNode(
-            const std::shared_ptr<const IMapStyle::IRuleNode>& ruleNode,
+            const MapStyleCompiledRules::Node& node,
             IntermediateEvaluationResult& outResultStorage,
             const bool allowOverride) const;
 
@@ -108,6 +117,8 @@ namespace OsmAnd
             const std::shared_ptr<const IMapStyle::IAttribute>& attribute,
             MapStyleEvaluationResult* const outResultStorage) const;
 
+        bool wasMapObjectInspected() const;
+
     friend class OsmAnd::MapStyleEvaluator;
     };
 }
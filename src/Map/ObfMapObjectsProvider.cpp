@@ -6,10 +6,12 @@
 
 OsmAnd::ObfMapObjectsProvider::ObfMapObjectsProvider(
     const std::shared_ptr<const IObfsCollection>& obfsCollection_,
-    const Mode mode_ /*= Mode::BinaryMapObjectsAndRoads*/)
+    const Mode mode_ /*= Mode::BinaryMapObjectsAndRoads*/,
+    QThreadPool* const parallelReadingThreadPool_ /*= nullptr*/)
     : _p(new ObfMapObjectsProvider_P(this))
     , obfsCollection(obfsCollection_)
     , mode(mode_)
+    , parallelReadingThreadPool(parallelReadingThreadPool_)
 {
 }
 
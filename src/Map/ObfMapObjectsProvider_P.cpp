@@ -125,6 +125,8 @@ bool OsmAnd::ObfMapObjectsProvider_P::obtainTiledObfMapObjects(
         request.zoom,
         request.zoom,
         ObfDataTypesMask().set(ObfDataType::Map).set(ObfDataType::Routing));
+    if (owner->parallelReadingThreadPool)
+        dataInterface->setParallelReading(owner->parallelReadingThreadPool);
     if (metric)
         metric->elapsedTimeForObtainingObfInterface += obtainObfInterfaceStopwatch.elapsed();
 
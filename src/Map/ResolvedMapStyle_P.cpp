@@ -425,6 +425,9 @@ bool OsmAnd::ResolvedMapStyle_P::resolve()
     if (!mergeAndResolveRulesets())
         return false;
 
+    // Flatten rule trees once, so that every evaluator of this style can share them
+    _compiledRules.reset(new MapStyleCompiledRules(owner));
+
     return true;
 }
 
@@ -15,10 +15,12 @@
 #include "PrivateImplementation.h"
 #include "UnresolvedMapStyle.h"
 #include "ResolvedMapStyle.h"
+#include "MapStyleCompiledRules.h"
 
 namespace OsmAnd
 {
     class MapStyleValueDefinition;
+    class MapStyleEvaluator_P;
 
     class ResolvedMapStyle;
     class ResolvedMapStyle_P Q_DECL_FINAL
@@ -79,6 +81,7 @@ namespace OsmAnd
         QHash<StringId, std::shared_ptr<const IMapStyle::IParameter> > _parameters;
         QHash<StringId, std::shared_ptr<const IMapStyle::IAttribute> > _attributes;
         std::array< QHash<TagValueId, std::shared_ptr<const IMapStyle::IRule> >, MapStyleRulesetTypesCount> _rulesets;
+        std::shared_ptr<const MapStyleCompiledRules> _compiledRules;
     public:
         virtual ~ResolvedMapStyle_P();
 
@@ -109,6 +112,7 @@ namespace OsmAnd
         QString getStringById(const StringId id) const;
 
     friend class OsmAnd::ResolvedMapStyle;
+    friend class OsmAnd::MapStyleEvaluator_P;
     };
 }
 
@@ -42,6 +42,58 @@ OsmAnd::SymbolRasterizer_P::~SymbolRasterizer_P()
 {
 }
 
+std::shared_ptr<const SkBitmap> OsmAnd::SymbolRasterizer_P::obtainTextBackground(
+    const QList< std::shared_ptr<const SkBitmap> >& layers,
+    const float scaleFactor) const
+{
+    if (layers.isEmpty())
+        return nullptr;
+
+    TextBackgroundKey key;
+    key.layers = layers;
+    key.scaleFactor = scaleFactor;
+
+    {
+        QMutexLocker scopedLocker(&_textBackgroundsMutex);
+
+        const auto citTextBackground = _textBackgrounds.constFind(key);
+        if (citTextBackground != _textBackgrounds.cend())
+            return *citTextBackground;
+    }
+
+    std::shared_ptr<const SkBitmap> textBackground = SkiaUtilities::mergeBitmaps(layers);
+    if (!qFuzzyCompare(scaleFactor, 1.0f) && textBackground)
+        textBackground = SkiaUtilities::scaleBitmap(textBackground, scaleFactor, scaleFactor);
+
+    {
+        QMutexLocker scopedLocker(&_textBackgroundsMutex);
+
+        // Prefer background that was stored by concurrent caller, to keep single identity
+        const auto citTextBackground = _textBackgrounds.constFind(key);
+        if (citTextBackground != _textBackgrounds.cend())
+            return *citTextBackground;
+
+        if (_textBackgrounds.size() >= MaxTextBackgroundsCount)
+            _textBackgrounds.clear();
+        _textBackgrounds.insert(key, textBackground);
+    }
+
+    return textBackground;
+}
+
+bool OsmAnd::SymbolRasterizer_P::TextBackgroundKey::operator==(const TextBackgroundKey& that) const
+{
+    return layers == that.layers && scaleFactor == that.scaleFactor;
+}
+
+uint OsmAnd::SymbolRasterizer_P::TextBackgroundKey::qHash() const
+{
+    uint hash = ::qHash(scaleFactor);
+    for (const auto& layer : constOf(layers))
+        hash = hash * 31 + ::qHash(layer.get());
+    return hash;
+}
+
 void OsmAnd::SymbolRasterizer_P::rasterize(
     const std::shared_ptr<const MapPrimitiviser::PrimitivisedObjects>& primitivisedObjects,
     QList< std::shared_ptr<const RasterizedSymbolsGroup> >& outSymbolsGroups,
@@ -106,14 +158,7 @@ void OsmAnd::SymbolRasterizer_P::rasterize(
                         backgroundLayers.push_back(icon);
                 }
 
-                style.backgroundBitmap = SkiaUtilities::mergeBitmaps(backgroundLayers);
-                if (!qFuzzyCompare(textSymbol->scaleFactor, 1.0f) && style.backgroundBitmap)
-                {
-                    style.backgroundBitmap = SkiaUtilities::scaleBitmap(
-                        style.backgroundBitmap,
-                        textSymbol->scaleFactor,
-                        textSymbol->scaleFactor);
-                }
+                style.backgroundBitmap = obtainTextBackground(backgroundLayers, textSymbol->scaleFactor);
 
                 style
                     .setBold(textSymbol->isBold)
@@ -133,7 +178,7 @@ void OsmAnd::SymbolRasterizer_P::rasterize(
                 float symbolExtraTopSpace;
                 float symbolExtraBottomSpace;
                 QVector<SkScalar> glyphsWidth;
-                const auto rasterizedText = owner->textRasterizer->rasterize(
+                const auto rasterizedText = owner->textRasterizer->rasterizeCached(
                     textSymbol->value,
                     style,
                     textSymbol->drawOnPath ? &glyphsWidth : nullptr,
@@ -8,6 +8,8 @@
 #include "ignore_warnings_on_external_includes.h"
 #include <QList>
 #include <QVector>
+#include <QHash>
+#include <QMutex>
 #include "restore_internal_warnings.h"
 
 #include "ignore_warnings_on_external_includes.h"
@@ -36,6 +38,24 @@ namespace OsmAnd
         typedef SymbolRasterizer::FilterByMapObject FilterByMapObject;
 
     private:
+        // Merged and scaled backgrounds of text symbols are kept, so that texts with same background have
+        // identical style for text rasterizer cache
+        enum {
+            MaxTextBackgroundsCount = 1024,
+        };
+        struct TextBackgroundKey Q_DECL_FINAL
+        {
+            QList< std::shared_ptr<const SkBitmap> > layers;
+            float scaleFactor;
+
+            bool operator==(const TextBackgroundKey& that) const;
+            uint qHash() const;
+        };
+        mutable QMutex _textBackgroundsMutex;
+        mutable QHash< TextBackgroundKey, std::shared_ptr<const SkBitmap> > _textBackgrounds;
+        std::shared_ptr<const SkBitmap> obtainTextBackground(
+            const QList< std::shared_ptr<const SkBitmap> >& layers,
+            const float scaleFactor) const;
     protected:
         SymbolRasterizer_P(SymbolRasterizer* const owner);
     public:
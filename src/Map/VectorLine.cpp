@@ -42,6 +42,21 @@ void OsmAnd::VectorLine::setPoints(const QVector<OsmAnd::PointI>& points)
     _p->setPoints(points);    
 }
 
+void OsmAnd::VectorLine::appendPoints(const QVector<OsmAnd::PointI>& points)
+{
+    _p->appendPoints(points);
+}
+
+QVector< QVector<int> > OsmAnd::VectorLine::getSimplifiedRuns(const double tolerance, const AreaI64& area31) const
+{
+    return _p->getSimplifiedRuns(tolerance, area31);
+}
+
+unsigned int OsmAnd::VectorLine::getSimplifiedPointsCount() const
+{
+    return _p->getSimplifiedPointsCount();
+}
+
 bool OsmAnd::VectorLine::hasUnappliedChanges() const
 {
     return _p->hasUnappliedChanges();
@@ -19,7 +19,7 @@
 
 OsmAnd::VectorLine_P::VectorLine_P(VectorLine* const owner_)
 : _hasUnappliedChanges(false), _hasUnappliedPrimitiveChanges(false), _isHidden(false),
-  _metersPerPixel(1.0), _mapZoomLevel(InvalidZoomLevel), _mapVisualZoom(0.f), _mapVisualZoomShift(0.f),
+  _simplifiedPointsCount(0), _metersPerPixel(1.0), _mapZoomLevel(InvalidZoomLevel), _mapVisualZoom(0.f), _mapVisualZoomShift(0.f),
   owner(owner_)
 {
 }
@@ -55,11 +55,132 @@ void OsmAnd::VectorLine_P::setPoints(const QVector<PointI>& points)
     QWriteLocker scopedLocker(&_lock);
     
     _points = points;
+    _pointsSignificance.clear();
+    _simplificationBlocks.clear();
+    updateSimplification();
     
     _hasUnappliedPrimitiveChanges = true;
     _hasUnappliedChanges = true;
 }
 
+void OsmAnd::VectorLine_P::appendPoints(const QVector<PointI>& points)
+{
+    if (points.isEmpty())
+        return;
+
+    QWriteLocker scopedLocker(&_lock);
+
+    _points += points;
+    updateSimplification();
+
+    _hasUnappliedPrimitiveChanges = true;
+    _hasUnappliedChanges = true;
+}
+
+void OsmAnd::VectorLine_P::updateSimplification()
+{
+    // Complete blocks are not affected by appended points, while last incomplete one is rebuilt
+    if (!_simplificationBlocks.isEmpty())
+    {
+        const auto& lastBlock = _simplificationBlocks.last();
+        if (lastBlock.end - lastBlock.start < SimplificationBlockSize)
+            _simplificationBlocks.removeLast();
+    }
+
+    const auto pointsCount = _points.size();
+    _pointsSignificance.resize(pointsCount);
+
+    auto start = _simplificationBlocks.isEmpty() ? 0 : _simplificationBlocks.last().end;
+    while (start < pointsCount - 1)
+    {
+        SimplificationBlock block;
+        block.start = start;
+        block.end = qMin(start + SimplificationBlockSize, pointsCount - 1);
+        block.bbox31 = AreaI(_points[block.start], _points[block.start]);
+        block.levels.resize(SimplificationLevelsCount);
+
+        computeSignificance(block.start, block.end);
+        _simplifiedPointsCount += block.end - block.start + 1;
+        for (auto pointIdx = block.start; pointIdx <= block.end; pointIdx++)
+        {
+            block.bbox31.enlargeToInclude(_points[pointIdx]);
+
+            const auto significance = _pointsSignificance[pointIdx];
+            const auto level = (significance < 2.0)
+                ? 0
+                : qMin(
+                    static_cast<int>(std::log2(qMin(significance, static_cast<double>(std::numeric_limits<int32_t>::max())))),
+                    static_cast<int>(SimplificationLevelsCount) - 1);
+            block.levels[level].push_back(pointIdx);
+        }
+
+        start = block.end;
+        _simplificationBlocks.push_back(qMove(block));
+    }
+}
+
+void OsmAnd::VectorLine_P::computeSignificance(const int start, const int end)
+{
+    struct Segment
+    {
+        int start;
+        int end;
+        double significance;
+    };
+
+    // Douglas-Peucker is run down to single segments, and each point remembers distance at which
+    // it splits its segment. That is capped by significance of parent split, since parent segment
+    // is not split at all at larger tolerance.
+    _pointsSignificance[start] = std::numeric_limits<double>::infinity();
+    _pointsSignificance[end] = std::numeric_limits<double>::infinity();
+    QVector<Segment> segments;
+    segments.push_back({ start, end, std::numeric_limits<double>::infinity() });
+    while (!segments.isEmpty())
+    {
+        const auto segment = segments.last();
+        segments.removeLast();
+        if (segment.end - segment.start < 2)
+            continue;
+
+        const PointD from(_points[segment.start]);
+        const PointD to(_points[segment.end]);
+        double dmax = -1;
+        int index = -1;
+        for (auto pointIdx = segment.start + 1; pointIdx < segment.end; pointIdx++)
+        {
+            const PointD point(_points[pointIdx]);
+            const auto proj = getProjection(point, from, to);
+            const auto d = qSqrt((point.x - proj.x) * (point.x - proj.x) + (point.y - proj.y) * (point.y - proj.y));
+            if (d > dmax)
+            {
+                dmax = d;
+                index = pointIdx;
+            }
+        }
+
+        const auto significance = qMin(dmax, segment.significance);
+        _pointsSignificance[index] = significance;
+        segments.push_back({ segment.start, index, significance });
+        segments.push_back({ index, segment.end, significance });
+    }
+}
+
+QVector< QVector<int> > OsmAnd::VectorLine_P::getSimplifiedRuns(const double tolerance, const AreaI64& area31) const
+{
+    QReadLocker scopedLocker(&_lock);
+
+    QVector< QVector<int> > runs;
+    collectVisibleRuns(tolerance, area31, runs);
+    return runs;
+}
+
+unsigned int OsmAnd::VectorLine_P::getSimplifiedPointsCount() const
+{
+    QReadLocker scopedLocker(&_lock);
+
+    return _simplifiedPointsCount;
+}
+
 bool OsmAnd::VectorLine_P::hasUnappliedChanges() const
 {
     QReadLocker scopedLocker(&_lock);
@@ -76,7 +197,8 @@ bool OsmAnd::VectorLine_P::hasUnappliedPrimitiveChanges() const
 
 bool OsmAnd::VectorLine_P::isMapStateChanged(const MapState& mapState) const
 {
-    bool changed = qAbs(_mapZoomLevel + _mapVisualZoom - mapState.zoomLevel - mapState.visualZoom) > 0.5;
+    bool changed = qAbs(_mapZoomLevel + _mapVisualZoom - mapState.zoomLevel - mapState.visualZoom) > 0.5 ||
+        !_clipArea31.contains(getVisibleArea31(mapState));
     //_mapZoomLevel != mapState.zoomLevel ||
     //_mapVisualZoom != mapState.visualZoom ||
     //_mapVisualZoomShift != mapState.visualZoomShift;
@@ -89,6 +211,34 @@ void OsmAnd::VectorLine_P::applyMapState(const MapState& mapState)
     _mapZoomLevel = mapState.zoomLevel;
     _mapVisualZoom = mapState.visualZoom;
     _mapVisualZoomShift = mapState.visualZoomShift;
+
+    // Clip area is larger than visible one, so that panning does not regenerate line on each frame
+    const auto visibleArea31 = getVisibleArea31(mapState);
+    _clipArea31 = visibleArea31.getEnlargedBy(PointI64(visibleArea31.width() / 2, visibleArea31.height() / 2));
+}
+
+OsmAnd::AreaI64 OsmAnd::VectorLine_P::getVisibleArea31(const MapState& mapState)
+{
+    const AreaI64 unclippedArea31(
+        std::numeric_limits<int32_t>::min(),
+        std::numeric_limits<int32_t>::min(),
+        std::numeric_limits<int32_t>::max(),
+        std::numeric_limits<int32_t>::max());
+
+    // Far edge of tilted view approaches horizon, so nothing can be clipped then
+    const auto farEdgeAngle = mapState.elevationAngle - mapState.fieldOfView;
+    if (farEdgeAngle < 10.0f || mapState.windowSize.x <= 0 || mapState.windowSize.y <= 0 || mapState.metersPerPixel <= 0.0)
+        return unclippedArea31;
+
+    const auto metersPerUnit31 = Utilities::getMetersPerTileUnit(ZoomLevel31, mapState.target31.y, 1);
+    const auto halfDiagonal = 0.5 * qSqrt(
+        static_cast<double>(mapState.windowSize.x) * mapState.windowSize.x +
+        static_cast<double>(mapState.windowSize.y) * mapState.windowSize.y);
+    const auto tiltFactor = qSin(qDegreesToRadians(mapState.elevationAngle)) / qSin(qDegreesToRadians(farEdgeAngle));
+    const auto radius31 = static_cast<int64_t>(halfDiagonal * mapState.metersPerPixel / metersPerUnit31 * tiltFactor);
+
+    const PointI64 target31(mapState.target31);
+    return AreaI64(target31, target31).getEnlargedBy(radius31);
 }
 
 bool OsmAnd::VectorLine_P::update(const MapState& mapState)
@@ -226,28 +376,76 @@ double OsmAnd::VectorLine_P::scalarMultiplication(double xA, double yA, double x
     return (xB - xA) * (xC - xA) + (yB - yA) * (yC - yA);
 }
 
-int OsmAnd::VectorLine_P::simplifyDouglasPeucker(std::vector<PointD>& points, uint start, uint end, double epsilon, std::vector<bool>& include) const
+void OsmAnd::VectorLine_P::collectVisibleRuns(
+    const double tolerance,
+    const AreaI64& clipArea31,
+    QVector< QVector<int> >& outRuns) const
 {
-    double dmax = -1;
-    int index = -1;
-    for (int i = start + 1; i <= end - 1; i++) {
-        PointD proj = getProjection(points[i],points[start], points[end]);
-        double d = qSqrt((points[i].x-proj.x)*(points[i].x-proj.x)+
-                         (points[i].y-proj.y)*(points[i].y-proj.y));
-        // calculate distance from line
-        if (d > dmax) {
-            dmax = d;
-            index = i;
+    // Only the level that contains tolerance needs to be filtered, since all points of higher levels
+    // are more significant and all points of lower levels are less significant than tolerance
+    const auto toleranceLevel = (tolerance < 2.0)
+        ? 0
+        : qMin(static_cast<int>(std::log2(tolerance)), static_cast<int>(SimplificationLevelsCount) - 1);
+
+    QVector<int> run;
+    QVector<int> blockPoints;
+    auto prevPointIdx = -1;
+    const auto flushRun =
+        [&run, &outRuns]
+        ()
+        {
+            if (run.size() > 1)
+                outRuns.push_back(run);
+            run.clear();
+        };
+    for (const auto& block : constOf(_simplificationBlocks))
+    {
+        if (!clipArea31.intersects(AreaI64(block.bbox31)))
+        {
+            flushRun();
+            prevPointIdx = -1;
+            continue;
+        }
+
+        blockPoints.clear();
+        for (auto level = toleranceLevel; level < SimplificationLevelsCount; level++)
+        {
+            for (const auto pointIdx : constOf(block.levels[level]))
+            {
+                if (level > toleranceLevel || _pointsSignificance[pointIdx] >= tolerance)
+                    blockPoints.push_back(pointIdx);
+            }
+        }
+        std::sort(blockPoints.begin(), blockPoints.end());
+
+        for (const auto pointIdx : constOf(blockPoints))
+        {
+            // Boundary point is shared with previous block
+            if (pointIdx == prevPointIdx)
+                continue;
+
+            if (prevPointIdx >= 0)
+            {
+                const auto& from = _points[prevPointIdx];
+                const auto& to = _points[pointIdx];
+                const AreaI64 segmentBBox31(
+                    qMin(from.y, to.y),
+                    qMin(from.x, to.x),
+                    qMax(from.y, to.y),
+                    qMax(from.x, to.x));
+                if (clipArea31.intersects(segmentBBox31))
+                {
+                    if (run.isEmpty())
+                        run.push_back(prevPointIdx);
+                    run.push_back(pointIdx);
+                }
+                else
+                    flushRun();
+            }
+            prevPointIdx = pointIdx;
         }
     }
-    if (dmax >= epsilon) {
-        int enabled1 = simplifyDouglasPeucker(points, start, index, epsilon, include);
-        int enabled2 = simplifyDouglasPeucker(points, index, end, epsilon, include);
-        return enabled1 + enabled2 ;
-    } else {
-        include[end] = true;
-        return 1;
-    }
+    flushRun();
 }
 
 float OsmAnd::VectorLine_P::zoom() const
@@ -258,10 +456,18 @@ float OsmAnd::VectorLine_P::zoom() const
 std::shared_ptr<OsmAnd::OnSurfaceVectorMapSymbol> OsmAnd::VectorLine_P::generatePrimitive(const std::shared_ptr<OnSurfaceVectorMapSymbol> vectorLine) const
 {
     int order = owner->baseOrder;
-    int pointsCount = _points.size();
     
+    float zoom = this->zoom();
+    double radius = owner->lineWidth * Utilities::getPowZoom( 31 - _mapZoomLevel) * qSqrt(zoom) /
+                        (IAtlasMapRenderer::TileSize3D * IAtlasMapRenderer::TileSize3D);
+    QVector< QVector<int> > runs;
+    collectVisibleRuns(radius / 3, _clipArea31, runs);
+
+    // Vertices are relative to start of first visible run, to keep precision of float coordinates
+    const auto& origin = runs.isEmpty() ? _points[0] : _points[runs.first().first()];
+
     vectorLine->order = order++;
-    vectorLine->position31 = _points[0];
+    vectorLine->position31 = origin;
     vectorLine->primitiveType = VectorMapSymbol::PrimitiveType::TriangleStrip;
 
     const auto verticesAndIndexes = std::make_shared<VectorMapSymbol::VerticesAndIndexes>();
@@ -273,59 +479,90 @@ std::shared_ptr<OsmAnd::OnSurfaceVectorMapSymbol> OsmAnd::VectorLine_P::generate
     vectorLine->scale = 1.0;
     vectorLine->direction = 0.f;
     
-    float zoom = this->zoom();
-    double radius = owner->lineWidth * Utilities::getPowZoom( 31 - _mapZoomLevel) * qSqrt(zoom) /
-                        (IAtlasMapRenderer::TileSize3D * IAtlasMapRenderer::TileSize3D);
-    // generate array of points
-    std::vector<OsmAnd::PointD> pointsToPlot(pointsCount);
-    for (auto pointIdx = 0u; pointIdx < pointsCount; pointIdx++)
+    verticesAndIndexes->position31 = new PointI(vectorLine->position31.x, vectorLine->position31.y);
+    
+    std::vector<VectorMapSymbol::Vertex> vertices;
+    std::vector<VectorMapSymbol::Vertex> runVertices;
+    std::vector<OsmAnd::PointD> original;
+    for (const auto& run : constOf(runs))
+    {
+        original.resize(run.size());
+        for (auto runPointIdx = 0; runPointIdx < run.size(); runPointIdx++)
+        {
+            const auto& point = _points[run[runPointIdx]];
+            original[runPointIdx] = PointD(point.x - origin.x, point.y - origin.y);
+        }
+
+        runVertices.clear();
+        generateRunVertices(original, radius, runVertices);
+        if (runVertices.empty())
+            continue;
+
+        // Runs are joined into single strip using degenerate triangles
+        if (!vertices.empty())
+        {
+            vertices.push_back(vertices.back());
+            vertices.push_back(runVertices.front());
+        }
+        vertices.insert(vertices.end(), runVertices.begin(), runVertices.end());
+    }
+
+    // Line that is not visible at all is represented by single degenerate triangle
+    if (vertices.empty())
     {
-        pointsToPlot[pointIdx] = PointD((_points[pointIdx].x-_points[0].x), (_points[pointIdx].y-_points[0].y));
+        VectorMapSymbol::Vertex vertex;
+        vertex.positionXY[0] = 0.0f;
+        vertex.positionXY[1] = 0.0f;
+        vertex.color = owner->fillColor;
+        vertices.assign(3, vertex);
     }
+
+    verticesAndIndexes->verticesCount = vertices.size();
+    verticesAndIndexes->vertices = new VectorMapSymbol::Vertex[vertices.size()];
+    std::copy(vertices.begin(), vertices.end(), verticesAndIndexes->vertices);
+
+    vectorLine->isHidden = _isHidden;
     
-    std::vector<bool> include(pointsCount, false);
-    include[0] = true;
-    int pointsSimpleCount = simplifyDouglasPeucker(pointsToPlot, 0, (uint) pointsToPlot.size() - 1, radius / 3, include) + 1;
+    vectorLine->setVerticesAndIndexes(verticesAndIndexes);
     
+    return vectorLine;
+}
+
+void OsmAnd::VectorLine_P::generateRunVertices(
+    const std::vector<PointD>& original,
+    const double radius,
+    std::vector<VectorMapSymbol::Vertex>& vertices) const
+{
+    const auto pointsSimpleCount = original.size();
+
     // generate base points for connecting lines with triangles
-    std::vector<OsmAnd::PointD> b1(pointsSimpleCount), b2(pointsSimpleCount), e1(pointsSimpleCount), e2(pointsSimpleCount), original(pointsSimpleCount);
-    double ntan = 0, nx1 = 0, ny1 = 0;
-    uint prevPointIdx = 0;
-    uint insertIdx = 0;
-    for (auto pointIdx = 0u; pointIdx < pointsCount; pointIdx++)
+    std::vector<OsmAnd::PointD> b1(pointsSimpleCount), b2(pointsSimpleCount), e1(pointsSimpleCount), e2(pointsSimpleCount);
+    double nx1 = 0, ny1 = 0;
+    for (auto pointIdx = 0u; pointIdx < pointsSimpleCount; pointIdx++)
     {
-        if(!include[pointIdx])
-        {
-            continue;
-        }
-        PointD pnt = pointsToPlot[pointIdx];
-        PointD prevPnt = pointsToPlot[prevPointIdx];
-        original[insertIdx]=pnt;
+        const PointD& pnt = original[pointIdx];
         if(pointIdx > 0)
         {
-            ntan = atan2(_points[pointIdx].x - _points[prevPointIdx].x,
-                            _points[pointIdx].y - _points[prevPointIdx].y);
-            nx1 = radius * sin(M_PI_2 - ntan) ;
-            ny1 = radius * cos(M_PI_2 - ntan) ;
-            e1[insertIdx] = b1[insertIdx] = OsmAnd::PointD(pnt.x - nx1, pnt.y + ny1);
-            e2[insertIdx] = b2[insertIdx] = OsmAnd::PointD(pnt.x + nx1, pnt.y - ny1);
-            e1[insertIdx-1] = OsmAnd::PointD(prevPnt.x - nx1, prevPnt.y + ny1);
-            e2[insertIdx-1] = OsmAnd::PointD(prevPnt.x + nx1, prevPnt.y - ny1);
+            const PointD& prevPnt = original[pointIdx - 1];
+
+            // Offset is segment direction rotated by 90 degrees and scaled to radius
+            const auto dx = pnt.x - prevPnt.x;
+            const auto dy = pnt.y - prevPnt.y;
+            const auto length = qSqrt(dx * dx + dy * dy);
+            nx1 = length > 0 ? radius * dy / length : radius;
+            ny1 = length > 0 ? radius * dx / length : 0.0;
+            e1[pointIdx] = b1[pointIdx] = OsmAnd::PointD(pnt.x - nx1, pnt.y + ny1);
+            e2[pointIdx] = b2[pointIdx] = OsmAnd::PointD(pnt.x + nx1, pnt.y - ny1);
+            e1[pointIdx-1] = OsmAnd::PointD(prevPnt.x - nx1, prevPnt.y + ny1);
+            e2[pointIdx-1] = OsmAnd::PointD(prevPnt.x + nx1, prevPnt.y - ny1);
         } else {
-            b2[insertIdx] = b1[insertIdx] = pnt;
+            b2[pointIdx] = b1[pointIdx] = pnt;
         }
-        prevPointIdx = pointIdx;
-        insertIdx++;
     }
     
-    verticesAndIndexes->position31 = new PointI(vectorLine->position31.x, vectorLine->position31.y);
-    
-    std::vector<VectorMapSymbol::Vertex> vertices;
     VectorMapSymbol::Vertex vertex;
     VectorMapSymbol::Vertex* pVertex = &vertex;
     
-    //OsmAnd::LogPrintf(OsmAnd::LogSeverityLevel::Info, "=== pointsCount=%d zoom=%d visualZoom=%f metersPerPixel=%f radius=%f simpleCount=%d cnt=%d", verticesAndIndexes->verticesCount,
-    //  _mapZoomLevel, _mapVisualZoom, _metersPerPixel, radius, pointsSimpleCount,pointsCount);
     bool direction = true;
     
     // generate triangles
@@ -467,17 +704,6 @@ std::shared_ptr<OsmAnd::OnSurfaceVectorMapSymbol> OsmAnd::VectorLine_P::generate
             
         }
     }
-    
-    //verticesAndIndexes->verticesCount = (pointsSimpleCount - 2) * 2 + 2 * 2;
-    verticesAndIndexes->verticesCount = vertices.size();
-    verticesAndIndexes->vertices = new VectorMapSymbol::Vertex[vertices.size()];
-    std::copy(vertices.begin(), vertices.end(), verticesAndIndexes->vertices);
-
-    vectorLine->isHidden = _isHidden;
-    
-    vectorLine->setVerticesAndIndexes(verticesAndIndexes);
-    
-    return vectorLine;
 }
 
 void OsmAnd::VectorLine_P::generateArrowsOnPath(const std::shared_ptr<VectorLine::SymbolsGroup> symbolsGroup) const
@@ -11,6 +11,8 @@
 #include "OsmAndCore.h"
 #include "PrivateImplementation.h"
 #include "CommonTypes.h"
+#include "PointsAndAreas.h"
+#include "MapRendererState.h"
 #include "MapSymbolsGroup.h"
 #include "IUpdatableMapSymbolsGroup.h"
 #include "OnSurfaceVectorMapSymbol.h"
@@ -29,6 +31,22 @@ namespace OsmAnd
         Q_DISABLE_COPY_AND_MOVE(VectorLine_P);
 
     private:
+        enum {
+            SimplificationBlockSize = 4096,
+            SimplificationLevelsCount = 32,
+        };
+
+        // Points are split into blocks that share boundary points. Each block is simplified on its own,
+        // so appending points rebuilds only the last block and blocks outside of visible area are skipped.
+        struct SimplificationBlock Q_DECL_FINAL
+        {
+            int start;
+            int end;
+            AreaI bbox31;
+
+            // Indices of points grouped by floor(log2(significance)), each group ordered by index
+            QVector< QVector<int> > levels;
+        };
     protected:
         VectorLine_P(VectorLine* const owner);
 
@@ -40,10 +58,18 @@ namespace OsmAnd
 
         QVector<PointI> _points;
 
+        // Significance of point is the largest simplification tolerance at which it still survives
+        QVector<double> _pointsSignificance;
+        QVector<SimplificationBlock> _simplificationBlocks;
+        unsigned int _simplifiedPointsCount;
+        void updateSimplification();
+        void computeSignificance(const int start, const int end);
+
         double _metersPerPixel;
         ZoomLevel _mapZoomLevel;
         float _mapVisualZoom;
         float _mapVisualZoomShift;
+        AreaI64 _clipArea31;
 
         float zoom() const;
 
@@ -53,6 +79,7 @@ namespace OsmAnd
 
         bool isMapStateChanged(const MapState& mapState) const;
         void applyMapState(const MapState& mapState);
+        static AreaI64 getVisibleArea31(const MapState& mapState);
         
         std::shared_ptr<VectorLine::SymbolsGroup> inflateSymbolsGroup() const;
         mutable QReadWriteLock _symbolsGroupsRegistryLock;
@@ -61,6 +88,14 @@ namespace OsmAnd
         void unregisterSymbolsGroup(MapSymbolsGroup* const symbolsGroup) const;
 
         std::shared_ptr<OnSurfaceVectorMapSymbol> generatePrimitive(const std::shared_ptr<OnSurfaceVectorMapSymbol> vectorLine) const;
+        void collectVisibleRuns(
+            const double tolerance,
+            const AreaI64& clipArea31,
+            QVector< QVector<int> >& outRuns) const;
+        void generateRunVertices(
+            const std::vector<PointD>& original,
+            const double radius,
+            std::vector<VectorMapSymbol::Vertex>& vertices) const;
         void generateArrowsOnPath(const std::shared_ptr<VectorLine::SymbolsGroup> symbolsGroup) const;
 
         PointD findLineIntersection(PointD p1, PointD p2, PointD p3, PointD p4) const;
@@ -68,9 +103,6 @@ namespace OsmAnd
         PointD getProjection(PointD point, PointD from, PointD to ) const;
         double scalarMultiplication(double xA, double yA, double xB, double yB, double xC, double yC) const;
         
-        int simplifyDouglasPeucker(std::vector<PointD>& points, uint begin, uint end, double epsilon,
-                                   std::vector<bool>& include) const;
-        
     public:
         virtual ~VectorLine_P();
 
@@ -81,6 +113,10 @@ namespace OsmAnd
 
         QVector<PointI> getPoints() const;
         void setPoints(const QVector<PointI>& points);
+        void appendPoints(const QVector<PointI>& points);
+
+        QVector< QVector<int> > getSimplifiedRuns(const double tolerance, const AreaI64& area31) const;
+        unsigned int getSimplifiedPointsCount() const;
 
         bool hasUnappliedChanges() const;
         bool hasUnappliedPrimitiveChanges() const;
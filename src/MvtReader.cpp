@@ -36,9 +36,42 @@ uint8_t OsmAnd::MvtReader::getUserDataId(const std::string& key)
     return UNKNOWN_ID;
 }
 
-std::shared_ptr<const OsmAnd::MvtReader::Tile> OsmAnd::MvtReader::parseTile(const QString &pathToFile) const
+std::shared_ptr<const OsmAnd::MvtReader::Tile> OsmAnd::MvtReader::parseTile(
+    const QString &pathToFile,
+    const Filter& filter /*= Filter()*/) const
+{
+    return _p->parseTile(pathToFile, filter);
+}
+
+std::shared_ptr<const OsmAnd::MvtReader::Tile> OsmAnd::MvtReader::parseTileData(
+    const QByteArray& data,
+    const Filter& filter /*= Filter()*/) const
+{
+    return _p->parseTileData(data, filter);
+}
+
+bool OsmAnd::MvtReader::readTile(
+    const QString& pathToFile,
+    const GeometryVisitor visitor,
+    const Filter& filter /*= Filter()*/) const
+{
+    return _p->readTile(pathToFile, visitor, filter);
+}
+
+bool OsmAnd::MvtReader::readTileData(
+    const QByteArray& data,
+    const GeometryVisitor visitor,
+    const Filter& filter /*= Filter()*/) const
+{
+    return _p->readTileData(data, visitor, filter);
+}
+
+OsmAnd::MvtReader::Filter::Filter()
+{
+}
+
+OsmAnd::MvtReader::Filter::~Filter()
 {
-    return _p->parseTile(pathToFile);
 }
 
 OsmAnd::MvtReader::Geometry::Geometry()
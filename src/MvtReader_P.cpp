@@ -18,6 +18,11 @@
 #include <sstream>
 #include "Logging.h"
 #include "QtExtensions.h"
+#include "ObfReaderUtilities.h"
+
+#include "ignore_warnings_on_external_includes.h"
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+#include "restore_internal_warnings.h"
 
 #define MIN_LINE_STRING_LEN 6
 
@@ -29,73 +34,423 @@ OsmAnd::MvtReader_P::~MvtReader_P()
 {
 }
 
-std::shared_ptr<const OsmAnd::MvtReader::Tile> OsmAnd::MvtReader_P::parseTile(const QString &pathToFile) const
+std::shared_ptr<const OsmAnd::MvtReader::Tile> OsmAnd::MvtReader_P::parseTile(const QString &pathToFile,
+                                                                             const MvtReader::Filter& filter) const
+{
+    const auto input = std::make_shared<QFile>(pathToFile);
+    QFileDeviceInputStream zcis(input);
+    return parseTile(&zcis, filter);
+}
+
+std::shared_ptr<const OsmAnd::MvtReader::Tile> OsmAnd::MvtReader_P::parseTileData(const QByteArray& data,
+                                                                                 const MvtReader::Filter& filter) const
+{
+    ::google::protobuf::io::ArrayInputStream zcis(data.constData(), data.size());
+    return parseTile(&zcis, filter);
+}
+
+std::shared_ptr<const OsmAnd::MvtReader::Tile> OsmAnd::MvtReader_P::parseTile(::google::protobuf::io::ZeroCopyInputStream* zcis,
+                                                                             const MvtReader::Filter& filter) const
+{
+    // Geometry is added to the same tile that holds keys referenced by its user data. Partially read
+    // tile is not returned, same as when whole message was parsed at once.
+    const auto geometryTile = std::make_shared<OsmAnd::MvtReader::Tile>();
+    const auto pGeometryTile = geometryTile.get();
+    const auto visitor =
+        [pGeometryTile]
+        (const std::shared_ptr<const OsmAnd::MvtReader::Tile>& tile,
+            const QString& layerName,
+            const std::shared_ptr<const OsmAnd::MvtReader::Geometry>& geometry) -> bool
+        {
+            pGeometryTile->addGeometry(geometry);
+            return true;
+        };
+    if (!readTile(zcis, geometryTile, visitor, filter))
+        return std::make_shared<OsmAnd::MvtReader::Tile>();
+
+    return geometryTile;
+}
+
+bool OsmAnd::MvtReader_P::readTile(const QString& pathToFile,
+                                   const MvtReader::GeometryVisitor visitor,
+                                   const MvtReader::Filter& filter) const
+{
+    const auto geometryTile = std::make_shared<OsmAnd::MvtReader::Tile>();
+
+    // File is read through memory-mapped windows, so that it is never loaded whole
+    const auto input = std::make_shared<QFile>(pathToFile);
+    QFileDeviceInputStream zcis(input);
+    return readTile(&zcis, geometryTile, visitor, filter);
+}
+
+bool OsmAnd::MvtReader_P::readTileData(const QByteArray& data,
+                                       const MvtReader::GeometryVisitor visitor,
+                                       const MvtReader::Filter& filter) const
+{
+    const auto geometryTile = std::make_shared<OsmAnd::MvtReader::Tile>();
+
+    ::google::protobuf::io::ArrayInputStream zcis(data.constData(), data.size());
+    return readTile(&zcis, geometryTile, visitor, filter);
+}
+
+bool OsmAnd::MvtReader_P::readTile(::google::protobuf::io::ZeroCopyInputStream* zcis,
+                                   const std::shared_ptr<OsmAnd::MvtReader::Tile>& geometryTile,
+                                   const MvtReader::GeometryVisitor visitor,
+                                   const MvtReader::Filter& filter) const
 {
     GOOGLE_PROTOBUF_VERIFY_VERSION;
-    
-    auto geometryTile = std::make_shared<OsmAnd::MvtReader::Tile>();
-    
-    std::string filename = pathToFile.toStdString();
-    OsmAnd::VectorTile::Tile tile;
-    
-    const auto input = std::shared_ptr<QIODevice>(new QFile(pathToFile));
-    // Create zero-copy input stream
-    ::google::protobuf::io::ZeroCopyInputStream* zcis = nullptr;
-    if (const auto inputFileDevice = std::dynamic_pointer_cast<QFileDevice>(input))
-        zcis = new QFileDeviceInputStream(inputFileDevice);
-    else
-        zcis = new QIODeviceInputStream(input);
-    
-    const auto cis = new ::google::protobuf::io::CodedInputStream(zcis);
-    cis->SetTotalBytesLimit(std::numeric_limits<int>::max(), std::numeric_limits<int>::max());
-    
-    bool res = tile.MergeFromCodedStream(cis);
-    delete cis;
-    delete zcis;
 
-    if (!res)
+    ::google::protobuf::io::CodedInputStream cis(zcis);
+    cis.SetTotalBytesLimit(std::numeric_limits<int>::max(), std::numeric_limits<int>::max());
+
+    for (;;)
     {
-        LogPrintf(OsmAnd::LogSeverityLevel::Debug, "Failed to parse protobuf");
-        return geometryTile;
+        const auto tag = cis.ReadTag();
+        switch (gpb::internal::WireFormatLite::GetTagFieldNumber(tag))
+        {
+            case 0:
+                if (!reachedMessageEnd(&cis, tag))
+                {
+                    LogPrintf(OsmAnd::LogSeverityLevel::Debug, "Failed to parse protobuf");
+                    return false;
+                }
+                return true;
+            case VectorTile::Tile::kLayersFieldNumber:
+            {
+                // Only one layer is held at once, and it's released as soon as it was visited
+                gpb::uint32 length;
+                if (!cis.ReadVarint32(&length))
+                {
+                    LogPrintf(OsmAnd::LogSeverityLevel::Debug, "Failed to parse protobuf");
+                    return false;
+                }
+                const auto oldLimit = cis.PushLimit(length);
+
+                Layer layer;
+                bool accepted = false;
+                if (!readLayer(&cis, layer, filter, accepted))
+                {
+                    LogPrintf(OsmAnd::LogSeverityLevel::Debug, "Failed to parse protobuf");
+                    return false;
+                }
+
+                cis.PopLimit(oldLimit);
+
+                if (accepted && !visitLayer(geometryTile, layer, visitor))
+                    return true;
+                break;
+            }
+            default:
+                if (!gpb::internal::WireFormatLite::SkipField(&cis, tag))
+                {
+                    LogPrintf(OsmAnd::LogSeverityLevel::Debug, "Failed to parse protobuf");
+                    return false;
+                }
+                break;
+        }
     }
-    
-    for (int i = 0; i < static_cast<std::size_t>(tile.layers_size()); ++i)
+}
+
+bool OsmAnd::MvtReader_P::reachedMessageEnd(::google::protobuf::io::CodedInputStream* cis,
+                                            const ::google::protobuf::uint32 tag) const
+{
+    // Protobuf treats end of input as legitimate end of message even inside of embedded message, so
+    // bytes left until limit mean that tile is truncated
+    if (tag != 0 || !ObfReaderUtilities::reachedDataEnd(cis))
+        return false;
+    if (cis->BytesUntilLimit() > 0)
     {
-        const auto& layer = tile.layers(i);
-        
-        for (int j = 0; j < static_cast<std::size_t>(layer.features_size()); ++j)
+        LogPrintf(LogSeverityLevel::Warning,
+            "Unexpected data end at %d, %d byte(s) not read",
+            cis->CurrentPosition(),
+            cis->BytesUntilLimit());
+        return false;
+    }
+
+    return true;
+}
+
+bool OsmAnd::MvtReader_P::readLayer(::google::protobuf::io::CodedInputStream* cis,
+                                    Layer& layer,
+                                    const MvtReader::Filter& filter,
+                                    bool& outAccepted) const
+{
+    for (;;)
+    {
+        const auto tag = cis->ReadTag();
+        switch (gpb::internal::WireFormatLite::GetTagFieldNumber(tag))
         {
-            const auto& feature = layer.features(j);
-            
-            if (feature.type() == VectorTile::Tile_GeomType_UNKNOWN)
-                continue;
-            
-            const auto& geomCmds = feature.geometry();
-            readGeometry(geometryTile, geomCmds, feature, layer);
+            case 0:
+                outAccepted = true;
+                return reachedMessageEnd(cis, tag);
+            case VectorTile::Tile_Layer::kNameFieldNumber:
+                if (!ObfReaderUtilities::readQString(cis, layer.name))
+                    return false;
+                if (!filter.layerNames.isEmpty() && !filter.layerNames.contains(layer.name))
+                {
+                    outAccepted = false;
+                    return cis->Skip(cis->BytesUntilLimit());
+                }
+                break;
+            case VectorTile::Tile_Layer::kFeaturesFieldNumber:
+            {
+                gpb::uint32 length;
+                if (!cis->ReadVarint32(&length))
+                    return false;
+                const auto oldLimit = cis->PushLimit(length);
+
+                Feature feature;
+                bool accepted = false;
+                if (!readFeature(cis, feature, filter, accepted))
+                    return false;
+                if (accepted)
+                    layer.features.push_back(qMove(feature));
+
+                cis->PopLimit(oldLimit);
+                break;
+            }
+            case VectorTile::Tile_Layer::kKeysFieldNumber:
+            {
+                // Only keys known to MvtReader are ever used, so keys are kept as their ids
+                std::string key;
+                if (!gpb::internal::WireFormatLite::ReadString(cis, &key))
+                    return false;
+                layer.keyIds.push_back(MvtReader::getUserDataId(key));
+                break;
+            }
+            case VectorTile::Tile_Layer::kValuesFieldNumber:
+            {
+                gpb::uint32 length;
+                if (!cis->ReadVarint32(&length))
+                    return false;
+                const auto oldLimit = cis->PushLimit(length);
+
+                QVariant value;
+                if (!readValue(cis, value))
+                    return false;
+                layer.values.push_back(qMove(value));
+
+                cis->PopLimit(oldLimit);
+                break;
+            }
+            default:
+                if (!gpb::internal::WireFormatLite::SkipField(cis, tag))
+                    return false;
+                break;
         }
     }
+}
 
-    return geometryTile;
+bool OsmAnd::MvtReader_P::readFeature(::google::protobuf::io::CodedInputStream* cis,
+                                      Feature& feature,
+                                      const MvtReader::Filter& filter,
+                                      bool& outAccepted) const
+{
+    for (;;)
+    {
+        const auto tag = cis->ReadTag();
+        switch (gpb::internal::WireFormatLite::GetTagFieldNumber(tag))
+        {
+            case 0:
+                outAccepted = isFeatureTypeAccepted(feature.type, filter);
+                return reachedMessageEnd(cis, tag);
+            case VectorTile::Tile_Feature::kTypeFieldNumber:
+            {
+                // Type usually precedes geometry, so geometry of rejected features is not even read
+                gpb::uint32 type;
+                if (!cis->ReadVarint32(&type))
+                    return false;
+                feature.type = VectorTile::Tile_GeomType_IsValid(type)
+                    ? static_cast<VectorTile::Tile_GeomType>(type)
+                    : VectorTile::Tile_GeomType_UNKNOWN;
+                if (!isFeatureTypeAccepted(feature.type, filter))
+                {
+                    outAccepted = false;
+                    return cis->Skip(cis->BytesUntilLimit());
+                }
+                break;
+            }
+            case VectorTile::Tile_Feature::kTagsFieldNumber:
+                if (!readPackedValues(cis, tag, feature.tags))
+                    return false;
+                break;
+            case VectorTile::Tile_Feature::kGeometryFieldNumber:
+                if (!readPackedValues(cis, tag, feature.geometry))
+                    return false;
+                break;
+            default:
+                if (!gpb::internal::WireFormatLite::SkipField(cis, tag))
+                    return false;
+                break;
+        }
+    }
+}
+
+bool OsmAnd::MvtReader_P::readValue(::google::protobuf::io::CodedInputStream* cis, QVariant& outValue) const
+{
+    for (;;)
+    {
+        const auto tag = cis->ReadTag();
+        switch (gpb::internal::WireFormatLite::GetTagFieldNumber(tag))
+        {
+            case 0:
+                return reachedMessageEnd(cis, tag);
+            case VectorTile::Tile_Value::kStringValueFieldNumber:
+            {
+                QString value;
+                if (!ObfReaderUtilities::readQString(cis, value))
+                    return false;
+                outValue = QVariant(value);
+                break;
+            }
+            case VectorTile::Tile_Value::kFloatValueFieldNumber:
+            {
+                gpb::uint32 value;
+                if (!cis->ReadLittleEndian32(&value))
+                    return false;
+                outValue = QVariant(gpb::internal::WireFormatLite::DecodeFloat(value));
+                break;
+            }
+            case VectorTile::Tile_Value::kDoubleValueFieldNumber:
+            {
+                gpb::uint64 value;
+                if (!cis->ReadLittleEndian64(&value))
+                    return false;
+                outValue = QVariant(gpb::internal::WireFormatLite::DecodeDouble(value));
+                break;
+            }
+            case VectorTile::Tile_Value::kIntValueFieldNumber:
+            {
+                gpb::uint64 value;
+                if (!cis->ReadVarint64(&value))
+                    return false;
+                outValue = QVariant(static_cast<qlonglong>(value));
+                break;
+            }
+            case VectorTile::Tile_Value::kUintValueFieldNumber:
+            {
+                gpb::uint64 value;
+                if (!cis->ReadVarint64(&value))
+                    return false;
+                outValue = QVariant(static_cast<qulonglong>(value));
+                break;
+            }
+            case VectorTile::Tile_Value::kSintValueFieldNumber:
+            {
+                gpb::uint64 value;
+                if (!cis->ReadVarint64(&value))
+                    return false;
+                outValue = QVariant(static_cast<qlonglong>(gpb::internal::WireFormatLite::ZigZagDecode64(value)));
+                break;
+            }
+            case VectorTile::Tile_Value::kBoolValueFieldNumber:
+            {
+                gpb::uint64 value;
+                if (!cis->ReadVarint64(&value))
+                    return false;
+                outValue = QVariant(value != 0);
+                break;
+            }
+            default:
+                if (!gpb::internal::WireFormatLite::SkipField(cis, tag))
+                    return false;
+                break;
+        }
+    }
+}
+
+bool OsmAnd::MvtReader_P::readPackedValues(::google::protobuf::io::CodedInputStream* cis,
+                                           const ::google::protobuf::uint32 tag,
+                                           QVector<uint32_t>& values) const
+{
+    // Unpacked encoding is valid too, where each value has its own tag
+    if (gpb::internal::WireFormatLite::GetTagWireType(tag) != gpb::internal::WireFormatLite::WIRETYPE_LENGTH_DELIMITED)
+    {
+        gpb::uint32 value;
+        if (!cis->ReadVarint32(&value))
+            return false;
+        values.push_back(value);
+        return true;
+    }
+
+    // Length is not trusted for reserving, since it's not verified against size of input until read
+    gpb::uint32 length;
+    if (!cis->ReadVarint32(&length))
+        return false;
+    const auto oldLimit = cis->PushLimit(length);
+
+    while (cis->BytesUntilLimit() > 0)
+    {
+        gpb::uint32 value;
+        if (!cis->ReadVarint32(&value))
+            return false;
+        values.push_back(value);
+    }
+
+    cis->PopLimit(oldLimit);
+    return true;
+}
+
+bool OsmAnd::MvtReader_P::isFeatureTypeAccepted(const VectorTile::Tile_GeomType type,
+                                                const MvtReader::Filter& filter) const
+{
+    switch (type)
+    {
+        case VectorTile::Tile_GeomType_POINT:
+            return filter.geometryTypes.isEmpty() || filter.geometryTypes.contains(MvtReader::POINT);
+        case VectorTile::Tile_GeomType_LINESTRING:
+            return filter.geometryTypes.isEmpty() || filter.geometryTypes.contains(MvtReader::LINE_STRING);
+        default:
+            return false;
+    }
+}
+
+bool OsmAnd::MvtReader_P::visitLayer(const std::shared_ptr<OsmAnd::MvtReader::Tile>& geometryTile,
+                                     const Layer& layer,
+                                     const MvtReader::GeometryVisitor visitor) const
+{
+    for (const auto& feature : constOf(layer.features))
+    {
+        std::shared_ptr<OsmAnd::MvtReader::Geometry> geom = nullptr;
+        switch (feature.type)
+        {
+            case VectorTile::Tile_GeomType_POINT:
+                geom = readPoint(feature.geometry);
+                break;
+            case VectorTile::Tile_GeomType_LINESTRING:
+                geom = readLineString(feature.geometry);
+                break;
+            default:
+                break;
+        }
+        if (geom == nullptr)
+            continue;
+
+        geom->setUserData(parseUserData(geometryTile, feature.tags, layer));
+        if (!visitor(geometryTile, layer.name, geom))
+            return false;
+    }
+
+    return true;
 }
 
 QHash<uint8_t, QVariant> OsmAnd::MvtReader_P::parseUserData(const std::shared_ptr<OsmAnd::MvtReader::Tile>& geometryTile,
-                                                            const ::google::protobuf::RepeatedField< ::google::protobuf::uint32 > &tags,
-                                                            const ::google::protobuf::RepeatedPtrField< ::std::string > &keys,
-                                                            const google::protobuf::RepeatedPtrField< ::OsmAnd::VectorTile::Tile_Value > &values) const
+                                                            const QVector<uint32_t>& tags,
+                                                            const Layer& layer) const
 {
     QHash<uint8_t, QVariant> result;
     uint32_t keyIndex, valIndex;
     for (int i = 0; i < tags.size() - 1; i += 2)
     {
-        keyIndex = tags.Get(i);
-        valIndex = tags.Get(i + 1);
+        keyIndex = tags[i];
+        valIndex = tags[i + 1];
         
-        if (keyIndex >= 0 && keyIndex < keys.size() && valIndex >= 0 && valIndex < values.size())
+        if (keyIndex < layer.keyIds.size() && valIndex < layer.values.size())
         {
-            auto userDataId = MvtReader::getUserDataId(keys.Get(keyIndex));
+            auto userDataId = layer.keyIds[keyIndex];
             if (userDataId != UNKNOWN_ID)
             {
-                QVariant var = tileValueToVariant(values.Get(valIndex));
+                const auto& var = layer.values[valIndex];
                 if (userDataId == USERKEY_ID)
                     result[userDataId] = geometryTile->addUserKey(var.toString());
                 else if (userDataId == SKEY_ID)
@@ -108,54 +463,12 @@ QHash<uint8_t, QVariant> OsmAnd::MvtReader_P::parseUserData(const std::shared_pt
     return result;
 }
 
-QVariant OsmAnd::MvtReader_P::tileValueToVariant(const OsmAnd::VectorTile::Tile_Value &value) const
-{
-    QVariant res;
-    if (value.has_double_value())
-        res = QVariant(value.double_value());
-    else if (value.has_float_value())
-        res = QVariant(value.float_value());
-    else if (value.has_int_value())
-        res = QVariant((qlonglong)value.int_value());
-    else if (value.has_bool_value())
-        res = QVariant(value.bool_value());
-    else if (value.has_string_value())
-        res = QVariant(value.string_value().c_str());
-    else if (value.has_sint_value())
-        res = QVariant((qlonglong)value.sint_value());
-    else if (value.has_uint_value())
-        res = QVariant((qulonglong)value.uint_value());
-
-    return res;
-}
-
-void OsmAnd::MvtReader_P::readGeometry(const std::shared_ptr<OsmAnd::MvtReader::Tile>& geometryTile,
-                                       const ::google::protobuf::RepeatedField< ::google::protobuf::uint32 >& geometry,
-                                       const VectorTile::Tile_Feature& feature,
-                                       const VectorTile::Tile_Layer& layer) const
+OsmAnd::MvtReader_P::Feature::Feature()
+    : type(VectorTile::Tile_GeomType_UNKNOWN)
 {
-    std::shared_ptr<OsmAnd::MvtReader::Geometry> geom = nullptr;
-    switch (feature.type()) {
-        case VectorTile::Tile_GeomType_POINT:
-            geom = readPoint(geometry);
-            break;
-        case VectorTile::Tile_GeomType_LINESTRING:
-            geom = readLineString(geometry);
-            break;
-//        case VectorTile::Tile_GeomType_POLYGON:
-//            readMultiLineString(geometry, res);
-//            break;
-        default:
-            break;
-    }
-    if (geom != nullptr)
-    {
-        geom->setUserData(parseUserData(geometryTile, feature.tags(), layer.keys(), layer.values()));
-        geometryTile->addGeometry(geom);
-    }
 }
 
-std::shared_ptr<OsmAnd::MvtReader::Geometry> OsmAnd::MvtReader_P::readPoint(const ::google::protobuf::RepeatedField< ::google::protobuf::uint32 >& geometry) const
+std::shared_ptr<OsmAnd::MvtReader::Geometry> OsmAnd::MvtReader_P::readPoint(const QVector<uint32_t>& geometry) const
 {
     if (geometry.size() == 0)
         return nullptr;
@@ -164,7 +477,7 @@ std::shared_ptr<OsmAnd::MvtReader::Geometry> OsmAnd::MvtReader_P::readPoint(cons
     int i = 0;
     
     // Read command header
-    const int cmdHdr = geometry.Get(i++);
+    const int cmdHdr = geometry[i++];
     const int cmdLength = cmdHdr >> 3;
     const OsmAnd::CommandType cmd = getCommandType(cmdHdr);
     
@@ -184,8 +497,8 @@ std::shared_ptr<OsmAnd::MvtReader::Geometry> OsmAnd::MvtReader_P::readPoint(cons
     OsmAnd::PointI nextCoord;
     
     while (i < geometry.size() - 1) {
-        int x = zigZagDecode(geometry.Get(i++));
-        int y = zigZagDecode(geometry.Get(i++));
+        int x = zigZagDecode(geometry[i++]);
+        int y = zigZagDecode(geometry[i++]);
         nextCoord = OsmAnd::PointI(x, y);
     }
     return std::make_shared<OsmAnd::MvtReader::Point>(nextCoord);
@@ -223,7 +536,7 @@ OsmAnd::CommandType OsmAnd::MvtReader_P::getCommandType(const int &cmdHdr) const
     
 }
 
-std::shared_ptr<OsmAnd::MvtReader::Geometry> OsmAnd::MvtReader_P::readLineString(const ::google::protobuf::RepeatedField< ::google::protobuf::uint32 >& geometry) const
+std::shared_ptr<OsmAnd::MvtReader::Geometry> OsmAnd::MvtReader_P::readLineString(const QVector<uint32_t>& geometry) const
 {
     // Guard: must have header
     if (geometry.size() == 0)
@@ -246,7 +559,7 @@ std::shared_ptr<OsmAnd::MvtReader::Geometry> OsmAnd::MvtReader_P::readLineString
         // --------------------------------------------
         
         // Read command header
-        cmdHdr = geometry.Get(i++);
+        cmdHdr = geometry[i++];
         cmdLength = cmdHdr >> 3;
         cmd = getCommandType(cmdHdr);
         
@@ -254,15 +567,15 @@ std::shared_ptr<OsmAnd::MvtReader::Geometry> OsmAnd::MvtReader_P::readLineString
         if (cmd != SEG_MOVETO || cmdLength != 1)
             break;
         
-        nextX += zigZagDecode(geometry.Get(i++));
-        nextY += zigZagDecode(geometry.Get(i++));
+        nextX += zigZagDecode(geometry[i++]);
+        nextY += zigZagDecode(geometry[i++]);
         
         // --------------------------------------------
         // Expected: LineTo command of length > 0
         // --------------------------------------------
         
         // Read command header
-        cmdHdr = geometry.Get(i++);
+        cmdHdr = geometry[i++];
         cmdLength = cmdHdr >> 3;
         cmd = getCommandType(cmdHdr);
         
@@ -279,8 +592,8 @@ std::shared_ptr<OsmAnd::MvtReader::Geometry> OsmAnd::MvtReader_P::readLineString
         
         // Set remaining points from LineTo command
         for (int lineToIndex = 0; lineToIndex < cmdLength; ++lineToIndex) {
-            nextX += zigZagDecode(geometry.Get(i++));
-            nextY += zigZagDecode(geometry.Get(i++));
+            nextX += zigZagDecode(geometry[i++]);
+            nextY += zigZagDecode(geometry[i++]);
             points << OsmAnd::PointI(nextX, nextY);
         }
 
@@ -11,6 +11,11 @@
 #include "restore_internal_warnings.h"
 
 #include <OsmAndCore/QtExtensions.h>
+#include <QByteArray>
+#include <QList>
+#include <QVector>
+
+#include "MvtReader.h"
 
 namespace OsmAnd
 {
@@ -26,24 +31,69 @@ namespace OsmAnd
     {
         Q_DISABLE_COPY_AND_MOVE(MvtReader_P);
     public:
-        std::shared_ptr<const OsmAnd::MvtReader::Tile> parseTile(const QString &pathToFile) const;
+        std::shared_ptr<const OsmAnd::MvtReader::Tile> parseTile(const QString &pathToFile,
+                                                                 const MvtReader::Filter& filter) const;
+        std::shared_ptr<const OsmAnd::MvtReader::Tile> parseTileData(const QByteArray& data,
+                                                                     const MvtReader::Filter& filter) const;
+        bool readTile(const QString& pathToFile,
+                      const MvtReader::GeometryVisitor visitor,
+                      const MvtReader::Filter& filter) const;
+        bool readTileData(const QByteArray& data,
+                          const MvtReader::GeometryVisitor visitor,
+                          const MvtReader::Filter& filter) const;
     private:
-        void readGeometry(const std::shared_ptr<OsmAnd::MvtReader::Tile>& geometryTile,
-                          const ::google::protobuf::RepeatedField< ::google::protobuf::uint32 >& geometry,
-                          const VectorTile::Tile_Feature& feature,
-                          const VectorTile::Tile_Layer& layer) const;
-        
+        // Features keep raw commands and tags until keys and values of their layer are read
+        struct Feature
+        {
+            Feature();
+
+            VectorTile::Tile_GeomType type;
+            QVector<uint32_t> tags;
+            QVector<uint32_t> geometry;
+        };
+        struct Layer
+        {
+            QString name;
+            QVector<uint8_t> keyIds;
+            QVector<QVariant> values;
+            QList<Feature> features;
+        };
+
+        std::shared_ptr<const OsmAnd::MvtReader::Tile> parseTile(::google::protobuf::io::ZeroCopyInputStream* zcis,
+                                                                 const MvtReader::Filter& filter) const;
+        bool readTile(::google::protobuf::io::ZeroCopyInputStream* zcis,
+                      const std::shared_ptr<OsmAnd::MvtReader::Tile>& geometryTile,
+                      const MvtReader::GeometryVisitor visitor,
+                      const MvtReader::Filter& filter) const;
+        // Readers of embedded messages fail on malformed or truncated data
+        bool reachedMessageEnd(::google::protobuf::io::CodedInputStream* cis,
+                               const ::google::protobuf::uint32 tag) const;
+        bool readLayer(::google::protobuf::io::CodedInputStream* cis,
+                       Layer& layer,
+                       const MvtReader::Filter& filter,
+                       bool& outAccepted) const;
+        bool readFeature(::google::protobuf::io::CodedInputStream* cis,
+                         Feature& feature,
+                         const MvtReader::Filter& filter,
+                         bool& outAccepted) const;
+        bool readValue(::google::protobuf::io::CodedInputStream* cis, QVariant& outValue) const;
+        bool readPackedValues(::google::protobuf::io::CodedInputStream* cis,
+                              const ::google::protobuf::uint32 tag,
+                              QVector<uint32_t>& values) const;
+        bool isFeatureTypeAccepted(const VectorTile::Tile_GeomType type, const MvtReader::Filter& filter) const;
+        bool visitLayer(const std::shared_ptr<OsmAnd::MvtReader::Tile>& geometryTile,
+                        const Layer& layer,
+                        const MvtReader::GeometryVisitor visitor) const;
+
         QHash<uint8_t, QVariant> parseUserData(const std::shared_ptr<OsmAnd::MvtReader::Tile>& geometryTile,
-                                               const ::google::protobuf::RepeatedField< ::google::protobuf::uint32 > &tags,
-                                               const ::google::protobuf::RepeatedPtrField< ::std::string> &keys,
-                                               const google::protobuf::RepeatedPtrField<::OsmAnd::VectorTile::Tile_Value> &values) const;
+                                               const QVector<uint32_t>& tags,
+                                               const Layer& layer) const;
         
-        std::shared_ptr<OsmAnd::MvtReader::Geometry> readPoint(const ::google::protobuf::RepeatedField< ::google::protobuf::uint32 >& geometry) const;
-        std::shared_ptr<OsmAnd::MvtReader::Geometry> readLineString(const ::google::protobuf::RepeatedField< ::google::protobuf::uint32 >& geometry) const;
+        std::shared_ptr<OsmAnd::MvtReader::Geometry> readPoint(const QVector<uint32_t>& geometry) const;
+        std::shared_ptr<OsmAnd::MvtReader::Geometry> readLineString(const QVector<uint32_t>& geometry) const;
         
         CommandType getCommandType(const int &cmdHdr) const;
         int zigZagDecode(const int &n) const;
-        QVariant tileValueToVariant(const OsmAnd::VectorTile::Tile_Value &value) const;
     protected:
     public:
         MvtReader_P();
@@ -7,6 +7,8 @@
 #include <QSet>
 #include <QHash>
 #include <QList>
+#include <QVector>
+#include <QMutex>
 #include "restore_internal_warnings.h"
 
 #include "Ref.h"
@@ -31,9 +33,14 @@
 #include "IQueryController.h"
 #include "FunctorQueryController.h"
 #include "QKeyValueIterator.h"
+#include "ParallelFor.h"
+#include "ObfMapSectionReader_Metrics.h"
+#include "ObfRoutingSectionReader_Metrics.h"
 
 OsmAnd::ObfDataInterface::ObfDataInterface(const QList< std::shared_ptr<const ObfReader> >& obfReaders_)
-    : obfReaders(obfReaders_)
+    : _parallelReadingThreadPool(nullptr)
+    , _maxParallelReaders(0)
+    , obfReaders(obfReaders_)
 {
 }
 
@@ -41,6 +48,27 @@ OsmAnd::ObfDataInterface::~ObfDataInterface()
 {
 }
 
+QThreadPool* OsmAnd::ObfDataInterface::getParallelReadingThreadPool() const
+{
+    return _parallelReadingThreadPool;
+}
+
+int OsmAnd::ObfDataInterface::getMaxParallelReaders() const
+{
+    return _maxParallelReaders;
+}
+
+void OsmAnd::ObfDataInterface::setParallelReading(QThreadPool* const threadPool, const int maxParallelReaders /*= 0*/)
+{
+    _parallelReadingThreadPool = threadPool;
+    _maxParallelReaders = maxParallelReaders;
+}
+
+bool OsmAnd::ObfDataInterface::shouldReadInParallel() const
+{
+    return _parallelReadingThreadPool && _maxParallelReaders != 1 && obfReaders.size() > 1;
+}
+
 bool OsmAnd::ObfDataInterface::loadObfFiles(
     QList< std::shared_ptr<const ObfFile> >* outFiles /*= nullptr*/,
     const std::shared_ptr<const IQueryController>& queryController /*= nullptr*/)
@@ -71,6 +99,20 @@ bool OsmAnd::ObfDataInterface::loadBinaryMapObjects(
     const std::shared_ptr<const IQueryController>& queryController /*= nullptr*/,
     ObfMapSectionReader_Metrics::Metric_loadMapObjects* const metric /*= nullptr*/)
 {
+    if (shouldReadInParallel())
+    {
+        return loadBinaryMapObjectsInParallel(
+            resultOut,
+            outSurfaceType,
+            zoom,
+            bbox31,
+            filterById,
+            cache,
+            outReferencedCacheEntries,
+            queryController,
+            metric);
+    }
+
     auto mergedSurfaceType = MapSurfaceType::Undefined;
     std::shared_ptr<const ObfReader> basemapReader;
 
@@ -186,6 +228,171 @@ bool OsmAnd::ObfDataInterface::loadBinaryMapObjects(
     return true;
 }
 
+bool OsmAnd::ObfDataInterface::loadBinaryMapObjectsInParallel(
+    QList< std::shared_ptr<const OsmAnd::BinaryMapObject> >* resultOut,
+    MapSurfaceType* outSurfaceType,
+    const ZoomLevel zoom,
+    const AreaI* const bbox31,
+    const ObfMapSectionReader::FilterByIdFunction filterById,
+    ObfMapSectionReader::DataBlocksCache* cache,
+    QList< std::shared_ptr<const ObfMapSectionReader::DataBlock> >* outReferencedCacheEntries,
+    const std::shared_ptr<const IQueryController>& queryController,
+    ObfMapSectionReader_Metrics::Metric_loadMapObjects* const metric)
+{
+    struct Job
+    {
+        std::shared_ptr<const ObfReader> obfReader;
+        ZoomLevel zoom;
+        const AreaI* bbox31;
+        bool isDeferredBasemap;
+
+        QList< std::shared_ptr<const OsmAnd::BinaryMapObject> > mapObjects;
+        QList< std::shared_ptr<const ObfMapSectionReader::DataBlock> > referencedCacheEntries;
+        QList<MapSurfaceType> surfaceTypes;
+        std::shared_ptr<ObfMapSectionReader_Metrics::Metric_loadMapObjects> metric;
+    };
+
+    // Collect jobs on calling thread, keeping same basemap rules as sequential reading
+    std::shared_ptr<const ObfReader> basemapReader;
+    std::vector<Job> jobs;
+    jobs.reserve(obfReaders.size() + 1);
+    for (const auto& obfReader : constOf(obfReaders))
+    {
+        if (queryController && queryController->isAborted())
+            return false;
+
+        const auto& obfInfo = obfReader->obtainInfo();
+
+        if (obfInfo->isBasemapWithCoastlines)
+        {
+            if (basemapReader)
+            {
+                LogPrintf(LogSeverityLevel::Warning, "More than 1 basemap available");
+                continue;
+            }
+            basemapReader = obfReader;
+
+            if (zoom > static_cast<ZoomLevel>(ObfMapSectionLevel::MaxBasemapZoomLevel))
+                continue;
+        }
+
+        Job job;
+        job.obfReader = obfReader;
+        job.zoom = zoom;
+        job.bbox31 = bbox31;
+        job.isDeferredBasemap = false;
+        jobs.push_back(qMove(job));
+    }
+    AreaI basemapBBox31;
+    if (basemapReader && zoom > static_cast<ZoomLevel>(ObfMapSectionLevel::MaxBasemapZoomLevel))
+    {
+        if (bbox31)
+        {
+            basemapBBox31 = Utilities::roundBoundingBox31(
+                *bbox31,
+                static_cast<ZoomLevel>(ObfMapSectionLevel::MaxBasemapZoomLevel));
+        }
+
+        Job job;
+        job.obfReader = basemapReader;
+        job.zoom = static_cast<ZoomLevel>(ObfMapSectionLevel::MaxBasemapZoomLevel);
+        job.bbox31 = bbox31 ? &basemapBBox31 : nullptr;
+        job.isDeferredBasemap = true;
+        jobs.push_back(qMove(job));
+    }
+
+    // Each OBF file is read by a single task, since sections of same file share reader stream.
+    // Filtering by ID is applied later during merge, so that the copy of object present in several files is
+    // accepted from the same file as in sequential reading, and filterById needs not be thread-safe.
+    Concurrent::ParallelFor::run(
+        _parallelReadingThreadPool,
+        static_cast<int>(jobs.size()),
+        [&jobs, cache, outReferencedCacheEntries, queryController, metric]
+        (const int index)
+        {
+            auto& job = jobs[index];
+            if (metric)
+                job.metric.reset(new ObfMapSectionReader_Metrics::Metric_loadMapObjects());
+
+            const auto& obfInfo = job.obfReader->obtainInfo();
+            for (const auto& mapSection : constOf(obfInfo->mapSections))
+            {
+                if (queryController && queryController->isAborted())
+                    return;
+
+                auto surfaceType = MapSurfaceType::Undefined;
+                OsmAnd::ObfMapSectionReader::loadMapObjects(
+                    job.obfReader,
+                    mapSection,
+                    job.zoom,
+                    job.bbox31,
+                    &job.mapObjects,
+                    &surfaceType,
+                    nullptr,
+                    nullptr,
+                    cache,
+                    outReferencedCacheEntries ? &job.referencedCacheEntries : nullptr,
+                    queryController,
+                    job.metric.get());
+                job.surfaceTypes.push_back(surfaceType);
+            }
+        },
+        _maxParallelReaders);
+
+    if (queryController && queryController->isAborted())
+        return false;
+
+    // Merge results in order of jobs
+    auto mergedSurfaceType = MapSurfaceType::Undefined;
+    for (auto& job : jobs)
+    {
+        for (auto& mapObject : job.mapObjects)
+        {
+            const auto shouldReject = filterById && !filterById(
+                mapObject->section,
+                mapObject->id,
+                mapObject->bbox31,
+                mapObject->level->minZoom,
+                mapObject->level->maxZoom,
+                job.zoom);
+            if (shouldReject)
+                continue;
+
+            if (resultOut)
+                resultOut->push_back(qMove(mapObject));
+        }
+
+        if (outReferencedCacheEntries)
+            outReferencedCacheEntries->append(job.referencedCacheEntries);
+
+        for (const auto surfaceTypeToMerge : constOf(job.surfaceTypes))
+        {
+            // Basemap must always have a surface type defined
+            if (job.isDeferredBasemap)
+                assert(surfaceTypeToMerge != MapSurfaceType::Undefined);
+            else if (surfaceTypeToMerge == MapSurfaceType::Undefined)
+                continue;
+
+            if (mergedSurfaceType == MapSurfaceType::Undefined)
+                mergedSurfaceType = surfaceTypeToMerge;
+            else if (mergedSurfaceType != surfaceTypeToMerge)
+                mergedSurfaceType = MapSurfaceType::Mixed;
+        }
+
+        if (metric && job.metric)
+            metric->addSubmetric(job.metric);
+    }
+
+    // In case there was a basemap present, Undefined is Land
+    if (mergedSurfaceType == MapSurfaceType::Undefined && !basemapReader)
+        mergedSurfaceType = MapSurfaceType::FullLand;
+
+    if (outSurfaceType)
+        *outSurfaceType = mergedSurfaceType;
+
+    return true;
+}
+
 bool OsmAnd::ObfDataInterface::loadRoads(
     const RoutingDataLevel dataLevel,
     const AreaI* const bbox31 /*= nullptr*/,
@@ -197,6 +404,21 @@ bool OsmAnd::ObfDataInterface::loadRoads(
     const std::shared_ptr<const IQueryController>& queryController /*= nullptr*/,
     ObfRoutingSectionReader_Metrics::Metric_loadRoads* const metric /*= nullptr*/)
 {
+    if (shouldReadInParallel())
+    {
+        return loadRoadsInParallel(
+            obfReaders,
+            QSet<QString>(),
+            dataLevel,
+            bbox31,
+            resultOut,
+            filterById,
+            cache,
+            outReferencedCacheEntries,
+            queryController,
+            metric);
+    }
+
     for (const auto& obfReader : constOf(obfReaders))
     {
         if (queryController && queryController->isAborted())
@@ -226,6 +448,99 @@ bool OsmAnd::ObfDataInterface::loadRoads(
     return true;
 }
 
+bool OsmAnd::ObfDataInterface::loadRoadsInParallel(
+    const QList< std::shared_ptr<const ObfReader> >& readers,
+    const QSet<QString>& skippedSectionsNames,
+    const RoutingDataLevel dataLevel,
+    const AreaI* const bbox31,
+    QList< std::shared_ptr<const OsmAnd::Road> >* resultOut,
+    const FilterRoadsByIdFunction filterById,
+    ObfRoutingSectionReader::DataBlocksCache* cache,
+    QList< std::shared_ptr<const ObfRoutingSectionReader::DataBlock> >* outReferencedCacheEntries,
+    const std::shared_ptr<const IQueryController>& queryController,
+    ObfRoutingSectionReader_Metrics::Metric_loadRoads* const metric)
+{
+    struct Job
+    {
+        QList< std::shared_ptr<const OsmAnd::Road> > roads;
+        QList< std::shared_ptr<const ObfRoutingSectionReader::DataBlock> > referencedCacheEntries;
+        std::shared_ptr<ObfRoutingSectionReader_Metrics::Metric_loadRoads> metric;
+    };
+    std::vector<Job> jobs(readers.size());
+
+    // Each OBF file is read by a single task, filtering by ID is applied later during merge
+    Concurrent::ParallelFor::run(
+        _parallelReadingThreadPool,
+        readers.size(),
+        [&readers,
+            &skippedSectionsNames,
+            &jobs,
+            dataLevel,
+            bbox31,
+            cache,
+            outReferencedCacheEntries,
+            queryController,
+            metric]
+        (const int index)
+        {
+            const auto& obfReader = readers[index];
+            auto& job = jobs[index];
+            if (metric)
+                job.metric.reset(new ObfRoutingSectionReader_Metrics::Metric_loadRoads());
+
+            if (queryController && queryController->isAborted())
+                return;
+
+            const auto& obfInfo = obfReader->obtainInfo();
+            for (const auto& routingSection : constOf(obfInfo->routingSections))
+            {
+                if (queryController && queryController->isAborted())
+                    return;
+
+                if (skippedSectionsNames.contains(routingSection->name))
+                    continue;
+
+                OsmAnd::ObfRoutingSectionReader::loadRoads(
+                    obfReader,
+                    routingSection,
+                    dataLevel,
+                    bbox31,
+                    &job.roads,
+                    nullptr,
+                    nullptr,
+                    cache,
+                    outReferencedCacheEntries ? &job.referencedCacheEntries : nullptr,
+                    queryController,
+                    job.metric.get());
+            }
+        },
+        _maxParallelReaders);
+
+    if (queryController && queryController->isAborted())
+        return false;
+
+    // Merge results in order of readers
+    for (auto& job : jobs)
+    {
+        for (auto& road : job.roads)
+        {
+            if (filterById && !filterById(road->section, road->id, road->bbox31))
+                continue;
+
+            if (resultOut)
+                resultOut->push_back(qMove(road));
+        }
+
+        if (outReferencedCacheEntries)
+            outReferencedCacheEntries->append(job.referencedCacheEntries);
+
+        if (metric && job.metric)
+            metric->addSubmetric(job.metric);
+    }
+
+    return true;
+}
+
 bool OsmAnd::ObfDataInterface::loadRoutingTreeNodes(
     const std::shared_ptr<const ObfReader>& obfReader,
     const std::shared_ptr<const ObfRoutingSectionInfo>& routingSection,
@@ -264,6 +579,54 @@ bool OsmAnd::ObfDataInterface::loadMapObjects(
     ObfMapSectionReader_Metrics::Metric_loadMapObjects* const binaryMapObjectsMetric /*= nullptr*/,
     ObfRoutingSectionReader_Metrics::Metric_loadRoads* const roadsMetric /*= nullptr*/)
 {
+    if (shouldReadInParallel())
+    {
+        // Roads filter may depend on map objects that were accepted, so roads are read after all map objects
+        const auto ok = loadBinaryMapObjectsInParallel(
+            outBinaryMapObjects,
+            outSurfaceType,
+            zoom,
+            bbox31,
+            filterMapObjectsById,
+            binaryMapObjectsCache,
+            outReferencedBinaryMapObjectsCacheEntries,
+            queryController,
+            binaryMapObjectsMetric);
+        if (!ok || zoom <= static_cast<ZoomLevel>(ObfMapSectionLevel::MaxBasemapZoomLevel))
+            return ok;
+
+        // Same as sequential reading: roads are read only from files without map sections, skipping sections
+        // that were already read as map sections from other files (basemap is never read at this zoom)
+        QSet<QString> processedMapSectionsNames;
+        QList< std::shared_ptr<const ObfReader> > roadsReaders;
+        for (const auto& obfReader : constOf(obfReaders))
+        {
+            const auto& obfInfo = obfReader->obtainInfo();
+            if (!obfInfo->mapSections.isEmpty())
+            {
+                if (obfInfo->isBasemapWithCoastlines)
+                    continue;
+                for (const auto& mapSection : constOf(obfInfo->mapSections))
+                    processedMapSectionsNames.insert(mapSection->name);
+                continue;
+            }
+            if (!obfInfo->routingSections.isEmpty())
+                roadsReaders.push_back(obfReader);
+        }
+
+        return loadRoadsInParallel(
+            roadsReaders,
+            processedMapSectionsNames,
+            RoutingDataLevel::Detailed,
+            bbox31,
+            outRoads,
+            filterRoadsById,
+            roadsCache,
+            outReferencedRoadsCacheEntries,
+            queryController,
+            roadsMetric);
+    }
+
     auto mergedSurfaceType = MapSurfaceType::Undefined;
     std::shared_ptr<const ObfReader> basemapReader;
 
@@ -482,78 +845,151 @@ bool OsmAnd::ObfDataInterface::loadAmenities(
     const ObfPoiSectionReader::VisitorFunction visitor /*= nullptr*/,
     const std::shared_ptr<const IQueryController>& queryController /*= nullptr*/)
 {
+    if (shouldReadInParallel())
+    {
+        // Visitor may be stateful, so invoke it from one worker at a time
+        ObfPoiSectionReader::VisitorFunction serializedVisitor = nullptr;
+        if (visitor)
+        {
+            const std::shared_ptr<QMutex> visitorMutex(new QMutex());
+            serializedVisitor =
+                [visitor, visitorMutex]
+                (const std::shared_ptr<const OsmAnd::Amenity>& amenity) -> bool
+                {
+                    QMutexLocker scopedLocker(visitorMutex.get());
+                    return visitor(amenity);
+                };
+        }
+
+        QVector< QList< std::shared_ptr<const OsmAnd::Amenity> > > amenitiesPerReader(obfReaders.size());
+        Concurrent::ParallelFor::run(
+            _parallelReadingThreadPool,
+            obfReaders.size(),
+            [this, &amenitiesPerReader, outAmenities, pBbox31, tileFilter, zoomFilter, categoriesFilter, serializedVisitor, queryController]
+            (const int index)
+            {
+                loadAmenitiesFromReader(
+                    obfReaders[index],
+                    outAmenities ? &amenitiesPerReader[index] : nullptr,
+                    pBbox31,
+                    tileFilter,
+                    zoomFilter,
+                    categoriesFilter,
+                    serializedVisitor,
+                    queryController);
+            },
+            _maxParallelReaders);
+
+        if (queryController && queryController->isAborted())
+            return false;
+
+        if (outAmenities)
+        {
+            for (const auto& amenities : constOf(amenitiesPerReader))
+                outAmenities->append(amenities);
+        }
+
+        return true;
+    }
+
     for (const auto& obfReader : constOf(obfReaders))
+    {
+        if (!loadAmenitiesFromReader(
+            obfReader,
+            outAmenities,
+            pBbox31,
+            tileFilter,
+            zoomFilter,
+            categoriesFilter,
+            visitor,
+            queryController))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool OsmAnd::ObfDataInterface::loadAmenitiesFromReader(
+    const std::shared_ptr<const ObfReader>& obfReader,
+    QList< std::shared_ptr<const OsmAnd::Amenity> >* outAmenities,
+    const AreaI* const pBbox31,
+    const TileAcceptorFunction tileFilter,
+    const ZoomLevel zoomFilter,
+    const QHash<QString, QStringList>* const categoriesFilter,
+    const ObfPoiSectionReader::VisitorFunction visitor,
+    const std::shared_ptr<const IQueryController>& queryController)
+{
+    if (queryController && queryController->isAborted())
+        return false;
+
+    const auto& obfInfo = obfReader->obtainInfo();
+    for (const auto& poiSection : constOf(obfInfo->poiSections))
     {
         if (queryController && queryController->isAborted())
             return false;
 
-        const auto& obfInfo = obfReader->obtainInfo();
-        for (const auto& poiSection : constOf(obfInfo->poiSections))
+        if (pBbox31)
         {
-            if (queryController && queryController->isAborted())
-                return false;
+            bool accept = false;
+            accept = accept || poiSection->area31.contains(*pBbox31);
+            accept = accept || poiSection->area31.intersects(*pBbox31);
+            accept = accept || pBbox31->contains(poiSection->area31);
 
-            if (pBbox31)
-            {
-                bool accept = false;
-                accept = accept || poiSection->area31.contains(*pBbox31);
-                accept = accept || poiSection->area31.intersects(*pBbox31);
-                accept = accept || pBbox31->contains(poiSection->area31);
+            if (!accept)
+                continue;
+        }
 
-                if (!accept)
-                    continue;
-            }
+        QSet<ObfPoiCategoryId> categoriesFilterById;
+        if (categoriesFilter)
+        {
+            std::shared_ptr<const ObfPoiSectionCategories> categories;
+            OsmAnd::ObfPoiSectionReader::loadCategories(
+                obfReader,
+                poiSection,
+                categories,
+                queryController);
 
-            QSet<ObfPoiCategoryId> categoriesFilterById;
-            if (categoriesFilter)
-            {
-                std::shared_ptr<const ObfPoiSectionCategories> categories;
-                OsmAnd::ObfPoiSectionReader::loadCategories(
-                    obfReader,
-                    poiSection,
-                    categories,
-                    queryController);
+            if (!categories)
+                continue;
 
-                if (!categories)
+            for (const auto& categoriesFilterEntry : rangeOf(constOf(*categoriesFilter)))
+            {
+                const auto mainCategoryIndex = categories->mainCategories.indexOf(categoriesFilterEntry.key());
+                if (mainCategoryIndex < 0)
                     continue;
 
-                for (const auto& categoriesFilterEntry : rangeOf(constOf(*categoriesFilter)))
+                const auto& subcategories = categories->subCategories[mainCategoryIndex];
+                if (categoriesFilterEntry.value().isEmpty())
                 {
-                    const auto mainCategoryIndex = categories->mainCategories.indexOf(categoriesFilterEntry.key());
-                    if (mainCategoryIndex < 0)
-                        continue;
-
-                    const auto& subcategories = categories->subCategories[mainCategoryIndex];
-                    if (categoriesFilterEntry.value().isEmpty())
-                    {
-                        for (auto subCategoryIndex = 0; subCategoryIndex < subcategories.size(); subCategoryIndex++)
-                            categoriesFilterById.insert(ObfPoiCategoryId::create(mainCategoryIndex, subCategoryIndex));
-                    }
-                    else
+                    for (auto subCategoryIndex = 0; subCategoryIndex < subcategories.size(); subCategoryIndex++)
+                        categoriesFilterById.insert(ObfPoiCategoryId::create(mainCategoryIndex, subCategoryIndex));
+                }
+                else
+                {
+                    for (const auto& subcategory : constOf(categoriesFilterEntry.value()))
                     {
-                        for (const auto& subcategory : constOf(categoriesFilterEntry.value()))
-                        {
-                            const auto subCategoryIndex = subcategories.indexOf(subcategory);
-                            if (subCategoryIndex < 0)
-                                continue;
-
-                            categoriesFilterById.insert(ObfPoiCategoryId::create(mainCategoryIndex, subCategoryIndex));
-                        }
+                        const auto subCategoryIndex = subcategories.indexOf(subcategory);
+                        if (subCategoryIndex < 0)
+                            continue;
+
+                        categoriesFilterById.insert(ObfPoiCategoryId::create(mainCategoryIndex, subCategoryIndex));
                     }
                 }
             }
-
-            OsmAnd::ObfPoiSectionReader::loadAmenities(
-                obfReader,
-                poiSection,
-                outAmenities,
-                pBbox31,
-                tileFilter,
-                zoomFilter,
-                categoriesFilter ? &categoriesFilterById : nullptr,
-                visitor,
-                queryController);
         }
+
+        OsmAnd::ObfPoiSectionReader::loadAmenities(
+            obfReader,
+            poiSection,
+            outAmenities,
+            pBbox31,
+            tileFilter,
+            zoomFilter,
+            categoriesFilter ? &categoriesFilterById : nullptr,
+            visitor,
+            queryController);
     }
 
     return true;
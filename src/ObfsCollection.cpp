@@ -40,6 +40,26 @@ bool OsmAnd::ObfsCollection::remove(const SourceOriginId entryId)
     return _p->remove(entryId);
 }
 
+bool OsmAnd::ObfsCollection::isMemoryMappingEnabled() const
+{
+    return _p->isMemoryMappingEnabled();
+}
+
+void OsmAnd::ObfsCollection::setMemoryMappingEnabled(const bool enabled)
+{
+    _p->setMemoryMappingEnabled(enabled);
+}
+
+unsigned int OsmAnd::ObfsCollection::getReadersPoolCapacity() const
+{
+    return _p->getReadersPoolCapacity();
+}
+
+void OsmAnd::ObfsCollection::setReadersPoolCapacity(const unsigned int capacity)
+{
+    _p->setReadersPoolCapacity(capacity);
+}
+
 QList< std::shared_ptr<const OsmAnd::ObfFile> >OsmAnd::ObfsCollection::getObfFiles() const
 {
     return _p->getObfFiles();
@@ -21,6 +21,7 @@ OsmAnd::ObfsCollection_P::ObfsCollection_P(ObfsCollection* owner_)
     , _fileSystemWatcher(new QFileSystemWatcher())
     , _lastUnusedSourceOriginId(0)
     , _collectedSourcesInvalidated(1)
+    , _memoryMappingEnabled(0)
 {
     _fileSystemWatcher->moveToThread(gMainThread);
 
@@ -57,6 +58,9 @@ void OsmAnd::ObfsCollection_P::collectSources() const
 
     const Stopwatch collectSourcesStopwatch(true);
 
+    // Pooled readers keep collected files referenced and opened, so release them before checking sources
+    _readersPool.releaseAllReaders();
+
     std::shared_ptr<CachedOsmandIndexes> cachedOsmandIndexes = nullptr;
     QFile* indCache = NULL;
     if (_sourcesOrigins.size() > 0)
@@ -305,10 +309,31 @@ QList< std::shared_ptr<const OsmAnd::ObfFile> > OsmAnd::ObfsCollection_P::getObf
     return obfFiles;
 }
 
+bool OsmAnd::ObfsCollection_P::isMemoryMappingEnabled() const
+{
+    return _memoryMappingEnabled.loadAcquire() != 0;
+}
+
+void OsmAnd::ObfsCollection_P::setMemoryMappingEnabled(const bool enabled)
+{
+    _memoryMappingEnabled.storeRelease(enabled ? 1 : 0);
+}
+
+unsigned int OsmAnd::ObfsCollection_P::getReadersPoolCapacity() const
+{
+    return _readersPool.getCapacity();
+}
+
+void OsmAnd::ObfsCollection_P::setReadersPoolCapacity(const unsigned int capacity)
+{
+    _readersPool.setCapacity(capacity);
+}
+
 std::shared_ptr<OsmAnd::ObfDataInterface> OsmAnd::ObfsCollection_P::obtainDataInterface(
     const std::shared_ptr<const ObfFile> obfFile) const
 {
-    return std::shared_ptr<ObfDataInterface>(new ObfDataInterface({ std::make_shared<ObfReader>(obfFile) }));
+    return std::shared_ptr<ObfDataInterface>(new ObfDataInterface({
+        _readersPool.obtainReader(obfFile, isMemoryMappingEnabled()) }));
 }
 
 std::shared_ptr<OsmAnd::ObfDataInterface> OsmAnd::ObfsCollection_P::obtainDataInterface(
@@ -329,6 +354,7 @@ std::shared_ptr<OsmAnd::ObfDataInterface> OsmAnd::ObfsCollection_P::obtainDataIn
         collectSources();
 
     // Create ObfReaders from collected sources
+    const auto useMemoryMapping = isMemoryMappingEnabled();
     QList< std::shared_ptr<const ObfReader> > obfReaders;
     {
         QReadLocker scopedLocker(&_collectedSourcesLock);
@@ -349,7 +375,7 @@ std::shared_ptr<OsmAnd::ObfDataInterface> OsmAnd::ObfsCollection_P::obtainDataIn
                 }
 
                 // Otherwise, open file in any case to repeat check
-                std::shared_ptr<const ObfReader> obfReader(new ObfReader(obfFile));
+                const auto obfReader = _readersPool.obtainReader(obfFile, useMemoryMapping);
                 if (!obfReader->isOpened() || !obfReader->obtainInfo())
                     continue;
 
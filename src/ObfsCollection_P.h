@@ -15,6 +15,7 @@
 #include "CommonTypes.h"
 #include "PrivateImplementation.h"
 #include "ObfsCollection.h"
+#include "ObfReadersPool.h"
 
 namespace OsmAnd
 {
@@ -80,6 +81,9 @@ namespace OsmAnd
         mutable QHash< ObfsCollection::SourceOriginId, QHash<QString, std::shared_ptr<ObfFile> > > _collectedSources;
         mutable QReadWriteLock _collectedSourcesLock;
         void collectSources() const;
+
+        QAtomicInt _memoryMappingEnabled;
+        mutable ObfReadersPool _readersPool;
     public:
         virtual ~ObfsCollection_P();
 
@@ -90,6 +94,12 @@ namespace OsmAnd
         ObfsCollection::SourceOriginId addFile(const QFileInfo& fileInfo);
         bool remove(const ObfsCollection::SourceOriginId entryId);
 
+        bool isMemoryMappingEnabled() const;
+        void setMemoryMappingEnabled(const bool enabled);
+
+        unsigned int getReadersPoolCapacity() const;
+        void setReadersPoolCapacity(const unsigned int capacity);
+
         QList< std::shared_ptr<const ObfFile> > getObfFiles() const;
         std::shared_ptr<OsmAnd::ObfDataInterface> obtainDataInterface(
             const std::shared_ptr<const ObfFile> obfFile) const;
@@ -0,0 +1,71 @@
+#include "QFileMemoryMapping.h"
+
+#include "Logging.h"
+
+OsmAnd::QFileMemoryMapping::QFileMemoryMapping(
+    const std::shared_ptr<QFile>& file_,
+    uint8_t* const mappedMemory_)
+    : _file(file_)
+    , _mappedMemory(mappedMemory_)
+    , fileName(_file->fileName())
+    , size(_file->size())
+    , data(_mappedMemory)
+{
+}
+
+OsmAnd::QFileMemoryMapping::~QFileMemoryMapping()
+{
+    if (_mappedMemory && !_file->unmap(_mappedMemory))
+    {
+        LogPrintf(LogSeverityLevel::Warning,
+            "Failed to unmap memory %p of '%s' (handle 0x%08x): (%d) %s",
+            _mappedMemory,
+            qPrintable(_file->fileName()),
+            _file->handle(),
+            static_cast<int>(_file->error()),
+            qPrintable(_file->errorString()));
+    }
+    _mappedMemory = nullptr;
+
+    if (_file->isOpen())
+        _file->close();
+}
+
+std::shared_ptr<const OsmAnd::QFileMemoryMapping> OsmAnd::QFileMemoryMapping::map(const QString& fileName)
+{
+    const std::shared_ptr<QFile> file(new QFile(fileName));
+    if (!file->open(QIODevice::ReadOnly))
+    {
+        LogPrintf(LogSeverityLevel::Warning,
+            "Failed to open '%s' for memory mapping: (%d) %s",
+            qPrintable(fileName),
+            static_cast<int>(file->error()),
+            qPrintable(file->errorString()));
+        return nullptr;
+    }
+
+    const auto fileSize = file->size();
+    if (fileSize <= 0)
+    {
+        file->close();
+        return nullptr;
+    }
+
+    // Whole-file mapping may legitimately fail on platforms with limited address space,
+    // caller is expected to fall back to windowed reading in that case
+    const auto mappedMemory = file->map(0, fileSize);
+    if (!mappedMemory)
+    {
+        LogPrintf(LogSeverityLevel::Warning,
+            "Failed to map %" PRIi64 " bytes of '%s' (handle 0x%08x) into memory: (%d) %s",
+            fileSize,
+            qPrintable(fileName),
+            file->handle(),
+            static_cast<int>(file->error()),
+            qPrintable(file->errorString()));
+        file->close();
+        return nullptr;
+    }
+
+    return std::shared_ptr<const QFileMemoryMapping>(new QFileMemoryMapping(file, mappedMemory));
+}
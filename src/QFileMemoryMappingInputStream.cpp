@@ -0,0 +1,63 @@
+#include "QFileMemoryMappingInputStream.h"
+
+namespace OsmAnd
+{
+    namespace gpb = google::protobuf;
+}
+
+OsmAnd::QFileMemoryMappingInputStream::QFileMemoryMappingInputStream(
+    const std::shared_ptr<const QFileMemoryMapping>& mapping_)
+    : _currentPosition(0)
+    , mapping(mapping_)
+{
+}
+
+OsmAnd::QFileMemoryMappingInputStream::~QFileMemoryMappingInputStream()
+{
+}
+
+bool OsmAnd::QFileMemoryMappingInputStream::Next(const void** data, int* size)
+{
+    // Check if current position is in valid range
+    if (Q_UNLIKELY(_currentPosition < 0 || _currentPosition >= mapping->size))
+    {
+        *data = nullptr;
+        *size = 0;
+        return false;
+    }
+
+    // Entire remainder of the file is available, limited only by what protobuf can address
+    auto availableSize = mapping->size - _currentPosition;
+    if (availableSize > std::numeric_limits<int>::max())
+        availableSize = std::numeric_limits<int>::max();
+
+    *data = mapping->data + _currentPosition;
+    *size = static_cast<int>(availableSize);
+    _currentPosition += availableSize;
+    return true;
+}
+
+void OsmAnd::QFileMemoryMappingInputStream::BackUp(int count)
+{
+    if (count > _currentPosition)
+        _currentPosition = 0;
+    else
+        _currentPosition -= count;
+}
+
+bool OsmAnd::QFileMemoryMappingInputStream::Skip(int count)
+{
+    if (Q_UNLIKELY(_currentPosition + count >= mapping->size))
+    {
+        _currentPosition = mapping->size;
+        return false;
+    }
+
+    _currentPosition += count;
+    return true;
+}
+
+OsmAnd::gpb::int64 OsmAnd::QFileMemoryMappingInputStream::ByteCount() const
+{
+    return static_cast<gpb::int64>(_currentPosition);
+}
@@ -231,6 +231,26 @@ const std::shared_ptr<const OsmAnd::OnlineTileSources> OsmAnd::ResourcesManager:
     return _p->downloadOnlineTileSources();
 }
 
+bool OsmAnd::ResourcesManager::isObfMemoryMappingEnabled() const
+{
+    return _p->isObfMemoryMappingEnabled();
+}
+
+void OsmAnd::ResourcesManager::setObfMemoryMappingEnabled(const bool enabled)
+{
+    _p->setObfMemoryMappingEnabled(enabled);
+}
+
+unsigned int OsmAnd::ResourcesManager::getObfReadersPoolCapacity() const
+{
+    return _p->getObfReadersPoolCapacity();
+}
+
+void OsmAnd::ResourcesManager::setObfReadersPoolCapacity(const unsigned int capacity)
+{
+    _p->setObfReadersPoolCapacity(capacity);
+}
+
 OsmAnd::ResourcesManager::Resource::Metadata::Metadata()
 {
 }
@@ -31,6 +31,7 @@ OsmAnd::ResourcesManager_P::ResourcesManager_P(
     : owner(owner_)
     , _fileSystemWatcher(new QFileSystemWatcher())
     , _localResourcesLock(QReadWriteLock::Recursive)
+    , _obfMemoryMappingEnabled(0)
     , _resourcesInRepositoryLoaded(false)
     , _webClient(webClient_)
     , changesManager(new IncrementalChangesManager(webClient_, owner_))
@@ -175,6 +176,8 @@ bool OsmAnd::ResourcesManager_P::scanManagedStoragePath()
     assert(_localResources.isEmpty());
     if (!loadLocalResourcesFromPath(owner->localStoragePath, false, _localResources))
         return false;
+    for (const auto& localResource : constOf(_localResources))
+        updateObfsSpatialIndex(localResource);
 
     return true;
 }
@@ -195,6 +198,9 @@ bool OsmAnd::ResourcesManager_P::rescanUnmanagedStoragePaths() const
             return false;
     }
 
+    // All unmanaged resources are going to be replaced, so no pooled reader should outlive them
+    _obfReadersPool.releaseAllReaders();
+
     // Merge results with current resources
     QList< QString > addedResources;
     QList< QString > removedResources;
@@ -246,6 +252,12 @@ bool OsmAnd::ResourcesManager_P::rescanUnmanagedStoragePaths() const
         _localResources.insert(id, newResource);
         addedResources.push_back(id);
     }
+    for (const auto& id : constOf(removedResources))
+        _obfsSpatialIndex.remove(id);
+    for (const auto& id : constOf(updatedResources))
+        updateObfsSpatialIndex(_localResources.value(id));
+    for (const auto& id : constOf(addedResources))
+        updateObfsSpatialIndex(_localResources.value(id));
 
     scopedLocker.unlock();
     owner->localResourcesChangeObservable.postNotify(owner, addedResources, removedResources, updatedResources);
@@ -1249,6 +1261,9 @@ bool OsmAnd::ResourcesManager_P::installTilesResource(const std::shared_ptr<cons
 
 bool OsmAnd::ResourcesManager_P::uninstallObf(const std::shared_ptr<const InstalledResource>& resource)
 {
+    _obfReadersPool.releaseReaders(resource->localPath);
+    _obfsSpatialIndex.remove(resource->id);
+
     return QFile(resource->localPath).remove();
 }
 
@@ -1299,6 +1314,7 @@ bool OsmAnd::ResourcesManager_P::installObfFile(const QString &filePath, const Q
     outResource.reset(pLocalResource);
     pLocalResource->_metadata.reset(new ObfMetadata(obfFile));
     _localResources.insert(id, outResource);
+    updateObfsSpatialIndex(outResource);
     
     return true;
 }
@@ -1422,6 +1438,51 @@ bool OsmAnd::ResourcesManager_P::installFromFile(const QString& id, const QStrin
     return ok;
 }
 
+bool OsmAnd::ResourcesManager_P::isObfMemoryMappingEnabled() const
+{
+    return _obfMemoryMappingEnabled.loadAcquire() != 0;
+}
+
+void OsmAnd::ResourcesManager_P::setObfMemoryMappingEnabled(const bool enabled)
+{
+    _obfMemoryMappingEnabled.storeRelease(enabled ? 1 : 0);
+}
+
+unsigned int OsmAnd::ResourcesManager_P::getObfReadersPoolCapacity() const
+{
+    return _obfReadersPool.getCapacity();
+}
+
+void OsmAnd::ResourcesManager_P::setObfReadersPoolCapacity(const unsigned int capacity)
+{
+    _obfReadersPool.setCapacity(capacity);
+}
+
+void OsmAnd::ResourcesManager_P::updateObfsSpatialIndex(const std::shared_ptr<const LocalResource>& localResource) const
+{
+    if (localResource->type != ResourceType::MapRegion &&
+        localResource->type != ResourceType::LiveUpdateRegion &&
+        localResource->type != ResourceType::RoadMapRegion &&
+        localResource->type != ResourceType::SrtmMapRegion &&
+        localResource->type != ResourceType::DepthContourRegion &&
+        localResource->type != ResourceType::WikiMapRegion)
+    {
+        _obfsSpatialIndex.remove(localResource->id);
+        return;
+    }
+
+    const auto& obfMetadata = std::static_pointer_cast<const ObfMetadata>(localResource->_metadata);
+    if (!obfMetadata)
+    {
+        _obfsSpatialIndex.remove(localResource->id);
+        return;
+    }
+
+    // Basemaps are always needed, regardless of area
+    const auto& obfInfo = obfMetadata->obfFile->obfInfo;
+    _obfsSpatialIndex.insert(localResource->id, obfInfo, obfInfo->isBasemap || obfInfo->isBasemapWithCoastlines);
+}
+
 bool OsmAnd::ResourcesManager_P::addLocalResource(const QString& filePath)
 {
     QFileInfo info(filePath);
@@ -1448,6 +1509,7 @@ bool OsmAnd::ResourcesManager_P::addLocalResource(const QString& filePath)
         obfFile->obfInfo->creationTimestamp);
     pLocalResource->_metadata.reset(new ObfMetadata(obfFile));
     std::shared_ptr<const LocalResource> localResource(pLocalResource);
+    updateObfsSpatialIndex(localResource);
     _localResources.insert(resourceId, qMove(localResource));
     return true;
 }
@@ -1943,12 +2005,14 @@ QList< std::shared_ptr<const OsmAnd::ObfFile> > OsmAnd::ResourcesManager_P::Obfs
 std::shared_ptr<OsmAnd::ObfDataInterface> OsmAnd::ResourcesManager_P::ObfsCollectionProxy::obtainDataInterface(
     const std::shared_ptr<const ObfFile> obfFile) const
 {
-    return std::shared_ptr<ObfDataInterface>(new ObfDataInterfaceProxy({ std::make_shared<ObfReader>(obfFile) }, {}));
+    return std::shared_ptr<ObfDataInterface>(new ObfDataInterfaceProxy({
+        owner->_obfReadersPool.obtainReader(obfFile, owner->isObfMemoryMappingEnabled()) }, {}));
 }
 
 std::shared_ptr<OsmAnd::ObfDataInterface> OsmAnd::ResourcesManager_P::ObfsCollectionProxy::obtainDataInterface(
     const QList< std::shared_ptr<const LocalResource> > localResources) const
 {
+    const auto useMemoryMapping = owner->isObfMemoryMappingEnabled();
     bool otherBasemapPresent = false;
     QList< std::shared_ptr<const InstalledResource> > lockedResources;
     QList< std::shared_ptr<const ObfReader> > obfReaders;
@@ -1977,12 +2041,12 @@ std::shared_ptr<OsmAnd::ObfDataInterface> OsmAnd::ResourcesManager_P::ObfsCollec
         
         if (obfMetadata->obfFile->obfInfo->isBasemapWithCoastlines)
             otherBasemapPresent = true;
-        std::shared_ptr<const ObfReader> obfReader(new ObfReader(obfMetadata->obfFile));
+        const auto obfReader = owner->_obfReadersPool.obtainReader(obfMetadata->obfFile, useMemoryMapping);
         obfReaders.push_back(qMove(obfReader));
     }
     if (!otherBasemapPresent && owner->_miniBasemapObfFile)
     {
-        std::shared_ptr<const ObfReader> obfReader(new ObfReader(owner->_miniBasemapObfFile));
+        const auto obfReader = owner->_obfReadersPool.obtainReader(owner->_miniBasemapObfFile, useMemoryMapping);
         obfReaders.push_back(qMove(obfReader));
     }
     
@@ -2007,33 +2071,24 @@ std::shared_ptr<OsmAnd::ObfDataInterface> OsmAnd::ResourcesManager_P::ObfsCollec
 {
     QReadLocker scopedLocker(&owner->_localResourcesLock);
 
+    // Spatial index already contains only OBF resources that have data for given area (and all basemaps)
+    const auto acceptedResourcesIds = owner->_obfsSpatialIndex.query(pBbox31, minZoomLevel, maxZoomLevel, desiredDataTypes);
+
+    const auto useMemoryMapping = owner->isObfMemoryMappingEnabled();
     bool otherBasemapPresent = false;
     QList< std::shared_ptr<const InstalledResource> > lockedResources;
     QList< std::shared_ptr<const ObfReader> > obfReaders;
-    for (const auto& localResource : constOf(owner->_localResources))
+    for (const auto& resourceId : constOf(acceptedResourcesIds))
     {
-        if (localResource->type != ResourceType::MapRegion &&
-            localResource->type != ResourceType::LiveUpdateRegion &&
-            localResource->type != ResourceType::RoadMapRegion &&
-            localResource->type != ResourceType::SrtmMapRegion &&
-            localResource->type != ResourceType::DepthContourRegion &&
-            localResource->type != ResourceType::WikiMapRegion)
-        {
+        const auto citLocalResource = owner->_localResources.constFind(resourceId);
+        if (citLocalResource == owner->_localResources.cend())
             continue;
-        }
+        const auto& localResource = *citLocalResource;
 
         const auto& obfMetadata = std::static_pointer_cast<const ObfMetadata>(localResource->_metadata);
         if (!obfMetadata)
             continue;
 
-        // Perform check if this OBF file is needed
-        if (!obfMetadata->obfFile->obfInfo->isBasemap && !obfMetadata->obfFile->obfInfo->isBasemapWithCoastlines)
-        {
-            bool accept = obfMetadata->obfFile->obfInfo->containsDataFor(pBbox31, minZoomLevel, maxZoomLevel, desiredDataTypes);
-            if (!accept)
-                continue;
-        }
-
         if (const auto installedResource = std::dynamic_pointer_cast<const InstalledResource>(localResource))
         {
             if (!installedResource->_lock.tryLockForReading())
@@ -2043,12 +2098,12 @@ std::shared_ptr<OsmAnd::ObfDataInterface> OsmAnd::ResourcesManager_P::ObfsCollec
 
         if (obfMetadata->obfFile->obfInfo->isBasemapWithCoastlines)
             otherBasemapPresent = true;
-        std::shared_ptr<const ObfReader> obfReader(new ObfReader(obfMetadata->obfFile));
+        const auto obfReader = owner->_obfReadersPool.obtainReader(obfMetadata->obfFile, useMemoryMapping);
         obfReaders.push_back(qMove(obfReader));
     }
     if (!otherBasemapPresent && owner->_miniBasemapObfFile)
     {
-        std::shared_ptr<const ObfReader> obfReader(new ObfReader(owner->_miniBasemapObfFile));
+        const auto obfReader = owner->_obfReadersPool.obtainReader(owner->_miniBasemapObfFile, useMemoryMapping);
         obfReaders.push_back(qMove(obfReader));
     }
 
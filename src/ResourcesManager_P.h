@@ -20,6 +20,8 @@
 #include "ObfDataInterface.h"
 #include "IMapStylesCollection.h"
 #include "IObfsCollection.h"
+#include "ObfReadersPool.h"
+#include "ObfsSpatialIndex.h"
 
 namespace OsmAnd
 {
@@ -94,6 +96,10 @@ namespace OsmAnd
         const std::shared_ptr<const OnlineTileSources> downloadOnlineTileSources() const;
 
         std::shared_ptr<const ObfFile> _miniBasemapObfFile;
+        QAtomicInt _obfMemoryMappingEnabled;
+        mutable ObfReadersPool _obfReadersPool;
+        mutable ObfsSpatialIndex _obfsSpatialIndex;
+        void updateObfsSpatialIndex(const std::shared_ptr<const LocalResource>& localResource) const;
 
         mutable QReadWriteLock _resourcesInRepositoryLock;
         mutable QHash< QString, std::shared_ptr<const ResourceInRepository> > _resourcesInRepository;
@@ -280,6 +286,12 @@ namespace OsmAnd
             const IWebClient::RequestProgressCallbackSignature downloadProgressCallback);
         bool updateFromRepository(const QString& id, const QString& filePath);
         
+        // OBF access:
+        bool isObfMemoryMappingEnabled() const;
+        void setObfMemoryMappingEnabled(const bool enabled);
+        unsigned int getObfReadersPoolCapacity() const;
+        void setObfReadersPoolCapacity(const unsigned int capacity);
+
         // Tests
         bool addLocalResource(const QString& filePath);
 
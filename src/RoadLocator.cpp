@@ -94,6 +94,25 @@ QList< std::shared_ptr<const OsmAnd::Road> > OsmAnd::RoadLocator::findRoadsInAre
         outReferencedCacheEntries);
 }
 
+QVector< QVector< std::pair<std::shared_ptr<const OsmAnd::Road>, std::shared_ptr<const OsmAnd::RoadInfo>> > > OsmAnd::RoadLocator::findNearestRoadsBatch(
+    const QVector<PointI>& positions31,
+    const double radiusInMeters,
+    const int maxRoadsPerPosition /*= 1*/,
+    const RoutingDataLevel dataLevel /*= RoutingDataLevel::Detailed*/,
+    const ObfRoutingSectionReader::VisitorFunction filter /*= nullptr*/,
+    QThreadPool* const threadPool /*= nullptr*/,
+    QList< std::shared_ptr<const ObfRoutingSectionReader::DataBlock> >* const outReferencedCacheEntries /*= nullptr*/) const
+{
+    return _p->findNearestRoadsBatch(
+        positions31,
+        radiusInMeters,
+        maxRoadsPerPosition,
+        dataLevel,
+        filter,
+        threadPool,
+        outReferencedCacheEntries);
+}
+
 std::shared_ptr<const OsmAnd::Road> OsmAnd::RoadLocator::findNearestRoad(
     const QList< std::shared_ptr<const Road> >& collection,
     const PointI position31,
@@ -138,3 +157,20 @@ QList< std::shared_ptr<const OsmAnd::Road> > OsmAnd::RoadLocator::findRoadsInAre
         radiusInMeters,
         filter);
 }
+
+QVector< QVector< std::pair<std::shared_ptr<const OsmAnd::Road>, std::shared_ptr<const OsmAnd::RoadInfo>> > > OsmAnd::RoadLocator::findNearestRoadsBatch(
+    const QList< std::shared_ptr<const Road> >& collection,
+    const QVector<PointI>& positions31,
+    const double radiusInMeters,
+    const int maxRoadsPerPosition /*= 1*/,
+    const ObfRoutingSectionReader::VisitorFunction filter /*= nullptr*/,
+    QThreadPool* const threadPool /*= nullptr*/)
+{
+    return RoadLocator_P::findNearestRoadsBatch(
+        collection,
+        positions31,
+        radiusInMeters,
+        maxRoadsPerPosition,
+        filter,
+        threadPool);
+}
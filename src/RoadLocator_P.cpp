@@ -1,9 +1,18 @@
 #include "RoadLocator_P.h"
 #include "RoadLocator.h"
 
+#include "QtCommon.h"
+#include "QKeyValueIterator.h"
+#include "ignore_warnings_on_external_includes.h"
+#include <QSet>
+#include <QHash>
+#include "restore_internal_warnings.h"
+
 #include "Road.h"
 #include "IObfsCollection.h"
 #include "ObfDataInterface.h"
+#include "QuadTree.h"
+#include "ParallelFor.h"
 #include "Utilities.h"
 
 OsmAnd::RoadLocator_P::RoadLocator_P(RoadLocator* const owner_)
@@ -79,6 +88,46 @@ QVector<std::pair<std::shared_ptr<const OsmAnd::Road>, std::shared_ptr<const Osm
                 filter);
 }
 
+QVector< QVector< std::pair<std::shared_ptr<const OsmAnd::Road>, std::shared_ptr<const OsmAnd::RoadInfo>> > > OsmAnd::RoadLocator_P::findNearestRoadsBatch(
+    const QVector<PointI>& positions31,
+    const double radiusInMeters,
+    const int maxRoadsPerPosition,
+    const RoutingDataLevel dataLevel,
+    const ObfRoutingSectionReader::VisitorFunction filter,
+    QThreadPool* const threadPool,
+    QList<std::shared_ptr<const ObfRoutingSectionReader::DataBlock>>* const outReferencedCacheEntries) const
+{
+    QList<std::shared_ptr<const Road>> roads;
+
+    const auto batchAreas = obtainBatchAreas(positions31, radiusInMeters);
+    for (const auto& bbox31 : constOf(batchAreas))
+    {
+        const auto obfDataInterface = owner->obfsCollection->obtainDataInterface(
+            &bbox31,
+            MinZoomLevel,
+            MaxZoomLevel,
+            ObfDataTypesMask().set(ObfDataType::Routing));
+        obfDataInterface->loadRoads(
+            dataLevel,
+            &bbox31,
+            &roads,
+            nullptr,
+            nullptr,
+            owner->cache.get(),
+            outReferencedCacheEntries,
+            nullptr,
+            nullptr);
+    }
+
+    return findNearestRoadsBatch(
+        roads,
+        positions31,
+        radiusInMeters,
+        maxRoadsPerPosition,
+        filter,
+        threadPool);
+}
+
 QList<std::shared_ptr<const OsmAnd::Road>> OsmAnd::RoadLocator_P::findRoadsInAreaEx(
     const PointI position31,
     const double radiusInMeters,
@@ -144,14 +193,14 @@ std::shared_ptr<const OsmAnd::Road> OsmAnd::RoadLocator_P::findNearestRoad(
     std::shared_ptr<const Road> minDistanceRoad;
     int minDistancePointIdx = -1;
     double minSqDistance = std::numeric_limits<double>::max();
-    QList<ObfObjectId> processedIds;
+    QSet<ObfObjectId> processedIds;
 
     for (const auto& road : constOf(collection))
     {
         if (processedIds.contains(road->id))
             continue;
         
-        processedIds.push_back(road->id);
+        processedIds.insert(road->id);
         
         if (road->isDeleted())
             continue;
@@ -320,3 +369,192 @@ QList<std::shared_ptr<const OsmAnd::Road>> OsmAnd::RoadLocator_P::findRoadsInAre
 
     return filteredRoads;
 }
+
+double OsmAnd::RoadLocator_P::squareDistanceToSegment(
+    const PointI& segmentStart31,
+    const PointI& segmentEnd31,
+    const PointI& position31,
+    uint32_t& outProjectionX31,
+    uint32_t& outProjectionY31)
+{
+    const auto& cpx31 = segmentEnd31.x;
+    const auto& cpy31 = segmentEnd31.y;
+    const auto& ppx31 = segmentStart31.x;
+    const auto& ppy31 = segmentStart31.y;
+
+    const auto sqLength = Utilities::squareDistance31(cpx31, cpy31, ppx31, ppy31);
+    const auto projection = Utilities::projection31(ppx31, ppy31, cpx31, cpy31, position31.x, position31.y);
+    if (projection < 0)
+    {
+        outProjectionX31 = ppx31;
+        outProjectionY31 = ppy31;
+    }
+    else if (projection >= sqLength)
+    {
+        outProjectionX31 = cpx31;
+        outProjectionY31 = cpy31;
+    }
+    else
+    {
+        const auto factor = projection / sqLength;
+        outProjectionX31 = ppx31 + (cpx31 - ppx31) * factor;
+        outProjectionY31 = ppy31 + (cpy31 - ppy31) * factor;
+    }
+
+    return Utilities::squareDistance31(outProjectionX31, outProjectionY31, position31.x, position31.y);
+}
+
+QList<OsmAnd::AreaI> OsmAnd::RoadLocator_P::obtainBatchAreas(
+    const QVector<PointI>& positions31,
+    const double radiusInMeters)
+{
+    // Nearby positions share same area, so that their roads are loaded only once
+    QHash<TileId, AreaI> areas;
+    const auto zoomShift = MaxZoomLevel - BatchAreasZoom;
+    for (const auto& position31 : constOf(positions31))
+    {
+        const auto tileId = TileId::fromXY(position31.x >> zoomShift, position31.y >> zoomShift);
+        const auto bbox31 = (AreaI)Utilities::boundingBox31FromAreaInMeters(radiusInMeters, position31);
+
+        const auto itArea = areas.find(tileId);
+        if (itArea == areas.end())
+            areas.insert(tileId, bbox31);
+        else
+            itArea->enlargeToInclude(bbox31);
+    }
+
+    return areas.values();
+}
+
+QVector< QVector< std::pair<std::shared_ptr<const OsmAnd::Road>, std::shared_ptr<const OsmAnd::RoadInfo>> > > OsmAnd::RoadLocator_P::findNearestRoadsBatch(
+    const QList<std::shared_ptr<const Road>>& collection,
+    const QVector<PointI>& positions31,
+    const double radiusInMeters,
+    const int maxRoadsPerPosition,
+    const ObfRoutingSectionReader::VisitorFunction filter,
+    QThreadPool* const threadPool)
+{
+    typedef std::pair<std::shared_ptr<const Road>, std::shared_ptr<const RoadInfo>> RoadWithInfo;
+    QVector< QVector<RoadWithInfo> > result(positions31.size());
+
+    // Accept each road only once, even if it was loaded from several data blocks
+    QVector< std::shared_ptr<const Road> > roads;
+    roads.reserve(collection.size());
+    QSet<ObfObjectId> processedIds;
+    for (const auto& road : constOf(collection))
+    {
+        if (processedIds.contains(road->id))
+            continue;
+        processedIds.insert(road->id);
+
+        if (road->isDeleted())
+            continue;
+
+        if (road->points31.size() <= 1)
+            continue;
+
+        if (filter && !filter(road))
+            continue;
+
+        roads.push_back(road);
+    }
+    if (roads.isEmpty() || positions31.isEmpty())
+        return result;
+
+    // Index every segment of every road, so that each position tests only segments near it
+    struct Segment
+    {
+        int roadIndex;
+        int pointIndex;
+    };
+    AreaI roadsBBox31(roads.first()->points31.first(), roads.first()->points31.first());
+    for (const auto& road : constOf(roads))
+    {
+        for (const auto& point31 : constOf(road->points31))
+            roadsBBox31.enlargeToInclude(point31);
+    }
+    QuadTree<Segment, AreaI::CoordType> segmentsTree(roadsBBox31, BatchSegmentsTreeDepth);
+    for (auto roadIndex = 0, roadsCount = roads.size(); roadIndex < roadsCount; roadIndex++)
+    {
+        const auto& points31 = roads[roadIndex]->points31;
+        for (auto pointIndex = 1, pointsCount = points31.size(); pointIndex < pointsCount; pointIndex++)
+        {
+            AreaI segmentBBox31(points31[pointIndex - 1], points31[pointIndex - 1]);
+            segmentBBox31.enlargeToInclude(points31[pointIndex]);
+
+            Segment segment;
+            segment.roadIndex = roadIndex;
+            segment.pointIndex = pointIndex;
+            segmentsTree.insert(segment, segmentBBox31);
+        }
+    }
+
+    // Positions are independent, while index and roads are only read
+    const auto pResult = result.data();
+    const auto maxSqDistance = radiusInMeters * radiusInMeters;
+    Concurrent::ParallelFor::run(
+        threadPool,
+        positions31.size(),
+        [&positions31, &roads, &segmentsTree, pResult, radiusInMeters, maxSqDistance, maxRoadsPerPosition]
+        (const int positionIndex)
+        {
+            const auto& position31 = positions31[positionIndex];
+            const auto bbox31 = (AreaI)Utilities::boundingBox31FromAreaInMeters(radiusInMeters, position31);
+
+            // Find nearest point of each road near this position
+            QHash<int, RoadInfo> nearestRoadsPoints;
+            QList<Segment> unused;
+            segmentsTree.query(bbox31, unused, false,
+                [&roads, &position31, &nearestRoadsPoints, maxSqDistance]
+                (const Segment& segment, const QuadTree<Segment, AreaI::CoordType>::BBox& segmentBBox) -> bool
+                {
+                    const auto& points31 = roads[segment.roadIndex]->points31;
+
+                    uint32_t projectionX31;
+                    uint32_t projectionY31;
+                    const auto sqDistance = squareDistanceToSegment(
+                        points31[segment.pointIndex - 1],
+                        points31[segment.pointIndex],
+                        position31,
+                        projectionX31,
+                        projectionY31);
+                    if (sqDistance > maxSqDistance)
+                        return false;
+
+                    const auto itNearestRoadPoint = nearestRoadsPoints.find(segment.roadIndex);
+                    if (itNearestRoadPoint == nearestRoadsPoints.end() || sqDistance < itNearestRoadPoint->distSquare)
+                    {
+                        auto& nearestRoadPoint = nearestRoadsPoints[segment.roadIndex];
+                        nearestRoadPoint.distSquare = sqDistance;
+                        nearestRoadPoint.preciseX = projectionX31;
+                        nearestRoadPoint.preciseY = projectionY31;
+                    }
+
+                    // Nothing has to be collected by the query itself
+                    return false;
+                });
+
+            // Order by distance, and by order of roads if distances are equal
+            QVector< std::pair<double, int> > order;
+            order.reserve(nearestRoadsPoints.size());
+            for (const auto& nearestRoadPointEntry : rangeOf(constOf(nearestRoadsPoints)))
+                order.push_back(std::make_pair(nearestRoadPointEntry.value().distSquare, nearestRoadPointEntry.key()));
+            std::sort(order.begin(), order.end());
+            if (maxRoadsPerPosition > 0 && order.size() > maxRoadsPerPosition)
+                order.resize(maxRoadsPerPosition);
+
+            QVector<RoadWithInfo>& positionResult = pResult[positionIndex];
+            positionResult.reserve(order.size());
+            for (const auto& orderEntry : constOf(order))
+            {
+                const auto& nearestRoadPoint = nearestRoadsPoints[orderEntry.second];
+                const auto roadInfo = std::make_shared<RoadInfo>();
+                roadInfo->distSquare = nearestRoadPoint.distSquare;
+                roadInfo->preciseX = nearestRoadPoint.preciseX;
+                roadInfo->preciseY = nearestRoadPoint.preciseY;
+                positionResult.push_back(RoadWithInfo(roads[orderEntry.second], roadInfo));
+            }
+        });
+
+    return result;
+}
@@ -5,6 +5,8 @@
 
 #include "QtExtensions.h"
 #include <QList>
+#include <QVector>
+#include <QThreadPool>
 
 #include "OsmAndCore.h"
 #include "CommonTypes.h"
@@ -29,6 +31,13 @@ namespace OsmAnd
             const double radiusInMeters,
             const RoutingDataLevel dataLevel,
             QList<std::shared_ptr<const ObfRoutingSectionReader::DataBlock>> * const outReferencedCacheEntries) const;
+
+        static double squareDistanceToSegment(
+            const PointI& segmentStart31,
+            const PointI& segmentEnd31,
+            const PointI& position31,
+            uint32_t& outProjectionX31,
+            uint32_t& outProjectionY31);
     protected:
         RoadLocator_P(RoadLocator* const owner);
     public:
@@ -36,6 +45,13 @@ namespace OsmAnd
 
         ImplementationInterface<RoadLocator> owner;
 
+        enum {
+            // Batch positions are grouped by tiles of this zoom, roads are loaded once per group
+            BatchAreasZoom = ZoomLevel12,
+            // Depth of per-batch segments index
+            BatchSegmentsTreeDepth = 16,
+        };
+
         std::shared_ptr<const Road> findNearestRoadEx(
             const PointI position31,
             const double radiusInMeters,
@@ -56,6 +72,14 @@ namespace OsmAnd
             const RoutingDataLevel dataLevel,
             const ObfRoutingSectionReader::VisitorFunction filter,
             QList< std::shared_ptr<const ObfRoutingSectionReader::DataBlock> >* const outReferencedCacheEntries) const;
+        QVector< QVector< std::pair<std::shared_ptr<const Road>, std::shared_ptr<const RoadInfo>> > > findNearestRoadsBatch(
+            const QVector<PointI>& positions31,
+            const double radiusInMeters,
+            const int maxRoadsPerPosition,
+            const RoutingDataLevel dataLevel,
+            const ObfRoutingSectionReader::VisitorFunction filter,
+            QThreadPool* const threadPool,
+            QList< std::shared_ptr<const ObfRoutingSectionReader::DataBlock> >* const outReferencedCacheEntries) const;
 
         static std::shared_ptr<const Road> findNearestRoad(
             const QList<std::shared_ptr<const Road>>& collection,
@@ -84,6 +108,16 @@ namespace OsmAnd
             const PointI position31,
             const double radiusInMeters,
             const ObfRoutingSectionReader::VisitorFunction filter);
+        static QList<AreaI> obtainBatchAreas(
+            const QVector<PointI>& positions31,
+            const double radiusInMeters);
+        static QVector< QVector< std::pair<std::shared_ptr<const Road>, std::shared_ptr<const RoadInfo>> > > findNearestRoadsBatch(
+            const QList<std::shared_ptr<const Road>>& collection,
+            const QVector<PointI>& positions31,
+            const double radiusInMeters,
+            const int maxRoadsPerPosition,
+            const ObfRoutingSectionReader::VisitorFunction filter,
+            QThreadPool* const threadPool);
 
         friend class OsmAnd::RoadLocator;
     };
@@ -0,0 +1,97 @@
+#ifndef _OSMAND_CORE_SHARED_OBJECTS_ARENA_H_
+#define _OSMAND_CORE_SHARED_OBJECTS_ARENA_H_
+
+#include "stdlib_common.h"
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "QtExtensions.h"
+
+#include "OsmAndCore.h"
+
+namespace OsmAnd
+{
+    // Bump allocator for objects of single type that live and die together. Objects are placed into blocks
+    // owned by arena and are referenced through aliasing shared pointers to the arena itself, so each object
+    // costs neither separate heap allocation nor separate reference counter. All objects are destroyed at once,
+    // when last reference to any of them (or to arena) is released.
+    // Allocation is not thread-safe: arena should be filled by single thread before its objects are shared.
+    template<typename OBJECT, unsigned int BLOCK_CAPACITY = 8>
+    class SharedObjectsArena Q_DECL_FINAL : public std::enable_shared_from_this< SharedObjectsArena<OBJECT, BLOCK_CAPACITY> >
+    {
+        Q_DISABLE_COPY_AND_MOVE(SharedObjectsArena);
+
+    public:
+        typedef OBJECT Object;
+
+    private:
+        struct Block Q_DECL_FINAL
+        {
+            Block()
+                : count(0)
+                , next(nullptr)
+            {
+            }
+
+            typename std::aligned_storage<sizeof(OBJECT), alignof(OBJECT)>::type storage[BLOCK_CAPACITY];
+            unsigned int count;
+            Block* next;
+        };
+
+        Block _firstBlock;
+        Block* _lastBlock;
+
+        static void destroyObjects(Block* const block)
+        {
+            for (auto index = block->count; index > 0; index--)
+                reinterpret_cast<OBJECT*>(&block->storage[index - 1])->~OBJECT();
+            block->count = 0;
+        }
+    protected:
+    public:
+        SharedObjectsArena()
+            : _lastBlock(&_firstBlock)
+        {
+        }
+
+        ~SharedObjectsArena()
+        {
+            destroyObjects(&_firstBlock);
+
+            auto block = _firstBlock.next;
+            while (block)
+            {
+                const auto nextBlock = block->next;
+                destroyObjects(block);
+                delete block;
+                block = nextBlock;
+            }
+        }
+
+        // Constructs object in storage of this arena. Object is counted only once its constructor succeeded,
+        // so that a throwing constructor never leaves unconstructed storage to be destroyed
+        template<typename... Args>
+        OBJECT* emplace(Args&&... args)
+        {
+            if (_lastBlock->count == BLOCK_CAPACITY)
+            {
+                const auto newBlock = new Block();
+                _lastBlock->next = newBlock;
+                _lastBlock = newBlock;
+            }
+
+            const auto object = new(&_lastBlock->storage[_lastBlock->count]) OBJECT(std::forward<Args>(args)...);
+            _lastBlock->count++;
+            return object;
+        }
+
+        // Returns reference to object constructed in storage of this arena, that keeps entire arena alive
+        std::shared_ptr<OBJECT> adopt(OBJECT* const object)
+        {
+            return std::shared_ptr<OBJECT>(this->shared_from_this(), object);
+        }
+    };
+}
+
+#endif // !defined(_OSMAND_CORE_SHARED_OBJECTS_ARENA_H_)
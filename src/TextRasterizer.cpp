@@ -58,6 +58,50 @@ bool OsmAnd::TextRasterizer::rasterize(
         outFontAscent);
 }
 
+std::shared_ptr<const SkBitmap> OsmAnd::TextRasterizer::rasterizeCached(
+    const QString& text,
+    const Style& style /*= Style()*/,
+    QVector<SkScalar>* const outGlyphWidths /*= nullptr*/,
+    float* const outExtraTopSpace /*= nullptr*/,
+    float* const outExtraBottomSpace /*= nullptr*/,
+    float* const outLineSpacing /*= nullptr*/,
+    float* const outFontAscent /*= nullptr*/) const
+{
+    return _p->rasterizeCached(
+        text,
+        style,
+        outGlyphWidths,
+        outExtraTopSpace,
+        outExtraBottomSpace,
+        outLineSpacing,
+        outFontAscent);
+}
+
+bool OsmAnd::TextRasterizer::layoutGlyphs(
+    const QString& text,
+    const Style& style,
+    GlyphAtlas& atlas,
+    QVector<GlyphAtlas::GlyphQuad>& outQuads,
+    PointI* const outSize /*= nullptr*/) const
+{
+    return _p->layoutGlyphs(text, style, atlas, outQuads, outSize);
+}
+
+OsmAnd::TextRasterizer::CacheStatistics OsmAnd::TextRasterizer::getCacheStatistics() const
+{
+    return _p->getCacheStatistics();
+}
+
+void OsmAnd::TextRasterizer::setCacheSizeLimit(const unsigned int sizeLimitInBytes)
+{
+    _p->setCacheSizeLimit(sizeLimitInBytes);
+}
+
+void OsmAnd::TextRasterizer::clearCache()
+{
+    _p->clearCache();
+}
+
 static std::shared_ptr<const OsmAnd::TextRasterizer> s_defaultTextRasterizer;
 std::shared_ptr<const OsmAnd::TextRasterizer> OsmAnd::TextRasterizer::getDefault()
 {
@@ -21,7 +21,10 @@
 #endif // !defined(OSMAND_LOG_CHARACTERS_FONT)
 
 OsmAnd::TextRasterizer_P::TextRasterizer_P(TextRasterizer* const owner_)
-    : owner(owner_)
+    : _cache(TextRasterizer::DefaultCacheSizeLimitInBytes)
+    , _cacheHits(0)
+    , _cacheMisses(0)
+    , owner(owner_)
 {
     _defaultPaint.setAntiAlias(true);
     _defaultPaint.setTextEncoding(SkPaint::kUTF16_TextEncoding);
@@ -585,3 +588,247 @@ bool OsmAnd::TextRasterizer_P::rasterize(
 
     return true;
 }
+
+std::shared_ptr<const SkBitmap> OsmAnd::TextRasterizer_P::rasterizeCached(
+    const QString& text,
+    const Style& style,
+    QVector<SkScalar>* const outGlyphWidths,
+    float* const outExtraTopSpace,
+    float* const outExtraBottomSpace,
+    float* const outLineSpacing,
+    float* const outFontAscent) const
+{
+    CacheKey key;
+    key.text = text;
+    key.style = style;
+
+    const auto provideEntry =
+        [outGlyphWidths, outExtraTopSpace, outExtraBottomSpace, outLineSpacing, outFontAscent]
+        (const CacheEntry& entry) -> std::shared_ptr<const SkBitmap>
+        {
+            if (outGlyphWidths)
+                *outGlyphWidths = entry.glyphWidths;
+            if (outExtraTopSpace)
+                *outExtraTopSpace = entry.extraTopSpace;
+            if (outExtraBottomSpace)
+                *outExtraBottomSpace = entry.extraBottomSpace;
+            if (outLineSpacing)
+                *outLineSpacing = entry.lineSpacing;
+            if (outFontAscent)
+                *outFontAscent = entry.fontAscent;
+
+            return entry.bitmap;
+        };
+
+    {
+        QMutexLocker scopedLocker(&_cacheMutex);
+
+        if (const auto entry = _cache.object(key))
+        {
+            _cacheHits++;
+            return provideEntry(*entry);
+        }
+        _cacheMisses++;
+    }
+
+    // Rasterize without lock, so that same text may be rarely rasterized twice by concurrent callers
+    std::unique_ptr<CacheEntry> newEntry(new CacheEntry());
+    const std::shared_ptr<SkBitmap> bitmap(new SkBitmap());
+    const bool ok = rasterize(
+        *bitmap,
+        text,
+        style,
+        &newEntry->glyphWidths,
+        &newEntry->extraTopSpace,
+        &newEntry->extraBottomSpace,
+        &newEntry->lineSpacing,
+        &newEntry->fontAscent);
+    if (!ok)
+        return nullptr;
+    newEntry->bitmap = bitmap;
+
+    const auto result = provideEntry(*newEntry);
+    const auto cost = static_cast<int>(
+        sizeof(CacheEntry) +
+        bitmap->getSize() +
+        newEntry->glyphWidths.size() * sizeof(SkScalar) +
+        text.size() * sizeof(QChar));
+    {
+        QMutexLocker scopedLocker(&_cacheMutex);
+
+        _cache.insert(key, newEntry.release(), cost);
+    }
+
+    return result;
+}
+
+bool OsmAnd::TextRasterizer_P::layoutGlyphs(
+    const QString& text_,
+    const Style& style,
+    GlyphAtlas& atlas,
+    QVector<GlyphAtlas::GlyphQuad>& outQuads,
+    PointI* const outSize) const
+{
+    // Prepare, measure and position text same way as rasterize() does
+    const auto text = ICU::convertToVisualOrder(text_);
+    const auto lineRefs = style.wrapWidth > 0
+        ? ICU::getTextWrappingRefs(text, style.wrapWidth, style.maxLines)
+        : (QVector<QStringRef>() << QStringRef(&text));
+    auto paints = evaluatePaints(lineRefs, style);
+    SkScalar maxLineWidthInPixels = 0;
+    measureText(paints, maxLineWidthInPixels);
+    if (style.haloRadius > 0)
+        measureHalo(style, paints);
+    const auto textArea = positionText(paints, maxLineWidthInPixels, style.textAlignment);
+
+    auto width = qCeil(textArea.width());
+    auto height = qCeil(textArea.height());
+    if (style.backgroundBitmap)
+    {
+        width = qMax(width, style.backgroundBitmap->width());
+        height = qMax(height, style.backgroundBitmap->height());
+
+        const auto offset = SkPoint::Make(
+            (width - qCeil(textArea.width())) / 2.0f,
+            (height - qCeil(textArea.height())) / 2.0f);
+        for (auto& linePaint : paints)
+        {
+            for (auto& textPaint : linePaint.textPaints)
+                textPaint.positionedBounds.offset(offset);
+        }
+    }
+    if (width <= 0 || height <= 0)
+    {
+        LogPrintf(LogSeverityLevel::Error,
+            "Failed to layout text '%s': resulting size %dx%d is invalid",
+            qPrintable(text),
+            width,
+            height);
+        return false;
+    }
+    if (outSize)
+        *outSize = PointI(width, height);
+
+    // Halo of all text goes first, same as in rasterize()
+    const auto withHaloQuads = (style.haloRadius > 0 && atlas.mode == GlyphAtlas::Mode::Coverage);
+    const auto pageSize = static_cast<float>(atlas.pageSize);
+    QVector<uint16_t> glyphIds;
+    QVector<SkScalar> glyphAdvances;
+    for (const auto isHalo : { true, false })
+    {
+        if (isHalo && !withHaloQuads)
+            continue;
+
+        for (const auto& linePaint : constOf(paints))
+        {
+            for (const auto& textPaint : constOf(linePaint.textPaints))
+            {
+                const auto textData = textPaint.text.constData();
+                const auto textLength = textPaint.text.length()*sizeof(QChar);
+
+                const auto glyphsCount = textPaint.paint.countText(textData, textLength);
+                glyphIds.resize(glyphsCount);
+                glyphAdvances.resize(glyphsCount);
+                textPaint.paint.textToGlyphs(textData, textLength, glyphIds.data());
+                textPaint.paint.getTextWidths(textData, textLength, glyphAdvances.data());
+
+                const auto textSize = textPaint.paint.getTextSize();
+                PointF penPosition(textPaint.positionedBounds.left(), textPaint.positionedBounds.top());
+                for (auto glyphIndex = 0; glyphIndex < glyphsCount; glyphIndex++)
+                {
+                    GlyphAtlas::Glyph glyph;
+                    const bool ok = atlas.obtainGlyph(
+                        textPaint.paint,
+                        glyphIds[glyphIndex],
+                        isHalo ? style.haloRadius : 0,
+                        glyph);
+                    if (!ok)
+                        return false;
+
+                    if (glyph.area.width() > 0 && glyph.area.height() > 0)
+                    {
+                        const auto scale = textSize / glyph.rasterizedSize;
+
+                        GlyphAtlas::GlyphQuad quad;
+                        quad.pageIndex = glyph.pageIndex;
+                        quad.isHalo = isHalo;
+                        quad.area.top() = penPosition.y + glyph.offset.y * scale;
+                        quad.area.left() = penPosition.x + glyph.offset.x * scale;
+                        quad.area.bottom() = quad.area.top() + glyph.area.height() * scale;
+                        quad.area.right() = quad.area.left() + glyph.area.width() * scale;
+                        quad.textureArea.top() = glyph.area.top() / pageSize;
+                        quad.textureArea.left() = glyph.area.left() / pageSize;
+                        quad.textureArea.bottom() = glyph.area.bottom() / pageSize;
+                        quad.textureArea.right() = glyph.area.right() / pageSize;
+                        outQuads.push_back(quad);
+                    }
+
+                    penPosition.x += glyphAdvances[glyphIndex];
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+OsmAnd::TextRasterizer_P::CacheStatistics OsmAnd::TextRasterizer_P::getCacheStatistics() const
+{
+    QMutexLocker scopedLocker(&_cacheMutex);
+
+    CacheStatistics statistics;
+    statistics.hits = _cacheHits;
+    statistics.misses = _cacheMisses;
+    statistics.entriesCount = _cache.count();
+    statistics.sizeInBytes = _cache.totalCost();
+    statistics.sizeLimitInBytes = _cache.maxCost();
+    return statistics;
+}
+
+void OsmAnd::TextRasterizer_P::setCacheSizeLimit(const unsigned int sizeLimitInBytes)
+{
+    QMutexLocker scopedLocker(&_cacheMutex);
+
+    _cache.setMaxCost(static_cast<int>(sizeLimitInBytes));
+}
+
+void OsmAnd::TextRasterizer_P::clearCache()
+{
+    QMutexLocker scopedLocker(&_cacheMutex);
+
+    _cache.clear();
+    _cacheHits = 0;
+    _cacheMisses = 0;
+}
+
+bool OsmAnd::TextRasterizer_P::CacheKey::operator==(const CacheKey& that) const
+{
+    return
+        text == that.text &&
+        style.wrapWidth == that.style.wrapWidth &&
+        style.maxLines == that.style.maxLines &&
+        style.size == that.style.size &&
+        style.bold == that.style.bold &&
+        style.italic == that.style.italic &&
+        style.color == that.style.color &&
+        style.haloRadius == that.style.haloRadius &&
+        style.haloColor == that.style.haloColor &&
+        style.backgroundBitmap == that.style.backgroundBitmap &&
+        style.textAlignment == that.style.textAlignment;
+}
+
+uint OsmAnd::TextRasterizer_P::CacheKey::qHash() const
+{
+    uint hash = ::qHash(text);
+    hash = hash * 31 + style.wrapWidth;
+    hash = hash * 31 + style.maxLines;
+    hash = hash * 31 + ::qHash(style.size);
+    hash = hash * 31 + (style.bold ? 1 : 0);
+    hash = hash * 31 + (style.italic ? 1 : 0);
+    hash = hash * 31 + style.color.argb;
+    hash = hash * 31 + style.haloRadius;
+    hash = hash * 31 + style.haloColor.argb;
+    hash = hash * 31 + ::qHash(style.backgroundBitmap.get());
+    hash = hash * 31 + static_cast<uint>(style.textAlignment);
+    return hash;
+}
@@ -8,6 +8,8 @@
 #include "ignore_warnings_on_external_includes.h"
 #include <QList>
 #include <QVector>
+#include <QMutex>
+#include <QCache>
 #include "restore_internal_warnings.h"
 
 #include "ignore_warnings_on_external_includes.h"
@@ -18,6 +20,7 @@
 #include "OsmAndCore.h"
 #include "CommonTypes.h"
 #include "MapCommonTypes.h"
+#include "GlyphAtlas.h"
 #include "TextRasterizer.h"
 
 namespace OsmAnd
@@ -30,10 +33,33 @@ namespace OsmAnd
     {
     public:
         typedef TextRasterizer::Style Style;
+        typedef TextRasterizer::CacheStatistics CacheStatistics;
 
     private:
         SkPaint _defaultPaint;
 
+        struct CacheKey Q_DECL_FINAL
+        {
+            QString text;
+            Style style;
+
+            bool operator==(const CacheKey& that) const;
+            uint qHash() const;
+        };
+        struct CacheEntry Q_DECL_FINAL
+        {
+            std::shared_ptr<const SkBitmap> bitmap;
+            QVector<SkScalar> glyphWidths;
+            float extraTopSpace;
+            float extraBottomSpace;
+            float lineSpacing;
+            float fontAscent;
+        };
+        mutable QMutex _cacheMutex;
+        mutable QCache<CacheKey, CacheEntry> _cache;
+        mutable unsigned int _cacheHits;
+        mutable unsigned int _cacheMisses;
+
         struct TextPaint
         {
             inline TextPaint()
@@ -118,6 +144,26 @@ namespace OsmAnd
             float* const outLineSpacing,
             float* const outFontAscent) const;
 
+        std::shared_ptr<const SkBitmap> rasterizeCached(
+            const QString& text,
+            const Style& style,
+            QVector<SkScalar>* const outGlyphWidths,
+            float* const outExtraTopSpace,
+            float* const outExtraBottomSpace,
+            float* const outLineSpacing,
+            float* const outFontAscent) const;
+
+        bool layoutGlyphs(
+            const QString& text,
+            const Style& style,
+            GlyphAtlas& atlas,
+            QVector<GlyphAtlas::GlyphQuad>& outQuads,
+            PointI* const outSize) const;
+
+        CacheStatistics getCacheStatistics() const;
+        void setCacheSizeLimit(const unsigned int sizeLimitInBytes);
+        void clearCache();
+
     friend class OsmAnd::TextRasterizer;
     };
 }
@@ -5,26 +5,49 @@
 #include <OsmAndCore/QtExtensions.h>
 #include <QtSql>
 
+#include "QtCommon.h"
 #include "Logging.h"
 #include "Utilities.h"
 
-OsmAnd::TileDB::TileDB( const QDir& dataPath_, const QString& indexFilename_/* = QString::null*/ )
-    : _indexMutex(QMutex::Recursive)
+OsmAnd::TileDB::TileDB(
+    const QDir& dataPath_,
+    const QString& indexFilename_/* = QString::null*/,
+    const unsigned int connectionsPoolCapacity_/* = DefaultConnectionsPoolCapacity*/)
+    : _isIntervalIndexLoaded(false)
+    , _connectionsPoolsOrphaned(new QAtomicInt(0))
+    , _connectionsGeneration(0)
+    , _indexMutex(QMutex::Recursive)
+    , _indexConnectionName(makeConnectionName(QLatin1String("tiledb-sqlite-index"), dataPath_.absolutePath()))
     , dataPath(dataPath_)
     , indexFilename(indexFilename_)
+    , connectionsPoolCapacity(connectionsPoolCapacity_)
 {
-    auto indexConnectionName = QLatin1String("tiledb-sqlite-index:") + dataPath_.absolutePath();
-
-    if (!QSqlDatabase::contains(indexConnectionName))
-        _indexDb = QSqlDatabase::addDatabase("QSQLITE", indexConnectionName);
-    else
-        _indexDb = QSqlDatabase::database(indexConnectionName);
+    _indexDb = QSqlDatabase::addDatabase("QSQLITE", _indexConnectionName);
 }
 
 OsmAnd::TileDB::~TileDB()
 {
+    // Connections of other threads may not be closed here, so their pools are only marked as orphaned.
+    // Pool of this thread is released right away.
+    _connectionsPoolsOrphaned->storeRelease(1);
+    obtainConnectionsPool(false);
+
     if (_indexDb.isOpen())
         _indexDb.close();
+    _indexDb = QSqlDatabase();
+    QSqlDatabase::removeDatabase(_indexConnectionName);
+}
+
+QString OsmAnd::TileDB::makeConnectionName(const QString& prefix, const QString& filename)
+{
+    // Registry of connections is global, and connection added with name that is already registered replaces
+    // existing one. So each connection gets name of its own.
+    static QAtomicInt lastConnectionId(0);
+
+    return QString(QLatin1String("%1:%2:%3"))
+        .arg(prefix)
+        .arg(filename)
+        .arg(lastConnectionId.fetchAndAddOrdered(1) + 1);
 }
 
 bool OsmAnd::TileDB::openIndex()
@@ -44,10 +67,257 @@ bool OsmAnd::TileDB::openIndex()
 
     if (shouldRebuild)
         rebuildIndex();
+    else
+        loadIntervalIndex();
 
     return true;
 }
 
+bool OsmAnd::TileDB::loadIntervalIndex()
+{
+    QMutexLocker scopeLock(&_indexMutex);
+
+    QHash<int, QString> files;
+    QSqlQuery filesQuery(_indexDb);
+    filesQuery.setForwardOnly(true);
+    if (!filesQuery.exec("SELECT id, filename FROM tiledb_files"))
+    {
+        LogPrintf(LogSeverityLevel::Error, "Failed to load TileDB index from '%s': %s", qPrintable(indexFilename), qPrintable(filesQuery.lastError().text()));
+        return false;
+    }
+    while (filesQuery.next())
+        files.insert(filesQuery.value(0).toInt(), filesQuery.value(1).toString());
+
+    QHash<ZoomLevel, QVector<IndexEntry> > intervalIndex;
+    QSqlQuery entriesQuery(_indexDb);
+    entriesQuery.setForwardOnly(true);
+    if (!entriesQuery.exec("SELECT xMin, yMin, xMax, yMax, zoom, id FROM tiledb_index"))
+    {
+        LogPrintf(LogSeverityLevel::Error, "Failed to load TileDB index from '%s': %s", qPrintable(indexFilename), qPrintable(entriesQuery.lastError().text()));
+        return false;
+    }
+    while (entriesQuery.next())
+    {
+        IndexEntry entry;
+        entry.area.left() = entriesQuery.value(0).toInt();
+        entry.area.top() = entriesQuery.value(1).toInt();
+        entry.area.right() = entriesQuery.value(2).toInt();
+        entry.area.bottom() = entriesQuery.value(3).toInt();
+        entry.fileId = entriesQuery.value(5).toInt();
+        entry.maxRightSoFar = entry.area.right();
+
+        const auto zoom = static_cast<ZoomLevel>(entriesQuery.value(4).toInt());
+        intervalIndex[zoom].push_back(entry);
+    }
+
+    for (auto& entries : intervalIndex)
+    {
+        std::sort(entries.begin(), entries.end(),
+            []
+            (const IndexEntry& l, const IndexEntry& r) -> bool
+            {
+                return l.area.left() < r.area.left();
+            });
+
+        for (auto entryIdx = 1; entryIdx < entries.size(); entryIdx++)
+            entries[entryIdx].maxRightSoFar = qMax(entries[entryIdx].area.right(), entries[entryIdx - 1].maxRightSoFar);
+    }
+
+    {
+        QWriteLocker scopedLocker(&_intervalIndexLock);
+
+        _files = qMove(files);
+        _intervalIndex = qMove(intervalIndex);
+        _isIntervalIndexLoaded = true;
+    }
+
+    return true;
+}
+
+bool OsmAnd::TileDB::lookupFiles(const TileId tileId, const ZoomLevel zoom, QList< QPair<int, QString> >& outFiles) const
+{
+    QReadLocker scopedLocker(&_intervalIndexLock);
+
+    if (!_isIntervalIndexLoaded)
+        return false;
+
+    const auto citEntries = _intervalIndex.constFind(zoom);
+    if (citEntries == _intervalIndex.cend())
+        return true;
+    const auto& entries = *citEntries;
+
+    // All entries that may contain tile start at or before it
+    const auto itEnd = std::upper_bound(entries.cbegin(), entries.cend(), tileId.x,
+        []
+        (const int32_t x, const IndexEntry& entry) -> bool
+        {
+            return x < entry.area.left();
+        });
+    for (auto entryIdx = static_cast<int>(itEnd - entries.cbegin()) - 1; entryIdx >= 0; entryIdx--)
+    {
+        const auto& entry = entries[entryIdx];
+        if (entry.maxRightSoFar < tileId.x)
+            break;
+
+        if (entry.area.contains(tileId.x, tileId.y))
+            outFiles.push_back(qMakePair(entry.fileId, _files.value(entry.fileId)));
+    }
+
+    return true;
+}
+
+OsmAnd::TileDB::Connection::Connection(const QString& connectionName_, const QString& filename)
+    : connectionName(connectionName_)
+    , isValid(false)
+{
+    db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+    db.setDatabaseName(filename);
+    db.setConnectOptions("QSQLITE_OPEN_READONLY");
+    if (!db.open())
+    {
+        LogPrintf(LogSeverityLevel::Error, "Failed to open TileDB from '%s': %s", qPrintable(filename), qPrintable(db.lastError().text()));
+        return;
+    }
+
+    tileQuery = QSqlQuery(db);
+    tileQuery.setForwardOnly(true);
+    if (!tileQuery.prepare("SELECT data FROM tiles WHERE x=? AND y=? AND zoom=?"))
+    {
+        LogPrintf(LogSeverityLevel::Error, "Failed to prepare TileDB query for '%s': %s", qPrintable(filename), qPrintable(tileQuery.lastError().text()));
+        return;
+    }
+
+    isValid = true;
+}
+
+OsmAnd::TileDB::Connection::~Connection()
+{
+    // Database can be removed only after all queries and handles to it are gone
+    tileQuery = QSqlQuery();
+    if (db.isOpen())
+        db.close();
+    db = QSqlDatabase();
+    QSqlDatabase::removeDatabase(connectionName);
+}
+
+OsmAnd::TileDB::ConnectionsPool::ConnectionsPool(const std::shared_ptr<QAtomicInt>& orphaned_, const int generation_)
+    : orphaned(orphaned_)
+    , useCounter(0)
+    , generation(generation_)
+{
+}
+
+QThreadStorage<OsmAnd::TileDB::ConnectionsPools>& OsmAnd::TileDB::threadConnectionsPools()
+{
+    // Storage outlives every TileDB, so that orphaned pools are still released when their threads exit
+    static QThreadStorage<ConnectionsPools> storage;
+    return storage;
+}
+
+std::shared_ptr<OsmAnd::TileDB::ConnectionsPool> OsmAnd::TileDB::obtainConnectionsPool(const bool create)
+{
+    auto& pools = threadConnectionsPools().localData();
+
+    std::shared_ptr<ConnectionsPool> pool;
+    auto itPool = mutableIteratorOf(pools);
+    while (itPool.hasNext())
+    {
+        const auto& candidate = itPool.next();
+
+        // Pools of destroyed TileDBs are released by this thread as soon as it notices them
+        if (candidate->orphaned->loadAcquire())
+        {
+            itPool.remove();
+            continue;
+        }
+
+        if (candidate->orphaned == _connectionsPoolsOrphaned)
+            pool = candidate;
+    }
+
+    if (!pool && create)
+    {
+        pool.reset(new ConnectionsPool(_connectionsPoolsOrphaned, _connectionsGeneration.loadAcquire()));
+        pools.push_back(pool);
+    }
+
+    return pool;
+}
+
+std::shared_ptr<OsmAnd::TileDB::Connection> OsmAnd::TileDB::obtainConnection(const int fileId, const QString& filename)
+{
+    if (connectionsPoolCapacity == 0)
+        return std::make_shared<Connection>(makeConnectionName(QLatin1String("tiledb-sqlite"), filename), filename);
+
+    const auto pool = obtainConnectionsPool(true);
+
+    // Connections opened before index was rebuilt may refer to files that are gone or replaced
+    const auto generation = _connectionsGeneration.loadAcquire();
+    if (pool->generation != generation)
+    {
+        pool->connections.clear();
+        pool->generation = generation;
+    }
+
+    const auto itEntry = pool->connections.find(fileId);
+    if (itEntry != pool->connections.end())
+    {
+        // Connection that is still referenced elsewhere is in use by this thread already, so a separate
+        // short-lived one is needed
+        if (itEntry->connection.use_count() > 1)
+            return std::make_shared<Connection>(makeConnectionName(QLatin1String("tiledb-sqlite"), filename), filename);
+
+        itEntry->lastUse = ++pool->useCounter;
+        return itEntry->connection;
+    }
+
+    const auto connection = std::make_shared<Connection>(makeConnectionName(QLatin1String("tiledb-sqlite"), filename), filename);
+    if (!connection->isValid)
+        return connection;
+
+    ConnectionsPoolEntry newEntry;
+    newEntry.connection = connection;
+    newEntry.lastUse = ++pool->useCounter;
+    pool->connections.insert(fileId, newEntry);
+    evictConnections(*pool);
+
+    return connection;
+}
+
+void OsmAnd::TileDB::evictConnections(ConnectionsPool& pool) const
+{
+    while (static_cast<unsigned int>(pool.connections.size()) > connectionsPoolCapacity)
+    {
+        // Find least recently used connection that is idle
+        auto itVictim = pool.connections.end();
+        for (auto itEntry = pool.connections.begin(); itEntry != pool.connections.end(); ++itEntry)
+        {
+            if (itEntry->connection.use_count() > 1)
+                continue;
+            if (itVictim == pool.connections.end() || itEntry->lastUse < itVictim->lastUse)
+                itVictim = itEntry;
+        }
+
+        // All connections are in use, pool will shrink on subsequent calls
+        if (itVictim == pool.connections.end())
+            break;
+
+        pool.connections.erase(itVictim);
+    }
+}
+
+void OsmAnd::TileDB::releaseAllConnections()
+{
+    _connectionsGeneration.fetchAndAddOrdered(1);
+
+    // Connections of this thread are released right away, while other threads release theirs on next use
+    if (const auto pool = obtainConnectionsPool(false))
+    {
+        pool->connections.clear();
+        pool->generation = _connectionsGeneration.loadAcquire();
+    }
+}
+
 bool OsmAnd::TileDB::rebuildIndex()
 {
     QMutexLocker scopeLock(&_indexMutex);
@@ -112,16 +382,22 @@ bool OsmAnd::TileDB::rebuildIndex()
     {
         const auto dbFilename = file.absoluteFilePath();
 
-        const auto connectionName = QLatin1String("tiledb-sqlite:") + dbFilename;
-        QSqlDatabase db;
-        if (!QSqlDatabase::contains(connectionName))
-            db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
-        else
-            db = QSqlDatabase::database(connectionName);
-        db.setDatabaseName(dbFilename);
-        if (!db.open())
+        // Connection is removed once it's no longer referenced
+        const auto connectionName = makeConnectionName(QLatin1String("tiledb-sqlite-indexing"), dbFilename);
+        const std::shared_ptr<QSqlDatabase> db(
+            new QSqlDatabase(QSqlDatabase::addDatabase("QSQLITE", connectionName)),
+            [connectionName]
+            (QSqlDatabase* const db)
+            {
+                if (db->isOpen())
+                    db->close();
+                delete db;
+                QSqlDatabase::removeDatabase(connectionName);
+            });
+        db->setDatabaseName(dbFilename);
+        if (!db->open())
         {
-            LogPrintf(LogSeverityLevel::Error, "Failed to open TileDB from '%s': %s", qPrintable(dbFilename), qPrintable(db.lastError().text()));
+            LogPrintf(LogSeverityLevel::Error, "Failed to open TileDB from '%s': %s", qPrintable(dbFilename), qPrintable(db->lastError().text()));
             continue;
         }
 
@@ -132,7 +408,7 @@ bool OsmAnd::TileDB::rebuildIndex()
         auto fileId = registerFileQuery.lastInsertId();
 
         // For each zoom, query min-max of tile coordinates
-        QSqlQuery minMaxQuery("SELECT zoom, xMin, yMin, xMax, yMax FROM bounds", db);
+        QSqlQuery minMaxQuery("SELECT zoom, xMin, yMin, xMax, yMax FROM bounds", *db);
         ok = minMaxQuery.exec();
         assert(ok);
         while(minMaxQuery.next())
@@ -153,12 +429,14 @@ bool OsmAnd::TileDB::rebuildIndex()
             ok = insertTileQuery.exec();
             assert(ok);
         }
-
-        db.close();
     }
 
     _indexDb.commit();
 
+    // Pooled connections may refer to files that are gone or replaced
+    releaseAllConnections();
+    loadIntervalIndex();
+
     auto endTimestamp = std::chrono::steady_clock::now();
     auto duration = std::chrono::duration_cast< std::chrono::duration<uint64_t, std::milli> >(endTimestamp - beginTimestamp).count();
     LogPrintf(LogSeverityLevel::Info, "Finished indexing '%s', took %lldms, average %lldms/db", qPrintable(dataPath.absolutePath()), duration, duration / files.length());
@@ -168,62 +446,41 @@ bool OsmAnd::TileDB::rebuildIndex()
 
 bool OsmAnd::TileDB::obtainTileData( const TileId tileId, const ZoomLevel zoom, QByteArray& data )
 {
-    QMutexLocker scopeLock(&_indexMutex);
-
-    // Check that index is available
-    if (!_indexDb.isOpen())
+    // Index is opened only once, after that lookups don't need exclusive access
+    QList< QPair<int, QString> > files;
+    if (!lookupFiles(tileId, zoom, files))
     {
-        if (!openIndex())
+        {
+            QMutexLocker scopeLock(&_indexMutex);
+
+            if (!_indexDb.isOpen() && !openIndex())
+                return false;
+        }
+
+        if (!lookupFiles(tileId, zoom, files))
             return false;
     }
 
-    QSqlQuery query(_indexDb);
-    query.prepare("SELECT filename FROM tiledb_files WHERE id IN (SELECT id FROM tiledb_index WHERE xMin<=? AND xMax>=? AND yMin<=? AND yMax>=? AND zoom=?)");
-    query.addBindValue(tileId.x);
-    query.addBindValue(tileId.x);
-    query.addBindValue(tileId.y);
-    query.addBindValue(tileId.y);
-    query.addBindValue(zoom);
-    if (!query.exec())
-        return false;
-
-    bool hit = false;
-    while(!hit && query.next())
+    for (const auto& file : constOf(files))
     {
-        const auto dbFilename = query.value(0).toString();
-
-        //TODO: manage access to database
-        //QMutexLocker scopeLock(&dbEntry->mutex);
-
-        // Open database
-        const auto connectionName = QLatin1String("tiledb-sqlite:") + dbFilename;
-        QSqlDatabase db;
-        if (!QSqlDatabase::contains(connectionName))
-            db = QSqlDatabase::addDatabase("QSQLITE", connectionName);
-        else
-            db = QSqlDatabase::database(connectionName);
-        db.setDatabaseName(dbFilename);
-        if (!db.open())
-        {
-            LogPrintf(LogSeverityLevel::Error, "Failed to open TileDB index from '%s': %s", qPrintable(dbFilename), qPrintable(db.lastError().text()));
-            return false;
-        }
+        const auto connection = obtainConnection(file.first, file.second);
+        if (!connection->isValid)
+            continue;
 
-        // Get tile from
-        QSqlQuery query(db);
-        query.prepare("SELECT data FROM tiles WHERE x=? AND y=? AND zoom=?");
-        query.addBindValue(tileId.x);
-        query.addBindValue(tileId.y);
-        query.addBindValue(static_cast<int>(zoom));
-        if (query.exec() && query.next())
-        {
+        auto& query = connection->tileQuery;
+        query.bindValue(0, tileId.x);
+        query.bindValue(1, tileId.y);
+        query.bindValue(2, static_cast<int>(zoom));
+        const auto hit = query.exec() && query.next();
+        if (hit)
             data = query.value(0).toByteArray();
-            hit = true;
-        }
 
-        // Close database
-        db.close();
+        // Release read lock on database, while keeping statement prepared
+        query.finish();
+
+        if (hit)
+            return true;
     }
     
-    return hit;
+    return false;
 }
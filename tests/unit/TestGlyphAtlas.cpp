@@ -0,0 +1,321 @@
+#include <OsmAndCore/GlyphAtlas.h>
+#include <OsmAndCore/TextRasterizer.h>
+#include <OsmAndCore/CachingFontFinder.h>
+#include <OsmAndCore/SystemFontFinder.h>
+
+#include <QtTest/QtTest>
+#include <QCoreApplication>
+
+#include <SkBitmap.h>
+#include <SkPaint.h>
+#include <SkTypeface.h>
+
+using namespace OsmAnd;
+
+class TestGlyphAtlas : public QObject
+{
+    Q_OBJECT
+
+private:
+    // Sets system typeface that has glyph of 'A' to paint, and returns that glyph
+    static bool prepareGlyph(SkPaint& paint, uint16_t& outGlyphId);
+    static std::shared_ptr<const TextRasterizer> createTextRasterizer();
+private slots:
+    void allocateArea();
+    void allocateAreaOpensNewPage();
+    void allocateAreaRejectsInvalidSize();
+    void allocateAreaRespectsMaxPagesCount();
+    void obtainGlyph();
+    void obtainGlyphSignedDistanceField();
+    void layoutGlyphs();
+    void layoutGlyphsWithHalo();
+    void computeSignedDistanceField();
+};
+
+bool TestGlyphAtlas::prepareGlyph(SkPaint& paint, uint16_t& outGlyphId)
+{
+    SystemFontFinder fontFinder;
+    const auto typeface = fontFinder.findFontForCharacterUCS4('A');
+    if (!typeface)
+        return false;
+    paint.setTypeface(typeface);
+    typeface->unref();
+
+    paint.setTextEncoding(SkPaint::kUTF8_TextEncoding);
+    paint.setTextSize(20.0f);
+    return paint.textToGlyphs("A", 1, &outGlyphId) == 1 && outGlyphId != 0;
+}
+
+std::shared_ptr<const TextRasterizer> TestGlyphAtlas::createTextRasterizer()
+{
+    SkPaint paint;
+    uint16_t glyphId;
+    if (!prepareGlyph(paint, glyphId))
+        return nullptr;
+
+    return std::make_shared<TextRasterizer>(std::shared_ptr<const IFontFinder>(new CachingFontFinder(
+        std::shared_ptr<const IFontFinder>(new SystemFontFinder()))));
+}
+
+void TestGlyphAtlas::allocateArea()
+{
+    GlyphAtlas atlas(GlyphAtlas::Mode::Coverage, 128);
+
+    QVector<AreaI> areas;
+    for (auto index = 0; index < 32; index++)
+    {
+        const PointI size(5 + (index * 7) % 20, 5 + (index * 11) % 20);
+
+        unsigned int pageIndex;
+        AreaI area;
+        QVERIFY(atlas.allocateArea(size, pageIndex, area));
+        QCOMPARE(pageIndex, 0u);
+        QCOMPARE(area.width(), size.x);
+        QCOMPARE(area.height(), size.y);
+        QVERIFY(area.left() >= 0 && area.top() >= 0);
+        QVERIFY(area.right() <= 128 && area.bottom() <= 128);
+
+        // Areas are half-open, so touching edges do not overlap
+        for (const auto& otherArea : areas)
+        {
+            const auto overlaps =
+                area.left() < otherArea.right() && otherArea.left() < area.right() &&
+                area.top() < otherArea.bottom() && otherArea.top() < area.bottom();
+            QVERIFY(!overlaps);
+        }
+        areas.push_back(area);
+    }
+    QCOMPARE(atlas.getPagesCount(), 1u);
+}
+
+void TestGlyphAtlas::allocateAreaOpensNewPage()
+{
+    GlyphAtlas atlas(GlyphAtlas::Mode::Coverage, 64);
+
+    unsigned int pageIndex;
+    AreaI area;
+    for (auto index = 0; index < 4; index++)
+    {
+        QVERIFY(atlas.allocateArea(PointI(32, 32), pageIndex, area));
+        QCOMPARE(pageIndex, 0u);
+    }
+
+    QVERIFY(atlas.allocateArea(PointI(32, 32), pageIndex, area));
+    QCOMPARE(pageIndex, 1u);
+    QCOMPARE(area, AreaI(0, 0, 32, 32));
+    QCOMPARE(atlas.getPagesCount(), 2u);
+}
+
+void TestGlyphAtlas::allocateAreaRejectsInvalidSize()
+{
+    GlyphAtlas atlas(GlyphAtlas::Mode::Coverage, 64);
+
+    unsigned int pageIndex;
+    AreaI area;
+    QVERIFY(!atlas.allocateArea(PointI(65, 1), pageIndex, area));
+    QVERIFY(!atlas.allocateArea(PointI(1, 65), pageIndex, area));
+    QVERIFY(!atlas.allocateArea(PointI(0, 10), pageIndex, area));
+    QCOMPARE(atlas.getPagesCount(), 0u);
+}
+
+void TestGlyphAtlas::allocateAreaRespectsMaxPagesCount()
+{
+    GlyphAtlas atlas(GlyphAtlas::Mode::Coverage, 64, 32.0f, GlyphAtlas::DefaultSignedDistanceFieldSpread, 2);
+
+    unsigned int pageIndex;
+    AreaI area;
+    for (auto index = 0; index < 8; index++)
+        QVERIFY(atlas.allocateArea(PointI(32, 32), pageIndex, area));
+    QVERIFY(!atlas.allocateArea(PointI(32, 32), pageIndex, area));
+    QCOMPARE(atlas.getPagesCount(), 2u);
+
+    // Cleared atlas starts over
+    const auto generation = atlas.getGeneration();
+    atlas.clear();
+    QCOMPARE(atlas.getPagesCount(), 0u);
+    QCOMPARE(atlas.getGeneration(), generation + 1);
+    QVERIFY(atlas.allocateArea(PointI(32, 32), pageIndex, area));
+    QCOMPARE(pageIndex, 0u);
+}
+
+void TestGlyphAtlas::obtainGlyph()
+{
+    SkPaint paint;
+    uint16_t glyphId;
+    if (!prepareGlyph(paint, glyphId))
+        QSKIP("No system font with glyph of 'A'");
+
+    GlyphAtlas atlas(GlyphAtlas::Mode::Coverage, 256);
+
+    GlyphAtlas::Glyph glyph;
+    QVERIFY(atlas.obtainGlyph(paint, glyphId, 0, glyph));
+    QVERIFY(glyph.area.width() > 0 && glyph.area.height() > 0);
+    QCOMPARE(glyph.rasterizedSize, 20.0f);
+    // Glyph of capital letter is placed above baseline
+    QVERIFY(glyph.offset.y < 0.0f);
+
+    // Glyph pixels were copied into page
+    SkBitmap page;
+    unsigned int revision;
+    QVERIFY(atlas.copyPage(glyph.pageIndex, page, &revision));
+    auto maxCoverage = 0;
+    for (auto y = glyph.area.top(); y < glyph.area.bottom(); y++)
+    {
+        for (auto x = glyph.area.left(); x < glyph.area.right(); x++)
+            maxCoverage = qMax(maxCoverage, static_cast<int>(*page.getAddr8(x, y)));
+    }
+    QVERIFY(maxCoverage > 128);
+
+    // Same glyph is returned from atlas without rasterizing it again
+    GlyphAtlas::Glyph sameGlyph;
+    QVERIFY(atlas.obtainGlyph(paint, glyphId, 0, sameGlyph));
+    QCOMPARE(sameGlyph.area, glyph.area);
+    QCOMPARE(sameGlyph.pageIndex, glyph.pageIndex);
+    QCOMPARE(atlas.getPageRevision(glyph.pageIndex), revision);
+
+    // Size and halo radius are parts of key in coverage mode
+    GlyphAtlas::Glyph haloGlyph;
+    QVERIFY(atlas.obtainGlyph(paint, glyphId, 2, haloGlyph));
+    QVERIFY(!(haloGlyph.area == glyph.area));
+    QVERIFY(haloGlyph.area.width() > glyph.area.width());
+
+    paint.setTextSize(40.0f);
+    GlyphAtlas::Glyph largerGlyph;
+    QVERIFY(atlas.obtainGlyph(paint, glyphId, 0, largerGlyph));
+    QVERIFY(!(largerGlyph.area == glyph.area));
+    QVERIFY(largerGlyph.area.height() > glyph.area.height());
+    QCOMPARE(largerGlyph.rasterizedSize, 40.0f);
+    QCOMPARE(atlas.getPagesCount(), 1u);
+}
+
+void TestGlyphAtlas::obtainGlyphSignedDistanceField()
+{
+    SkPaint paint;
+    uint16_t glyphId;
+    if (!prepareGlyph(paint, glyphId))
+        QSKIP("No system font with glyph of 'A'");
+
+    GlyphAtlas atlas(GlyphAtlas::Mode::SignedDistanceField, 256, 32.0f, 4);
+
+    GlyphAtlas::Glyph glyph;
+    QVERIFY(atlas.obtainGlyph(paint, glyphId, 0, glyph));
+    QCOMPARE(glyph.rasterizedSize, 32.0f);
+    const auto revision = atlas.getPageRevision(glyph.pageIndex);
+
+    // Distance field serves all sizes and halo radii
+    paint.setTextSize(48.0f);
+    GlyphAtlas::Glyph otherGlyph;
+    QVERIFY(atlas.obtainGlyph(paint, glyphId, 3, otherGlyph));
+    QCOMPARE(otherGlyph.area, glyph.area);
+    QCOMPARE(otherGlyph.rasterizedSize, 32.0f);
+    QCOMPARE(atlas.getPageRevision(glyph.pageIndex), revision);
+
+    // Spread is kept around glyph, so its border is outside of glyph
+    SkBitmap page;
+    QVERIFY(atlas.copyPage(glyph.pageIndex, page));
+    QVERIFY(*page.getAddr8(glyph.area.left(), glyph.area.top()) < 128);
+}
+
+void TestGlyphAtlas::layoutGlyphs()
+{
+    const auto textRasterizer = createTextRasterizer();
+    if (!textRasterizer)
+        QSKIP("No system font with glyph of 'A'");
+
+    const auto pageSize = 256;
+    GlyphAtlas atlas(GlyphAtlas::Mode::Coverage, pageSize);
+    TextRasterizer::Style style;
+    style.setSize(20.0f);
+
+    QVector<GlyphAtlas::GlyphQuad> quads;
+    PointI size;
+    QVERIFY(textRasterizer->layoutGlyphs(QLatin1String("AB"), style, atlas, quads, &size));
+    QCOMPARE(quads.size(), 2);
+
+    // Layout has size of bitmap that rasterize() produces
+    const auto bitmap = textRasterizer->rasterize(QLatin1String("AB"), style);
+    QVERIFY(bitmap != nullptr);
+    QCOMPARE(size, PointI(bitmap->width(), bitmap->height()));
+
+    for (const auto& quad : quads)
+    {
+        QVERIFY(!quad.isHalo);
+
+        // Coverage quads are not scaled, and include one texel of padding that may stick out of layout
+        QCOMPARE(qRound(quad.area.width()), qRound(quad.textureArea.width() * pageSize));
+        QCOMPARE(qRound(quad.area.height()), qRound(quad.textureArea.height() * pageSize));
+        QVERIFY(quad.area.left() >= -1.0f && quad.area.right() <= size.x + 1.0f);
+        QVERIFY(quad.area.top() >= -1.0f && quad.area.bottom() <= size.y + 1.0f);
+        QVERIFY(quad.textureArea.left() >= 0.0f && quad.textureArea.right() <= 1.0f);
+        QVERIFY(quad.textureArea.top() >= 0.0f && quad.textureArea.bottom() <= 1.0f);
+    }
+
+    // Glyphs follow each other from left to right
+    QVERIFY(quads[0].area.left() < quads[1].area.left());
+}
+
+void TestGlyphAtlas::layoutGlyphsWithHalo()
+{
+    const auto textRasterizer = createTextRasterizer();
+    if (!textRasterizer)
+        QSKIP("No system font with glyph of 'A'");
+
+    TextRasterizer::Style style;
+    style.setSize(20.0f).setHaloRadius(2);
+
+    // In coverage mode halo of all text goes first
+    GlyphAtlas coverageAtlas(GlyphAtlas::Mode::Coverage, 256);
+    QVector<GlyphAtlas::GlyphQuad> quads;
+    QVERIFY(textRasterizer->layoutGlyphs(QLatin1String("AB"), style, coverageAtlas, quads));
+    QCOMPARE(quads.size(), 4);
+    QVERIFY(quads[0].isHalo && quads[1].isHalo);
+    QVERIFY(!quads[2].isHalo && !quads[3].isHalo);
+    QVERIFY(quads[0].area.width() > quads[2].area.width());
+
+    // Distance field is enough to draw halo, and is scaled from base size
+    const auto pageSize = 256;
+    GlyphAtlas distanceFieldAtlas(GlyphAtlas::Mode::SignedDistanceField, pageSize, 40.0f);
+    quads.clear();
+    QVERIFY(textRasterizer->layoutGlyphs(QLatin1String("AB"), style, distanceFieldAtlas, quads));
+    QCOMPARE(quads.size(), 2);
+    for (const auto& quad : quads)
+    {
+        QVERIFY(!quad.isHalo);
+        QVERIFY(qAbs(quad.area.width() - quad.textureArea.width() * pageSize * 0.5f) < 0.01f);
+    }
+}
+
+void TestGlyphAtlas::computeSignedDistanceField()
+{
+    const auto size = 24;
+    const auto spread = 4;
+
+    // Square of 8x8 texels in the middle
+    QVector<uint8_t> coverage(size * size, 0);
+    for (auto y = 8; y < 16; y++)
+    {
+        for (auto x = 8; x < 16; x++)
+            coverage[y * size + x] = 255;
+    }
+
+    QVector<uint8_t> distances(size * size);
+    GlyphAtlas::computeSignedDistanceField(coverage.constData(), size, size, spread, distances.data());
+
+    for (auto y = 0; y < size; y++)
+    {
+        for (auto x = 0; x < size; x++)
+        {
+            const auto isInside = (coverage[y * size + x] >= 128);
+            QCOMPARE(distances[y * size + x] > 128, isInside);
+        }
+    }
+
+    // Values grow monotonically from outside towards the center
+    QCOMPARE(distances[0], uint8_t(0));
+    QVERIFY(distances[12 * size + 12] > distances[12 * size + 8]);
+    QVERIFY(distances[12 * size + 8] > distances[12 * size + 7]);
+    QVERIFY(distances[12 * size + 7] > distances[12 * size + 4]);
+}
+
+QTEST_MAIN(TestGlyphAtlas)
+#include "TestGlyphAtlas.moc"
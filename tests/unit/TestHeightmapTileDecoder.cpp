@@ -0,0 +1,279 @@
+#include <OsmAndCore/Map/HeightmapTileDecoder.h>
+
+#include <QtTest/QtTest>
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QHash>
+#include <QPair>
+
+using namespace OsmAnd;
+Q_DECLARE_METATYPE(QDataStream::ByteOrder)
+
+class TestHeightmapTileDecoder : public QObject
+{
+    Q_OBJECT
+
+private:
+    enum {
+        TileSize = 32,
+        RowsPerStrip = 8,
+    };
+
+    static QVector<qint16> makeHeights();
+    static QByteArray compressLzw(const QByteArray& input);
+    static QByteArray makeTiff(
+        const QVector<qint16>& heights,
+        const quint16 compression,
+        const quint16 predictor,
+        const QDataStream::ByteOrder byteOrder);
+    static void verifyHeights(const QVector<float>& decoded, const QVector<qint16>& expected);
+private slots:
+    void decodeRaw();
+    void decodeGeoTiff_data();
+    void decodeGeoTiff();
+    void decodeGeoTiffRejectsOtherSize();
+    void benchmarkDecodeGeoTiff();
+    void benchmarkDecodeUsingGDAL();
+};
+
+QVector<qint16> TestHeightmapTileDecoder::makeHeights()
+{
+    // Slope with noise, crossing sea level
+    QVector<qint16> heights(TileSize * TileSize);
+    for (auto y = 0; y < TileSize; y++)
+    {
+        for (auto x = 0; x < TileSize; x++)
+            heights[y * TileSize + x] = static_cast<qint16>((x - 8) * 37 + y * 11 + ((x * 7 + y * 13) % 5) - 100);
+    }
+    return heights;
+}
+
+QByteArray TestHeightmapTileDecoder::compressLzw(const QByteArray& input)
+{
+    QByteArray output;
+    quint32 bitBuffer = 0;
+    int bitsCount = 0;
+    auto codeWidth = 9;
+    const auto writeCode =
+        [&output, &bitBuffer, &bitsCount, &codeWidth]
+        (const int code)
+        {
+            bitBuffer = (bitBuffer << codeWidth) | static_cast<quint32>(code);
+            bitsCount += codeWidth;
+            while (bitsCount >= 8)
+            {
+                output.append(static_cast<char>((bitBuffer >> (bitsCount - 8)) & 0xFF));
+                bitsCount -= 8;
+            }
+        };
+
+    // Tile is small enough for table to never fill up, so single clear code is enough
+    QHash< QPair<int, quint8>, int > table;
+    auto nextCode = 258;
+    writeCode(256);
+    auto prefixCode = static_cast<int>(static_cast<quint8>(input[0]));
+    for (auto byteIdx = 1; byteIdx < input.size(); byteIdx++)
+    {
+        const auto byte = static_cast<quint8>(input[byteIdx]);
+        const auto key = qMakePair(prefixCode, byte);
+        const auto citCode = table.constFind(key);
+        if (citCode != table.cend())
+        {
+            prefixCode = *citCode;
+            continue;
+        }
+
+        writeCode(prefixCode);
+        table.insert(key, nextCode++);
+        if (nextCode > (1 << codeWidth) - 1)
+            codeWidth++;
+        prefixCode = byte;
+    }
+    writeCode(prefixCode);
+    nextCode++;
+    if (nextCode > (1 << codeWidth) - 1)
+        codeWidth++;
+    writeCode(257);
+    if (bitsCount > 0)
+        output.append(static_cast<char>((bitBuffer << (8 - bitsCount)) & 0xFF));
+
+    return output;
+}
+
+QByteArray TestHeightmapTileDecoder::makeTiff(
+    const QVector<qint16>& heights,
+    const quint16 compression,
+    const quint16 predictor,
+    const QDataStream::ByteOrder byteOrder)
+{
+    const auto stripsCount = TileSize / RowsPerStrip;
+
+    QList<QByteArray> strips;
+    for (auto stripIdx = 0; stripIdx < stripsCount; stripIdx++)
+    {
+        QByteArray strip;
+        QDataStream stripStream(&strip, QIODevice::WriteOnly);
+        stripStream.setByteOrder(byteOrder);
+        for (auto row = stripIdx * RowsPerStrip; row < (stripIdx + 1) * RowsPerStrip; row++)
+        {
+            qint16 previous = 0;
+            for (auto column = 0; column < TileSize; column++)
+            {
+                const auto height = heights[row * TileSize + column];
+                stripStream << static_cast<qint16>(predictor == 2 ? height - previous : height);
+                previous = height;
+            }
+        }
+
+        if (compression == 5)
+            strip = compressLzw(strip);
+        else if (compression == 8)
+            strip = qCompress(strip).mid(4);
+        strips.push_back(strip);
+    }
+
+    QByteArray tiff;
+    QDataStream stream(&tiff, QIODevice::WriteOnly);
+    stream.setByteOrder(byteOrder);
+    stream.writeRawData(byteOrder == QDataStream::LittleEndian ? "II" : "MM", 2);
+    stream << quint16(42);
+
+    // Strips go first, then directory, then arrays referenced by directory
+    quint32 stripsSize = 0;
+    for (const auto& strip : strips)
+        stripsSize += strip.size();
+    const quint32 ifdOffset = 8 + stripsSize + (stripsSize % 2);
+    const quint16 entriesCount = 11;
+    const quint32 stripOffsetsOffset = ifdOffset + 2 + entriesCount * 12 + 4;
+    const quint32 stripByteCountsOffset = stripOffsetsOffset + stripsCount * 4;
+    stream << ifdOffset;
+    for (const auto& strip : strips)
+        stream.writeRawData(strip.constData(), strip.size());
+    if (stripsSize % 2)
+        stream << quint8(0);
+
+    const auto writeEntry =
+        [&stream]
+        (const quint16 tag, const quint16 type, const quint32 count, const quint32 value)
+        {
+            stream << tag << type << count;
+            if (type == 3 && count == 1)
+                stream << static_cast<quint16>(value) << quint16(0);
+            else
+                stream << value;
+        };
+    stream << entriesCount;
+    writeEntry(256, 3, 1, TileSize);
+    writeEntry(257, 3, 1, TileSize);
+    writeEntry(258, 3, 1, 16);
+    writeEntry(259, 3, 1, compression);
+    writeEntry(262, 3, 1, 1);
+    writeEntry(273, 4, stripsCount, stripOffsetsOffset);
+    writeEntry(277, 3, 1, 1);
+    writeEntry(278, 3, 1, RowsPerStrip);
+    writeEntry(279, 4, stripsCount, stripByteCountsOffset);
+    writeEntry(317, 3, 1, predictor);
+    writeEntry(339, 3, 1, 2);
+    stream << quint32(0);
+
+    quint32 stripOffset = 8;
+    for (const auto& strip : strips)
+    {
+        stream << stripOffset;
+        stripOffset += strip.size();
+    }
+    for (const auto& strip : strips)
+        stream << static_cast<quint32>(strip.size());
+
+    return tiff;
+}
+
+void TestHeightmapTileDecoder::verifyHeights(const QVector<float>& decoded, const QVector<qint16>& expected)
+{
+    QCOMPARE(decoded.size(), expected.size());
+    for (auto sampleIdx = 0; sampleIdx < expected.size(); sampleIdx++)
+        QCOMPARE(decoded[sampleIdx], static_cast<float>(expected[sampleIdx]));
+}
+
+void TestHeightmapTileDecoder::decodeRaw()
+{
+    const auto heights = makeHeights();
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream.setByteOrder(QDataStream::LittleEndian);
+    for (const auto height : heights)
+        stream << height;
+
+    QVector<float> decoded(TileSize * TileSize);
+    QVERIFY(HeightmapTileDecoder::decodeRaw(data, TileSize, decoded.data()));
+    verifyHeights(decoded, heights);
+
+    QVERIFY(!HeightmapTileDecoder::decodeRaw(data.left(data.size() - 2), TileSize, decoded.data()));
+}
+
+void TestHeightmapTileDecoder::decodeGeoTiff_data()
+{
+    QTest::addColumn<int>("compression");
+    QTest::addColumn<int>("predictor");
+    QTest::addColumn<QDataStream::ByteOrder>("byteOrder");
+
+    QTest::newRow("uncompressed") << 1 << 1 << QDataStream::LittleEndian;
+    QTest::newRow("uncompressed big-endian") << 1 << 1 << QDataStream::BigEndian;
+    QTest::newRow("lzw") << 5 << 1 << QDataStream::LittleEndian;
+    QTest::newRow("lzw with predictor") << 5 << 2 << QDataStream::LittleEndian;
+    QTest::newRow("deflate") << 8 << 1 << QDataStream::LittleEndian;
+    QTest::newRow("deflate with predictor") << 8 << 2 << QDataStream::BigEndian;
+}
+
+void TestHeightmapTileDecoder::decodeGeoTiff()
+{
+    QFETCH(int, compression);
+    QFETCH(int, predictor);
+    QFETCH(QDataStream::ByteOrder, byteOrder);
+
+    const auto heights = makeHeights();
+    const auto data = makeTiff(heights, compression, predictor, byteOrder);
+
+    QVector<float> decoded(TileSize * TileSize);
+    QVERIFY(HeightmapTileDecoder::decodeGeoTiff(data, TileSize, decoded.data()));
+    verifyHeights(decoded, heights);
+}
+
+void TestHeightmapTileDecoder::decodeGeoTiffRejectsOtherSize()
+{
+    const auto data = makeTiff(makeHeights(), 1, 1, QDataStream::LittleEndian);
+
+    QVector<float> decoded(2 * TileSize * 2 * TileSize);
+    QVERIFY(!HeightmapTileDecoder::decodeGeoTiff(data, 2 * TileSize, decoded.data()));
+    QVERIFY(!HeightmapTileDecoder::decodeGeoTiff(QByteArray("II*\0", 4), TileSize, decoded.data()));
+}
+
+void TestHeightmapTileDecoder::benchmarkDecodeGeoTiff()
+{
+    const auto data = makeTiff(makeHeights(), 8, 2, QDataStream::LittleEndian);
+
+    QVector<float> decoded(TileSize * TileSize);
+    QBENCHMARK
+    {
+        HeightmapTileDecoder::decodeGeoTiff(data, TileSize, decoded.data());
+    }
+}
+
+void TestHeightmapTileDecoder::benchmarkDecodeUsingGDAL()
+{
+    const auto heights = makeHeights();
+    const auto data = makeTiff(heights, 8, 2, QDataStream::LittleEndian);
+
+    QVector<float> decoded(TileSize * TileSize);
+    if (!HeightmapTileDecoder::decodeUsingGDAL(data, TileSize, decoded.data()))
+        QSKIP("GDAL drivers are not registered");
+    verifyHeights(decoded, heights);
+
+    QBENCHMARK
+    {
+        HeightmapTileDecoder::decodeUsingGDAL(data, TileSize, decoded.data());
+    }
+}
+
+QTEST_MAIN(TestHeightmapTileDecoder)
+#include "TestHeightmapTileDecoder.moc"
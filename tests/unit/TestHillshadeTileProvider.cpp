@@ -0,0 +1,450 @@
+#include <OsmAndCore/Map/HillshadeTileProvider.h>
+#include <OsmAndCore/Map/IMapElevationDataProvider.h>
+#include <OsmAndCore/Map/MapDataProviderHelpers.h>
+
+#include <QtTest/QtTest>
+#include <QCoreApplication>
+#include <QList>
+
+using namespace OsmAnd;
+
+namespace
+{
+    // Serves tiles of single zoom, where height of each sample is unique function of its global position
+    class FakeElevationDataProvider : public IMapElevationDataProvider
+    {
+    public:
+        FakeElevationDataProvider(const ZoomLevel zoom_, const uint32_t size_)
+            : zoom(zoom_)
+            , size(size_)
+        {
+        }
+
+        const ZoomLevel zoom;
+        const uint32_t size;
+        QList<TileId> missingTiles;
+
+        static float getHeight(const int globalX, const int globalY)
+        {
+            return static_cast<float>(globalX + globalY * 1000);
+        }
+
+        virtual unsigned int getTileSize() const
+        {
+            return size;
+        }
+
+        virtual bool supportsNaturalObtainData() const
+        {
+            return true;
+        }
+
+        virtual bool obtainData(
+            const IMapDataProvider::Request& request_,
+            std::shared_ptr<IMapDataProvider::Data>& outData,
+            std::shared_ptr<Metric>* const pOutMetric = nullptr)
+        {
+            const auto& request = MapDataProviderHelpers::castRequest<IMapTiledDataProvider::Request>(request_);
+            if (pOutMetric)
+                pOutMetric->reset();
+
+            if (request.zoom != zoom || missingTiles.contains(request.tileId))
+            {
+                outData.reset();
+                return true;
+            }
+
+            const auto pRawData = new float[size * size];
+            for (auto y = 0u; y < size; y++)
+            {
+                for (auto x = 0u; x < size; x++)
+                {
+                    pRawData[y * size + x] = getHeight(
+                        request.tileId.x * size + x,
+                        request.tileId.y * size + y);
+                }
+            }
+            outData.reset(new IMapElevationDataProvider::Data(
+                request.tileId,
+                request.zoom,
+                size * sizeof(float),
+                size,
+                pRawData));
+            return true;
+        }
+
+        virtual bool supportsNaturalObtainDataAsync() const
+        {
+            return false;
+        }
+
+        virtual void obtainDataAsync(
+            const IMapDataProvider::Request& request,
+            const IMapDataProvider::ObtainDataAsyncCallback callback,
+            const bool collectMetric = false)
+        {
+            MapDataProviderHelpers::nonNaturalObtainDataAsync(this, request, callback, collectMetric);
+        }
+
+        virtual ZoomLevel getMinZoom() const
+        {
+            return zoom;
+        }
+
+        virtual ZoomLevel getMaxZoom() const
+        {
+            return zoom;
+        }
+    };
+}
+
+class TestHillshadeTileProvider : public QObject
+{
+    Q_OBJECT
+
+private:
+    enum {
+        TileSize = 16,
+    };
+
+    // Elevation tiles are 4x4 at zoom 2, so that there are 4x4 tiles
+    enum {
+        ElevationTileSize = 4,
+        ElevationTilesCount = 4,
+    };
+
+    // Plane rising by given number of meters per cell to the east and to the north
+    static QVector<float> makePlane(const float eastRise, const float northRise);
+    static std::shared_ptr<HillshadeTileProvider> createProvider(
+        const std::shared_ptr<FakeElevationDataProvider>& elevationDataProvider);
+    static float getPaddedHeight(const QVector<float>& paddedHeights, const int x, const int y);
+private slots:
+    void computeShading_data();
+    void computeShading();
+    void benchmarkComputeShading();
+    void paddedHeightsAreStitchedWithNeighbours();
+    void paddedHeightsWrapAroundAntimeridian();
+    void paddedHeightsAreClampedAtPoles();
+    void paddedHeightsAreClampedAtMissingNeighbours();
+    void paddedHeightsOfMissingTile();
+    void resampleHeightsKeepsSameSize();
+    void resampleHeightsKeepsPlane_data();
+    void resampleHeightsKeepsPlane();
+};
+
+QVector<float> TestHillshadeTileProvider::makePlane(const float eastRise, const float northRise)
+{
+    const auto paddedSize = TileSize + 2;
+    QVector<float> heights(paddedSize * paddedSize);
+    for (auto y = 0; y < paddedSize; y++)
+    {
+        for (auto x = 0; x < paddedSize; x++)
+            heights[y * paddedSize + x] = 100.0f + x * eastRise + (paddedSize - 1 - y) * northRise;
+    }
+    return heights;
+}
+
+std::shared_ptr<HillshadeTileProvider> TestHillshadeTileProvider::createProvider(
+    const std::shared_ptr<FakeElevationDataProvider>& elevationDataProvider)
+{
+    return std::make_shared<HillshadeTileProvider>(
+        elevationDataProvider,
+        HillshadeTileProvider::Mode::Hillshade,
+        315.0f,
+        45.0f,
+        1.0f,
+        TileSize);
+}
+
+float TestHillshadeTileProvider::getPaddedHeight(const QVector<float>& paddedHeights, const int x, const int y)
+{
+    // Coordinates are relative to first sample of tile, so padding is at -1 and ElevationTileSize
+    return paddedHeights[(y + 1) * (ElevationTileSize + 2) + (x + 1)];
+}
+
+void TestHillshadeTileProvider::computeShading_data()
+{
+    QTest::addColumn<int>("mode");
+    QTest::addColumn<float>("sunAzimuth");
+    QTest::addColumn<float>("eastRise");
+    QTest::addColumn<float>("northRise");
+    QTest::addColumn<int>("expectedValue");
+
+    const auto hillshade = static_cast<int>(HillshadeTileProvider::Mode::Hillshade);
+    const auto slope = static_cast<int>(HillshadeTileProvider::Mode::Slope);
+    const auto aspect = static_cast<int>(HillshadeTileProvider::Mode::Aspect);
+
+    // Sun is 45 degrees above horizon, and cells are 10 meters wide
+    QTest::newRow("hillshade flat") << hillshade << 315.0f << 0.0f << 0.0f << 180;
+    QTest::newRow("hillshade facing sun") << hillshade << 270.0f << 10.0f << 0.0f << 255;
+    QTest::newRow("hillshade facing away from sun") << hillshade << 90.0f << 10.0f << 0.0f << 0;
+    QTest::newRow("slope flat") << slope << 315.0f << 0.0f << 0.0f << 0;
+    QTest::newRow("slope 45 degrees") << slope << 315.0f << 10.0f << 0.0f << 128;
+    QTest::newRow("aspect flat") << aspect << 315.0f << 0.0f << 0.0f << 0;
+    QTest::newRow("aspect west") << aspect << 315.0f << 10.0f << 0.0f << 191;
+    QTest::newRow("aspect south") << aspect << 315.0f << 0.0f << 10.0f << 128;
+}
+
+void TestHillshadeTileProvider::computeShading()
+{
+    QFETCH(int, mode);
+    QFETCH(float, sunAzimuth);
+    QFETCH(float, eastRise);
+    QFETCH(float, northRise);
+    QFETCH(int, expectedValue);
+
+    const auto heights = makePlane(eastRise, northRise);
+    QVector<uint8_t> values(TileSize * TileSize);
+    HillshadeTileProvider::computeShading(
+        heights.constData(),
+        TileSize,
+        10.0f,
+        static_cast<HillshadeTileProvider::Mode>(mode),
+        sunAzimuth,
+        45.0f,
+        1.0f,
+        values.data());
+
+    for (const auto value : values)
+        QCOMPARE(static_cast<int>(value), expectedValue);
+}
+
+void TestHillshadeTileProvider::benchmarkComputeShading()
+{
+    const auto size = 256;
+    QVector<float> heights((size + 2) * (size + 2));
+    for (auto sampleIdx = 0; sampleIdx < heights.size(); sampleIdx++)
+        heights[sampleIdx] = static_cast<float>((sampleIdx * 37) % 101);
+
+    QVector<uint8_t> values(size * size);
+    QBENCHMARK
+    {
+        HillshadeTileProvider::computeShading(
+            heights.constData(),
+            size,
+            10.0f,
+            HillshadeTileProvider::Mode::Hillshade,
+            315.0f,
+            45.0f,
+            1.0f,
+            values.data());
+    }
+}
+
+void TestHillshadeTileProvider::paddedHeightsAreStitchedWithNeighbours()
+{
+    const auto elevationDataProvider = std::make_shared<FakeElevationDataProvider>(
+        ZoomLevel2,
+        ElevationTileSize);
+    const auto provider = createProvider(elevationDataProvider);
+
+    QVector<float> paddedHeights;
+    uint32_t size = 0;
+    QVERIFY(provider->obtainPaddedElevationHeights(TileId::fromXY(1, 2), ZoomLevel2, paddedHeights, size));
+    QCOMPARE(size, static_cast<uint32_t>(ElevationTileSize));
+    QCOMPARE(paddedHeights.size(), (ElevationTileSize + 2) * (ElevationTileSize + 2));
+
+    for (auto y = -1; y <= ElevationTileSize; y++)
+    {
+        for (auto x = -1; x <= ElevationTileSize; x++)
+        {
+            QCOMPARE(
+                getPaddedHeight(paddedHeights, x, y),
+                FakeElevationDataProvider::getHeight(ElevationTileSize + x, 2 * ElevationTileSize + y));
+        }
+    }
+}
+
+void TestHillshadeTileProvider::paddedHeightsWrapAroundAntimeridian()
+{
+    const auto elevationDataProvider = std::make_shared<FakeElevationDataProvider>(
+        ZoomLevel2,
+        ElevationTileSize);
+    const auto provider = createProvider(elevationDataProvider);
+    const auto globalSize = ElevationTileSize * ElevationTilesCount;
+
+    // Westmost tile is padded by last column of eastmost tile, and vice versa
+    QVector<float> paddedHeights;
+    uint32_t size = 0;
+    QVERIFY(provider->obtainPaddedElevationHeights(TileId::fromXY(0, 1), ZoomLevel2, paddedHeights, size));
+    QCOMPARE(size, static_cast<uint32_t>(ElevationTileSize));
+    for (auto y = -1; y <= ElevationTileSize; y++)
+    {
+        const auto globalY = ElevationTileSize + y;
+        QCOMPARE(
+            getPaddedHeight(paddedHeights, -1, y),
+            FakeElevationDataProvider::getHeight(globalSize - 1, globalY));
+        QCOMPARE(
+            getPaddedHeight(paddedHeights, ElevationTileSize, y),
+            FakeElevationDataProvider::getHeight(ElevationTileSize, globalY));
+    }
+
+    QVERIFY(provider->obtainPaddedElevationHeights(
+        TileId::fromXY(ElevationTilesCount - 1, 1),
+        ZoomLevel2,
+        paddedHeights,
+        size));
+    QCOMPARE(size, static_cast<uint32_t>(ElevationTileSize));
+    for (auto y = -1; y <= ElevationTileSize; y++)
+    {
+        const auto globalY = ElevationTileSize + y;
+        QCOMPARE(
+            getPaddedHeight(paddedHeights, -1, y),
+            FakeElevationDataProvider::getHeight(globalSize - ElevationTileSize - 1, globalY));
+        QCOMPARE(
+            getPaddedHeight(paddedHeights, ElevationTileSize, y),
+            FakeElevationDataProvider::getHeight(0, globalY));
+    }
+}
+
+void TestHillshadeTileProvider::paddedHeightsAreClampedAtPoles()
+{
+    const auto elevationDataProvider = std::make_shared<FakeElevationDataProvider>(
+        ZoomLevel2,
+        ElevationTileSize);
+    const auto provider = createProvider(elevationDataProvider);
+
+    // Tiles are not wrapped across poles, so nearest samples of requested tile are repeated, including
+    // corners that are next to samples of west and east neighbours
+    QVector<float> paddedHeights;
+    uint32_t size = 0;
+    QVERIFY(provider->obtainPaddedElevationHeights(TileId::fromXY(1, 0), ZoomLevel2, paddedHeights, size));
+    QCOMPARE(size, static_cast<uint32_t>(ElevationTileSize));
+    for (auto x = 0; x < ElevationTileSize; x++)
+        QCOMPARE(getPaddedHeight(paddedHeights, x, -1), getPaddedHeight(paddedHeights, x, 0));
+    QCOMPARE(getPaddedHeight(paddedHeights, -1, -1), getPaddedHeight(paddedHeights, 0, 0));
+    QCOMPARE(
+        getPaddedHeight(paddedHeights, ElevationTileSize, -1),
+        getPaddedHeight(paddedHeights, ElevationTileSize - 1, 0));
+
+    QVERIFY(provider->obtainPaddedElevationHeights(
+        TileId::fromXY(1, ElevationTilesCount - 1),
+        ZoomLevel2,
+        paddedHeights,
+        size));
+    QCOMPARE(size, static_cast<uint32_t>(ElevationTileSize));
+    for (auto x = 0; x < ElevationTileSize; x++)
+    {
+        QCOMPARE(
+            getPaddedHeight(paddedHeights, x, ElevationTileSize),
+            getPaddedHeight(paddedHeights, x, ElevationTileSize - 1));
+    }
+    QCOMPARE(
+        getPaddedHeight(paddedHeights, -1, ElevationTileSize),
+        getPaddedHeight(paddedHeights, 0, ElevationTileSize - 1));
+}
+
+void TestHillshadeTileProvider::paddedHeightsAreClampedAtMissingNeighbours()
+{
+    const auto elevationDataProvider = std::make_shared<FakeElevationDataProvider>(
+        ZoomLevel2,
+        ElevationTileSize);
+    elevationDataProvider->missingTiles.push_back(TileId::fromXY(2, 1));
+    elevationDataProvider->missingTiles.push_back(TileId::fromXY(2, 2));
+    const auto provider = createProvider(elevationDataProvider);
+
+    QVector<float> paddedHeights;
+    uint32_t size = 0;
+    QVERIFY(provider->obtainPaddedElevationHeights(TileId::fromXY(1, 1), ZoomLevel2, paddedHeights, size));
+    QCOMPARE(size, static_cast<uint32_t>(ElevationTileSize));
+
+    // East neighbour and south-east one are missing, while north-east one is present
+    QCOMPARE(
+        getPaddedHeight(paddedHeights, ElevationTileSize, -1),
+        FakeElevationDataProvider::getHeight(2 * ElevationTileSize, ElevationTileSize - 1));
+    for (auto y = 0; y < ElevationTileSize; y++)
+    {
+        QCOMPARE(
+            getPaddedHeight(paddedHeights, ElevationTileSize, y),
+            getPaddedHeight(paddedHeights, ElevationTileSize - 1, y));
+    }
+    QCOMPARE(
+        getPaddedHeight(paddedHeights, ElevationTileSize, ElevationTileSize),
+        getPaddedHeight(paddedHeights, ElevationTileSize - 1, ElevationTileSize - 1));
+    QCOMPARE(
+        getPaddedHeight(paddedHeights, -1, ElevationTileSize),
+        FakeElevationDataProvider::getHeight(ElevationTileSize - 1, 2 * ElevationTileSize));
+}
+
+void TestHillshadeTileProvider::paddedHeightsOfMissingTile()
+{
+    const auto elevationDataProvider = std::make_shared<FakeElevationDataProvider>(
+        ZoomLevel2,
+        ElevationTileSize);
+    elevationDataProvider->missingTiles.push_back(TileId::fromXY(1, 1));
+    const auto provider = createProvider(elevationDataProvider);
+
+    QVector<float> paddedHeights;
+    uint32_t size = 1;
+    QVERIFY(provider->obtainPaddedElevationHeights(TileId::fromXY(1, 1), ZoomLevel2, paddedHeights, size));
+    QCOMPARE(size, 0u);
+
+    std::shared_ptr<IMapDataProvider::Data> data;
+    HillshadeTileProvider::Request request;
+    request.tileId = TileId::fromXY(1, 1);
+    request.zoom = ZoomLevel2;
+    QVERIFY(provider->obtainData(request, data));
+    QVERIFY(!data);
+}
+
+void TestHillshadeTileProvider::resampleHeightsKeepsSameSize()
+{
+    const auto paddedSize = TileSize + 2;
+    QVector<float> heights(paddedSize * paddedSize);
+    for (auto sampleIdx = 0; sampleIdx < heights.size(); sampleIdx++)
+        heights[sampleIdx] = static_cast<float>((sampleIdx * 37) % 101);
+
+    QVector<float> resampledHeights(paddedSize * paddedSize);
+    HillshadeTileProvider::resampleHeights(heights.constData(), TileSize, TileSize, resampledHeights.data());
+    QCOMPARE(resampledHeights, heights);
+}
+
+void TestHillshadeTileProvider::resampleHeightsKeepsPlane_data()
+{
+    QTest::addColumn<int>("resampledSize");
+
+    QTest::newRow("upsampled 4 times") << TileSize * 4;
+    QTest::newRow("upsampled 3 times") << TileSize * 3;
+    QTest::newRow("downsampled 2 times") << TileSize / 2;
+    QTest::newRow("downsampled to odd size") << TileSize / 2 - 1;
+}
+
+void TestHillshadeTileProvider::resampleHeightsKeepsPlane()
+{
+    QFETCH(int, resampledSize);
+
+    // Bilinear resampling reproduces plane at every sample that lies between padded input samples,
+    // which includes all interior samples, so that edges of output tiles follow neighbour tiles
+    const auto eastRise = 3.0f;
+    const auto northRise = 7.0f;
+    const auto paddedSize = TileSize + 2;
+    const auto heights = makePlane(eastRise, northRise);
+    const auto resampledPaddedSize = resampledSize + 2;
+    QVector<float> resampledHeights(resampledPaddedSize * resampledPaddedSize);
+    HillshadeTileProvider::resampleHeights(
+        heights.constData(),
+        TileSize,
+        resampledSize,
+        resampledHeights.data());
+
+    const auto scale = static_cast<float>(TileSize) / resampledSize;
+    for (auto y = 0; y < resampledPaddedSize; y++)
+    {
+        const auto sourceY = (y - 0.5f) * scale + 0.5f;
+        if (sourceY < 0.0f || sourceY > paddedSize - 1)
+            continue;
+
+        for (auto x = 0; x < resampledPaddedSize; x++)
+        {
+            const auto sourceX = (x - 0.5f) * scale + 0.5f;
+            if (sourceX < 0.0f || sourceX > paddedSize - 1)
+                continue;
+
+            const auto expectedHeight = 100.0f + sourceX * eastRise + (paddedSize - 1 - sourceY) * northRise;
+            QVERIFY(qAbs(resampledHeights[y * resampledPaddedSize + x] - expectedHeight) < 1.0e-3f);
+        }
+    }
+}
+
+QTEST_MAIN(TestHillshadeTileProvider)
+#include "TestHillshadeTileProvider.moc"
@@ -0,0 +1,108 @@
+#include <OsmAndCore/Map/UnresolvedMapStyle.h>
+#include <OsmAndCore/Map/ResolvedMapStyle.h>
+#include <OsmAndCore/Map/MapStyleEvaluator.h>
+#include <OsmAndCore/Map/MapStyleEvaluationResult.h>
+#include <OsmAndCore/Map/MapStyleBuiltinValueDefinitions.h>
+
+#include <QtTest/QtTest>
+#include <QCoreApplication>
+#include <QBuffer>
+
+using namespace OsmAnd;
+
+namespace
+{
+    enum {
+        AttributesCount = 8,
+        BaseValue = 7,
+    };
+
+    // Every attribute references previous one, so whichever order attributes are compiled in,
+    // some of them reference an attribute that was not compiled yet
+    QByteArray makeStyle()
+    {
+        QByteArray xml;
+        xml += "<renderingStyle name=\"test\">\n";
+        xml += "<renderingAttribute name=\"attr_0\"><case attrIntValue=\"" + QByteArray::number(BaseValue) + "\"/></renderingAttribute>\n";
+        for (int idx = 1; idx < AttributesCount; idx++)
+        {
+            xml += "<renderingAttribute name=\"attr_" + QByteArray::number(idx) + "\">";
+            xml += "<case attrIntValue=\"$attr_" + QByteArray::number(idx - 1) + "\"/>";
+            xml += "</renderingAttribute>\n";
+        }
+        xml += "<order>\n";
+        xml += "<case tag=\"highway\" value=\"primary\" minzoom=\"$attr_3\" order=\"$attr_"
+            + QByteArray::number(AttributesCount - 1) + "\"/>\n";
+        xml += "</order>\n";
+        xml += "</renderingStyle>\n";
+        return xml;
+    }
+
+    std::shared_ptr<const ResolvedMapStyle> resolveStyle()
+    {
+        const std::shared_ptr<QBuffer> source(new QBuffer());
+        source->setData(makeStyle());
+        const std::shared_ptr<UnresolvedMapStyle> unresolvedStyle(new UnresolvedMapStyle(source, QLatin1String("test")));
+        if (!unresolvedStyle->load())
+            return nullptr;
+
+        QList< std::shared_ptr<const UnresolvedMapStyle> > chain;
+        chain.push_back(unresolvedStyle);
+        return ResolvedMapStyle::resolveMapStylesChain(chain);
+    }
+}
+
+class TestMapStyleCompiledRules : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void attributeReferencingAttribute();
+    void ruleReferencingAttribute();
+};
+
+void TestMapStyleCompiledRules::attributeReferencingAttribute()
+{
+    const auto style = resolveStyle();
+    QVERIFY(style);
+
+    const auto builtinValueDefs = MapStyleBuiltinValueDefinitions::get();
+    MapStyleEvaluator evaluator(style, 1.0f);
+    for (int idx = 0; idx < AttributesCount; idx++)
+    {
+        const auto attribute = style->getAttribute(QLatin1String("attr_") + QString::number(idx));
+        QVERIFY(attribute);
+
+        MapStyleEvaluationResult result(style->getValueDefinitionsCount());
+        QVERIFY(evaluator.evaluate(attribute, &result));
+
+        int value = 0;
+        QVERIFY(result.getIntegerValue(builtinValueDefs->id_OUTPUT_ATTR_INT_VALUE, value));
+        QCOMPARE(value, static_cast<int>(BaseValue));
+    }
+}
+
+void TestMapStyleCompiledRules::ruleReferencingAttribute()
+{
+    const auto style = resolveStyle();
+    QVERIFY(style);
+
+    const auto builtinValueDefs = MapStyleBuiltinValueDefinitions::get();
+    MapStyleEvaluator evaluator(style, 1.0f);
+    evaluator.setStringValue(builtinValueDefs->id_INPUT_TAG, QLatin1String("highway"));
+    evaluator.setStringValue(builtinValueDefs->id_INPUT_VALUE, QLatin1String("primary"));
+
+    evaluator.setIntegerValue(builtinValueDefs->id_INPUT_MINZOOM, BaseValue + 1);
+    MapStyleEvaluationResult result(style->getValueDefinitionsCount());
+    QVERIFY(evaluator.evaluate(std::shared_ptr<const MapObject>(), MapStyleRulesetType::Order, &result));
+    int order = 0;
+    QVERIFY(result.getIntegerValue(builtinValueDefs->id_OUTPUT_ORDER, order));
+    QCOMPARE(order, static_cast<int>(BaseValue));
+
+    // Condition value is taken from attribute as well
+    evaluator.setIntegerValue(builtinValueDefs->id_INPUT_MINZOOM, BaseValue - 1);
+    QVERIFY(!evaluator.evaluate(std::shared_ptr<const MapObject>(), MapStyleRulesetType::Order));
+}
+
+QTEST_MAIN(TestMapStyleCompiledRules)
+#include "TestMapStyleCompiledRules.moc"
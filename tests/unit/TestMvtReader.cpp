@@ -0,0 +1,690 @@
+#include <OsmAndCore/CommonTypes.h>
+#include <OsmAndCore/MvtReader.h>
+
+#include <cstring>
+
+#include <QtTest/QtTest>
+#include <QCoreApplication>
+#include <QTemporaryFile>
+
+using namespace OsmAnd;
+
+namespace
+{
+    // Geometry as reported by MvtReader, with user and sequence keys resolved to strings. Lines that were
+    // read as MULTI_LINE_STRING are kept as LINE_STRING with several parts.
+    struct Record
+    {
+        QString layerName;
+        int type;
+        QVector< QVector<PointI> > parts;
+        QHash<int, QVariant> userData;
+
+        bool operator==(const Record& that) const
+        {
+            return
+                layerName == that.layerName &&
+                type == that.type &&
+                parts == that.parts &&
+                userData == that.userData;
+        }
+    };
+
+    // Tile that is encoded by test itself, field numbers and values follow vector_tile.proto
+    enum {
+        GeomUnknown = 0,
+        GeomPoint = 1,
+        GeomLineString = 2,
+        GeomPolygon = 3,
+    };
+
+    enum {
+        StringValue = 1,
+        FloatValue = 2,
+        DoubleValue = 3,
+        IntValue = 4,
+        UintValue = 5,
+        SintValue = 6,
+        BoolValue = 7,
+    };
+
+    struct ValueModel
+    {
+        int field;
+        // Holds type MvtReader is expected to report value with
+        QVariant value;
+    };
+
+    struct FeatureModel
+    {
+        FeatureModel()
+            : type(GeomUnknown)
+        {
+        }
+
+        int type;
+        QVector<uint32_t> tags;
+        QVector<uint32_t> geometry;
+    };
+
+    struct LayerModel
+    {
+        LayerModel()
+            : extent(0)
+        {
+        }
+
+        QString name;
+        QStringList keys;
+        QList<ValueModel> values;
+        QList<FeatureModel> features;
+        int extent;
+    };
+
+    typedef QList<LayerModel> TileModel;
+}
+
+class TestMvtReader : public QObject
+{
+    Q_OBJECT
+
+private:
+    static uint32_t encodeCommand(const int command, const int count);
+    static uint32_t encodeZigZag(const int value);
+    static void addPoint(FeatureModel& feature, const PointI& point);
+    static void addLines(FeatureModel& feature, const QVector< QVector<PointI> >& lines);
+    static ValueModel makeValue(const int field, const QVariant& value);
+    static TileModel buildTile();
+
+    static void writeVarint(QByteArray& output, const quint64 value);
+    static void writeKey(QByteArray& output, const int field, const int wireType);
+    static void writeFixed(QByteArray& output, const quint64 bits, const int size);
+    static void writeBytes(QByteArray& output, const int field, const QByteArray& bytes);
+    static void writePacked(QByteArray& output, const int field, const QVector<uint32_t>& values);
+    static QByteArray encodeValue(const ValueModel& value);
+    static QByteArray encodeFeature(const FeatureModel& feature);
+    static QByteArray encodeLayer(const LayerModel& layer);
+    static QByteArray serialize(const TileModel& tile);
+
+    static MvtReader::Filter makeFilter(const QStringList& layerNames, const QList<int>& geometryTypes);
+    static Record makeRecord(
+        const std::shared_ptr<const MvtReader::Tile>& tile,
+        const QString& layerName,
+        const std::shared_ptr<const MvtReader::Geometry>& geometry);
+    static bool readRecords(
+        const MvtReader& reader,
+        const QByteArray& data,
+        const MvtReader::Filter& filter,
+        QList<Record>& outRecords);
+    static QList<Record> parseRecords(const std::shared_ptr<const MvtReader::Tile>& tile);
+
+    // Decodes tile model the way MvtReader is expected to decode its encoded form
+    static QVector< QVector<PointI> > decodeGeometry(const FeatureModel& feature);
+    static QList<Record> decodeReference(const TileModel& tile, const MvtReader::Filter& filter);
+    static QList<Record> withoutLayerNames(const QList<Record>& records);
+private slots:
+    void readTileData_data();
+    void readTileData();
+    void parseTileData_data();
+    void parseTileData();
+    void parseTile();
+    void visitorStopsReading();
+    void truncatedTile_data();
+    void truncatedTile();
+};
+
+uint32_t TestMvtReader::encodeCommand(const int command, const int count)
+{
+    return static_cast<uint32_t>((count << 3) | command);
+}
+
+uint32_t TestMvtReader::encodeZigZag(const int value)
+{
+    return static_cast<uint32_t>((value << 1) ^ (value >> 31));
+}
+
+void TestMvtReader::addPoint(FeatureModel& feature, const PointI& point)
+{
+    feature.type = GeomPoint;
+    feature.geometry.push_back(encodeCommand(1, 1));
+    feature.geometry.push_back(encodeZigZag(point.x));
+    feature.geometry.push_back(encodeZigZag(point.y));
+}
+
+void TestMvtReader::addLines(FeatureModel& feature, const QVector< QVector<PointI> >& lines)
+{
+    // Coordinates are relative to previous point, including first point of each next line
+    feature.type = GeomLineString;
+    PointI cursor(0, 0);
+    for (const auto& line : lines)
+    {
+        for (auto pointIdx = 0; pointIdx < line.size(); pointIdx++)
+        {
+            if (pointIdx == 0)
+                feature.geometry.push_back(encodeCommand(1, 1));
+            else if (pointIdx == 1)
+                feature.geometry.push_back(encodeCommand(2, line.size() - 1));
+            feature.geometry.push_back(encodeZigZag(line[pointIdx].x - cursor.x));
+            feature.geometry.push_back(encodeZigZag(line[pointIdx].y - cursor.y));
+            cursor = line[pointIdx];
+        }
+    }
+}
+
+ValueModel TestMvtReader::makeValue(const int field, const QVariant& value)
+{
+    ValueModel valueModel;
+    valueModel.field = field;
+    valueModel.value = value;
+    return valueModel;
+}
+
+TileModel TestMvtReader::buildTile()
+{
+    TileModel tile;
+
+    // Values of every type are referenced by known keys, while unknown key and out of range indices are ignored
+    LayerModel images;
+    images.name = QLatin1String("mapillary-images");
+    images.extent = 4096;
+    images.keys << "ca" << "captured_at" << "key" << "pano" << "userkey" << "unknown";
+    images.values
+        << makeValue(DoubleValue, QVariant(123.5))
+        << makeValue(UintValue, QVariant(static_cast<qulonglong>(1500000000000ull)))
+        << makeValue(StringValue, QVariant(QLatin1String("image-a")))
+        << makeValue(IntValue, QVariant(static_cast<qlonglong>(1)))
+        << makeValue(BoolValue, QVariant(true))
+        << makeValue(StringValue, QVariant(QLatin1String("user-a")))
+        << makeValue(FloatValue, QVariant(2.5f))
+        << makeValue(SintValue, QVariant(static_cast<qlonglong>(-7)))
+        << makeValue(StringValue, QVariant(QLatin1String("image-b")))
+        << makeValue(StringValue, QVariant(QLatin1String("user-b")));
+
+    FeatureModel feature;
+    feature.tags << 0 << 0 << 1 << 1 << 2 << 2 << 3 << 4 << 4 << 5 << 5 << 2;
+    addPoint(feature, PointI(100, 200));
+    images.features.push_back(feature);
+    feature = FeatureModel();
+    feature.tags << 0 << 6 << 2 << 8 << 4 << 9 << 3 << 3 << 1 << 100;
+    addPoint(feature, PointI(-50, 4000));
+    images.features.push_back(feature);
+    feature = FeatureModel();
+    feature.tags << 0 << 7 << 4 << 5;
+    addPoint(feature, PointI(4096, 0));
+    images.features.push_back(feature);
+    feature = FeatureModel();
+    addLines(feature, { { PointI(0, 0), PointI(10, 0), PointI(10, 10), PointI(0, 0) } });
+    feature.type = GeomPolygon;
+    images.features.push_back(feature);
+    feature = FeatureModel();
+    addPoint(feature, PointI(1, 1));
+    feature.type = GeomUnknown;
+    images.features.push_back(feature);
+    tile.push_back(images);
+
+    LayerModel sequences;
+    sequences.name = QLatin1String("mapillary-sequences");
+    sequences.extent = 4096;
+    sequences.keys << "skey" << "userkey" << "captured_at";
+    sequences.values
+        << makeValue(StringValue, QVariant(QLatin1String("sequence-a")))
+        << makeValue(StringValue, QVariant(QLatin1String("user-a")))
+        << makeValue(UintValue, QVariant(static_cast<qulonglong>(42)))
+        << makeValue(StringValue, QVariant(QLatin1String("sequence-b")));
+
+    feature = FeatureModel();
+    feature.tags << 0 << 0 << 1 << 1 << 2 << 2;
+    addLines(feature, { { PointI(0, 0), PointI(10, 10), PointI(20, 5) } });
+    sequences.features.push_back(feature);
+    feature = FeatureModel();
+    feature.tags << 0 << 3 << 1 << 1;
+    addLines(feature, {
+        { PointI(5, 5), PointI(6, 7) },
+        { PointI(100, 100), PointI(90, 80), PointI(70, 70) } });
+    sequences.features.push_back(feature);
+    feature = FeatureModel();
+    feature.tags << 0 << 0;
+    addPoint(feature, PointI(300, 300));
+    sequences.features.push_back(feature);
+    tile.push_back(sequences);
+
+    LayerModel overview;
+    overview.name = QLatin1String("overview");
+    overview.keys << "key";
+    overview.values << makeValue(StringValue, QVariant(QLatin1String("overview-a")));
+
+    feature = FeatureModel();
+    feature.tags << 0 << 0;
+    addPoint(feature, PointI(1, 1));
+    overview.features.push_back(feature);
+    feature = FeatureModel();
+    addLines(feature, { { PointI(1, 1), PointI(2, 2) } });
+    overview.features.push_back(feature);
+    tile.push_back(overview);
+
+    return tile;
+}
+
+void TestMvtReader::writeVarint(QByteArray& output, const quint64 value)
+{
+    auto remainder = value;
+    while (remainder >= 0x80)
+    {
+        output.append(static_cast<char>((remainder & 0x7F) | 0x80));
+        remainder >>= 7;
+    }
+    output.append(static_cast<char>(remainder));
+}
+
+void TestMvtReader::writeKey(QByteArray& output, const int field, const int wireType)
+{
+    writeVarint(output, static_cast<quint64>((field << 3) | wireType));
+}
+
+void TestMvtReader::writeFixed(QByteArray& output, const quint64 bits, const int size)
+{
+    // Fixed-size values are little-endian
+    for (auto byteIdx = 0; byteIdx < size; byteIdx++)
+        output.append(static_cast<char>((bits >> (byteIdx * 8)) & 0xFF));
+}
+
+void TestMvtReader::writeBytes(QByteArray& output, const int field, const QByteArray& bytes)
+{
+    writeKey(output, field, 2);
+    writeVarint(output, static_cast<quint64>(bytes.size()));
+    output.append(bytes);
+}
+
+void TestMvtReader::writePacked(QByteArray& output, const int field, const QVector<uint32_t>& values)
+{
+    if (values.isEmpty())
+        return;
+
+    QByteArray packed;
+    for (const auto value : values)
+        writeVarint(packed, value);
+    writeBytes(output, field, packed);
+}
+
+QByteArray TestMvtReader::encodeValue(const ValueModel& value)
+{
+    QByteArray output;
+    switch (value.field)
+    {
+        case StringValue:
+            writeBytes(output, value.field, value.value.toString().toUtf8());
+            break;
+        case FloatValue:
+        {
+            const auto floatValue = value.value.toFloat();
+            quint32 bits;
+            memcpy(&bits, &floatValue, sizeof(bits));
+            writeKey(output, value.field, 5);
+            writeFixed(output, bits, sizeof(bits));
+            break;
+        }
+        case DoubleValue:
+        {
+            const auto doubleValue = value.value.toDouble();
+            quint64 bits;
+            memcpy(&bits, &doubleValue, sizeof(bits));
+            writeKey(output, value.field, 1);
+            writeFixed(output, bits, sizeof(bits));
+            break;
+        }
+        case IntValue:
+            writeKey(output, value.field, 0);
+            writeVarint(output, static_cast<quint64>(value.value.toLongLong()));
+            break;
+        case UintValue:
+            writeKey(output, value.field, 0);
+            writeVarint(output, value.value.toULongLong());
+            break;
+        case SintValue:
+        {
+            const auto sintValue = value.value.toLongLong();
+            writeKey(output, value.field, 0);
+            writeVarint(output, (static_cast<quint64>(sintValue) << 1) ^ static_cast<quint64>(sintValue >> 63));
+            break;
+        }
+        case BoolValue:
+            writeKey(output, value.field, 0);
+            writeVarint(output, value.value.toBool() ? 1 : 0);
+            break;
+    }
+    return output;
+}
+
+QByteArray TestMvtReader::encodeFeature(const FeatureModel& feature)
+{
+    QByteArray output;
+    writePacked(output, 2, feature.tags);
+    writeKey(output, 3, 0);
+    writeVarint(output, static_cast<quint64>(feature.type));
+    writePacked(output, 4, feature.geometry);
+    return output;
+}
+
+QByteArray TestMvtReader::encodeLayer(const LayerModel& layer)
+{
+    // Fields are written in order of their numbers, as generated serializer does
+    QByteArray output;
+    writeBytes(output, 1, layer.name.toUtf8());
+    for (const auto& feature : layer.features)
+        writeBytes(output, 2, encodeFeature(feature));
+    for (const auto& key : layer.keys)
+        writeBytes(output, 3, key.toUtf8());
+    for (const auto& value : layer.values)
+        writeBytes(output, 4, encodeValue(value));
+    if (layer.extent != 0)
+    {
+        writeKey(output, 5, 0);
+        writeVarint(output, static_cast<quint64>(layer.extent));
+    }
+    writeKey(output, 15, 0);
+    writeVarint(output, 2);
+    return output;
+}
+
+QByteArray TestMvtReader::serialize(const TileModel& tile)
+{
+    QByteArray output;
+    for (const auto& layer : tile)
+        writeBytes(output, 3, encodeLayer(layer));
+    return output;
+}
+
+MvtReader::Filter TestMvtReader::makeFilter(const QStringList& layerNames, const QList<int>& geometryTypes)
+{
+    MvtReader::Filter filter;
+    for (const auto& layerName : layerNames)
+        filter.layerNames.insert(layerName);
+    for (const auto geometryType : geometryTypes)
+        filter.geometryTypes.insert(static_cast<MvtReader::GeomType>(geometryType));
+    return filter;
+}
+
+Record TestMvtReader::makeRecord(
+    const std::shared_ptr<const MvtReader::Tile>& tile,
+    const QString& layerName,
+    const std::shared_ptr<const MvtReader::Geometry>& geometry)
+{
+    Record record;
+    record.layerName = layerName;
+    record.type = MvtReader::UNKNOWN;
+    switch (geometry->getType())
+    {
+        case MvtReader::POINT:
+            record.type = MvtReader::POINT;
+            record.parts.push_back(QVector<PointI>()
+                << std::dynamic_pointer_cast<const MvtReader::Point>(geometry)->getCoordinate());
+            break;
+        case MvtReader::LINE_STRING:
+            record.type = MvtReader::LINE_STRING;
+            record.parts.push_back(
+                std::dynamic_pointer_cast<const MvtReader::LineString>(geometry)->getCoordinateSequence());
+            break;
+        case MvtReader::MULTI_LINE_STRING:
+            record.type = MvtReader::LINE_STRING;
+            for (const auto& line : std::dynamic_pointer_cast<const MvtReader::MultiLineString>(geometry)->getLines())
+                record.parts.push_back(line->getCoordinateSequence());
+            break;
+        default:
+            break;
+    }
+
+    const auto userData = geometry->getUserData();
+    for (auto itUserData = userData.cbegin(); itUserData != userData.cend(); ++itUserData)
+    {
+        if (itUserData.key() == USERKEY_ID)
+            record.userData.insert(itUserData.key(), tile->getUserKey(itUserData.value().toUInt()));
+        else if (itUserData.key() == SKEY_ID)
+            record.userData.insert(itUserData.key(), tile->getSequenceKey(itUserData.value().toUInt()));
+        else
+            record.userData.insert(itUserData.key(), itUserData.value());
+    }
+    return record;
+}
+
+bool TestMvtReader::readRecords(
+    const MvtReader& reader,
+    const QByteArray& data,
+    const MvtReader::Filter& filter,
+    QList<Record>& outRecords)
+{
+    return reader.readTileData(data,
+        [&outRecords]
+        (const std::shared_ptr<const MvtReader::Tile>& tile,
+            const QString& layerName,
+            const std::shared_ptr<const MvtReader::Geometry>& geometry) -> bool
+        {
+            outRecords.push_back(makeRecord(tile, layerName, geometry));
+            return true;
+        },
+        filter);
+}
+
+QList<Record> TestMvtReader::parseRecords(const std::shared_ptr<const MvtReader::Tile>& tile)
+{
+    QList<Record> records;
+    for (const auto& geometry : tile->getGeometry())
+        records.push_back(makeRecord(tile, QString(), geometry));
+    return records;
+}
+
+QVector< QVector<PointI> > TestMvtReader::decodeGeometry(const FeatureModel& feature)
+{
+    const auto decodeZigZag =
+        []
+        (const uint32_t value) -> int
+        {
+            return static_cast<int>(value >> 1) ^ -static_cast<int>(value & 1);
+        };
+
+    QVector< QVector<PointI> > parts;
+    PointI cursor(0, 0);
+    auto idx = 0;
+    while (idx < feature.geometry.size())
+    {
+        const auto command = feature.geometry[idx] & 0x7;
+        const auto count = static_cast<int>(feature.geometry[idx] >> 3);
+        idx++;
+        if (command == 1)
+            parts.push_back(QVector<PointI>());
+        for (auto pointIdx = 0; pointIdx < count; pointIdx++)
+        {
+            cursor.x += decodeZigZag(feature.geometry[idx++]);
+            cursor.y += decodeZigZag(feature.geometry[idx++]);
+            parts.last().push_back(cursor);
+        }
+    }
+    return parts;
+}
+
+QList<Record> TestMvtReader::decodeReference(const TileModel& tile, const MvtReader::Filter& filter)
+{
+    QList<Record> records;
+    for (const auto& layer : tile)
+    {
+        if (!filter.layerNames.isEmpty() && !filter.layerNames.contains(layer.name))
+            continue;
+
+        for (const auto& feature : layer.features)
+        {
+            Record record;
+            record.layerName = layer.name;
+            if (feature.type == GeomPoint)
+                record.type = MvtReader::POINT;
+            else if (feature.type == GeomLineString)
+                record.type = MvtReader::LINE_STRING;
+            else
+                continue;
+            if (!filter.geometryTypes.isEmpty() &&
+                !filter.geometryTypes.contains(static_cast<MvtReader::GeomType>(record.type)))
+            {
+                continue;
+            }
+            record.parts = decodeGeometry(feature);
+
+            for (auto tagIdx = 0; tagIdx + 1 < feature.tags.size(); tagIdx += 2)
+            {
+                const auto keyIdx = static_cast<int>(feature.tags[tagIdx]);
+                const auto valueIdx = static_cast<int>(feature.tags[tagIdx + 1]);
+                if (keyIdx >= layer.keys.size() || valueIdx >= layer.values.size())
+                    continue;
+
+                const auto userDataId = MvtReader::getUserDataId(layer.keys[keyIdx].toStdString());
+                if (userDataId != UNKNOWN_ID)
+                    record.userData.insert(userDataId, layer.values[valueIdx].value);
+            }
+            records.push_back(record);
+        }
+    }
+    return records;
+}
+
+QList<Record> TestMvtReader::withoutLayerNames(const QList<Record>& records)
+{
+    auto result = records;
+    for (auto& record : result)
+        record.layerName.clear();
+    return result;
+}
+
+void TestMvtReader::readTileData_data()
+{
+    QTest::addColumn<QStringList>("layerNames");
+    QTest::addColumn< QList<int> >("geometryTypes");
+
+    QTest::newRow("all") << QStringList() << QList<int>();
+    QTest::newRow("one layer") << (QStringList() << "mapillary-images") << QList<int>();
+    QTest::newRow("two layers") << (QStringList() << "mapillary-sequences" << "overview") << QList<int>();
+    QTest::newRow("missing layer") << (QStringList() << "missing") << QList<int>();
+    QTest::newRow("points") << QStringList() << (QList<int>() << MvtReader::POINT);
+    QTest::newRow("lines") << QStringList() << (QList<int>() << MvtReader::LINE_STRING);
+    QTest::newRow("polygons") << QStringList() << (QList<int>() << MvtReader::POLYGON);
+    QTest::newRow("points of layers")
+        << (QStringList() << "mapillary-sequences" << "overview")
+        << (QList<int>() << MvtReader::POINT);
+}
+
+void TestMvtReader::readTileData()
+{
+    QFETCH(QStringList, layerNames);
+    QFETCH(QList<int>, geometryTypes);
+    const auto filter = makeFilter(layerNames, geometryTypes);
+
+    const auto tile = buildTile();
+    const auto data = serialize(tile);
+
+    MvtReader reader;
+    QList<Record> records;
+    QVERIFY(readRecords(reader, data, filter, records));
+    QCOMPARE(records, decodeReference(tile, filter));
+}
+
+void TestMvtReader::parseTileData_data()
+{
+    readTileData_data();
+}
+
+void TestMvtReader::parseTileData()
+{
+    QFETCH(QStringList, layerNames);
+    QFETCH(QList<int>, geometryTypes);
+    const auto filter = makeFilter(layerNames, geometryTypes);
+
+    const auto tile = buildTile();
+    const auto data = serialize(tile);
+
+    MvtReader reader;
+    const auto parsedTile = reader.parseTileData(data, filter);
+    QVERIFY(parsedTile);
+    QCOMPARE(parseRecords(parsedTile), withoutLayerNames(decodeReference(tile, filter)));
+}
+
+void TestMvtReader::parseTile()
+{
+    const auto tile = buildTile();
+    const auto data = serialize(tile);
+
+    QTemporaryFile file;
+    QVERIFY(file.open());
+    QCOMPARE(file.write(data), static_cast<qint64>(data.size()));
+    file.close();
+
+    MvtReader reader;
+    const auto parsedTile = reader.parseTile(file.fileName());
+    QVERIFY(parsedTile);
+    QCOMPARE(parseRecords(parsedTile), withoutLayerNames(decodeReference(tile, MvtReader::Filter())));
+}
+
+void TestMvtReader::visitorStopsReading()
+{
+    const auto data = serialize(buildTile());
+
+    MvtReader reader;
+    auto visitedCount = 0;
+    QVERIFY(reader.readTileData(data,
+        [&visitedCount]
+        (const std::shared_ptr<const MvtReader::Tile>& tile,
+            const QString& layerName,
+            const std::shared_ptr<const MvtReader::Geometry>& geometry) -> bool
+        {
+            visitedCount++;
+            return false;
+        }));
+    QCOMPARE(visitedCount, 1);
+}
+
+void TestMvtReader::truncatedTile_data()
+{
+    QTest::addColumn<QStringList>("layerNames");
+    QTest::addColumn< QList<int> >("geometryTypes");
+
+    QTest::newRow("all") << QStringList() << QList<int>();
+    QTest::newRow("skipped layers") << (QStringList() << "overview") << QList<int>();
+    QTest::newRow("skipped features") << QStringList() << (QList<int>() << MvtReader::POINT);
+}
+
+void TestMvtReader::truncatedTile()
+{
+    QFETCH(QStringList, layerNames);
+    QFETCH(QList<int>, geometryTypes);
+    const auto filter = makeFilter(layerNames, geometryTypes);
+
+    // Tile can be cut only between layers without being malformed
+    const auto tile = buildTile();
+    const auto data = serialize(tile);
+    QHash<int, int> layersCountByEnd;
+    for (auto layersCount = 0; layersCount <= tile.size(); layersCount++)
+        layersCountByEnd.insert(serialize(tile.mid(0, layersCount)).size(), layersCount);
+    QCOMPARE(layersCountByEnd.size(), tile.size() + 1);
+
+    MvtReader reader;
+    for (auto size = 0; size < data.size(); size++)
+    {
+        const auto truncatedData = data.left(size);
+
+        QList<Record> records;
+        const auto read = readRecords(reader, truncatedData, filter, records);
+        const auto parsedTile = reader.parseTileData(truncatedData, filter);
+        QVERIFY(parsedTile);
+        const auto citLayersCount = layersCountByEnd.constFind(size);
+        if (citLayersCount != layersCountByEnd.cend())
+        {
+            QVERIFY(read);
+            QCOMPARE(records, decodeReference(tile.mid(0, *citLayersCount), filter));
+            QCOMPARE(parseRecords(parsedTile), withoutLayerNames(records));
+        }
+        else
+        {
+            // Tile cut inside of a layer is rejected, including cuts between fields of embedded messages
+            QVERIFY(!read);
+            QVERIFY(parsedTile->empty());
+        }
+    }
+}
+
+QTEST_MAIN(TestMvtReader)
+#include "TestMvtReader.moc"
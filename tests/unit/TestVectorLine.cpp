@@ -0,0 +1,253 @@
+#include <OsmAndCore/Map/VectorLine.h>
+#include <OsmAndCore/Map/VectorLineBuilder.h>
+
+#include <limits>
+#include <vector>
+
+#include <QtTest/QtTest>
+#include <QCoreApplication>
+
+using namespace OsmAnd;
+
+class TestVectorLine : public QObject
+{
+    Q_OBJECT
+
+private:
+    // Same as size of simplification block of VectorLine
+    enum {
+        SimplificationBlockSize = 4096,
+    };
+
+    static QVector<PointI> generatePoints(const int count, const uint32_t seed);
+    static std::shared_ptr<VectorLine> buildLine(const QVector<PointI>& points);
+    static AreaI64 getUnclippedArea31();
+
+    // Douglas-Peucker as it was implemented before simplification was precomputed
+    static PointD getProjection(const PointD& point, const PointD& from, const PointD& to);
+    static int simplifyDouglasPeucker(
+        const std::vector<PointD>& points,
+        const int start,
+        const int end,
+        const double epsilon,
+        std::vector<bool>& include);
+    static QVector<int> simplify(const QVector<PointI>& points, const double epsilon);
+private slots:
+    void simplificationMatchesDouglasPeucker();
+    void simplificationKeepsBlockBoundaries();
+    void appendPointsRebuildsOnlyLastBlock();
+    void simplifiedRunsAreClipped();
+};
+
+QVector<PointI> TestVectorLine::generatePoints(const int count, const uint32_t seed)
+{
+    // Random walk that starts at origin, so that coordinates relative to first point are the same as
+    // absolute ones and distances are computed with exactly the same rounding
+    QVector<PointI> points;
+    points.reserve(count);
+    auto state = seed;
+    PointI point(0, 0);
+    for (auto pointIdx = 0; pointIdx < count; pointIdx++)
+    {
+        points.push_back(point);
+
+        state = state * 1664525u + 1013904223u;
+        point.x += static_cast<int32_t>((state >> 16) % 2001) - 1000;
+        state = state * 1664525u + 1013904223u;
+        point.y += static_cast<int32_t>((state >> 16) % 2001) - 1000;
+    }
+    return points;
+}
+
+std::shared_ptr<VectorLine> TestVectorLine::buildLine(const QVector<PointI>& points)
+{
+    VectorLineBuilder builder;
+    builder.setLineId(1);
+    builder.setLineWidth(10.0);
+    builder.setFillColor(FColorARGB(1.0f, 1.0f, 0.0f, 0.0f));
+    builder.setPoints(points);
+    return builder.build();
+}
+
+AreaI64 TestVectorLine::getUnclippedArea31()
+{
+    return AreaI64(
+        std::numeric_limits<int32_t>::min(),
+        std::numeric_limits<int32_t>::min(),
+        std::numeric_limits<int32_t>::max(),
+        std::numeric_limits<int32_t>::max());
+}
+
+PointD TestVectorLine::getProjection(const PointD& point, const PointD& from, const PointD& to)
+{
+    const double mDist = (from.x - to.x) * (from.x - to.x) + (from.y - to.y) * (from.y - to.y);
+    const double projection = (to.x - from.x) * (point.x - from.x) + (to.y - from.y) * (point.y - from.y);
+    if (projection < 0)
+        return from;
+    else if (projection >= mDist)
+        return to;
+    return PointD(
+        from.x + (to.x - from.x) * (projection / mDist),
+        from.y + (to.y - from.y) * (projection / mDist));
+}
+
+int TestVectorLine::simplifyDouglasPeucker(
+    const std::vector<PointD>& points,
+    const int start,
+    const int end,
+    const double epsilon,
+    std::vector<bool>& include)
+{
+    double dmax = -1;
+    int index = -1;
+    for (auto i = start + 1; i <= end - 1; i++)
+    {
+        const auto proj = getProjection(points[i], points[start], points[end]);
+        const auto d = qSqrt((points[i].x - proj.x) * (points[i].x - proj.x) + (points[i].y - proj.y) * (points[i].y - proj.y));
+        if (d > dmax)
+        {
+            dmax = d;
+            index = i;
+        }
+    }
+    if (dmax >= epsilon)
+    {
+        const auto enabled1 = simplifyDouglasPeucker(points, start, index, epsilon, include);
+        const auto enabled2 = simplifyDouglasPeucker(points, index, end, epsilon, include);
+        return enabled1 + enabled2;
+    }
+
+    include[end] = true;
+    return 1;
+}
+
+QVector<int> TestVectorLine::simplify(const QVector<PointI>& points, const double epsilon)
+{
+    std::vector<PointD> pointsToPlot;
+    for (const auto& point : points)
+        pointsToPlot.push_back(PointD(point.x - points[0].x, point.y - points[0].y));
+
+    // Each block is simplified on its own, so boundaries of blocks are always kept
+    std::vector<bool> include(points.size(), false);
+    include[0] = true;
+    for (auto start = 0; start < points.size() - 1; start += SimplificationBlockSize)
+    {
+        const auto end = qMin(start + static_cast<int>(SimplificationBlockSize), points.size() - 1);
+        simplifyDouglasPeucker(pointsToPlot, start, end, epsilon, include);
+    }
+
+    QVector<int> indices;
+    for (auto pointIdx = 0; pointIdx < points.size(); pointIdx++)
+    {
+        if (include[pointIdx])
+            indices.push_back(pointIdx);
+    }
+    return indices;
+}
+
+void TestVectorLine::simplificationMatchesDouglasPeucker()
+{
+    for (const auto seed : { 1u, 7u, 42u })
+    {
+        const auto points = generatePoints(1000, seed);
+        const auto line = buildLine(points);
+
+        for (const auto tolerance : { 0.0, 0.5, 1.0, 3.0, 10.0, 100.0, 1000.0, 10000.0, 1.0e6 })
+        {
+            const auto runs = line->getSimplifiedRuns(tolerance, getUnclippedArea31());
+            QCOMPARE(runs.size(), 1);
+            QCOMPARE(runs.first(), simplify(points, tolerance));
+        }
+    }
+}
+
+void TestVectorLine::simplificationKeepsBlockBoundaries()
+{
+    const auto points = generatePoints(SimplificationBlockSize * 2 + 500, 3);
+    const auto line = buildLine(points);
+
+    for (const auto tolerance : { 1.0, 100.0, 10000.0, 1.0e9 })
+    {
+        const auto runs = line->getSimplifiedRuns(tolerance, getUnclippedArea31());
+        QCOMPARE(runs.size(), 1);
+        QCOMPARE(runs.first(), simplify(points, tolerance));
+        QVERIFY(runs.first().contains(SimplificationBlockSize));
+        QVERIFY(runs.first().contains(SimplificationBlockSize * 2));
+    }
+}
+
+void TestVectorLine::appendPointsRebuildsOnlyLastBlock()
+{
+    const auto points = generatePoints(SimplificationBlockSize + 1000, 5);
+    const auto initialPointsCount = SimplificationBlockSize + 500;
+    const auto line = buildLine(points.mid(0, initialPointsCount));
+
+    // Complete block and incomplete one share boundary point
+    const auto simplifiedPointsCount = line->getSimplifiedPointsCount();
+    QCOMPARE(simplifiedPointsCount, static_cast<unsigned int>(initialPointsCount + 1));
+
+    line->appendPoints(points.mid(initialPointsCount));
+    QCOMPARE(
+        line->getSimplifiedPointsCount() - simplifiedPointsCount,
+        static_cast<unsigned int>(points.size() - SimplificationBlockSize));
+    QCOMPARE(line->getPoints(), points);
+
+    // Appended line is simplified the same way as line that had all points from the start
+    const auto completeLine = buildLine(points);
+    for (const auto tolerance : { 1.0, 100.0, 10000.0 })
+    {
+        QCOMPARE(
+            line->getSimplifiedRuns(tolerance, getUnclippedArea31()),
+            completeLine->getSimplifiedRuns(tolerance, getUnclippedArea31()));
+    }
+}
+
+void TestVectorLine::simplifiedRunsAreClipped()
+{
+    const auto points = generatePoints(SimplificationBlockSize * 3, 11);
+    const auto line = buildLine(points);
+
+    AreaI64 bbox31(points.first().y, points.first().x, points.first().y, points.first().x);
+    for (const auto& point : points)
+        bbox31.enlargeToInclude(PointI64(point));
+    const AreaI64 area31(
+        bbox31.top() + bbox31.height() / 4,
+        bbox31.left() + bbox31.width() / 4,
+        bbox31.bottom() - bbox31.height() / 4,
+        bbox31.right() - bbox31.width() / 4);
+
+    for (const auto tolerance : { 1.0, 1000.0 })
+    {
+        const auto simplifiedPoints = simplify(points, tolerance);
+        const auto runs = line->getSimplifiedRuns(tolerance, area31);
+
+        // Runs consist of consecutive simplified segments that intersect area, and no such segment is missed
+        QVector< QPair<int, int> > visibleSegments;
+        for (auto idx = 1; idx < simplifiedPoints.size(); idx++)
+        {
+            const auto& from = points[simplifiedPoints[idx - 1]];
+            const auto& to = points[simplifiedPoints[idx]];
+            const AreaI64 segmentBBox31(
+                qMin(from.y, to.y),
+                qMin(from.x, to.x),
+                qMax(from.y, to.y),
+                qMax(from.x, to.x));
+            if (area31.intersects(segmentBBox31))
+                visibleSegments.push_back(qMakePair(simplifiedPoints[idx - 1], simplifiedPoints[idx]));
+        }
+
+        QVector< QPair<int, int> > runsSegments;
+        for (const auto& run : runs)
+        {
+            QVERIFY(run.size() > 1);
+            for (auto idx = 1; idx < run.size(); idx++)
+                runsSegments.push_back(qMakePair(run[idx - 1], run[idx]));
+        }
+        QVERIFY(!runsSegments.isEmpty());
+        QVERIFY(runs.size() > 1 || runsSegments.size() < simplifiedPoints.size() - 1);
+        QCOMPARE(runsSegments, visibleSegments);
+    }
+}
+
+QTEST_MAIN(TestVectorLine)
+#include "TestVectorLine.moc"
@@ -0,0 +1,360 @@
+#include <OsmAndCore/Concurrent/WorkerPool.h>
+
+#include <functional>
+
+#include <QtTest/QtTest>
+#include <QCoreApplication>
+#include <QAtomicInt>
+#include <QMutex>
+#include <QSemaphore>
+#include <QVector>
+
+using namespace OsmAnd;
+using namespace OsmAnd::Concurrent;
+
+namespace
+{
+    class FunctorRunnable : public QRunnable
+    {
+    public:
+        FunctorRunnable(const std::function<void ()>& functor_)
+            : functor(functor_)
+        {
+        }
+
+        const std::function<void ()> functor;
+
+        virtual void run()
+        {
+            functor();
+        }
+    };
+
+    // Records order in which runnables are executed
+    class ExecutionLog
+    {
+    private:
+        mutable QMutex _mutex;
+        QVector<int> _ids;
+    public:
+        void append(const int id)
+        {
+            QMutexLocker scopedLocker(&_mutex);
+            _ids.push_back(id);
+        }
+
+        QVector<int> ids() const
+        {
+            QMutexLocker scopedLocker(&_mutex);
+            return _ids;
+        }
+    };
+
+    // Occupies the only thread of pool until released, so that queue can be filled before anything
+    // else is executed
+    class PoolBlocker
+    {
+    private:
+        QSemaphore _started;
+        QSemaphore _released;
+    public:
+        void block(WorkerPool& pool)
+        {
+            pool.enqueue(new FunctorRunnable(
+                [this]
+                ()
+                {
+                    _started.release();
+                    _released.acquire();
+                }));
+            _started.acquire();
+        }
+
+        void release()
+        {
+            _released.release();
+        }
+    };
+}
+
+class TestWorkerPool : public QObject
+{
+    Q_OBJECT
+
+private:
+    static QRunnable* createLoggingRunnable(ExecutionLog& log, const int id);
+private slots:
+    void fifoExecutesMostRecentFirst();
+    void lifoExecutesOldestFirst();
+    void priorityTakesPrecedenceOverOrder();
+    void sortPredicate();
+    void dequeue();
+    void updatePriorities();
+    void setOrderReordersQueue();
+    void waitForDone();
+    void respectsMaxThreadCount();
+    void concurrentEnqueue();
+};
+
+QRunnable* TestWorkerPool::createLoggingRunnable(ExecutionLog& log, const int id)
+{
+    return new FunctorRunnable(
+        [&log, id]
+        ()
+        {
+            log.append(id);
+        });
+}
+
+void TestWorkerPool::fifoExecutesMostRecentFirst()
+{
+    WorkerPool pool(WorkerPool::Order::FIFO, 1);
+    ExecutionLog log;
+    PoolBlocker blocker;
+
+    blocker.block(pool);
+    for (auto id = 0; id < 4; id++)
+        pool.enqueue(createLoggingRunnable(log, id));
+    QCOMPARE(pool.queueSize(), 4u);
+    blocker.release();
+    QVERIFY(pool.waitForDone(10000));
+
+    QCOMPARE(log.ids(), QVector<int>() << 3 << 2 << 1 << 0);
+}
+
+void TestWorkerPool::lifoExecutesOldestFirst()
+{
+    WorkerPool pool(WorkerPool::Order::LIFO, 1);
+    ExecutionLog log;
+    PoolBlocker blocker;
+
+    blocker.block(pool);
+    for (auto id = 0; id < 4; id++)
+        pool.enqueue(createLoggingRunnable(log, id));
+    blocker.release();
+    QVERIFY(pool.waitForDone(10000));
+
+    QCOMPARE(log.ids(), QVector<int>() << 0 << 1 << 2 << 3);
+}
+
+void TestWorkerPool::priorityTakesPrecedenceOverOrder()
+{
+    WorkerPool pool(WorkerPool::Order::LIFO, 1);
+    ExecutionLog log;
+    PoolBlocker blocker;
+
+    blocker.block(pool);
+    pool.enqueueWithPriority(createLoggingRunnable(log, 0), 1);
+    pool.enqueueWithPriority(createLoggingRunnable(log, 1), 5);
+    pool.enqueueWithPriority(createLoggingRunnable(log, 2), 1);
+    pool.enqueueWithPriority(createLoggingRunnable(log, 3), 3);
+    pool.enqueueWithPriority(createLoggingRunnable(log, 4), 5);
+    blocker.release();
+    QVERIFY(pool.waitForDone(10000));
+
+    QCOMPARE(log.ids(), QVector<int>() << 1 << 4 << 3 << 0 << 2);
+}
+
+void TestWorkerPool::sortPredicate()
+{
+    QHash<QRunnable*, int> keys;
+    const WorkerPool::SortPredicate predicate =
+        [&keys]
+        (QRunnable* const l, QRunnable* const r) -> bool
+        {
+            return keys[l] < keys[r];
+        };
+
+    // FIFO executes runnables from the start of sorted queue, LIFO from its end
+    for (const auto order : { WorkerPool::Order::FIFO, WorkerPool::Order::LIFO })
+    {
+        WorkerPool pool(order, 1);
+        ExecutionLog log;
+        PoolBlocker blocker;
+
+        blocker.block(pool);
+        QVector<QRunnable*> runnables;
+        for (const auto id : { 2, 0, 3, 1 })
+        {
+            const auto runnable = createLoggingRunnable(log, id);
+            keys.insert(runnable, id);
+            runnables.push_back(runnable);
+        }
+        pool.enqueue(runnables, predicate);
+        blocker.release();
+        QVERIFY(pool.waitForDone(10000));
+
+        if (order == WorkerPool::Order::FIFO)
+            QCOMPARE(log.ids(), QVector<int>() << 0 << 1 << 2 << 3);
+        else
+            QCOMPARE(log.ids(), QVector<int>() << 3 << 2 << 1 << 0);
+        keys.clear();
+    }
+}
+
+void TestWorkerPool::dequeue()
+{
+    WorkerPool pool(WorkerPool::Order::LIFO, 1);
+    ExecutionLog log;
+    PoolBlocker blocker;
+
+    blocker.block(pool);
+    QVector<QRunnable*> runnables;
+    for (auto id = 0; id < 8; id++)
+    {
+        const auto runnable = createLoggingRunnable(log, id);
+        runnable->setAutoDelete(false);
+        runnables.push_back(runnable);
+        pool.enqueueWithPriority(runnable, id % 3);
+    }
+
+    // Runnable 2 is at the top of heap
+    QVERIFY(pool.dequeue(runnables[4]));
+    QVERIFY(pool.dequeue(runnables[7]));
+    QVERIFY(pool.dequeue(runnables[2]));
+    QVERIFY(!pool.dequeue(runnables[2]));
+    QCOMPARE(pool.queueSize(), 5u);
+    blocker.release();
+    QVERIFY(pool.waitForDone(10000));
+
+    QCOMPARE(log.ids(), QVector<int>() << 5 << 1 << 0 << 3 << 6);
+    qDeleteAll(runnables);
+}
+
+void TestWorkerPool::updatePriorities()
+{
+    WorkerPool pool(WorkerPool::Order::LIFO, 1);
+    ExecutionLog log;
+    PoolBlocker blocker;
+
+    blocker.block(pool);
+    QHash<QRunnable*, int> ids;
+    for (auto id = 0; id < 6; id++)
+    {
+        const auto runnable = createLoggingRunnable(log, id);
+        ids.insert(runnable, id);
+        pool.enqueueWithPriority(runnable, id);
+    }
+    pool.updatePriorities(
+        [&ids]
+        (QRunnable* const runnable) -> int64_t
+        {
+            return -ids[runnable];
+        });
+    blocker.release();
+    QVERIFY(pool.waitForDone(10000));
+
+    QCOMPARE(log.ids(), QVector<int>() << 0 << 1 << 2 << 3 << 4 << 5);
+}
+
+void TestWorkerPool::setOrderReordersQueue()
+{
+    WorkerPool pool(WorkerPool::Order::FIFO, 1);
+    ExecutionLog log;
+    PoolBlocker blocker;
+
+    blocker.block(pool);
+    for (auto id = 0; id < 4; id++)
+        pool.enqueue(createLoggingRunnable(log, id));
+    pool.setOrder(WorkerPool::Order::LIFO);
+    QCOMPARE(pool.order(), WorkerPool::Order::LIFO);
+    blocker.release();
+    QVERIFY(pool.waitForDone(10000));
+
+    QCOMPARE(log.ids(), QVector<int>() << 0 << 1 << 2 << 3);
+}
+
+void TestWorkerPool::waitForDone()
+{
+    WorkerPool pool(WorkerPool::Order::FIFO, 2);
+    PoolBlocker blocker;
+
+    blocker.block(pool);
+    QVERIFY(!pool.waitForDone(50));
+    QCOMPARE(pool.activeThreadCount(), 1u);
+    blocker.release();
+    QVERIFY(pool.waitForDone(10000));
+    QCOMPARE(pool.activeThreadCount(), 0u);
+    QCOMPARE(pool.queueSize(), 0u);
+}
+
+void TestWorkerPool::respectsMaxThreadCount()
+{
+    const auto maxThreadCount = 3;
+    WorkerPool pool(WorkerPool::Order::FIFO, maxThreadCount);
+    QAtomicInt runningCount;
+    QAtomicInt maxRunningCount;
+    QAtomicInt executedCount;
+
+    QVector<QRunnable*> runnables;
+    for (auto index = 0; index < 64; index++)
+    {
+        runnables.push_back(new FunctorRunnable(
+            [&runningCount, &maxRunningCount, &executedCount]
+            ()
+            {
+                const auto running = runningCount.fetchAndAddOrdered(1) + 1;
+                for (;;)
+                {
+                    const auto maxRunning = maxRunningCount.loadAcquire();
+                    if (running <= maxRunning || maxRunningCount.testAndSetOrdered(maxRunning, running))
+                        break;
+                }
+                QThread::msleep(1);
+                runningCount.fetchAndAddOrdered(-1);
+                executedCount.fetchAndAddOrdered(1);
+            }));
+    }
+    pool.enqueue(runnables);
+    QVERIFY(pool.waitForDone(10000));
+
+    QCOMPARE(executedCount.loadAcquire(), 64);
+    QVERIFY(maxRunningCount.loadAcquire() <= maxThreadCount);
+    QVERIFY(maxRunningCount.loadAcquire() > 0);
+}
+
+void TestWorkerPool::concurrentEnqueue()
+{
+    WorkerPool pool(WorkerPool::Order::Random, 4);
+    QAtomicInt executedCount;
+
+    // Producers enqueue and dequeue at the same time as workers take runnables
+    const auto producersCount = 4;
+    const auto runnablesPerProducer = 500;
+    QVector<QThread*> producers;
+    for (auto producerIndex = 0; producerIndex < producersCount; producerIndex++)
+    {
+        producers.push_back(QThread::create(
+            [&pool, &executedCount, producerIndex]
+            ()
+            {
+                for (auto index = 0; index < runnablesPerProducer; index++)
+                {
+                    const auto runnable = new FunctorRunnable(
+                        [&executedCount]
+                        ()
+                        {
+                            executedCount.fetchAndAddOrdered(1);
+                        });
+                    if (index % 2 == 0)
+                        pool.enqueue(runnable);
+                    else
+                        pool.enqueueWithPriority(runnable, producerIndex * runnablesPerProducer + index);
+                }
+            }));
+    }
+    for (const auto producer : producers)
+        producer->start();
+    for (const auto producer : producers)
+    {
+        producer->wait();
+        delete producer;
+    }
+    QVERIFY(pool.waitForDone(10000));
+
+    QCOMPARE(executedCount.loadAcquire(), producersCount * runnablesPerProducer);
+    QCOMPARE(pool.queueSize(), 0u);
+}
+
+QTEST_MAIN(TestWorkerPool)
+#include "TestWorkerPool.moc"